@@ -0,0 +1,79 @@
+# 基准测试库，提供 main 函数、场景注册、帧时间统计以及 JSON 输出
+function(BuildBenchmarkLibrary)
+    file(GLOB benchmark_sources ${PROJECT_SOURCE_DIR}/sources/benchmark/*.cpp)
+    file(GLOB benchmark_headers ${PROJECT_SOURCE_DIR}/sources/benchmark/*.h)
+
+    add_library(benchmark STATIC ${benchmark_sources} ${benchmark_headers})
+    target_include_directories(benchmark PUBLIC ${PROJECT_SOURCE_DIR}/sources/benchmark)
+    target_include_directories(benchmark PRIVATE ${PROJECT_SOURCE_DIR}/includes)
+
+    if(WIN32)
+        target_link_libraries(benchmark PUBLIC psapi)
+    endif()
+endfunction(BuildBenchmarkLibrary)
+
+# 示例目录下有 bench 目录时生成 bench_<number>_<name> 目标
+# 示例中除 main.cpp 以外的源文件和 bench 目录中的场景一起编译
+function(BuildBenchmark path)
+    get_filename_component(var_name ${path} NAME)
+    string(FIND ${var_name} "_" underscore_pos)
+
+    if (underscore_pos GREATER 0)
+        string(SUBSTRING ${var_name} 0 ${underscore_pos} number)
+        file(GLOB subdirectories ${path}/*)
+
+        foreach(subdir ${subdirectories})
+            if (NOT IS_DIRECTORY ${subdir}/bench)
+                continue()
+            endif()
+
+            get_filename_component(tar_name ${subdir} NAME)
+            file(GLOB_RECURSE subdir_sources ${subdir}/*.cpp)
+            file(GLOB_RECURSE subdir_headers ${subdir}/*.h)
+            list(FILTER subdir_sources EXCLUDE REGEX "/main\\.cpp$")
+            set(target_name "bench_${number}_${tar_name}")
+
+            # target
+            add_executable(${target_name} ${subdir_sources} ${subdir_headers})
+            target_include_directories(${target_name} PRIVATE ${subdir} ${PROJECT_SOURCE_DIR}/sources/common)
+            target_link_libraries(${target_name} PRIVATE benchmark)
+
+            # 3rdparty
+            target_include_directories(${target_name} PRIVATE ${PROJECT_SOURCE_DIR}/includes)
+            target_link_directories(${target_name} PRIVATE ${PROJECT_SOURCE_DIR}/libs)
+            target_link_libraries(${target_name} PRIVATE glfw imgui)
+
+            # vulkan
+            target_include_directories(${target_name} PRIVATE ${Vulkan_INCLUDE_DIR})
+            target_link_libraries(${target_name} PRIVATE ${Vulkan_LIBRARIES})
+
+            add_dependencies(${target_name} imgui)
+
+            # 运行时读取 resources/shaders 中的 spv
+            add_dependencies(${target_name} shaders)
+
+            set_property(GLOBAL APPEND PROPERTY BENCHMARK_TARGETS ${target_name})
+        endforeach(subdir ${subdirectories})
+    endif()
+endfunction(BuildBenchmark path)
+
+# bench_all 构建所有基准测试，bench_run 依次运行并把结果写入 <build>/bench/<target>.json
+# 可以通过 BENCHMARK_LABEL 把提交的哈希等信息写入结果，用来对比不同提交之间的性能
+function(AddBenchmarkRunTarget)
+    get_property(benchmark_targets GLOBAL PROPERTY BENCHMARK_TARGETS)
+    if (NOT benchmark_targets)
+        return()
+    endif()
+
+    set(output_dir ${CMAKE_BINARY_DIR}/bench)
+    set(commands COMMAND ${CMAKE_COMMAND} -E make_directory ${output_dir})
+    foreach(target_name ${benchmark_targets})
+        # 着色器使用相对于可执行文件目录的路径加载
+        list(APPEND commands
+            COMMAND ${CMAKE_COMMAND} -E chdir $<TARGET_FILE_DIR:${target_name}>
+                    $<TARGET_FILE:${target_name}> --output ${output_dir}/${target_name}.json --label "${BENCHMARK_LABEL}")
+    endforeach()
+
+    add_custom_target(bench_all DEPENDS ${benchmark_targets})
+    add_custom_target(bench_run ${commands} DEPENDS ${benchmark_targets} VERBATIM)
+endfunction(AddBenchmarkRunTarget)
@@ -10,11 +10,18 @@ function(BuildTarget path)
             get_filename_component(tar_name ${subdir} NAME)
             file(GLOB_RECURSE subdir_sources ${subdir}/*.cpp)
             file(GLOB_RECURSE subdir_headers ${subdir}/*.h)
+
+            # bench 目录中的基准测试场景由 BuildBenchmark 编译
+            list(FILTER subdir_sources EXCLUDE REGEX "/bench/")
+            list(FILTER subdir_headers EXCLUDE REGEX "/bench/")
             set(target_name "${number}_${tar_name}")
 
             # target
             add_executable(${target_name} ${subdir_sources} ${subdir_headers})
 
+            # 多个示例共用的头文件
+            target_include_directories(${target_name} PRIVATE ${PROJECT_SOURCE_DIR}/sources/common)
+
             # 3rdparty
             target_include_directories(${target_name} PRIVATE ${PROJECT_SOURCE_DIR}/includes)
             target_link_directories(${target_name} PRIVATE ${PROJECT_SOURCE_DIR}/libs)
@@ -27,6 +34,9 @@ function(BuildTarget path)
             # 确保 imgui 已经成功构建
             add_dependencies(${target_name} imgui)
 
+            # 运行时读取 resources/shaders 中的 spv
+            add_dependencies(${target_name} shaders)
+
             # install(TARGETS ${target_name} RUNTIME DESTINATION .)
 
         endforeach(subdir ${subdirectories})
@@ -0,0 +1,47 @@
+# 构建时把 sources/<章节>/<示例>/shaders 中的着色器编译到 resources/shaders/<章节编号>_<示例编号>_<文件名>_<扩展名>.spv
+# 命名规则和 script/compile_shaders.py 相同，示例目标都依赖 shaders 目标
+# 仓库中的 spv 不一定和着色器同步（有的还没有提交，有的早于着色器的修改），所以 glslc 是必需的
+# 每个构建目录第一次构建时全部编译一次（stamp 文件不存在），之后只重新编译修改过的着色器
+function(CompileShaders)
+    if(Vulkan_GLSLC_EXECUTABLE)
+        set(glslc ${Vulkan_GLSLC_EXECUTABLE})
+    else()
+        find_program(glslc NAMES glslc HINTS $ENV{VULKAN_SDK}/bin $ENV{VULKAN_SDK}/Bin)
+    endif()
+
+    if(NOT glslc)
+        message(FATAL_ERROR "glslc not found, install the Vulkan SDK or set Vulkan_GLSLC_EXECUTABLE")
+    endif()
+
+    file(GLOB shader_sources ${PROJECT_SOURCE_DIR}/sources/*/*/shaders/*)
+    file(MAKE_DIRECTORY ${CMAKE_BINARY_DIR}/shaders)
+
+    set(shader_stamps)
+    foreach(shader ${shader_sources})
+        get_filename_component(shader_dir ${shader} DIRECTORY)
+        get_filename_component(sample_dir ${shader_dir} DIRECTORY)
+        get_filename_component(section_dir ${sample_dir} DIRECTORY)
+        get_filename_component(sample_name ${sample_dir} NAME)
+        get_filename_component(section_name ${section_dir} NAME)
+        get_filename_component(shader_name ${shader} NAME)
+
+        string(REGEX MATCH "^[^_]+" sample_number ${sample_name})
+        string(REGEX MATCH "^[^_]+" section_number ${section_name})
+        string(REPLACE "." "_" shader_name ${shader_name})
+
+        set(output_name ${section_number}_${sample_number}_${shader_name}.spv)
+        set(output ${PROJECT_SOURCE_DIR}/resources/shaders/${output_name})
+        set(stamp ${CMAKE_BINARY_DIR}/shaders/${output_name}.stamp)
+        add_custom_command(
+            OUTPUT ${stamp}
+            COMMAND ${glslc} ${shader} -o ${output}
+            COMMAND ${CMAKE_COMMAND} -E touch ${stamp}
+            DEPENDS ${shader}
+            COMMENT "Compiling ${output_name}"
+            VERBATIM
+        )
+        list(APPEND shader_stamps ${stamp})
+    endforeach()
+
+    add_custom_target(shaders ALL DEPENDS ${shader_stamps})
+endfunction(CompileShaders)
@@ -3,9 +3,9 @@ import sys
 
 path_env = os.environ.get('PATH')
 path_dirs = path_env.split(os.pathsep)
-executable_name = "glslc.exe"
-src_path = os.path.dirname(os.path.abspath(__file__)) + "\\..\\sources"
-dst_path = os.path.dirname(os.path.abspath(__file__)) + "\\..\\resources\\shaders"
+executable_name = "glslc.exe" if os.name == "nt" else "glslc"
+src_path = os.path.join(os.path.dirname(os.path.abspath(__file__)), "..", "sources")
+dst_path = os.path.join(os.path.dirname(os.path.abspath(__file__)), "..", "resources", "shaders")
 
 # 获取glsc.exe
 def Find_glslc():
@@ -31,7 +31,7 @@ def list_subdirectories(root_dir):
     subdirectories = []
     for item in os.listdir(root_dir):
         if(item == "shaders"):
-            subdirectories.append(root_dir + "\\shaders")
+            subdirectories.append(os.path.join(root_dir, "shaders"))
         item_path = os.path.join(root_dir, item)
         if os.path.isdir(item_path):
             subdirectories.extend(list_subdirectories(item_path))
@@ -39,7 +39,7 @@ def list_subdirectories(root_dir):
 
 # 将所有shaders文件夹中的shader文件编译到 resources/shaders文件夹中
 for subdir in list_subdirectories(src_path):
-    parts = subdir.split("\\")
+    parts = os.path.normpath(subdir).split(os.sep)
     pre = parts[-3].split("_")[0] + "_" + parts[-2].split("_")[0] + "_"
     for shader in os.listdir(subdir):
         shader_path = os.path.join(subdir, shader)
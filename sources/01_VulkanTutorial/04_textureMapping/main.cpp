@@ -2130,14 +2130,17 @@ int main()
 
 #include <algorithm>
 #include <array>
+#include <chrono>
 #include <fstream>
+#include <future>
 #include <iostream>
-#include <map>
 #include <optional>
 #include <set>
 #include <stdexcept>
 #include <vector>
 
+#include "ThreadPool.h"
+
 // 窗口默认大小
 constexpr uint32_t WIDTH  = 800;
 constexpr uint32_t HEIGHT = 600;
@@ -2145,6 +2148,9 @@ constexpr uint32_t HEIGHT = 600;
 // 同时并行处理的帧数
 constexpr int MAX_FRAMES_IN_FLIGHT = 2;
 
+// 解码纹理的后台线程数（ThreadPool.h），切换纹理时不再为每次选择创建一个线程
+constexpr uint32_t TEXTURE_DECODE_THREADS = 1;
+
 // 需要开启的校验层的名称
 const std::vector<const char*> g_validationLayers = {"VK_LAYER_KHRONOS_validation"};
 // 交换链扩展
@@ -2164,6 +2170,33 @@ struct Texture
     VkDeviceMemory imageMemory {nullptr};
 };
 
+// 后台线程解码之后写入的暂存缓冲
+struct StagingImage
+{
+    uint32_t width {0};
+    uint32_t height {0};
+    VkBuffer buffer {nullptr};
+    VkDeviceMemory memory {nullptr};
+};
+
+// 正在加载的纹理：后台线程解码 => 主线程提交上传 => 栅栏发出信号之后替换当前显示的纹理
+struct TextureLoad
+{
+    int index {0}; // m_textureFileNames 的下标
+    std::future<StagingImage> decoded {};
+    StagingImage staging {};
+    std::unique_ptr<Texture> texture {};
+    VkCommandBuffer commandBuffer {nullptr};
+    VkFence fence {nullptr};
+};
+
+// 被替换的纹理，所有帧的描述符集都更新之后销毁
+struct RetiredTexture
+{
+    std::unique_ptr<Texture> texture {};
+    uint32_t staleFrames {0}; // 描述符集还在引用这个纹理的帧，每一位对应一个同时处理的帧
+};
+
 struct Vertex
 {
     glm::vec2 pos {0.f, 0.f};
@@ -2303,10 +2336,9 @@ private:
 
     void LoadTextures()
     {
-        for (auto name : m_textureFileNames)
-        {
-            m_textures.try_emplace(name, CreateTextureImage(std::string("../resources/textures/") + name));
-        }
+        // 第一个纹理也通过后台线程加载，这里等待完成，保证第一帧绘制时描述符集引用有效的纹理
+        RequestTexture(m_currentTextureIndex);
+        UpdateTextureLoads(true);
     }
 
     void MainLoop()
@@ -2314,6 +2346,7 @@ private:
         while (!glfwWindowShouldClose(m_window))
         {
             glfwPollEvents();
+            UpdateTextureLoads(false);
             PrepareImGui();
             DrawFrame();
         }
@@ -2333,12 +2366,31 @@ private:
 
         vkDestroySampler(m_device, m_textureSampler, nullptr);
 
-        for (const auto& [_, texture] : m_textures)
+        // 等待正在加载的纹理完成，设备已经空闲，被替换的纹理可以直接销毁
+        // Cleanup 不能抛出异常，解码失败的纹理已经从列表中移除，只输出错误，再次等待其余的纹理，线程池的任务不会在设备销毁之后执行
+        for (auto failed = true; failed;)
         {
-            vkDestroyImage(m_device, texture->image, nullptr);
-            vkFreeMemory(m_device, texture->imageMemory, nullptr);
-            vkDestroyImageView(m_device, texture->imageView, nullptr);
+            failed = false;
+            try
+            {
+                UpdateTextureLoads(true);
+            }
+            catch (const std::exception& e)
+            {
+                std::cerr << e.what() << '\n';
+                failed = true;
+            }
+            catch (...)
+            {
+                std::cerr << "failed to load texture\n";
+                failed = true;
+            }
+        }
+        for (const auto& retired : m_retiredTextures)
+        {
+            DestroyTexture(*retired.texture);
         }
+        DestroyTexture(*m_texture);
 
         vkDestroyBuffer(m_device, m_vertexBuffer, nullptr);
         vkFreeMemory(m_device, m_vertexBufferMemory, nullptr);
@@ -2390,14 +2442,21 @@ private:
         ImGui::SetNextWindowPos(ImVec2(10, 10));
         ImGui::Begin("Display Infomation", nullptr, ImGuiWindowFlags_AlwaysAutoResize | ImGuiWindowFlags_NoResize | ImGuiWindowFlags_NoMove);
 
+        // 切换纹理时在后台加载，加载完成之前继续显示当前的纹理
         if (ImGui::Combo("Texture", &m_currentTextureIndex, m_textureFileNames.data(), static_cast<int>(m_textureFileNames.size())))
         {
-            for (auto i = 0; i < MAX_FRAMES_IN_FLIGHT; ++i)
+            auto loading = std::ranges::any_of(m_textureLoads, [this](const TextureLoad& load) { return load.index == m_currentTextureIndex; });
+            if (m_currentTextureIndex != m_displayedTextureIndex && !loading)
             {
-                m_textureChanged[i] = true;
+                RequestTexture(m_currentTextureIndex);
             }
         }
 
+        if (!m_textureLoads.empty())
+        {
+            ImGui::Text("Loading...");
+        }
+
         ImGui::End();
 
         ImGui::Render();
@@ -3442,6 +3501,9 @@ private:
             m_textureChanged[m_currentFrame] = false;
         }
 
+        // 这一帧的描述符集已经不再引用被替换的纹理
+        ReleaseRetiredTextures();
+
         // 每一帧都更新uniform
         UpdateUniformBuffer(static_cast<uint32_t>(m_currentFrame));
 
@@ -3728,6 +3790,21 @@ private:
         return commandBuffer;
     }
 
+    /// @brief 加载纹理时返回上传的指令缓冲，否则创建一个单次使用的指令缓冲
+    VkCommandBuffer BeginUploadCommands() const noexcept
+    {
+        return m_uploadCommandBuffer ? m_uploadCommandBuffer : BeginSingleTimeCommands();
+    }
+
+    /// @brief 加载纹理时由 UploadTexture 统一提交，否则立即提交并等待完成
+    void EndUploadCommands(VkCommandBuffer commandBuffer) const noexcept
+    {
+        if (!m_uploadCommandBuffer)
+        {
+            EndSingleTimeCommands(commandBuffer);
+        }
+    }
+
     void EndSingleTimeCommands(VkCommandBuffer commandBuffer) const noexcept
     {
         vkEndCommandBuffer(commandBuffer);
@@ -3900,7 +3977,7 @@ private:
 
         VkDescriptorImageInfo imageInfo {};
         imageInfo.imageLayout = VK_IMAGE_LAYOUT_SHADER_READ_ONLY_OPTIMAL;
-        imageInfo.imageView   = m_textures.at(m_textureFileNames[m_currentTextureIndex])->imageView;
+        imageInfo.imageView   = m_texture->imageView;
         imageInfo.sampler     = m_textureSampler;
 
         std::array<VkWriteDescriptorSet, 2> descriptorWrites {};
@@ -3952,50 +4029,137 @@ private:
         }
     }
 
-    std::unique_ptr<Texture> CreateTextureImage(const std::string& filePath)
+    /// @brief 在后台线程解码纹理文件并写入暂存缓冲，不阻塞主循环
+    void RequestTexture(int index)
     {
-        auto texture = std::make_unique<Texture>();
+        auto filePath = std::string("../resources/textures/") + m_textureFileNames[index];
+        m_textureLoads.emplace_back(index, m_decodePool.Submit([this, filePath]() { return DecodeTexture(filePath); }));
+    }
 
+    /// @brief 在后台线程中执行：解码图像文件并复制到暂存缓冲
+    /// @details 创建缓冲、分配内存不需要外部同步，指令缓冲的录制和提交只在主线程进行
+    StagingImage DecodeTexture(const std::string& filePath) const
+    {
         // STBI_rgb_alpha 强制使用alpha通道，如果没有会被添加一个默认的alpha值，texChannels返回图像实际的通道数
         int texWidth {0}, texHeight {0}, texChannels {0};
         auto pixels = stbi_load(filePath.c_str(), &texWidth, &texHeight, &texChannels, STBI_rgb_alpha);
-        std::cout << "image extent: " << texWidth << ", " << texHeight << ", " << texChannels << '\n';
         if (!pixels)
         {
-            throw std::runtime_error("failed to load texture image");
+            throw std::runtime_error("failed to load texture image: " + filePath);
         }
 
+        StagingImage staging {static_cast<uint32_t>(texWidth), static_cast<uint32_t>(texHeight)};
         VkDeviceSize imageSize = texWidth * texHeight * 4;
 
-        VkBuffer stagingBuffer {};
-        VkDeviceMemory stagingBufferMemory {};
-
         CreateBuffer(
             imageSize,
             VK_BUFFER_USAGE_TRANSFER_SRC_BIT,
             VK_MEMORY_PROPERTY_HOST_VISIBLE_BIT | VK_MEMORY_PROPERTY_HOST_COHERENT_BIT,
-            stagingBuffer,
-            stagingBufferMemory
+            staging.buffer,
+            staging.memory
         );
 
         void* data {nullptr};
-        vkMapMemory(m_device, stagingBufferMemory, 0, imageSize, 0, &data);
+        vkMapMemory(m_device, staging.memory, 0, imageSize, 0, &data);
         std::memcpy(data, pixels, static_cast<size_t>(imageSize));
-        vkUnmapMemory(m_device, stagingBufferMemory);
+        vkUnmapMemory(m_device, staging.memory);
 
         stbi_image_free(pixels);
 
+        return staging;
+    }
+
+    /// @brief 检查正在加载的纹理：解码完成的纹理在主线程提交上传，上传完成之后替换当前显示的纹理
+    /// @param wait 为 true 时等待所有纹理加载完成，初始化和退出程序时使用
+    void UpdateTextureLoads(bool wait)
+    {
+        for (auto it = m_textureLoads.begin(); it != m_textureLoads.end();)
+        {
+            auto& load = *it;
+            if (!load.fence)
+            {
+                if (!wait && std::future_status::ready != load.decoded.wait_for(std::chrono::seconds(0)))
+                {
+                    ++it;
+                    continue;
+                }
+
+                // 解码失败的纹理从列表中移除之后再抛出异常，其他纹理留给下一次调用
+                try
+                {
+                    load.staging = load.decoded.get();
+                }
+                catch (...)
+                {
+                    m_textureLoads.erase(it);
+                    throw;
+                }
+                UploadTexture(load);
+            }
+
+            auto status = wait ? vkWaitForFences(m_device, 1, &load.fence, VK_TRUE, std::numeric_limits<uint64_t>::max())
+                               : vkGetFenceStatus(m_device, load.fence);
+            if (VK_SUCCESS != status)
+            {
+                ++it;
+                continue;
+            }
+
+            vkDestroyBuffer(m_device, load.staging.buffer, nullptr);
+            vkFreeMemory(m_device, load.staging.memory, nullptr);
+            vkDestroyFence(m_device, load.fence, nullptr);
+            vkFreeCommandBuffers(m_device, m_commandPool, 1, &load.commandBuffer);
+
+            if (load.index == m_currentTextureIndex)
+            {
+                // 每一帧在自己的栅栏发出信号之后更新描述符集，旧的纹理在所有帧都更新之后销毁
+                if (m_texture)
+                {
+                    m_retiredTextures.emplace_back(std::move(m_texture), (1u << MAX_FRAMES_IN_FLIGHT) - 1);
+                }
+
+                m_texture               = std::move(load.texture);
+                m_displayedTextureIndex = load.index;
+                m_textureChanged.fill(true);
+            }
+            else
+            {
+                // 加载期间又选择了其他纹理，这个纹理还没有被任何描述符集引用，可以直接销毁
+                DestroyTexture(*load.texture);
+            }
+
+            it = m_textureLoads.erase(it);
+        }
+    }
+
+    /// @brief 创建图像并提交上传指令，用栅栏等待完成，不调用 vkQueueWaitIdle
+    void UploadTexture(TextureLoad& load)
+    {
+        load.texture = std::make_unique<Texture>();
+
         CreateImage(
-            texWidth,
-            texHeight,
+            load.staging.width,
+            load.staging.height,
             VK_FORMAT_R8G8B8A8_SRGB,
             VK_IMAGE_TILING_OPTIMAL,
             VK_IMAGE_USAGE_TRANSFER_DST_BIT | VK_IMAGE_USAGE_SAMPLED_BIT,
             VK_MEMORY_PROPERTY_DEVICE_LOCAL_BIT,
-            texture->image,
-            texture->imageMemory
+            load.texture->image,
+            load.texture->imageMemory
         );
 
+        VkFenceCreateInfo fenceInfo = {};
+        fenceInfo.sType             = VK_STRUCTURE_TYPE_FENCE_CREATE_INFO;
+
+        if (VK_SUCCESS != vkCreateFence(m_device, &fenceInfo, nullptr, &load.fence))
+        {
+            throw std::runtime_error("failed to create fence");
+        }
+
+        // 布局变换和复制指令都录制到 load.commandBuffer 中
+        load.commandBuffer    = BeginSingleTimeCommands();
+        m_uploadCommandBuffer = load.commandBuffer;
+
         // 图像布局的适用场合：
         // VK_IMAGE_LAYOUT_PRESENT_SRC_KHR 适合呈现操作
         // VK_IMAGE_LAYOUT_COLOR_ATTACHMENT_OPTIMAL 适合作为颜色附着，在片段着色器中写入颜色数据
@@ -4005,20 +4169,53 @@ private:
 
         // 变换纹理图像到 VK_IMAGE_LAYOUT_TRANSFER_DST_OPTIMAL
         // 旧布局设置为 VK_IMAGE_LAYOUT_UNDEFINED ，因为不需要读取复制之前的图像内容
-        TransitionImageLayout(texture->image, VK_FORMAT_R8G8B8A8_SRGB, VK_IMAGE_LAYOUT_UNDEFINED, VK_IMAGE_LAYOUT_TRANSFER_DST_OPTIMAL);
+        TransitionImageLayout(load.texture->image, VK_FORMAT_R8G8B8A8_SRGB, VK_IMAGE_LAYOUT_UNDEFINED, VK_IMAGE_LAYOUT_TRANSFER_DST_OPTIMAL);
         // 执行图像数据复制操作
-        CopyBufferToImage(stagingBuffer, texture->image, static_cast<uint32_t>(texWidth), static_cast<uint32_t>(texHeight));
+        CopyBufferToImage(load.staging.buffer, load.texture->image, load.staging.width, load.staging.height);
         // 将图像转换为能够在着色器中采样的纹理数据图像
         TransitionImageLayout(
-            texture->image, VK_FORMAT_R8G8B8A8_SRGB, VK_IMAGE_LAYOUT_TRANSFER_DST_OPTIMAL, VK_IMAGE_LAYOUT_SHADER_READ_ONLY_OPTIMAL
+            load.texture->image, VK_FORMAT_R8G8B8A8_SRGB, VK_IMAGE_LAYOUT_TRANSFER_DST_OPTIMAL, VK_IMAGE_LAYOUT_SHADER_READ_ONLY_OPTIMAL
         );
 
-        vkDestroyBuffer(m_device, stagingBuffer, nullptr);
-        vkFreeMemory(m_device, stagingBufferMemory, nullptr);
+        m_uploadCommandBuffer = nullptr;
+        vkEndCommandBuffer(load.commandBuffer);
+
+        VkSubmitInfo submitInfo       = {};
+        submitInfo.sType              = VK_STRUCTURE_TYPE_SUBMIT_INFO;
+        submitInfo.commandBufferCount = 1;
+        submitInfo.pCommandBuffers    = &load.commandBuffer;
+
+        if (VK_SUCCESS != vkQueueSubmit(m_graphicsQueue, 1, &submitInfo, load.fence))
+        {
+            throw std::runtime_error("failed to submit texture upload");
+        }
+
+        load.texture->imageView = CreateImageView(load.texture->image, VK_FORMAT_R8G8B8A8_SRGB);
+    }
 
-        texture->imageView = CreateImageView(texture->image, VK_FORMAT_R8G8B8A8_SRGB);
+    /// @brief 当前帧的栅栏已经发出信号，并且描述符集已经更新，被替换的纹理不再被这一帧使用
+    void ReleaseRetiredTextures() noexcept
+    {
+        auto frameBit = 1u << m_currentFrame;
+        for (auto it = m_retiredTextures.begin(); it != m_retiredTextures.end();)
+        {
+            it->staleFrames &= ~frameBit;
+            if (0 != it->staleFrames)
+            {
+                ++it;
+                continue;
+            }
 
-        return texture;
+            DestroyTexture(*it->texture);
+            it = m_retiredTextures.erase(it);
+        }
+    }
+
+    void DestroyTexture(const Texture& texture) noexcept
+    {
+        vkDestroyImage(m_device, texture.image, nullptr);
+        vkFreeMemory(m_device, texture.imageMemory, nullptr);
+        vkDestroyImageView(m_device, texture.imageView, nullptr);
     }
 
     /// @brief 创建指定格式的图像对象
@@ -4088,7 +4285,7 @@ private:
     /// @param newLayout
     void TransitionImageLayout(VkImage image, VkFormat format, VkImageLayout oldLayout, VkImageLayout newLayout)
     {
-        VkCommandBuffer commandBuffer = BeginSingleTimeCommands();
+        VkCommandBuffer commandBuffer = BeginUploadCommands();
 
         VkImageMemoryBarrier barrier {};
         barrier.sType                           = VK_STRUCTURE_TYPE_IMAGE_MEMORY_BARRIER;
@@ -4137,12 +4334,12 @@ private:
         // 2.指定发生在屏障之后的管线阶段
         // 6.用于引用3种可用的管线屏障数组（内存、缓冲、图像）
         vkCmdPipelineBarrier(commandBuffer, sourceStage, destinationStage, 0, 0, nullptr, 0, nullptr, 1, &barrier);
-        EndSingleTimeCommands(commandBuffer);
+        EndUploadCommands(commandBuffer);
     }
 
     void CopyBufferToImage(VkBuffer buffer, VkImage image, uint32_t widht, uint32_t height)
     {
-        VkCommandBuffer commandBuffer = BeginSingleTimeCommands();
+        VkCommandBuffer commandBuffer = BeginUploadCommands();
 
         // 用于指定将数据复制到图像的哪一部分
         VkBufferImageCopy region {};
@@ -4159,7 +4356,7 @@ private:
         // 4.指定目的图像当前使用的图像布局
         // 最后一个参数为数组时可以一次从一个缓冲复制数据到多个不同的图像对象
         vkCmdCopyBufferToImage(commandBuffer, buffer, image, VK_IMAGE_LAYOUT_TRANSFER_DST_OPTIMAL, 1, &region);
-        EndSingleTimeCommands(commandBuffer);
+        EndUploadCommands(commandBuffer);
     }
 
     VkImageView CreateImageView(VkImage image, VkFormat format)
@@ -4343,10 +4540,16 @@ private:
     VkDescriptorPool m_imguiDescriptorPool {nullptr};
 
     std::vector<const char*> m_textureFileNames {"alpha.png", "barce.jpg", "nightsky.png"};
-    std::map<const char*, std::unique_ptr<Texture>> m_textures {};
-    int m_currentTextureIndex {0};
+    std::unique_ptr<Texture> m_texture {};  // 当前显示的纹理
+    int m_currentTextureIndex {0};           // ImGui 中选择的纹理
+    int m_displayedTextureIndex {-1};        // m_texture 对应的纹理
+    std::vector<TextureLoad> m_textureLoads {};
+    std::vector<RetiredTexture> m_retiredTextures {};
+    VkCommandBuffer m_uploadCommandBuffer {nullptr}; // 不为空时纹理的上传指令录制到这个指令缓冲中
 
     std::array<bool, MAX_FRAMES_IN_FLIGHT> m_textureChanged {true, true};
+
+    ThreadPool m_decodePool {TEXTURE_DECODE_THREADS}; // 最后声明，最先析构，Cleanup 已经等待了所有解码任务
 };
 
 int main()
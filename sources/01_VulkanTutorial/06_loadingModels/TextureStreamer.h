@@ -0,0 +1,244 @@
+#pragma once
+
+#include <algorithm>
+#include <cmath>
+#include <cstddef>
+#include <cstdint>
+#include <span>
+#include <vector>
+
+/// @brief 纹理流送的 CPU 端策略：决定每个纹理有哪些 mip 常驻显存，不涉及 Vulkan 对象
+/// @details 1. 加载时只上传不大于 initialSize 的低分辨率 mip，模型可以立即绘制
+///          2. 每帧根据屏幕空间的纹素密度累计每个纹理需要的最精细的 mip
+///          3. 需要的 mip 比常驻的更精细时，在每帧的上传预算内提高常驻的级别，缺少的级数越多越先上传
+///          4. 连续 EvictFrames 帧都不需要常驻的最精细的 mip 时降低常驻的级别，释放显存
+///          常驻的级别总是 [residentMip, mipCount)，调用者按照 Change 重新创建只包含这些级别的图像
+class TextureStreamer
+{
+public:
+    static inline constexpr uint32_t EvictFrames {300};
+
+    struct Change
+    {
+        uint32_t texture {0};
+        uint32_t residentMip {0}; // 新的常驻级别
+    };
+
+    /// @brief 添加一个纹理，初始的 mip 上传完成之后调用 Complete 才开始流送
+    /// @param texelSize 每个纹素的字节数
+    /// @param initialSize 加载时上传的最大的 mip 的边长
+    /// @return 纹理的编号
+    uint32_t Add(uint32_t width, uint32_t height, uint32_t texelSize, uint32_t initialSize)
+    {
+        Texture texture {};
+        texture.width     = width;
+        texture.height    = height;
+        texture.texelSize = texelSize;
+        texture.mipCount  = static_cast<uint32_t>(std::floor(std::log2(std::max({width, height, 1u})))) + 1;
+
+        while (texture.residentMip + 1 < texture.mipCount && std::max(width >> texture.residentMip, height >> texture.residentMip) > initialSize)
+        {
+            ++texture.residentMip;
+        }
+        texture.desiredMip = texture.residentMip;
+        texture.busy       = true;
+
+        m_textures.emplace_back(texture);
+        return static_cast<uint32_t>(m_textures.size() - 1);
+    }
+
+    uint32_t GetMipCount(uint32_t texture) const noexcept
+    {
+        return m_textures[texture].mipCount;
+    }
+
+    uint32_t GetResidentMip(uint32_t texture) const noexcept
+    {
+        return m_textures[texture].residentMip;
+    }
+
+    /// @brief 每帧开始时调用，之后通过 Request 累计本帧的需求
+    void BeginFrame() noexcept
+    {
+        for (auto& texture : m_textures)
+        {
+            texture.desiredMip = texture.mipCount - 1;
+        }
+    }
+
+    /// @brief 本帧某个图元需要 mip 级的细节，一个纹理被多个图元使用时取最精细的一级
+    void Request(uint32_t texture, float mip) noexcept
+    {
+        auto& entry      = m_textures[texture];
+        auto level       = static_cast<uint32_t>(std::clamp(std::floor(mip), 0.f, static_cast<float>(entry.mipCount - 1)));
+        entry.desiredMip = std::min(entry.desiredMip, level);
+    }
+
+    /// @brief 选择本帧开始的上传和释放，返回的纹理在 Complete 之前不会再次被选择
+    /// @param budget 本帧最多上传的字节数，一级 mip 就超过预算时，如果本帧还没有其他上传仍然上传这一级，否则大纹理永远不会提高
+    std::vector<Change> Update(uint64_t budget)
+    {
+        std::vector<Change> changes {};
+
+        std::vector<uint32_t> candidates {};
+        for (uint32_t i = 0; i < m_textures.size(); ++i)
+        {
+            auto& texture = m_textures[i];
+            if (texture.busy)
+            {
+                continue;
+            }
+
+            if (texture.desiredMip < texture.residentMip)
+            {
+                candidates.emplace_back(i);
+            }
+
+            // 释放不需要的 mip 不占用上传预算（只需要重新上传更小的几级）
+            texture.idleFrames = texture.desiredMip > texture.residentMip ? texture.idleFrames + 1 : 0;
+            if (texture.idleFrames >= EvictFrames)
+            {
+                texture.busy = true;
+                changes.push_back({i, texture.desiredMip});
+            }
+        }
+
+        std::ranges::stable_sort(candidates, [this](uint32_t a, uint32_t b) {
+            return m_textures[a].residentMip - m_textures[a].desiredMip > m_textures[b].residentMip - m_textures[b].desiredMip;
+        });
+
+        auto uploaded = false;
+        for (auto i : candidates)
+        {
+            auto& texture = m_textures[i];
+
+            // 新的图像包含 [target, mipCount) 的所有级别，全部从 CPU 上传
+            auto target = texture.residentMip;
+            while (target > texture.desiredMip)
+            {
+                auto size = GetSize(texture, target - 1);
+                if (size > budget && (uploaded || target != texture.residentMip))
+                {
+                    break;
+                }
+
+                --target;
+                if (size >= budget)
+                {
+                    break;
+                }
+            }
+
+            if (target == texture.residentMip)
+            {
+                continue;
+            }
+
+            budget -= std::min(budget, GetSize(texture, target));
+            uploaded     = true;
+            texture.busy = true;
+            changes.push_back({i, target});
+        }
+
+        return changes;
+    }
+
+    /// @brief Update 返回的变化已经生效，旧的图像已经释放
+    void Complete(uint32_t texture, uint32_t residentMip) noexcept
+    {
+        auto& entry       = m_textures[texture];
+        entry.residentMip = residentMip;
+        entry.idleFrames  = 0;
+        entry.busy        = false;
+    }
+
+    /// @brief 当前常驻的字节数
+    uint64_t GetResidentSize() const noexcept
+    {
+        uint64_t size {0};
+        for (const auto& texture : m_textures)
+        {
+            size += GetSize(texture, texture.residentMip);
+        }
+        return size;
+    }
+
+    /// @brief 所有 mip 都常驻时的字节数
+    uint64_t GetFullSize() const noexcept
+    {
+        uint64_t size {0};
+        for (const auto& texture : m_textures)
+        {
+            size += GetSize(texture, 0);
+        }
+        return size;
+    }
+
+    /// @brief 导入时计算：纹理坐标空间的面积和模型空间的面积之比的平方根，即模型空间的一个单位对应的纹理坐标长度
+    /// @param positions 每个顶点 3 个 float
+    /// @param texCoords 每个顶点 2 个 float
+    static float ComputeUvDensity(std::span<const float> positions, std::span<const float> texCoords, std::span<const uint32_t> indices) noexcept
+    {
+        double positionArea {0.0};
+        double texCoordArea {0.0};
+        for (size_t i = 0; i + 2 < indices.size(); i += 3)
+        {
+            const auto* p0 = &positions[indices[i] * 3];
+            const auto* p1 = &positions[indices[i + 1] * 3];
+            const auto* p2 = &positions[indices[i + 2] * 3];
+
+            double e1[3] {p1[0] - p0[0], p1[1] - p0[1], p1[2] - p0[2]};
+            double e2[3] {p2[0] - p0[0], p2[1] - p0[1], p2[2] - p0[2]};
+            double cross[3] {e1[1] * e2[2] - e1[2] * e2[1], e1[2] * e2[0] - e1[0] * e2[2], e1[0] * e2[1] - e1[1] * e2[0]};
+            positionArea += .5 * std::sqrt(cross[0] * cross[0] + cross[1] * cross[1] + cross[2] * cross[2]);
+
+            const auto* t0 = &texCoords[indices[i] * 2];
+            const auto* t1 = &texCoords[indices[i + 1] * 2];
+            const auto* t2 = &texCoords[indices[i + 2] * 2];
+            texCoordArea += .5 * std::abs((t1[0] - t0[0]) * (t2[1] - t0[1]) - (t2[0] - t0[0]) * (t1[1] - t0[1]));
+        }
+
+        return positionArea > 0.0 ? static_cast<float>(std::sqrt(texCoordArea / positionArea)) : 0.f;
+    }
+
+    /// @brief 需要的 mip 是一个像素覆盖的纹素个数的 log2，和硬件根据纹理坐标导数选择 mip 的方式一致
+    /// @param textureSize 纹理的边长（宽高中较大的一个）
+    /// @param pixelsPerUnit 模型空间的一个单位在屏幕上的像素个数
+    static float ComputeMip(uint32_t textureSize, float uvDensity, float pixelsPerUnit) noexcept
+    {
+        if (pixelsPerUnit <= 0.f)
+        {
+            return 0.f;
+        }
+
+        auto texelsPerPixel = static_cast<float>(textureSize) * uvDensity / pixelsPerUnit;
+        return std::log2(std::max(texelsPerPixel, 1.f));
+    }
+
+private:
+    struct Texture
+    {
+        uint32_t width {0};
+        uint32_t height {0};
+        uint32_t texelSize {4};
+        uint32_t mipCount {1};
+        uint32_t residentMip {0};
+        uint32_t desiredMip {0};
+        uint32_t idleFrames {0};
+        bool busy {false}; // 正在上传或者等待旧的图像释放
+    };
+
+    /// @brief [firstMip, mipCount) 所有级别的字节数
+    static uint64_t GetSize(const Texture& texture, uint32_t firstMip) noexcept
+    {
+        uint64_t size {0};
+        for (auto mip = firstMip; mip < texture.mipCount; ++mip)
+        {
+            size += uint64_t {std::max(texture.width >> mip, 1u)} * std::max(texture.height >> mip, 1u) * texture.texelSize;
+        }
+        return size;
+    }
+
+private:
+    std::vector<Texture> m_textures {};
+};
@@ -0,0 +1,172 @@
+#pragma once
+
+#include <glm/gtc/packing.hpp>
+
+#include <algorithm>
+#include <array>
+#include <cmath>
+#include <cstdint>
+#include <limits>
+#include <span>
+#include <vector>
+
+/// @brief 加载时把浮点的顶点属性压缩为 GPU 可以直接读取的量化格式
+/// @details 位置：相对于包围盒的 snorm16x4（第 4 个分量不使用），还原为 offset + position * scale
+///          法线：八面体映射之后的 snorm16x2，在顶点着色器中解码
+///          纹理坐标：half x2，硬件在读取顶点时转换为 float
+///          关节：所有索引都小于 256 时为 u8x4，否则为 u16x4；权重：unorm8x4，量化之后的和仍然等于 1
+class VertexPacking
+{
+public:
+    struct PackedPositions
+    {
+        std::vector<int16_t> data {}; // 每个顶点 4 个分量
+        std::array<float, 3> offset {0.f, 0.f, 0.f};
+        std::array<float, 3> scale {1.f, 1.f, 1.f};
+    };
+
+    /// @param positions 每个顶点 3 个 float
+    static PackedPositions PackPositions(std::span<const float> positions)
+    {
+        PackedPositions packed {};
+
+        auto vertexCount = positions.size() / 3;
+        if (0 == vertexCount)
+        {
+            return packed;
+        }
+
+        std::array<float, 3> boundsMin {};
+        std::array<float, 3> boundsMax {};
+        boundsMin.fill(std::numeric_limits<float>::max());
+        boundsMax.fill(std::numeric_limits<float>::lowest());
+        for (size_t i = 0; i < vertexCount; ++i)
+        {
+            for (size_t j = 0; j < 3; ++j)
+            {
+                boundsMin[j] = std::min(boundsMin[j], positions[i * 3 + j]);
+                boundsMax[j] = std::max(boundsMax[j], positions[i * 3 + j]);
+            }
+        }
+
+        // 包围盒的某一个轴长度为 0 时所有顶点在该轴上都编码为 0
+        for (size_t j = 0; j < 3; ++j)
+        {
+            packed.offset[j] = (boundsMin[j] + boundsMax[j]) * .5f;
+            packed.scale[j]  = std::max((boundsMax[j] - boundsMin[j]) * .5f, std::numeric_limits<float>::min());
+        }
+
+        packed.data.resize(vertexCount * 4, 0);
+        for (size_t i = 0; i < vertexCount; ++i)
+        {
+            for (size_t j = 0; j < 3; ++j)
+            {
+                auto normalized        = (positions[i * 3 + j] - packed.offset[j]) / packed.scale[j];
+                packed.data[i * 4 + j] = static_cast<int16_t>(glm::packSnorm1x16(normalized));
+            }
+        }
+
+        return packed;
+    }
+
+    /// @param normals 每个顶点 3 个 float，不要求已经归一化
+    static std::vector<int16_t> PackNormals(std::span<const float> normals)
+    {
+        auto vertexCount = normals.size() / 3;
+
+        std::vector<int16_t> packed(vertexCount * 2, 0);
+        for (size_t i = 0; i < vertexCount; ++i)
+        {
+            auto x = normals[i * 3];
+            auto y = normals[i * 3 + 1];
+            auto z = normals[i * 3 + 2];
+
+            // 投影到 |x| + |y| + |z| = 1 的八面体上，下半部分沿对角线折叠到上半部分的外侧
+            auto l1 = std::abs(x) + std::abs(y) + std::abs(z);
+            if (l1 <= 0.f)
+            {
+                continue;
+            }
+
+            x /= l1;
+            y /= l1;
+            if (z < 0.f)
+            {
+                auto foldedX = (1.f - std::abs(y)) * (x >= 0.f ? 1.f : -1.f);
+                auto foldedY = (1.f - std::abs(x)) * (y >= 0.f ? 1.f : -1.f);
+                x            = foldedX;
+                y            = foldedY;
+            }
+
+            packed[i * 2]     = static_cast<int16_t>(glm::packSnorm1x16(x));
+            packed[i * 2 + 1] = static_cast<int16_t>(glm::packSnorm1x16(y));
+        }
+
+        return packed;
+    }
+
+    static std::vector<uint16_t> PackTexCoords(std::span<const float> texCoords)
+    {
+        std::vector<uint16_t> packed(texCoords.size());
+        std::ranges::transform(texCoords, packed.begin(), [](float value) { return glm::packHalf1x16(value); });
+        return packed;
+    }
+
+    /// @param joints 每个顶点 4 个关节索引
+    /// @param jointSize 输出每个分量的字节数，1 或者 2
+    static std::vector<uint8_t> PackJoints(std::span<const float> joints, uint32_t& jointSize)
+    {
+        auto maxJoint = joints.empty() ? 0.f : std::ranges::max(joints);
+        jointSize     = maxJoint < 256.f ? 1 : 2;
+
+        std::vector<uint8_t> packed(joints.size() * jointSize);
+        for (size_t i = 0; i < joints.size(); ++i)
+        {
+            auto joint = static_cast<uint32_t>(std::max(joints[i], 0.f));
+            if (1 == jointSize)
+            {
+                packed[i] = static_cast<uint8_t>(joint);
+            }
+            else
+            {
+                packed[i * 2]     = static_cast<uint8_t>(joint & 0xff);
+                packed[i * 2 + 1] = static_cast<uint8_t>(joint >> 8);
+            }
+        }
+
+        return packed;
+    }
+
+    /// @param weights 每个顶点 4 个权重，范围 [0, 1]
+    static std::vector<uint8_t> PackWeights(std::span<const float> weights)
+    {
+        auto vertexCount = weights.size() / 4;
+
+        std::vector<uint8_t> packed(vertexCount * 4, 0);
+        for (size_t i = 0; i < vertexCount; ++i)
+        {
+            std::array<int, 4> quantized {};
+            size_t largest {0};
+            int sum {0};
+            for (size_t j = 0; j < 4; ++j)
+            {
+                quantized[j] = static_cast<int>(std::lround(std::clamp(weights[i * 4 + j], 0.f, 1.f) * 255.f));
+                sum += quantized[j];
+                largest = quantized[j] > quantized[largest] ? j : largest;
+            }
+
+            // 舍入误差补到最大的权重上，否则蒙皮之后顶点会向原点收缩或者膨胀
+            if (sum > 0)
+            {
+                quantized[largest] = std::clamp(quantized[largest] + 255 - sum, 0, 255);
+            }
+
+            for (size_t j = 0; j < 4; ++j)
+            {
+                packed[i * 4 + j] = static_cast<uint8_t>(quantized[j]);
+            }
+        }
+
+        return packed;
+    }
+};
@@ -0,0 +1,102 @@
+#define TINYOBJLOADER_IMPLEMENTATION
+#include <tiny_obj_loader.h>
+
+#include "Benchmark.h"
+#include "MeshOptimizer.h"
+#include <array>
+#include <stdexcept>
+#include <string>
+#include <unordered_map>
+#include <vector>
+
+// 和示例中的 Vertex 大小一致（位置、颜色、纹理坐标），只用于统计顶点读取
+struct BenchVertex
+{
+    std::array<float, 3> pos {};
+    std::array<float, 3> color {};
+    std::array<float, 2> texCoord {};
+};
+
+// 每一帧对去重之后的 viking_room 执行一次完整的 cook 优化，测量 cook 的耗时，指标中记录优化前后的缓存效率
+class MeshOptimizerScene : public BenchmarkScene
+{
+public:
+    void Setup() override
+    {
+        tinyobj::attrib_t attrib {};
+        std::vector<tinyobj::shape_t> shapes {};
+        std::vector<tinyobj::material_t> materials {};
+        std::string warn {}, err {};
+
+        if (!tinyobj::LoadObj(&attrib, &shapes, &materials, &warn, &err, "../resources/models/viking_room/viking_room.obj"))
+        {
+            throw std::runtime_error(warn + err);
+        }
+
+        // 只按照位置和纹理坐标的索引去重
+        std::unordered_map<uint64_t, uint32_t> uniqueVertices {};
+        for (const auto& shape : shapes)
+        {
+            for (const auto& index : shape.mesh.indices)
+            {
+                auto key = (static_cast<uint64_t>(static_cast<uint32_t>(index.vertex_index)) << 32) | static_cast<uint32_t>(index.texcoord_index);
+                auto [it, inserted] = uniqueVertices.try_emplace(key, static_cast<uint32_t>(m_vertices.size()));
+                if (inserted)
+                {
+                    BenchVertex vertex {};
+                    vertex.pos      = {
+                        attrib.vertices[3 * index.vertex_index + 0],
+                        attrib.vertices[3 * index.vertex_index + 1],
+                        attrib.vertices[3 * index.vertex_index + 2]
+                    };
+                    vertex.texCoord = {attrib.texcoords[2 * index.texcoord_index + 0], 1.0f - attrib.texcoords[2 * index.texcoord_index + 1]};
+                    vertex.color    = {1.0f, 1.0f, 1.0f};
+                    m_vertices.push_back(vertex);
+                }
+                m_indices.push_back(it->second);
+            }
+        }
+
+        m_cacheBefore = MeshOptimizer::AnalyzeVertexCache(m_indices, m_vertices.size());
+        m_fetchBefore = MeshOptimizer::AnalyzeVertexFetch(m_indices, m_vertices.size(), sizeof(BenchVertex));
+    }
+
+    void RenderFrame() override
+    {
+        m_optimizedIndices  = m_indices;
+        m_optimizedVertices = m_vertices;
+
+        std::vector<uint32_t> clusters {};
+        auto vertexCount   = m_optimizedVertices.size();
+        m_optimizedIndices = MeshOptimizer::OptimizeVertexCache(m_optimizedIndices, vertexCount, MeshOptimizer::DefaultCacheSize, &clusters);
+        m_optimizedIndices = MeshOptimizer::OptimizeOverdraw(m_optimizedIndices, clusters, &m_optimizedVertices.front().pos[0], sizeof(BenchVertex));
+        MeshOptimizer::OptimizeVertexFetch(m_optimizedIndices, m_optimizedVertices);
+    }
+
+    std::vector<std::pair<std::string, double>> GetMetrics() const override
+    {
+        auto cacheAfter = MeshOptimizer::AnalyzeVertexCache(m_optimizedIndices, m_optimizedVertices.size());
+        auto fetchAfter = MeshOptimizer::AnalyzeVertexFetch(m_optimizedIndices, m_optimizedVertices.size(), sizeof(BenchVertex));
+
+        return {
+            {"triangles", static_cast<double>(m_indices.size() / 3)},
+            {"vertices", static_cast<double>(m_vertices.size())},
+            {"acmrBefore", m_cacheBefore.acmr},
+            {"acmrAfter", cacheAfter.acmr},
+            {"atvrBefore", m_cacheBefore.atvr},
+            {"atvrAfter", cacheAfter.atvr},
+            {"overfetchBefore", m_fetchBefore.overfetch},
+            {"overfetchAfter", fetchAfter.overfetch},
+        };
+    }
+
+private:
+    std::vector<BenchVertex> m_vertices {};
+    std::vector<uint32_t> m_indices {};
+    std::vector<BenchVertex> m_optimizedVertices {};
+    std::vector<uint32_t> m_optimizedIndices {};
+    MeshOptimizer::VertexCacheStatistics m_cacheBefore {};
+    MeshOptimizer::VertexFetchStatistics m_fetchBefore {};
+};
+
+BENCHMARK_SCENE(MeshOptimizerScene, "mesh_optimize_viking_room");
@@ -0,0 +1,72 @@
+#include <tiny_obj_loader.h>
+
+#include "Benchmark.h"
+#include "MeshSimplifier.h"
+#include <stdexcept>
+#include <string>
+#include <unordered_map>
+#include <vector>
+
+// 每一帧为 apple 生成一次完整的 LOD 链，测量导入时增加的耗时，指标中记录每一级的三角形个数和误差
+class MeshSimplifierScene : public BenchmarkScene
+{
+public:
+    void Setup() override
+    {
+        tinyobj::attrib_t attrib {};
+        std::vector<tinyobj::shape_t> shapes {};
+        std::vector<tinyobj::material_t> materials {};
+        std::string warn {}, err {};
+
+        if (!tinyobj::LoadObj(&attrib, &shapes, &materials, &warn, &err, "../resources/models/apple.obj"))
+        {
+            throw std::runtime_error(warn + err);
+        }
+
+        // 按照位置和纹理坐标的索引去重，纹理坐标不同的顶点是接缝
+        std::unordered_map<uint64_t, uint32_t> uniqueVertices {};
+        for (const auto& shape : shapes)
+        {
+            for (const auto& index : shape.mesh.indices)
+            {
+                auto key = (static_cast<uint64_t>(static_cast<uint32_t>(index.vertex_index)) << 32) | static_cast<uint32_t>(index.texcoord_index);
+                auto [it, inserted] = uniqueVertices.try_emplace(key, static_cast<uint32_t>(m_positions.size() / 3));
+                if (inserted)
+                {
+                    m_positions.insert(
+                        m_positions.end(), attrib.vertices.begin() + 3 * index.vertex_index, attrib.vertices.begin() + 3 * index.vertex_index + 3
+                    );
+                }
+                m_indices.push_back(it->second);
+            }
+        }
+    }
+
+    void RenderFrame() override
+    {
+        m_lods = MeshSimplifier::BuildLodChain(m_indices, m_positions.data(), m_positions.size() / 3, sizeof(float) * 3);
+    }
+
+    std::vector<std::pair<std::string, double>> GetMetrics() const override
+    {
+        std::vector<std::pair<std::string, double>> metrics {
+            {"vertices", static_cast<double>(m_positions.size() / 3)},
+            {"lodCount", static_cast<double>(m_lods.size())},
+        };
+
+        for (size_t i = 0; i < m_lods.size(); ++i)
+        {
+            metrics.emplace_back("lod" + std::to_string(i) + "Triangles", static_cast<double>(m_lods[i].indices.size() / 3));
+            metrics.emplace_back("lod" + std::to_string(i) + "Error", m_lods[i].error);
+        }
+
+        return metrics;
+    }
+
+private:
+    std::vector<float> m_positions {};
+    std::vector<uint32_t> m_indices {};
+    std::vector<MeshSimplifier::Lod> m_lods {};
+};
+
+BENCHMARK_SCENE(MeshSimplifierScene, "mesh_lod_chain_apple");
@@ -0,0 +1,158 @@
+#include "Benchmark.h"
+#include "VertexWelder.h"
+#include <cmath>
+#include <unordered_map>
+#include <vector>
+
+#define GLM_FORCE_RADIANS
+#include <glm/glm.hpp>
+#define GLM_ENABLE_EXPERIMENTAL
+#include <glm/gtx/hash.hpp>
+
+namespace {
+// 和示例中原来的 Vertex 完全一致（位置、颜色、纹理坐标，glm 向量逐个分量比较）
+struct WeldVertex
+{
+    glm::vec3 pos {0.f, 0.f, 0.f};
+    glm::vec3 color {0.f, 0.f, 0.f};
+    glm::vec2 texCoord {0.f, 0.f};
+
+    bool operator==(const WeldVertex& other) const
+    {
+        return pos == other.pos && color == other.color && texCoord == other.texCoord;
+    }
+};
+} // namespace
+
+// 原来的去重方式使用的哈希：glm 的 std::hash 按分量组合，三个成员再移位异或
+namespace std {
+template <>
+struct hash<WeldVertex>
+{
+    size_t operator()(WeldVertex const& vertex) const
+    {
+        return ((hash<glm::vec3>()(vertex.pos) ^ (hash<glm::vec3>()(vertex.color) << 1)) >> 1) ^ (hash<glm::vec2>()(vertex.texCoord) << 1);
+    }
+};
+} // namespace std
+
+namespace {
+enum class WeldMode
+{
+    UnorderedMap,
+    SingleThread,
+    Parallel,
+    Epsilon,
+};
+
+// GridSize x GridSize 个四边形的高度场，每个三角形的每个角一个顶点，和 obj 展开之后的数据一样
+// 后一半三角形打乱顺序，相同的顶点不会总是相邻；Epsilon 模式给每个角加上小于 epsilon 的扰动，模拟扫描数据
+template <WeldMode Mode, uint32_t GridSize>
+class VertexWelderScene : public BenchmarkScene
+{
+public:
+    void Setup() override
+    {
+        auto makeVertex = [](uint32_t x, uint32_t y, uint32_t corner) {
+            WeldVertex vertex {};
+            vertex.pos      = {static_cast<float>(x) * .01f, static_cast<float>(y) * .01f, std::sin(x * .1f) * std::cos(y * .1f)};
+            vertex.color    = {1.f, 1.f, 1.f};
+            vertex.texCoord = {static_cast<float>(x) / GridSize, static_cast<float>(y) / GridSize};
+
+            if constexpr (WeldMode::Epsilon == Mode)
+            {
+                // 确定性的扰动，范围 [-1e-6, 1e-6]
+                auto noise = static_cast<float>((x * 73856093u ^ y * 19349663u ^ corner * 83492791u) % 2001u) * 1e-9f - 1e-6f;
+                vertex.pos[0] += noise;
+                vertex.pos[1] -= noise;
+            }
+
+            return vertex;
+        };
+
+        m_corners.reserve(static_cast<size_t>(GridSize) * GridSize * 6);
+        uint32_t corner {0};
+        for (uint32_t y = 0; y < GridSize; ++y)
+        {
+            for (uint32_t x = 0; x < GridSize; ++x)
+            {
+                for (auto [dx, dy] : {std::pair {0u, 0u}, {1u, 0u}, {1u, 1u}, {0u, 0u}, {1u, 1u}, {0u, 1u}})
+                {
+                    m_corners.emplace_back(makeVertex(x + dx, y + dy, corner++));
+                }
+            }
+        }
+
+        // 按三角形打乱后一半
+        auto triangles = m_corners.size() / 3;
+        uint64_t state {0x2545f4914f6cdd1dull};
+        for (auto i = triangles - 1; i > triangles / 2; --i)
+        {
+            state ^= state << 13;
+            state ^= state >> 7;
+            state ^= state << 17;
+            auto j = triangles / 2 + state % (i - triangles / 2 + 1);
+            std::swap_ranges(m_corners.begin() + i * 3, m_corners.begin() + i * 3 + 3, m_corners.begin() + j * 3);
+        }
+    }
+
+    void RenderFrame() override
+    {
+        if constexpr (WeldMode::UnorderedMap == Mode)
+        {
+            // 和原来的 LoadModel 相同：每个角先 count 再 operator[]，新顶点再查找一次
+            std::unordered_map<WeldVertex, uint32_t> uniqueVertices {};
+            m_vertices.clear();
+            m_indices.clear();
+            for (const auto& vertex : m_corners)
+            {
+                if (uniqueVertices.count(vertex) == 0)
+                {
+                    uniqueVertices[vertex] = static_cast<uint32_t>(m_vertices.size());
+                    m_vertices.push_back(vertex);
+                }
+
+                m_indices.push_back(uniqueVertices[vertex]);
+            }
+        }
+        else
+        {
+            VertexWelder::Options options {};
+            options.threadCount = WeldMode::SingleThread == Mode ? 1 : 0;
+            options.epsilon     = WeldMode::Epsilon == Mode ? 1e-4f : 0.f;
+            VertexWelder::Weld<WeldVertex>(m_corners, m_vertices, m_indices, options);
+        }
+    }
+
+    uint32_t GetFrameLimit() const override
+    {
+        return 10;
+    }
+
+    std::vector<std::pair<std::string, double>> GetMetrics() const override
+    {
+        return {
+            {"triangles", static_cast<double>(m_corners.size() / 3)},
+            {"corners", static_cast<double>(m_corners.size())},
+            {"uniqueVertices", static_cast<double>(m_vertices.size())},
+            {"gridVertices", static_cast<double>((GridSize + 1) * (GridSize + 1))},
+        };
+    }
+
+private:
+    std::vector<WeldVertex> m_corners {};
+    std::vector<WeldVertex> m_vertices {};
+    std::vector<uint32_t> m_indices {};
+};
+
+// 1024 x 1024 个四边形，约 2M 三角形、6.3M 个角
+using WeldUnorderedMap = VertexWelderScene<WeldMode::UnorderedMap, 1024>;
+using WeldSingleThread = VertexWelderScene<WeldMode::SingleThread, 1024>;
+using WeldParallel     = VertexWelderScene<WeldMode::Parallel, 1024>;
+using WeldEpsilon      = VertexWelderScene<WeldMode::Epsilon, 1024>;
+} // namespace
+
+BENCHMARK_SCENE(WeldUnorderedMap, "weld_unordered_map_2m");
+BENCHMARK_SCENE(WeldSingleThread, "weld_single_thread_2m");
+BENCHMARK_SCENE(WeldParallel, "weld_parallel_2m");
+BENCHMARK_SCENE(WeldEpsilon, "weld_epsilon_2m");
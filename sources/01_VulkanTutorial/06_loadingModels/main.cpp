@@ -14,8 +14,6 @@
 #define GLM_FORCE_DEPTH_ZERO_TO_ONE // 透视矩阵深度值范围 [-1, 1] => [0, 1]
 #include <glm/glm.hpp>
 #include <glm/gtc/matrix_transform.hpp>
-#define GLM_ENABLE_EXPERIMENTAL
-#include <glm/gtx/hash.hpp>
 
 #define STB_IMAGE_IMPLEMENTATION
 #include <stb_image.h>
@@ -25,14 +23,18 @@
 
 #include <algorithm>
 #include <array>
+#include <filesystem>
 #include <fstream>
 #include <iostream>
+#include <limits>
 #include <optional>
 #include <set>
+#include <span>
 #include <stdexcept>
-#include <unordered_map>
 #include <vector>
 
+#include "MeshFile.h"
+
 // 窗口默认大小
 constexpr uint32_t WIDTH  = 800;
 constexpr uint32_t HEIGHT = 600;
@@ -97,17 +99,6 @@ struct Vertex
     }
 };
 
-namespace std {
-template <>
-struct hash<Vertex>
-{
-    size_t operator()(Vertex const& vertex) const
-    {
-        return ((hash<glm::vec3>()(vertex.pos) ^ (hash<glm::vec3>()(vertex.color) << 1)) >> 1) ^ (hash<glm::vec2>()(vertex.texCoord) << 1);
-    }
-};
-} // namespace std
-
 struct UniformBufferObject
 {
     glm::mat4 model {glm::mat4(1.f)};
@@ -2078,44 +2069,29 @@ private:
 
     void LoadModel()
     {
-        tinyobj::attrib_t attrib {};
-        std::vector<tinyobj::shape_t> shapes {};
-        std::vector<tinyobj::material_t> materials {};
-        std::string warn {}, err {};
-
-        if (!tinyobj::LoadObj(&attrib, &shapes, &materials, &warn, &err, "../resources/models/viking_room/viking_room.obj"))
-        {
-            throw std::runtime_error(warn + err);
-        }
+        const std::string objName    = "../resources/models/viking_room/viking_room.obj";
+        const std::string cookedName = "../resources/models/viking_room/viking_room.mesh";
 
-        std::unordered_map<Vertex, uint32_t> uniqueVertices {};
+        // 没有 cook 过、obj 比 cook 之后的文件新或者文件格式不一致时重新 cook，之后的启动只需要映射文件
+        auto stale = !std::filesystem::exists(cookedName)
+            || (std::filesystem::exists(objName) && std::filesystem::last_write_time(objName) > std::filesystem::last_write_time(cookedName));
 
-        for (const auto& shape : shapes)
+        if (stale || !m_meshFile.Open(cookedName, static_cast<uint32_t>(sizeof(Vertex))))
         {
-            for (const auto& index : shape.mesh.indices)
-            {
-                Vertex vertex {};
-
-                vertex.pos = {
-                    attrib.vertices[3 * index.vertex_index + 0],
-                    attrib.vertices[3 * index.vertex_index + 1],
-                    attrib.vertices[3 * index.vertex_index + 2]
-                };
-
-                vertex.texCoord = {attrib.texcoords[2 * index.texcoord_index + 0], 1.0f - attrib.texcoords[2 * index.texcoord_index + 1]};
+            auto statistics = MeshFile::Cook<Vertex>(objName, cookedName);
+            std::cout << "ACMR: " << statistics.cacheBefore.acmr << " => " << statistics.cacheAfter.acmr
+                      << "\tvertex fetch: " << statistics.fetchBefore.overfetch << " => " << statistics.fetchAfter.overfetch << '\n';
 
-                vertex.color = {1.0f, 1.0f, 1.0f};
-
-                if (uniqueVertices.count(vertex) == 0)
-                {
-                    uniqueVertices[vertex] = static_cast<uint32_t>(m_vertices.size());
-                    m_vertices.push_back(vertex);
-                }
-
-                m_indices.push_back(uniqueVertices[vertex]);
+            if (!m_meshFile.Open(cookedName, static_cast<uint32_t>(sizeof(Vertex))))
+            {
+                throw std::runtime_error("failed to load mesh file: " + cookedName);
             }
         }
 
+        // 顶点和索引直接指向映射的内存，创建缓冲时从这里复制到暂存缓冲
+        m_vertices = m_meshFile.GetVertices<Vertex>();
+        m_indices  = m_meshFile.GetIndices();
+
         std::cout << "vertices size: " << m_vertices.size() << "\tindices size: " << m_indices.size() << '\n';
     }
 
@@ -2247,8 +2223,9 @@ private:
     VkImage m_depthImage {nullptr};
     VkDeviceMemory m_depthImageMemory {nullptr};
     VkImageView m_depthImageView {nullptr};
-    std::vector<Vertex> m_vertices {};
-    std::vector<uint32_t> m_indices {};
+    MeshFile m_meshFile {};
+    std::span<const Vertex> m_vertices {};
+    std::span<const uint32_t> m_indices {};
 };
 
 int main()
@@ -2297,8 +2274,13 @@ int main()
 
 #include <algorithm>
 #include <array>
+#include <atomic>
+#include <chrono>
+#include <cmath>
+#include <cstring>
 #include <filesystem>
 #include <fstream>
+#include <future>
 #include <iostream>
 #include <numbers>
 #include <optional>
@@ -2307,6 +2289,13 @@ int main()
 #include <unordered_map>
 #include <vector>
 
+#include "MeshOptimizer.h"
+#include "MeshSimplifier.h"
+#include "MipChain.h"
+#include "TextureStreamer.h"
+#include "ThreadPool.h"
+#include "VertexPacking.h"
+
 // 窗口默认大小
 constexpr uint32_t WIDTH  = 800;
 constexpr uint32_t HEIGHT = 600;
@@ -2314,6 +2303,26 @@ constexpr uint32_t HEIGHT = 600;
 // 同时并行处理的帧数
 constexpr int MAX_FRAMES_IN_FLIGHT = 2;
 
+// 加载时把静态图元的顶点属性压缩为量化格式（VertexPacking.h），false 时直接使用 gltf 中的 float 数据
+constexpr bool PACK_VERTICES = true;
+
+// 加载时为静态图元生成 LOD 链（MeshSimplifier.h），绘制时选择投影到屏幕上的误差不超过 LOD_PIXEL_ERROR 像素的最简单的一级
+constexpr bool GENERATE_LODS   = true;
+constexpr float LOD_PIXEL_ERROR = 1.f;
+
+// 纹理流送（TextureStreamer.h）：加载时只上传边长不超过 STREAM_INITIAL_SIZE 的 mip，之后根据屏幕上的纹素密度逐步上传更精细的 mip
+// 每帧最多上传 STREAM_UPLOAD_BUDGET 字节，false 时加载时上传完整的第 0 级
+constexpr bool STREAM_TEXTURES              = true;
+constexpr uint32_t STREAM_INITIAL_SIZE      = 64;
+constexpr VkDeviceSize STREAM_UPLOAD_BUDGET = 4 * 1024 * 1024;
+
+// 更新动画的工作线程数（ThreadPool.h），当前线程也更新一部分模型
+constexpr uint32_t ANIMATION_THREADS = 3;
+
+// 加载模型的线程数，解析文件的任务会等待解码图像的任务，所以两者使用不同的线程池，0 表示使用硬件线程数
+constexpr uint32_t MODEL_FILE_THREADS   = 2;
+constexpr uint32_t IMAGE_DECODE_THREADS = 0;
+
 // 需要开启的校验层的名称
 const std::vector<const char*> g_validationLayers = {"VK_LAYER_KHRONOS_validation"};
 // 交换链扩展
@@ -2338,6 +2347,13 @@ struct Image
     VkImage image {nullptr};
     VkImageView imageView {nullptr};
     VkDeviceMemory imageMemory {nullptr};
+
+    // 流送的纹理只包含常驻的 mip，图像的第 0 级是 mip 链的第 residentMip 级
+    std::optional<uint32_t> streamId {}; // TextureStreamer 中的编号，为空时不流送
+    VkFormat format {VK_FORMAT_UNDEFINED};
+    uint32_t width {0};
+    uint32_t height {0};
+    std::vector<std::vector<uint8_t>> mips {}; // CPU 上完整的 mip 链，改变常驻的级别时从这里重新上传
 };
 
 struct DescriptorSets
@@ -2417,6 +2433,14 @@ enum class AnimationMode : uint8_t
     Skin,  ///< 蒙皮
 };
 
+// 所有 LOD 的索引依次存放在同一个索引缓冲中，共用图元的顶点缓冲
+struct PrimitiveLod
+{
+    uint32_t firstIndex {0};
+    uint32_t indexCount {0};
+    float error {0.f}; // 模型空间的几何误差
+};
+
 struct Primitive
 {
     bool vertexColoring()
@@ -2481,6 +2505,10 @@ struct Primitive
     VkIndexType indexType {};
     uint32_t indexCount {0};
 
+    std::vector<PrimitiveLod> lods {}; // 为空时只有原始网格，第 0 级是原始网格，误差递增
+    glm::vec4 boundingSphere {0.f};    // 模型空间的包围球，xyz 为球心，w 为半径
+    float uvDensity {0.f};             // 模型空间的一个单位对应的纹理坐标长度，用于估计纹理需要的 mip
+
     std::unique_ptr<Material> material {};
 
     std::optional<std::string> texCoord {};
@@ -2491,18 +2519,45 @@ struct Primitive
 
     std::optional<std::string> joints {};
     std::optional<std::string> weights {};
+    uint32_t jointSize {1}; // 关节索引每个分量的字节数，见 VertexPacking::PackJoints
+
+    bool packed {false};              // 位置、法线、纹理坐标已经压缩，使用 *_Q 管线绘制
+    glm::vec4 dequantizeOffset {0.f}; // 压缩的位置还原为模型空间：offset + position * scale
+    glm::vec4 dequantizeScale {1.f};
+
+    uint32_t vertexCount {0};
+    std::optional<std::string> morphedPosition {}; // 计算着色器变形之后的顶点，播放动画时代替 position 使用
 
-    std::optional<std::vector<std::string>> morphPosition {};
-    std::optional<std::unique_ptr<Uniform>> animationWeight {};
+    std::vector<std::pair<uint32_t, uint32_t>> morphTargets {}; // 每个变形目标在稀疏增量缓冲中的起始位置和个数
+    std::optional<std::string> morphDelta {};
+    VkDescriptorSet morphDescriptorSet {nullptr};
 };
 
 struct Mesh
 {
     std::string name {};
 
+    std::vector<float> weights {}; // 变形目标的权重，个数等于变形目标的个数，播放动画时每帧更新
+
     std::vector<std::unique_ptr<Primitive>> primitives {};
 };
 
+// 稀疏存储的变形目标，只保存位置发生变化的顶点，std430 布局
+struct MorphDelta
+{
+    uint32_t vertex {0};
+    float x {0.f};
+    float y {0.f};
+    float z {0.f};
+};
+
+struct MorphPushConstant
+{
+    uint32_t first {0}; // 变形目标在稀疏增量缓冲中的起始位置
+    uint32_t count {0};
+    float weight {0.f};
+};
+
 struct Camera
 {
     std::string name {};
@@ -2510,41 +2565,134 @@ struct Camera
 
 struct Skin
 {
-    std::unique_ptr<Uniform> matrix {};
+    VkDeviceSize paletteOffset {0}; // 这一帧的关节矩阵在 JointPalette 中的偏移
     std::vector<glm::mat4> inverseBindMatrices {};
     std::vector<int> joints {}; // 元素是 gltf 中 Node 的索引，骨骼动画的关节
 };
 
-struct Node
+/// @brief 扁平化的节点变换层级，所有数组按照父节点在子节点之前的顺序排列（SoA）
+/// @details 修改 TRS 只设置脏标记，Update 从前往后遍历一次，只重新计算本地矩阵变化的节点以及它们的子树
+struct NodeHierarchy
 {
-    std::string name {};
-    int index {};
+    enum Flags : uint8_t
+    {
+        LocalDirty  = 1 << 0, // TRS 被修改，需要重新计算本地矩阵
+        WorldDirty  = 1 << 1, // 本地矩阵被修改，需要重新计算世界矩阵
+        FixedMatrix = 1 << 2, // gltf 中直接指定了 matrix，不能被动画修改
+    };
 
-    Node* parent {};
+    std::vector<int> parents {}; // 父节点在数组中的索引，根节点为 -1
+    std::vector<glm::vec3> translations {};
+    std::vector<glm::quat> rotations {};
+    std::vector<glm::vec3> scales {};
+    std::vector<glm::mat4> localMatrices {};
+    std::vector<glm::mat4> worldMatrices {};
+    std::vector<uint8_t> flags {};
+    std::vector<uint8_t> changed {}; // Update 中世界矩阵被重新计算的节点为 1，写入模型矩阵的 uniform 之后清零
 
-    std::map<std::string, glm::mat4> matrices {};
+    std::vector<int> gltfToFlat {}; // gltf 中 Node 的索引到数组索引，不在任何场景中的节点为 -1
 
-    glm::mat4 GetLocalMatrix() const
+    /// @brief 添加一个节点，父节点必须已经添加，同一个 gltf 节点只添加一次
+    uint32_t Add(const tinygltf::Node& node, int gltfIndex, int parent)
     {
-        if (matrices.contains("matrix"))
+        if (gltfIndex < static_cast<int>(gltfToFlat.size()) && gltfToFlat[gltfIndex] >= 0)
         {
-            return matrices.at("matrix");
+            return static_cast<uint32_t>(gltfToFlat[gltfIndex]);
         }
 
-        auto translation = matrices.contains("translation") ? matrices.at("translation") : glm::mat4(1.f);
-        auto rotation    = matrices.contains("rotation") ? matrices.at("rotation") : glm::mat4(1.f);
-        auto scale       = matrices.contains("scale") ? matrices.at("scale") : glm::mat4(1.f);
+        auto index = static_cast<uint32_t>(parents.size());
+        if (gltfIndex >= static_cast<int>(gltfToFlat.size()))
+        {
+            gltfToFlat.resize(gltfIndex + 1, -1);
+        }
+        gltfToFlat[gltfIndex] = static_cast<int>(index);
+
+        parents.emplace_back(parent);
+        translations.emplace_back(node.translation.size() == 3 ? glm::vec3(glm::make_vec3(node.translation.data())) : glm::vec3(0.f));
+        rotations.emplace_back(node.rotation.size() == 4 ? glm::quat(glm::make_quat(node.rotation.data())) : glm::quat(1.f, 0.f, 0.f, 0.f));
+        scales.emplace_back(node.scale.size() == 3 ? glm::vec3(glm::make_vec3(node.scale.data())) : glm::vec3(1.f));
+        flags.emplace_back(node.matrix.size() == 16 ? FixedMatrix : 0);
+        changed.emplace_back(0);
+
+        localMatrices.emplace_back(node.matrix.size() == 16 ? glm::mat4(glm::make_mat4(node.matrix.data())) : ComposeLocal(index));
+        worldMatrices.emplace_back(parent >= 0 ? worldMatrices[parent] * localMatrices[index] : localMatrices[index]);
+
+        return index;
+    }
+
+    void SetTranslation(uint32_t index, const glm::vec3& translation) noexcept
+    {
+        translations[index] = translation;
+        flags[index] |= LocalDirty;
+    }
+
+    void SetRotation(uint32_t index, const glm::quat& rotation) noexcept
+    {
+        rotations[index] = rotation;
+        flags[index] |= LocalDirty;
+    }
+
+    void SetScale(uint32_t index, const glm::vec3& scale) noexcept
+    {
+        scales[index] = scale;
+        flags[index] |= LocalDirty;
+    }
+
+    /// @brief 线性遍历一次，父节点的世界矩阵总是先于子节点更新
+    void Update() noexcept
+    {
+        for (size_t i = 0; i < parents.size(); ++i)
+        {
+            auto parent = parents[i];
+
+            if ((flags[i] & LocalDirty) && !(flags[i] & FixedMatrix))
+            {
+                localMatrices[i] = ComposeLocal(i);
+                flags[i] |= WorldDirty;
+            }
+
+            changed[i] = (flags[i] & WorldDirty) || (parent >= 0 && changed[parent]) ? 1 : 0;
+            if (changed[i])
+            {
+                worldMatrices[i] = parent >= 0 ? worldMatrices[parent] * localMatrices[i] : localMatrices[i];
+            }
 
-        return translation * rotation * scale;
+            flags[i] &= FixedMatrix;
+        }
+    }
+
+    glm::mat4 ComposeLocal(size_t index) const noexcept
+    {
+        return glm::translate(glm::mat4(1.f), translations[index]) * glm::toMat4(rotations[index]) * glm::scale(glm::mat4(1.f), scales[index]);
     }
+};
+
+/// @brief 一个节点的一个图元蒙皮之后的顶点，不同节点的蒙皮不同，输出按照（节点，图元）分开
+struct SkinnedInstance
+{
+    std::string position {}; // 在 Model::buffers 中的键，播放动画时代替 Primitive::position 使用
+    VkDescriptorSet descriptorSet {nullptr};
+};
+
+struct Node
+{
+    std::string name {};
+    int index {};
+
+    Node* parent {};
+
+    uint32_t transform {}; // 在 Model::hierarchy 中的索引
 
     std::unique_ptr<Uniform> modelUniform {};
+    uint32_t staleUniformFrames {0}; // 世界矩阵改变之后，modelUniform 中还没有写入新矩阵的帧数
 
     std::unique_ptr<Skin> skin {};
 
     std::unique_ptr<Mesh> mesh {};
     std::unique_ptr<Camera> camera {};
 
+    std::vector<SkinnedInstance> skinnedInstances {}; // 和 mesh->primitives 一一对应，不需要蒙皮的图元 descriptorSet 为空
+
     std::vector<std::unique_ptr<Node>> children {};
 };
 
@@ -2561,10 +2709,37 @@ enum class PipelineType : uint8_t
     TC_NL,
     DC_PL,
     TC_PL,     // texture color + pbr light
-    DC_NL_AW2, // direct color + none light + animation weights[2]
-    DC_NL_AS2, // direct color + none light + animation skins[2]
+    CS_SKIN,   // compute shader skinning
+    CS_MORPH,  // compute shader morph targets
+    DC_NL_Q,   // 顶点属性压缩（quantized）之后的 DC_NL，着色器相同，只有顶点输入格式和特化常量不同
+    TC_NL_Q,
+    DC_PL_Q,
+    TC_PL_Q,
 };
 
+constexpr bool IsPackedPipeline(const PipelineType pipelineType) noexcept
+{
+    return PipelineType::DC_NL_Q == pipelineType || PipelineType::TC_NL_Q == pipelineType || PipelineType::DC_PL_Q == pipelineType
+        || PipelineType::TC_PL_Q == pipelineType;
+}
+
+constexpr PipelineType ToPackedPipeline(const PipelineType pipelineType) noexcept
+{
+    switch (pipelineType)
+    {
+        case PipelineType::DC_NL:
+            return PipelineType::DC_NL_Q;
+        case PipelineType::TC_NL:
+            return PipelineType::TC_NL_Q;
+        case PipelineType::DC_PL:
+            return PipelineType::DC_PL_Q;
+        case PipelineType::TC_PL:
+            return PipelineType::TC_PL_Q;
+        default:
+            return pipelineType;
+    }
+}
+
 struct DescriptorSetLayout
 {
     VkDescriptorSetLayout descriptorSetLayout {nullptr};
@@ -2587,25 +2762,39 @@ struct ModelAttributes
     std::string infomation {};
 };
 
-struct AnimationChannel
+enum class AnimationPath : uint8_t
 {
-    int sampler {};
-
-    // TODO: 这两个成员应该组织为结构体
-    int node {};
-    std::string path {};
+    Translation,
+    Rotation,
+    Scale,
+    Weights,
 };
 
-struct AnimationSampler
+/// @brief 加载时由 gltf 的 channel 和 sampler 编译得到，目标节点已经解析为 NodeHierarchy 的索引
+struct AnimationTrack
 {
-    std::vector<float> input {};
-    std::vector<float> output {};
+    uint32_t target {};     // NodeHierarchy 中的索引
+    Mesh* mesh {};          // 只有 AnimationPath::Weights 使用，变形的权重写入 Mesh::weights
+    uint32_t components {}; // 每个关键帧的分量个数，Weights 等于变形目标的个数
+    std::vector<float> times {};
+    std::vector<float> values {};
+    size_t cursor {0}; // 上一次采样的关键帧，播放时时间单调递增，大多数帧不需要查找
 };
 
 struct Animation
 {
-    std::vector<std::unique_ptr<AnimationChannel>> channels {};
-    std::vector<std::unique_ptr<AnimationSampler>> samplers {};
+    float duration {0.f};
+
+    // 按照 AnimationPath 分组，同一种类型的通道一起计算
+    std::array<std::vector<AnimationTrack>, 4> tracks {};
+};
+
+/// @brief 导入时由 MeshSimplifier 生成，ParseModel 创建索引缓冲时代替 gltf 中的索引
+struct LodChain
+{
+    std::vector<uint32_t> indices {}; // 所有级别的索引依次存放
+    std::vector<PrimitiveLod> levels {};
+    glm::vec4 boundingSphere {0.f};
 };
 
 struct Model
@@ -2618,18 +2807,105 @@ struct Model
     // 定义 LoadNode LoadImage LoadTexture LoadSampler 等函数
     std::vector<std::unique_ptr<Scene>> scenes {};
 
-    std::vector<std::unique_ptr<Animation>> animations {};
+    NodeHierarchy hierarchy {};
+
+    std::vector<Animation> animations {};
+
+    std::unordered_map<int, LodChain> lodChains {}; // 键是 gltf 中索引的 accessor
 
     std::unordered_map<std::string, std::unique_ptr<Image>> images;
     std::unordered_map<std::string, std::unique_ptr<Buffer>> buffers;
     std::unordered_map<std::string, std::unique_ptr<Sampler>> samplers;
     std::unordered_map<std::string, std::unique_ptr<Texture>> textures;
+
+    std::vector<std::vector<std::vector<uint8_t>>> imageMips {}; // 流送纹理时在后台线程生成的 mip 链，下标和 gltfModel.images 相同
+};
+
+/// @brief 所有蒙皮的关节矩阵共用一个环形缓冲，每个同时处理的帧使用其中的一段，每帧开始时重置
+struct JointPalette
+{
+    VkBuffer buffer {nullptr};
+    VkDeviceMemory memory {nullptr};
+    void* mapped {nullptr};
+
+    VkDeviceSize frameSize {0};         // 每一帧的容量，加载模型时累加所有蒙皮的大小
+    VkDeviceSize maxSkinSize {0};       // 最大的一个蒙皮的大小，也是描述符的 range
+    std::atomic<VkDeviceSize> head {0}; // 当前帧已经使用的大小，不同的模型在不同的线程中分配
+
+    VkDescriptorSet descriptorSet {nullptr};
+
+    // 动态偏移必须是 minStorageBufferOffsetAlignment 的倍数，规范规定这个值最大为 256
+    static constexpr VkDeviceSize Alignment {256};
+
+    static VkDeviceSize AlignedSize(VkDeviceSize size) noexcept
+    {
+        return (size + Alignment - 1) / Alignment * Alignment;
+    }
+
+    /// @brief 写入一个蒙皮的关节矩阵，返回相对于整个缓冲的偏移，用作动态偏移
+    std::optional<VkDeviceSize> Allocate(size_t frame, const void* data, VkDeviceSize size) noexcept
+    {
+        // 所有模型加载完成之前还没有创建缓冲
+        if (!mapped)
+        {
+            return std::nullopt;
+        }
+
+        auto offset = head.fetch_add(AlignedSize(size), std::memory_order_relaxed);
+        if (offset + size > frameSize)
+        {
+            return std::nullopt;
+        }
+
+        offset += frame * frameSize;
+        std::memcpy(static_cast<char*>(mapped) + offset, data, size);
+        return offset;
+    }
 };
 
 struct Context
 {
     std::unordered_map<PipelineType, std::unique_ptr<Pipeline>> pipelines;
     std::unordered_map<std::string, std::unique_ptr<DescriptorSetLayout>> descriptorSetLayouts;
+
+    JointPalette jointPalette {};
+};
+
+// 一个模型的所有上传指令录制到一个指令缓冲中一次提交，fence 完成之后释放暂存缓冲
+struct UploadBatch
+{
+    VkCommandBuffer commandBuffer {nullptr};
+    VkFence fence {nullptr};
+    std::vector<std::pair<VkBuffer, VkDeviceMemory>> stagingBuffers {};
+};
+
+// 正在加载的模型：后台线程解析文件、解码图像 => 主线程创建 Vulkan 对象并提交上传 => 上传完成之后加入 m_models
+struct LoadingModel
+{
+    std::string name {};
+    std::future<std::unique_ptr<Model>> parsed {};
+    std::unique_ptr<Model> model {};
+    UploadBatch upload {};
+};
+
+// 纹理流送时新创建的图像，上传完成之后和 Image 中的对象交换，交换之后保存旧的对象，在所有帧的描述符集都更新之后销毁
+struct StreamingImage
+{
+    uint32_t streamId {0};
+    uint32_t residentMip {0};
+
+    VkImage image {nullptr};
+    VkImageView imageView {nullptr};
+    VkDeviceMemory imageMemory {nullptr};
+
+    uint32_t staleFrames {0}; // 描述符集还在引用旧的图像的帧，每一位对应一个同时处理的帧
+};
+
+// 一帧中开始的所有纹理流送的上传
+struct StreamingUpload
+{
+    UploadBatch upload {};
+    std::vector<StreamingImage> images {};
 };
 
 struct PushConstantVP
@@ -2643,51 +2919,64 @@ struct PushConstantCamPos
     alignas(16) glm::vec3 position;
 };
 
+// 顶点着色器中还原压缩的位置，没有压缩的图元 offset 为 0，scale 为 1
+struct PushConstantDequantize
+{
+    alignas(16) glm::vec4 offset {0.f};
+    alignas(16) glm::vec4 scale {1.f};
+};
+
+struct SkinPushConstant
+{
+    uint32_t vertexCount {0};
+    uint32_t jointSize {1};
+};
+
 struct Vertex
 {
     using position_type = glm::vec3;
     using normal_type   = glm::vec3;
     using texCoord_type = glm::vec2;
-    using weight_type   = glm::vec4;
-    using joint_type    = glm::vec4;
+
+    // 压缩之后的格式，见 VertexPacking.h
+    using packed_position_type = std::array<int16_t, 4>;  // snorm16，相对于包围盒，第 4 个分量不使用
+    using packed_normal_type   = std::array<int16_t, 2>;  // 八面体映射，snorm16
+    using packed_texCoord_type = std::array<uint16_t, 2>; // half
 
     static std::vector<VkVertexInputBindingDescription> GetBindingDescriptions(const PipelineType pipelineType) noexcept
     {
+        const auto packed       = IsPackedPipeline(pipelineType);
+        const auto positionSize = packed ? sizeof(packed_position_type) : sizeof(position_type);
+        const auto normalSize   = packed ? sizeof(packed_normal_type) : sizeof(normal_type);
+        const auto texCoordSize = packed ? sizeof(packed_texCoord_type) : sizeof(texCoord_type);
+
         std::vector<VkVertexInputBindingDescription> bindingDescriptions {};
-        bindingDescriptions.emplace_back(0, static_cast<uint32_t>(sizeof(position_type)), VK_VERTEX_INPUT_RATE_VERTEX);
+        bindingDescriptions.emplace_back(0, static_cast<uint32_t>(positionSize), VK_VERTEX_INPUT_RATE_VERTEX);
 
         switch (pipelineType)
         {
             case PipelineType::DC_NL:
+            case PipelineType::DC_NL_Q:
             {
             }
             break;
             case PipelineType::TC_NL:
+            case PipelineType::TC_NL_Q:
             {
-                bindingDescriptions.emplace_back(1, static_cast<uint32_t>(sizeof(texCoord_type)), VK_VERTEX_INPUT_RATE_VERTEX);
+                bindingDescriptions.emplace_back(1, static_cast<uint32_t>(texCoordSize), VK_VERTEX_INPUT_RATE_VERTEX);
             }
             break;
             case PipelineType::DC_PL:
+            case PipelineType::DC_PL_Q:
             {
-                bindingDescriptions.emplace_back(1, static_cast<uint32_t>(sizeof(normal_type)), VK_VERTEX_INPUT_RATE_VERTEX);
+                bindingDescriptions.emplace_back(1, static_cast<uint32_t>(normalSize), VK_VERTEX_INPUT_RATE_VERTEX);
             }
             break;
             case PipelineType::TC_PL:
+            case PipelineType::TC_PL_Q:
             {
-                bindingDescriptions.emplace_back(1, static_cast<uint32_t>(sizeof(normal_type)), VK_VERTEX_INPUT_RATE_VERTEX);
-                bindingDescriptions.emplace_back(2, static_cast<uint32_t>(sizeof(texCoord_type)), VK_VERTEX_INPUT_RATE_VERTEX);
-            }
-            break;
-            case PipelineType::DC_NL_AW2:
-            {
-                bindingDescriptions.emplace_back(1, static_cast<uint32_t>(sizeof(position_type)), VK_VERTEX_INPUT_RATE_VERTEX);
-                bindingDescriptions.emplace_back(2, static_cast<uint32_t>(sizeof(position_type)), VK_VERTEX_INPUT_RATE_VERTEX);
-            }
-            break;
-            case PipelineType::DC_NL_AS2:
-            {
-                bindingDescriptions.emplace_back(1, static_cast<uint32_t>(sizeof(weight_type)), VK_VERTEX_INPUT_RATE_VERTEX);
-                bindingDescriptions.emplace_back(2, static_cast<uint32_t>(sizeof(joint_type)), VK_VERTEX_INPUT_RATE_VERTEX);
+                bindingDescriptions.emplace_back(1, static_cast<uint32_t>(normalSize), VK_VERTEX_INPUT_RATE_VERTEX);
+                bindingDescriptions.emplace_back(2, static_cast<uint32_t>(texCoordSize), VK_VERTEX_INPUT_RATE_VERTEX);
             }
             break;
             default:
@@ -2697,43 +2986,41 @@ struct Vertex
         return bindingDescriptions;
     }
 
+    /// @details 压缩的格式在读取顶点时由硬件转换为 float，着色器中的输入变量不变，只有法线需要在着色器中解码
     static std::vector<VkVertexInputAttributeDescription> GetAttributeDescriptions(const PipelineType pipelineType) noexcept
     {
+        const auto packed         = IsPackedPipeline(pipelineType);
+        const auto positionFormat = packed ? VK_FORMAT_R16G16B16A16_SNORM : VK_FORMAT_R32G32B32_SFLOAT;
+        const auto normalFormat   = packed ? VK_FORMAT_R16G16_SNORM : VK_FORMAT_R32G32B32_SFLOAT;
+        const auto texCoordFormat = packed ? VK_FORMAT_R16G16_SFLOAT : VK_FORMAT_R32G32_SFLOAT;
+
         std::vector<VkVertexInputAttributeDescription> attributeDescriptions {};
-        attributeDescriptions.emplace_back(0, 0, VK_FORMAT_R32G32B32_SFLOAT, 0);
+        attributeDescriptions.emplace_back(0, 0, positionFormat, 0);
 
         switch (pipelineType)
         {
             case PipelineType::DC_NL:
+            case PipelineType::DC_NL_Q:
             {
             }
             break;
             case PipelineType::TC_NL:
+            case PipelineType::TC_NL_Q:
             {
-                attributeDescriptions.emplace_back(1, 1, VK_FORMAT_R32G32_SFLOAT, 0);
+                attributeDescriptions.emplace_back(1, 1, texCoordFormat, 0);
             }
             break;
             case PipelineType::DC_PL:
+            case PipelineType::DC_PL_Q:
             {
-                attributeDescriptions.emplace_back(1, 1, VK_FORMAT_R32G32B32_SFLOAT, 0);
+                attributeDescriptions.emplace_back(1, 1, normalFormat, 0);
             }
             break;
             case PipelineType::TC_PL:
+            case PipelineType::TC_PL_Q:
             {
-                attributeDescriptions.emplace_back(1, 1, VK_FORMAT_R32G32B32_SFLOAT, 0);
-                attributeDescriptions.emplace_back(2, 2, VK_FORMAT_R32G32_SFLOAT, 0);
-            }
-            break;
-            case PipelineType::DC_NL_AW2:
-            {
-                attributeDescriptions.emplace_back(1, 1, VK_FORMAT_R32G32B32_SFLOAT, 0);
-                attributeDescriptions.emplace_back(2, 2, VK_FORMAT_R32G32B32_SFLOAT, 0);
-            }
-            break;
-            case PipelineType::DC_NL_AS2:
-            {
-                attributeDescriptions.emplace_back(1, 1, VK_FORMAT_R32G32B32A32_SFLOAT, 0);
-                attributeDescriptions.emplace_back(2, 2, VK_FORMAT_R32G32B32A32_SFLOAT, 0);
+                attributeDescriptions.emplace_back(1, 1, normalFormat, 0);
+                attributeDescriptions.emplace_back(2, 2, texCoordFormat, 0);
             }
             break;
             default:
@@ -2822,6 +3109,8 @@ private:
         while (!glfwWindowShouldClose(m_window))
         {
             glfwPollEvents();
+            UpdateLoadingModels(false);
+            UpdateTextureStreaming();
             PrepareImGui();
             DrawFrame();
         }
@@ -2841,11 +3130,6 @@ private:
             }
         };
 
-        if (node->skin && node->skin->matrix)
-        {
-            destroyUniform(node->skin->matrix);
-        }
-
         if (node->mesh)
         {
             destroyUniform(node->modelUniform);
@@ -2863,11 +3147,6 @@ private:
                 {
                     destroyUniform(option_roughnessMetallic.value());
                 }
-
-                if (auto& option_animation = primitive->animationWeight)
-                {
-                    destroyUniform(option_animation.value());
-                }
             }
         }
 
@@ -2908,6 +3187,9 @@ private:
             }
         }
 
+        vkDestroyBuffer(m_device, m_context->jointPalette.buffer, nullptr);
+        vkFreeMemory(m_device, m_context->jointPalette.memory, nullptr);
+
         for (const auto& [_, pipeline] : m_context->pipelines)
         {
             vkDestroyPipeline(m_device, pipeline->pipeline, nullptr);
@@ -2927,6 +3209,8 @@ private:
         ImGui::DestroyContext();
 
         CleanupSwapChain();
+        UpdateLoadingModels(true);
+        DestroyTextureStreaming();
         DestroyModel();
 
         vkDestroyRenderPass(m_device, m_renderPass, nullptr);
@@ -2961,22 +3245,52 @@ private:
         CreateDescriptorSetLayouts();
         CreatePipelines();
 
-        m_models.try_emplace("../resources/models/morph.gltf", std::make_unique<Model>());
-        m_models.try_emplace("../resources/models/test.gltf", std::make_unique<Model>());
-        m_models.try_emplace("../resources/models/teapot.gltf", std::make_unique<Model>());
-        m_models.try_emplace("../resources/models/sphere.gltf", std::make_unique<Model>());
-        m_models.try_emplace("../resources/models/WaterBottle/WaterBottle.gltf", std::make_unique<Model>());
-        m_models.try_emplace("../resources/models/FlightHelmet/FlightHelmet.gltf", std::make_unique<Model>());
-        m_models.try_emplace("../resources/models/skin.gltf", std::make_unique<Model>());
-
-        for (const auto& [name, model] : m_models)
+        // 文件在 m_filePool 中解析，主循环中每帧调用 UpdateLoadingModels，加载完成的模型立即开始绘制
+        for (const auto& fileName : {
+                 "../resources/models/morph.gltf",
+                 "../resources/models/test.gltf",
+                 "../resources/models/teapot.gltf",
+                 "../resources/models/sphere.gltf",
+                 "../resources/models/WaterBottle/WaterBottle.gltf",
+                 "../resources/models/FlightHelmet/FlightHelmet.gltf",
+                 "../resources/models/skin.gltf",
+             })
         {
-            LoadModel(name, model);
+            auto parsed = m_filePool.Submit([fileName = std::string(fileName), &decodePool = m_decodePool]() {
+                return ReadModelFile(fileName, decodePool);
+            });
+            m_loadingModels.emplace_back(fileName, std::move(parsed));
         }
     }
 
-    void LoadModel(const std::string& fileName, const std::unique_ptr<Model>& model)
+    /// @brief 在后台线程中读取 gltf 文件，文件中的图像在解析完成之后提交到 decodePool 并行解码
+    /// @details 只访问 CPU 数据，不创建任何 Vulkan 对象，每个线程使用独立的 TinyGLTF
+    static std::unique_ptr<Model> ReadModelFile(const std::string& fileName, ThreadPool& decodePool)
     {
+        struct EncodedImage
+        {
+            int index {0};
+            int width {0};
+            int height {0};
+            std::vector<unsigned char> bytes {};
+        };
+
+        // tinygltf 默认在解析文件的线程中依次解码图像，这里只保存编码之后的数据
+        std::vector<EncodedImage> encodedImages {};
+
+        tinygltf::TinyGLTF loader {};
+        loader.SetImageLoader(
+            [&encodedImages](
+                tinygltf::Image*, const int index, std::string*, std::string*, int width, int height, const unsigned char* bytes, int size, void*
+            ) {
+                encodedImages.emplace_back(index, width, height, std::vector<unsigned char>(bytes, bytes + size));
+                return true;
+            },
+            nullptr
+        );
+
+        auto model = std::make_unique<Model>();
+
         std::string err {};
         std::string warn {};
 
@@ -2984,14 +3298,13 @@ private:
         std::filesystem::path path(fileName);
         if (path.has_extension())
         {
-            auto ex = path.extension();
             if (path.extension() == ".glb")
             {
-                res = m_gltfLoader.LoadBinaryFromFile(&model->gltfModel, &err, &warn, path.string());
+                res = loader.LoadBinaryFromFile(&model->gltfModel, &err, &warn, path.string());
             }
             if (path.extension() == ".gltf")
             {
-                res = m_gltfLoader.LoadASCIIFromFile(&model->gltfModel, &err, &warn, path.string());
+                res = loader.LoadASCIIFromFile(&model->gltfModel, &err, &warn, path.string());
             }
         }
 
@@ -3007,121 +3320,642 @@ private:
 
         if (!res)
         {
-            throw std::runtime_error("failed to load gltf model");
+            throw std::runtime_error("failed to load gltf model: " + fileName);
         }
 
-        ParseModel(model);
-    }
+        // 每个图像写入 gltfModel.images 中不同的元素，可以同时解码；流送纹理时解码之后接着生成 mip 链
+        auto& images = model->gltfModel.images;
+        auto& mips   = model->imageMips;
+        mips.resize(images.size());
 
-    std::vector<float> ParseAnimationBuffer(const std::unique_ptr<Model>& model, const tinygltf::Accessor& accessor)
-    {
-        size_t size {1};
-        switch (accessor.type)
+        std::vector<std::future<std::string>> decodes {};
+
+        // 线程池的 future 析构时不会等待，解码的任务引用了这里的局部变量，离开这个函数之前必须等待所有任务完成
+        auto waitDecodes = [&decodes]() {
+            for (const auto& decode : decodes)
+            {
+                decode.wait();
+            }
+        };
+
+        try
         {
-            case TINYGLTF_TYPE_VEC4:
-                size = 4;
-                break;
-            case TINYGLTF_TYPE_SCALAR:
-                size = 1;
-                break;
-            default:
-                std::cout << std::format("ParseAnimationBuffer: type {} not supported\n", accessor.type);
-                break;
-        }
+            for (const auto& encoded : encodedImages)
+            {
+                decodes.emplace_back(decodePool.Submit([&images, &mips, &encoded]() {
+                    std::string decodeErr {};
+                    std::string decodeWarn {};
+                    tinygltf::LoadImageData(
+                        &images[encoded.index],
+                        encoded.index,
+                        &decodeErr,
+                        &decodeWarn,
+                        encoded.width,
+                        encoded.height,
+                        encoded.bytes.data(),
+                        static_cast<int>(encoded.bytes.size()),
+                        nullptr
+                    );
 
-        if (accessor.componentType != TINYGLTF_COMPONENT_TYPE_FLOAT)
+                    // 颜色纹理使用 UNORM 格式（见 ParseImage），所以直接在编码空间中求平均
+                    const auto& image = images[encoded.index];
+                    if (STREAM_TEXTURES && decodeErr.empty() && 4 == image.component && 8 == image.bits && !image.image.empty())
+                    {
+                        auto width          = static_cast<uint32_t>(image.width);
+                        auto height         = static_cast<uint32_t>(image.height);
+                        mips[encoded.index] = MipChain::Generate(image.image.data(), width, height, 4, false);
+                    }
+
+                    return decodeErr;
+                }));
+            }
+
+            // 图像解码的同时对索引重新排序，生成 LOD 链
+            OptimizeIndices(model->gltfModel);
+            if constexpr (GENERATE_LODS)
+            {
+                GenerateLods(model);
+            }
+        }
+        catch (...)
         {
-            std::cout << std::format("ParseAnimationBuffer: componentType {} not supported\n", accessor.componentType);
+            waitDecodes();
+            throw;
         }
 
-        const auto& bufferView = model->gltfModel.bufferViews[accessor.bufferView];
-        const auto dataPointer = &model->gltfModel.buffers[bufferView.buffer].data[accessor.byteOffset + bufferView.byteOffset];
+        waitDecodes();
+        for (auto& decode : decodes)
+        {
+            if (auto decodeErr = decode.get(); !decodeErr.empty())
+            {
+                throw std::runtime_error("failed to decode image: " + decodeErr);
+            }
+        }
 
-        return std::vector<float>(reinterpret_cast<float*>(dataPointer), reinterpret_cast<float*>(dataPointer) + accessor.count * size);
+        return model;
     }
 
-    void ParseModel(const std::unique_ptr<Model>& model) noexcept
+    /// @brief 对三角形列表的索引重新排序（顶点缓存、过度绘制），直接修改 gltf 缓冲中的数据
+    /// @details 顶点属性分别存放在不同的缓冲中，并且可能被多个图元共用，所以只改变三角形的顺序，不重新排列顶点
+    static void OptimizeIndices(tinygltf::Model& gltfModel)
     {
-        for (const auto& animation : model->gltfModel.animations)
+        std::set<int> optimized {};
+        for (const auto& mesh : gltfModel.meshes)
         {
-            auto tempAnimation = std::make_unique<Animation>();
-
-            for (const auto& sampler : animation.samplers)
+            for (const auto& primitive : mesh.primitives)
             {
-                auto tempSampler = std::make_unique<AnimationSampler>();
-                if (sampler.input >= 0)
+                if (TINYGLTF_MODE_TRIANGLES != primitive.mode || primitive.indices < 0 || !primitive.attributes.contains("POSITION")
+                    || !optimized.insert(primitive.indices).second)
                 {
-                    const auto& accessor = model->gltfModel.accessors[sampler.input];
-                    tempSampler->input   = ParseAnimationBuffer(model, accessor);
+                    continue;
                 }
-                if (sampler.output >= 0)
+
+                const auto& indexAccessor    = gltfModel.accessors[primitive.indices];
+                const auto& positionAccessor = gltfModel.accessors[primitive.attributes.at("POSITION")];
+                if (indexAccessor.bufferView < 0 || positionAccessor.bufferView < 0 || positionAccessor.sparse.isSparse
+                    || TINYGLTF_COMPONENT_TYPE_FLOAT != positionAccessor.componentType)
                 {
-                    const auto& accessor = model->gltfModel.accessors[sampler.output];
-                    tempSampler->output  = ParseAnimationBuffer(model, accessor);
+                    continue;
                 }
 
-                tempAnimation->samplers.emplace_back(std::move(tempSampler));
-            }
+                const auto& positionView = gltfModel.bufferViews[positionAccessor.bufferView];
+                const auto& indexView    = gltfModel.bufferViews[indexAccessor.bufferView];
+                auto positions = reinterpret_cast<const float*>(&gltfModel.buffers[positionView.buffer].data[positionView.byteOffset + positionAccessor.byteOffset]);
+                auto indexData = &gltfModel.buffers[indexView.buffer].data[indexView.byteOffset + indexAccessor.byteOffset];
 
-            for (const auto& channel : animation.channels)
-            {
-                auto tempChannel     = std::make_unique<AnimationChannel>();
-                tempChannel->sampler = channel.sampler;
-                tempChannel->node    = channel.target_node;
-                tempChannel->path    = channel.target_path;
+                auto indices = ReadTriangleIndices(gltfModel, indexAccessor, positionAccessor.count);
+                if (indices.empty())
+                {
+                    continue;
+                }
 
-                tempAnimation->channels.emplace_back(std::move(tempChannel));
-            }
+                std::vector<uint32_t> clusters {};
+                indices = MeshOptimizer::OptimizeVertexCache(indices, positionAccessor.count, MeshOptimizer::DefaultCacheSize, &clusters);
+                indices = MeshOptimizer::OptimizeOverdraw(
+                    indices, clusters, positions, static_cast<size_t>(positionAccessor.ByteStride(positionView))
+                );
 
-            model->animations.emplace_back(std::move(tempAnimation));
+                if (TINYGLTF_COMPONENT_TYPE_UNSIGNED_INT == indexAccessor.componentType)
+                {
+                    std::memcpy(indexData, indices.data(), indices.size() * sizeof(uint32_t));
+                }
+                else
+                {
+                    std::ranges::transform(indices, reinterpret_cast<uint16_t*>(indexData), [](uint32_t index) { return static_cast<uint16_t>(index); });
+                }
+            }
         }
+    }
 
-        uint32_t imguiScene {0};
-        for (const auto& scene : model->gltfModel.scenes)
+    /// @brief 为静态图元生成 LOD 链，保存在 Model::lodChains 中，所有级别共用原始的顶点
+    /// @details 蒙皮和变形的图元在计算着色器中移动顶点，按照绑定姿势计算的误差不可靠，不生成 LOD
+    static void GenerateLods(const std::unique_ptr<Model>& model)
+    {
+        const auto& gltfModel = model->gltfModel;
+        for (const auto& mesh : gltfModel.meshes)
         {
-            model->attributes.infomation += std::format("Scene {} : {}\n", imguiScene++, scene.name);
+            for (const auto& primitive : mesh.primitives)
+            {
+                if (TINYGLTF_MODE_TRIANGLES != primitive.mode || primitive.indices < 0 || !primitive.attributes.contains("POSITION")
+                    || primitive.attributes.contains("JOINTS_0") || !primitive.targets.empty() || model->lodChains.contains(primitive.indices))
+                {
+                    continue;
+                }
 
-            auto tempScene  = std::make_unique<Scene>();
-            tempScene->name = scene.name;
+                const auto& indexAccessor    = gltfModel.accessors[primitive.indices];
+                const auto& positionAccessor = gltfModel.accessors[primitive.attributes.at("POSITION")];
+                if (indexAccessor.bufferView < 0 || positionAccessor.bufferView < 0 || positionAccessor.sparse.isSparse
+                    || TINYGLTF_COMPONENT_TYPE_FLOAT != positionAccessor.componentType)
+                {
+                    continue;
+                }
 
-            for (const auto& nodeIndex : scene.nodes)
-            {
-                ParseNode(model, tempScene->nodes, nodeIndex);
-            }
+                auto indices = ReadTriangleIndices(gltfModel, indexAccessor, positionAccessor.count);
+                if (indices.empty())
+                {
+                    continue;
+                }
 
-            model->scenes.emplace_back(std::move(tempScene));
-        }
-    }
+                const auto& positionView = gltfModel.bufferViews[positionAccessor.bufferView];
+                auto positions = reinterpret_cast<const float*>(&gltfModel.buffers[positionView.buffer].data[positionView.byteOffset + positionAccessor.byteOffset]);
+                auto stride    = static_cast<size_t>(positionAccessor.ByteStride(positionView));
 
-    void ParseNode(const std::unique_ptr<Model>& model, std::vector<std::unique_ptr<Node>>& nodes, int nodeIndex, Node* parent = nullptr)
+                auto lods = MeshSimplifier::BuildLodChain(indices, positions, positionAccessor.count, stride);
+                if (lods.size() < 2)
+                {
+                    continue;
+                }
+
+                // 包围盒的中心作为球心
+                glm::vec3 boundsMin {std::numeric_limits<float>::max()};
+                glm::vec3 boundsMax {std::numeric_limits<float>::lowest()};
+                for (auto index : indices)
+                {
+                    auto p    = glm::make_vec3(reinterpret_cast<const float*>(reinterpret_cast<const std::byte*>(positions) + index * stride));
+                    boundsMin = glm::min(boundsMin, p);
+                    boundsMax = glm::max(boundsMax, p);
+                }
+                auto center = (boundsMin + boundsMax) * .5f;
+                float radius {0.f};
+                for (auto index : indices)
+                {
+                    auto p = glm::make_vec3(reinterpret_cast<const float*>(reinterpret_cast<const std::byte*>(positions) + index * stride));
+                    radius = std::max(radius, glm::length(p - center));
+                }
+
+                LodChain chain {};
+                chain.boundingSphere = glm::vec4(center, radius);
+                for (auto& lod : lods)
+                {
+                    // 简化之后的三角形重新排序，第 0 级已经在 OptimizeIndices 中排序
+                    if (!chain.levels.empty())
+                    {
+                        lod.indices = MeshOptimizer::OptimizeVertexCache(lod.indices, positionAccessor.count);
+                    }
+
+                    chain.levels.emplace_back(
+                        static_cast<uint32_t>(chain.indices.size()), static_cast<uint32_t>(lod.indices.size()), lod.error
+                    );
+                    chain.indices.insert(chain.indices.end(), lod.indices.begin(), lod.indices.end());
+                }
+
+                model->lodChains.try_emplace(primitive.indices, std::move(chain));
+            }
+        }
+    }
+
+    /// @brief 读取三角形列表的索引并转换为 uint32_t，不是 3 的倍数或者超出顶点个数时返回空
+    static std::vector<uint32_t> ReadTriangleIndices(const tinygltf::Model& gltfModel, const tinygltf::Accessor& indexAccessor, size_t vertexCount)
     {
-        const tinygltf::Node& node = model->gltfModel.nodes[nodeIndex];
-        model->attributes.infomation += std::format("  Node {} :\n", node.name);
+        const auto& indexView = gltfModel.bufferViews[indexAccessor.bufferView];
+        auto indexData        = &gltfModel.buffers[indexView.buffer].data[indexView.byteOffset + indexAccessor.byteOffset];
 
-        auto tempNode    = std::make_unique<Node>();
-        tempNode->name   = node.name;
-        tempNode->index  = nodeIndex;
-        tempNode->parent = parent;
+        std::vector<uint32_t> indices(indexAccessor.count);
+        switch (indexAccessor.componentType)
+        {
+            case TINYGLTF_COMPONENT_TYPE_UNSIGNED_INT:
+                std::memcpy(indices.data(), indexData, indices.size() * sizeof(uint32_t));
+                break;
+            case TINYGLTF_COMPONENT_TYPE_UNSIGNED_SHORT:
+                std::copy_n(reinterpret_cast<const uint16_t*>(indexData), indices.size(), indices.begin());
+                break;
+            default:
+                indices.clear();
+                break;
+        }
 
-        if (node.matrix.size() == 16)
+        if (0 != indices.size() % 3 || std::ranges::any_of(indices, [vertexCount](uint32_t index) { return index >= vertexCount; }))
         {
-            tempNode->matrices["matrix"] = glm::make_mat4(node.matrix.data());
+            indices.clear();
         }
-        else
+
+        return indices;
+    }
+
+    /// @brief 检查后台加载的模型：文件解析完成的模型在主线程创建 Vulkan 对象并提交上传，上传完成之后加入 m_models 开始绘制
+    /// @param wait 为 true 时等待所有模型加载完成，退出程序时使用
+    void UpdateLoadingModels(bool wait)
+    {
+        if (m_loadingModels.empty())
+        {
+            return;
+        }
+
+        for (auto it = m_loadingModels.begin(); it != m_loadingModels.end();)
+        {
+            auto& loading = *it;
+            if (!loading.model)
+            {
+                if (!wait && std::future_status::ready != loading.parsed.wait_for(std::chrono::seconds(0)))
+                {
+                    ++it;
+                    continue;
+                }
+
+                // 描述符集等对象只在主线程创建，缓冲和纹理的复制指令全部录制到 loading.upload 中
+                loading.model = loading.parsed.get();
+                BeginUpload(loading.upload);
+                ParseModel(loading.model);
+                EndUpload(loading.upload);
+            }
+
+            auto status = wait ? vkWaitForFences(m_device, 1, &loading.upload.fence, VK_TRUE, UINT64_MAX)
+                               : vkGetFenceStatus(m_device, loading.upload.fence);
+            if (VK_SUCCESS != status)
+            {
+                ++it;
+                continue;
+            }
+
+            DestroyUpload(loading.upload);
+
+            // 初始的 mip 上传完成之后才开始流送
+            for (const auto& [_, image] : loading.model->images)
+            {
+                if (image->streamId)
+                {
+                    m_textureStreamer.Complete(image->streamId.value(), m_textureStreamer.GetResidentMip(image->streamId.value()));
+                }
+            }
+
+            m_models.try_emplace(loading.name, std::move(loading.model));
+            it = m_loadingModels.erase(it);
+        }
+
+        // 关节矩阵的环形缓冲的大小由所有模型的蒙皮决定
+        if (m_loadingModels.empty())
+        {
+            CreateJointPalette();
+        }
+    }
+
+    void BeginUpload(UploadBatch& upload)
+    {
+        upload.commandBuffer = BeginSingleTimeCommands();
+
+        VkFenceCreateInfo fenceInfo = {};
+        fenceInfo.sType             = VK_STRUCTURE_TYPE_FENCE_CREATE_INFO;
+
+        if (VK_SUCCESS != vkCreateFence(m_device, &fenceInfo, nullptr, &upload.fence))
+        {
+            throw std::runtime_error("failed to create fence");
+        }
+
+        m_uploadBatch = &upload;
+    }
+
+    void EndUpload(UploadBatch& upload)
+    {
+        m_uploadBatch = nullptr;
+
+        vkEndCommandBuffer(upload.commandBuffer);
+
+        VkSubmitInfo submitInfo       = {};
+        submitInfo.sType              = VK_STRUCTURE_TYPE_SUBMIT_INFO;
+        submitInfo.commandBufferCount = 1;
+        submitInfo.pCommandBuffers    = &upload.commandBuffer;
+
+        if (VK_SUCCESS != vkQueueSubmit(m_transferQueue, 1, &submitInfo, upload.fence))
+        {
+            throw std::runtime_error("failed to submit upload command buffer");
+        }
+    }
+
+    void DestroyUpload(UploadBatch& upload) noexcept
+    {
+        for (const auto& [buffer, memory] : upload.stagingBuffers)
+        {
+            vkDestroyBuffer(m_device, buffer, nullptr);
+            vkFreeMemory(m_device, memory, nullptr);
+        }
+
+        vkDestroyFence(m_device, upload.fence, nullptr);
+        vkFreeCommandBuffers(m_device, m_commandPool, 1, &upload.commandBuffer);
+
+        upload = {};
+    }
+
+    /// @brief 纹理流送：替换上传完成的图像，根据本帧的需求开始新的上传
+    /// @details 1. 需求由图元的纹理坐标密度和包围球在屏幕上的大小在 CPU 上估计，不读取 GPU 的反馈
+    ///          2. 改变常驻的级别时创建新的图像，从 CPU 上的 mip 链上传所有常驻的级别，上传完成之前继续使用旧的图像
+    ///          3. 本帧开始的所有上传录制到一个批次中，和加载模型一样提交到 m_transferQueue，不阻塞主循环
+    void UpdateTextureStreaming()
+    {
+        if (!STREAM_TEXTURES)
+        {
+            return;
+        }
+
+        for (auto it = m_streamingUploads.begin(); it != m_streamingUploads.end();)
+        {
+            if (VK_SUCCESS != vkGetFenceStatus(m_device, it->upload.fence))
+            {
+                ++it;
+                continue;
+            }
+
+            DestroyUpload(it->upload);
+
+            // 交换之后 streaming 中保存的是旧的图像，每一帧的描述符集由 UpdateStreamedDescriptors 更新
+            for (auto& streaming : it->images)
+            {
+                const auto& [model, key] = m_streamedImages[streaming.streamId];
+                const auto& image        = model->images.at(key);
+                std::swap(image->image, streaming.image);
+                std::swap(image->imageView, streaming.imageView);
+                std::swap(image->imageMemory, streaming.imageMemory);
+
+                streaming.staleFrames = (1u << MAX_FRAMES_IN_FLIGHT) - 1;
+                m_retiredImages.emplace_back(std::move(streaming));
+            }
+
+            it = m_streamingUploads.erase(it);
+        }
+
+        m_textureStreamer.BeginFrame();
+
+        auto pc = GetViewProjection();
+        for (const auto& [_, model] : m_models)
+        {
+            if (!model->attributes.visibility)
+            {
+                continue;
+            }
+
+            for (const auto& scene : model->scenes)
+            {
+                for (const auto& node : scene->nodes)
+                {
+                    RequestTextureMips(model, node, pc.view, pc.proj);
+                }
+            }
+        }
+
+        auto changes = m_textureStreamer.Update(STREAM_UPLOAD_BUDGET);
+        if (changes.empty())
+        {
+            return;
+        }
+
+        auto& streaming = m_streamingUploads.emplace_back();
+        BeginUpload(streaming.upload);
+        for (const auto& change : changes)
         {
-            if (node.translation.size() == 3)
+            const auto& [model, key] = m_streamedImages[change.texture];
+            auto& image              = streaming.images.emplace_back(change.texture, change.residentMip);
+            CreateStreamedImage(*model->images.at(key), change.residentMip, image.image, image.imageView, image.imageMemory);
+        }
+        EndUpload(streaming.upload);
+    }
+
+    /// @brief 估计节点中每个使用流送纹理的图元需要的 mip，和 SelectLod 一样使用包围球上离相机最近的点
+    void RequestTextureMips(const std::unique_ptr<Model>& model, const std::unique_ptr<Node>& node, const glm::mat4& view, const glm::mat4& proj)
+    {
+        if (node->mesh)
+        {
+            for (const auto& primitive : node->mesh->primitives)
             {
-                tempNode->matrices["translation"] = glm::translate(glm::mat4(1.f), glm::vec3(glm::make_vec3(node.translation.data())));
+                if (ColoringMode::TextureMapping != primitive->coloringMode)
+                {
+                    continue;
+                }
+
+                const auto& texture = model->textures.at(primitive->material->pbrMetallicRoughness->baseColorTexture.value());
+                auto image          = model->images.find(texture->image);
+                if (image == model->images.end() || !image->second->streamId)
+                {
+                    continue;
+                }
+
+                // 相机在包围球内部时需要最精细的一级
+                const auto& streamed = image->second;
+                auto pixelsPerUnit   = ComputePixelsPerUnit(*primitive, model->hierarchy.worldMatrices[node->transform], view, proj);
+                auto textureSize     = std::max(streamed->width, streamed->height);
+                auto mip = pixelsPerUnit ? TextureStreamer::ComputeMip(textureSize, primitive->uvDensity, pixelsPerUnit.value()) : 0.f;
+                m_textureStreamer.Request(streamed->streamId.value(), mip);
             }
-            if (node.rotation.size() == 4)
+        }
+
+        for (const auto& child : node->children)
+        {
+            RequestTextureMips(model, child, view, proj);
+        }
+    }
+
+    /// @brief 这一帧的栅栏发出信号之后更新这一帧的描述符集，所有帧都更新之后旧的图像不再被使用，可以销毁
+    void UpdateStreamedDescriptors()
+    {
+        auto frameBit = 1u << m_currentFrame;
+        for (auto it = m_retiredImages.begin(); it != m_retiredImages.end();)
+        {
+            if (it->staleFrames & frameBit)
             {
-                tempNode->matrices["rotation"] = glm::toMat4(glm::make_quat(node.rotation.data()));
+                const auto& [model, key] = m_streamedImages[it->streamId];
+                for (const auto& [_, texture] : model->textures)
+                {
+                    if (texture->image == key)
+                    {
+                        WriteTextureDescriptor(*model, *texture, m_currentFrame);
+                    }
+                }
+
+                it->staleFrames &= ~frameBit;
             }
-            if (node.scale.size() == 3)
+
+            if (0 != it->staleFrames)
             {
-                tempNode->matrices["scale"] = glm::scale(glm::mat4(1.f), glm::vec3(glm::make_vec3(node.scale.data())));
+                ++it;
+                continue;
+            }
+
+            DestroyStreamingImage(*it);
+            m_textureStreamer.Complete(it->streamId, it->residentMip);
+            it = m_retiredImages.erase(it);
+        }
+    }
+
+    void DestroyStreamingImage(const StreamingImage& image) noexcept
+    {
+        vkDestroyImageView(m_device, image.imageView, nullptr);
+        vkDestroyImage(m_device, image.image, nullptr);
+        vkFreeMemory(m_device, image.imageMemory, nullptr);
+    }
+
+    /// @brief 退出程序时调用，设备已经空闲
+    void DestroyTextureStreaming() noexcept
+    {
+        for (auto& streaming : m_streamingUploads)
+        {
+            DestroyUpload(streaming.upload);
+            for (const auto& image : streaming.images)
+            {
+                DestroyStreamingImage(image);
+            }
+        }
+
+        for (const auto& image : m_retiredImages)
+        {
+            DestroyStreamingImage(image);
+        }
+
+        m_streamingUploads.clear();
+        m_retiredImages.clear();
+    }
+
+    std::vector<float> ParseAnimationBuffer(const std::unique_ptr<Model>& model, const tinygltf::Accessor& accessor)
+    {
+        size_t size {1};
+        switch (accessor.type)
+        {
+            case TINYGLTF_TYPE_VEC4:
+                size = 4;
+                break;
+            case TINYGLTF_TYPE_VEC3:
+                size = 3;
+                break;
+            case TINYGLTF_TYPE_SCALAR:
+                size = 1;
+                break;
+            default:
+                std::cout << std::format("ParseAnimationBuffer: type {} not supported\n", accessor.type);
+                break;
+        }
+
+        if (accessor.componentType != TINYGLTF_COMPONENT_TYPE_FLOAT)
+        {
+            std::cout << std::format("ParseAnimationBuffer: componentType {} not supported\n", accessor.componentType);
+        }
+
+        const auto& bufferView = model->gltfModel.bufferViews[accessor.bufferView];
+        const auto dataPointer = &model->gltfModel.buffers[bufferView.buffer].data[accessor.byteOffset + bufferView.byteOffset];
+
+        return std::vector<float>(reinterpret_cast<float*>(dataPointer), reinterpret_cast<float*>(dataPointer) + accessor.count * size);
+    }
+
+    void ParseModel(const std::unique_ptr<Model>& model) noexcept
+    {
+        uint32_t imguiScene {0};
+        for (const auto& scene : model->gltfModel.scenes)
+        {
+            model->attributes.infomation += std::format("Scene {} : {}\n", imguiScene++, scene.name);
+
+            auto tempScene  = std::make_unique<Scene>();
+            tempScene->name = scene.name;
+
+            for (const auto& nodeIndex : scene.nodes)
+            {
+                ParseNode(model, tempScene->nodes, nodeIndex);
+            }
+
+            model->scenes.emplace_back(std::move(tempScene));
+        }
+
+        // 动画的目标节点需要在场景解析完成之后才能确定
+        CompileAnimations(model);
+    }
+
+    /// @brief 将 gltf 的动画编译为 AnimationTrack，运行时不再查找节点和比较字符串
+    void CompileAnimations(const std::unique_ptr<Model>& model)
+    {
+        const auto& hierarchy = model->hierarchy;
+
+        for (const auto& animation : model->gltfModel.animations)
+        {
+            Animation tempAnimation {};
+
+            for (const auto& channel : animation.channels)
+            {
+                if (channel.target_node < 0 || channel.target_node >= static_cast<int>(hierarchy.gltfToFlat.size())
+                    || hierarchy.gltfToFlat[channel.target_node] < 0 || channel.sampler < 0)
+                {
+                    continue;
+                }
+
+                AnimationPath path {};
+                if (channel.target_path == "translation")
+                {
+                    path = AnimationPath::Translation;
+                }
+                else if (channel.target_path == "rotation")
+                {
+                    path = AnimationPath::Rotation;
+                }
+                else if (channel.target_path == "scale")
+                {
+                    path = AnimationPath::Scale;
+                }
+                else if (channel.target_path == "weights")
+                {
+                    path = AnimationPath::Weights;
+                }
+                else
+                {
+                    continue;
+                }
+
+                const auto& sampler = animation.samplers[channel.sampler];
+
+                AnimationTrack track {};
+                track.target = static_cast<uint32_t>(hierarchy.gltfToFlat[channel.target_node]);
+                track.times  = ParseAnimationBuffer(model, model->gltfModel.accessors[sampler.input]);
+                track.values = ParseAnimationBuffer(model, model->gltfModel.accessors[sampler.output]);
+
+                if (track.times.empty())
+                {
+                    continue;
+                }
+
+                track.components = static_cast<uint32_t>(track.values.size() / track.times.size());
+
+                if (AnimationPath::Weights == path)
+                {
+                    auto node  = FindNode(model, channel.target_node);
+                    track.mesh = node ? node->mesh.get() : nullptr;
+                    if (!track.mesh)
+                    {
+                        continue;
+                    }
+                }
+
+                tempAnimation.duration = std::max(tempAnimation.duration, track.times.back());
+                tempAnimation.tracks[static_cast<size_t>(path)].emplace_back(std::move(track));
             }
+
+            model->animations.emplace_back(std::move(tempAnimation));
         }
+    }
+
+    void ParseNode(const std::unique_ptr<Model>& model, std::vector<std::unique_ptr<Node>>& nodes, int nodeIndex, Node* parent = nullptr)
+    {
+        const tinygltf::Node& node = model->gltfModel.nodes[nodeIndex];
+        model->attributes.infomation += std::format("  Node {} :\n", node.name);
+
+        auto tempNode    = std::make_unique<Node>();
+        tempNode->name   = node.name;
+        tempNode->index  = nodeIndex;
+        tempNode->parent = parent;
+
+        tempNode->transform = model->hierarchy.Add(node, nodeIndex, parent ? static_cast<int>(parent->transform) : -1);
 
         if (node.skin >= 0)
         {
@@ -3138,23 +3972,34 @@ private:
                 {
                     tempSkin->inverseBindMatrices.emplace_back(glm::make_mat4(std::get<4>(buffer).data() + i));
                 }
-
-                tempSkin->matrix = CreateStorageBuffer(
-                    std::get<0>(buffer), std::get<1>(buffer), m_context->descriptorSetLayouts.at("uniform_animation_skin")->descriptorSetLayout
-                );
             }
 
             tempSkin->joints = skin.joints;
             tempNode->skin   = std::move(tempSkin);
+
+            // 关节矩阵的环形缓冲需要容纳所有蒙皮
+            auto& palette       = m_context->jointPalette;
+            auto paletteSize    = static_cast<VkDeviceSize>(sizeof(glm::mat4) * skin.joints.size());
+            palette.frameSize   += palette.AlignedSize(paletteSize);
+            palette.maxSkinSize = std::max(palette.maxSkinSize, paletteSize);
         }
 
         if (node.mesh >= 0)
         {
-            tempNode->modelUniform =
-                CreateUniforms(GetNodeMatrix(tempNode.get()), m_context->descriptorSetLayouts.at("uniform_model")->descriptorSetLayout);
+            tempNode->modelUniform = CreateUniforms(
+                model->hierarchy.worldMatrices[tempNode->transform], m_context->descriptorSetLayouts.at("uniform_model")->descriptorSetLayout
+            );
 
             tempNode->mesh = std::make_unique<Mesh>();
             ParseMesh(model, tempNode->mesh, model->gltfModel.meshes[node.mesh]);
+
+            if (tempNode->skin)
+            {
+                for (const auto& primitive : tempNode->mesh->primitives)
+                {
+                    tempNode->skinnedInstances.emplace_back(CreateSkinningResources(model, tempNode, primitive));
+                }
+            }
         }
 
         if (node.camera >= 0)
@@ -3176,6 +4021,60 @@ private:
     /// @brief
     /// @param accessor
     /// @return dataPointer dataSize elementCount bufferInfo rawData->floatData
+    /// @brief 读取一个变形目标的位置增量，只保留不为 0 的顶点
+    /// @details gltf 的稀疏访问器没有 bufferView 时所有顶点默认为 0，只需要读取稀疏部分的索引和值
+    void ParseMorphDeltas(const std::unique_ptr<Model>& model, const tinygltf::Accessor& accessor, std::vector<MorphDelta>& morphDeltas)
+    {
+        std::vector<float> deltas(accessor.count * 3, 0.f);
+        if (accessor.bufferView >= 0)
+        {
+            deltas = std::get<4>(ParseBuffer(model, accessor));
+        }
+
+        if (accessor.sparse.isSparse)
+        {
+            const auto& sparse    = accessor.sparse;
+            const auto& indexView = model->gltfModel.bufferViews[sparse.indices.bufferView];
+            const auto& valueView = model->gltfModel.bufferViews[sparse.values.bufferView];
+            const auto indexPtr   = &model->gltfModel.buffers[indexView.buffer].data[indexView.byteOffset + sparse.indices.byteOffset];
+            const auto valuePtr   = reinterpret_cast<const float*>(
+                &model->gltfModel.buffers[valueView.buffer].data[valueView.byteOffset + sparse.values.byteOffset]
+            );
+
+            for (size_t i = 0; i < static_cast<size_t>(sparse.count); ++i)
+            {
+                size_t index {0};
+                switch (sparse.indices.componentType)
+                {
+                    case TINYGLTF_COMPONENT_TYPE_UNSIGNED_BYTE:
+                        index = indexPtr[i];
+                        break;
+                    case TINYGLTF_COMPONENT_TYPE_UNSIGNED_SHORT:
+                        index = reinterpret_cast<const uint16_t*>(indexPtr)[i];
+                        break;
+                    case TINYGLTF_COMPONENT_TYPE_UNSIGNED_INT:
+                        index = reinterpret_cast<const uint32_t*>(indexPtr)[i];
+                        break;
+                    default:
+                        break;
+                }
+
+                if (index < accessor.count)
+                {
+                    std::copy_n(valuePtr + i * 3, 3, deltas.begin() + static_cast<std::ptrdiff_t>(index * 3));
+                }
+            }
+        }
+
+        for (uint32_t i = 0; i * 3 + 2 < deltas.size(); ++i)
+        {
+            if (0.f != deltas[i * 3] || 0.f != deltas[i * 3 + 1] || 0.f != deltas[i * 3 + 2])
+            {
+                morphDeltas.emplace_back(i, deltas[i * 3], deltas[i * 3 + 1], deltas[i * 3 + 2]);
+            }
+        }
+    }
+
     std::tuple<const void*, size_t, uint32_t, std::string, std::vector<float>>
     ParseBuffer(const std::unique_ptr<Model>& model, const tinygltf::Accessor& accessor)
     {
@@ -3212,6 +4111,17 @@ private:
         fData.reserve(count);
         switch (accessor.componentType)
         {
+            case TINYGLTF_COMPONENT_TYPE_UNSIGNED_BYTE:
+            {
+                dataSize *= sizeof(unsigned char);
+
+                auto tempPtr = reinterpret_cast<unsigned char*>(dataPointer);
+                for (size_t i = 0; i < count; ++i)
+                {
+                    fData.emplace_back(static_cast<float>(*tempPtr++));
+                }
+            }
+            break;
             case TINYGLTF_COMPONENT_TYPE_UNSIGNED_SHORT:
             {
                 dataSize *= sizeof(unsigned short);
@@ -3255,8 +4165,10 @@ private:
         return std::make_tuple(dataPointer, count * sizeof(float), static_cast<uint32_t>(elementCount), bufferInfo, fData);
     }
 
-    std::string ParseImage(const std::unique_ptr<Model>& model, const tinygltf::Image& image)
+    std::string ParseImage(const std::unique_ptr<Model>& model, int index)
     {
+        const auto& image = model->gltfModel.images[index];
+
         std::unique_ptr<Image> tempImage {};
         std::string imageInfo {};
 
@@ -3313,7 +4225,24 @@ private:
 
             if (!model->images.contains(imageInfo))
             {
-                tempImage = CreateTextureImage(image.image.data(), dataSize, image.width, image.height, format);
+                if (auto& mips = model->imageMips[index]; STREAM_TEXTURES && !mips.empty())
+                {
+                    // 先上传低分辨率的 mip，更精细的 mip 由 UpdateTextureStreaming 按需上传
+                    tempImage           = std::make_unique<Image>();
+                    tempImage->format   = format;
+                    tempImage->width    = static_cast<uint32_t>(image.width);
+                    tempImage->height   = static_cast<uint32_t>(image.height);
+                    tempImage->mips     = std::move(mips);
+                    tempImage->streamId = m_textureStreamer.Add(tempImage->width, tempImage->height, 4, STREAM_INITIAL_SIZE);
+                    m_streamedImages.emplace_back(model.get(), imageInfo);
+
+                    auto residentMip = m_textureStreamer.GetResidentMip(tempImage->streamId.value());
+                    CreateStreamedImage(*tempImage, residentMip, tempImage->image, tempImage->imageView, tempImage->imageMemory);
+                }
+                else
+                {
+                    tempImage = CreateTextureImage(image.image.data(), dataSize, image.width, image.height, format);
+                }
             }
         }
         else
@@ -3321,8 +4250,12 @@ private:
             throw std::runtime_error("this image not supported");
         }
 
-        tempImage->name = image.name;
-        model->images.try_emplace(imageInfo, std::move(tempImage));
+        // 多个纹理使用同一个图像时只创建一次
+        if (tempImage)
+        {
+            tempImage->name = image.name;
+            model->images.try_emplace(imageInfo, std::move(tempImage));
+        }
 
         return imageInfo;
     }
@@ -3339,37 +4272,49 @@ private:
             model->attributes.infomation += std::format("      Primitive {} :\n", imguiPrimitive++);
             auto tempPrimitive = std::make_unique<Primitive>();
 
-            if (!gltfMesh.weights.empty())
-            {
-                std::array<float, 2> weights {static_cast<float>(gltfMesh.weights[0]), static_cast<float>(gltfMesh.weights[1])};
-                tempPrimitive->animationWeight =
-                    CreateUniforms(weights, m_context->descriptorSetLayouts.at("uniform_animation_morph")->descriptorSetLayout);
-            }
-
+            // 所有变形目标的位置增量只保存不为 0 的顶点，依次存放在一个缓冲中
+            std::vector<MorphDelta> morphDeltas {};
             for (const auto& target : primitive.targets)
             {
+                auto first = static_cast<uint32_t>(morphDeltas.size());
+
                 if (target.contains("POSITION"))
                 {
                     const auto& accessor = model->gltfModel.accessors[target.at("POSITION")];
-                    const auto& buffer   = ParseBuffer(model, accessor);
+                    ParseMorphDeltas(model, accessor, morphDeltas);
 
-                    model->attributes.infomation += std::format("        Target: Position : {}\n", std::get<2>(buffer));
+                    model->attributes.infomation +=
+                        std::format("        Target: Position : {} ({} non-zero)\n", accessor.count, morphDeltas.size() - first);
+                }
 
-                    if (!model->buffers.contains(std::get<3>(buffer)))
-                    {
-                        model->buffers.try_emplace(std::get<3>(buffer), CreateVertexBuffer(std::get<1>(buffer), std::get<0>(buffer)));
-                    }
+                tempPrimitive->morphTargets.emplace_back(first, static_cast<uint32_t>(morphDeltas.size()) - first);
+            }
 
-                    if (!tempPrimitive->morphPosition)
-                    {
-                        tempPrimitive->morphPosition = std::vector<std::string> {};
-                    }
+            if (!morphDeltas.empty())
+            {
+                auto deltaInfo = "morph ptr: " + std::to_string(reinterpret_cast<std::uintptr_t>(tempPrimitive.get()));
+                model->buffers.try_emplace(
+                    deltaInfo,
+                    CreateDrawableBuffer(sizeof(MorphDelta) * morphDeltas.size(), morphDeltas.data(), VK_BUFFER_USAGE_STORAGE_BUFFER_BIT)
+                );
 
-                    tempPrimitive->animationMode = AnimationMode::Morph;
-                    tempPrimitive->morphPosition.value().emplace_back(std::get<3>(buffer));
-                }
+                tempPrimitive->animationMode = AnimationMode::Morph;
+                tempPrimitive->morphDelta    = std::move(deltaInfo);
             }
 
+            // 蒙皮和变形的计算着色器读写 float 的位置，播放动画的图元不压缩；已经是整数格式的属性也保持原样
+            auto floatAttribute = [&model, &primitive](const std::string& name) {
+                return !primitive.attributes.contains(name)
+                    || TINYGLTF_COMPONENT_TYPE_FLOAT == model->gltfModel.accessors[primitive.attributes.at(name)].componentType;
+            };
+            tempPrimitive->packed = PACK_VERTICES && AnimationMode::None == tempPrimitive->animationMode
+                && !primitive.attributes.contains("JOINTS_0") && primitive.attributes.contains("POSITION") && floatAttribute("POSITION")
+                && floatAttribute("NORMAL") && floatAttribute("TEXCOORD_0");
+
+            // 流送纹理时用来计算图元的纹理坐标密度
+            std::vector<float> positions {};
+            std::vector<float> texCoords {};
+
             if (primitive.attributes.contains("POSITION"))
             {
                 const auto& accessor = model->gltfModel.accessors[primitive.attributes.at("POSITION")];
@@ -3377,14 +4322,48 @@ private:
 
                 model->attributes.infomation += std::format("        Position : {}\n", std::get<2>(buffer));
 
-                if (!model->buffers.contains(std::get<3>(buffer)))
+                // 没有 LOD 链的图元用 accessor 的包围盒估计包围球，有 LOD 链时使用 LodChain 中的包围球
+                if (3 == accessor.minValues.size() && 3 == accessor.maxValues.size())
+                {
+                    glm::vec3 lower(accessor.minValues[0], accessor.minValues[1], accessor.minValues[2]);
+                    glm::vec3 upper(accessor.maxValues[0], accessor.maxValues[1], accessor.maxValues[2]);
+                    tempPrimitive->boundingSphere = glm::vec4((lower + upper) * .5f, glm::length(upper - lower) * .5f);
+                }
+
+                if (STREAM_TEXTURES)
+                {
+                    positions = std::get<4>(buffer);
+                }
+
+                if (tempPrimitive->packed)
+                {
+                    auto packed     = VertexPacking::PackPositions(std::get<4>(buffer));
+                    auto packedInfo = "packed " + std::get<3>(buffer);
+
+                    tempPrimitive->dequantizeOffset = glm::vec4(packed.offset[0], packed.offset[1], packed.offset[2], 0.f);
+                    tempPrimitive->dequantizeScale  = glm::vec4(packed.scale[0], packed.scale[1], packed.scale[2], 1.f);
+
+                    if (!model->buffers.contains(packedInfo))
+                    {
+                        model->buffers.try_emplace(packedInfo, CreateVertexBuffer(packed.data.size() * sizeof(int16_t), packed.data.data()));
+                    }
+
+                    tempPrimitive->position = std::move(packedInfo);
+                }
+                else
                 {
-                    model->buffers.try_emplace(std::get<3>(buffer), CreateVertexBuffer(std::get<1>(buffer), std::get<0>(buffer)));
+                    if (!model->buffers.contains(std::get<3>(buffer)))
+                    {
+                        model->buffers.try_emplace(std::get<3>(buffer), CreateVertexBuffer(std::get<1>(buffer), std::get<0>(buffer)));
+                    }
+
+                    tempPrimitive->position = std::get<3>(buffer);
                 }
 
-                tempPrimitive->position = std::get<3>(buffer);
+                tempPrimitive->vertexCount = std::get<2>(buffer);
             }
 
+            // 关节和权重只在蒙皮的计算着色器中读取，总是压缩为 u8x4（关节较多时 u16x4）和 unorm8x4
             if (primitive.attributes.contains("JOINTS_0"))
             {
                 const auto& accessor = model->gltfModel.accessors[primitive.attributes.at("JOINTS_0")];
@@ -3392,31 +4371,43 @@ private:
 
                 model->attributes.infomation += std::format("        JOINTS_0 : {}\n", std::get<2>(buffer));
 
-                if (!model->buffers.contains(std::get<3>(buffer)))
+                auto packed     = VertexPacking::PackJoints(std::get<4>(buffer), tempPrimitive->jointSize);
+                auto packedInfo = "packed " + std::get<3>(buffer);
+                if (!model->buffers.contains(packedInfo) && !packed.empty())
                 {
-                    if (!std::get<4>(buffer).empty())
-                    {
-                        model->buffers.try_emplace(std::get<3>(buffer), CreateVertexBuffer(std::get<1>(buffer), std::get<4>(buffer).data()));
-                    }
+                    model->buffers.try_emplace(packedInfo, CreateVertexBuffer(packed.size(), packed.data()));
                 }
 
                 tempPrimitive->animationMode = AnimationMode::Skin;
-                tempPrimitive->joints        = std::get<3>(buffer);
+                tempPrimitive->joints        = std::move(packedInfo);
             }
 
             if (primitive.attributes.contains("WEIGHTS_0"))
             {
                 const auto& accessor = model->gltfModel.accessors[primitive.attributes.at("WEIGHTS_0")];
-                const auto& buffer   = ParseBuffer(model, accessor);
+                auto buffer          = ParseBuffer(model, accessor);
 
                 model->attributes.infomation += std::format("        WEIGHTS_0 : {}\n", std::get<2>(buffer));
 
-                if (!model->buffers.contains(std::get<3>(buffer)))
+                // 整数类型的权重是归一化的
+                auto& weights = std::get<4>(buffer);
+                if (TINYGLTF_COMPONENT_TYPE_UNSIGNED_BYTE == accessor.componentType)
                 {
-                    model->buffers.try_emplace(std::get<3>(buffer), CreateVertexBuffer(std::get<1>(buffer), std::get<0>(buffer)));
+                    std::ranges::for_each(weights, [](float& weight) { weight /= 255.f; });
+                }
+                else if (TINYGLTF_COMPONENT_TYPE_UNSIGNED_SHORT == accessor.componentType)
+                {
+                    std::ranges::for_each(weights, [](float& weight) { weight /= 65535.f; });
                 }
 
-                tempPrimitive->weights = std::get<3>(buffer);
+                auto packed     = VertexPacking::PackWeights(weights);
+                auto packedInfo = "packed " + std::get<3>(buffer);
+                if (!model->buffers.contains(packedInfo) && !packed.empty())
+                {
+                    model->buffers.try_emplace(packedInfo, CreateVertexBuffer(packed.size(), packed.data()));
+                }
+
+                tempPrimitive->weights = std::move(packedInfo);
             }
 
             if (primitive.attributes.contains("NORMAL"))
@@ -3426,12 +4417,26 @@ private:
 
                 model->attributes.infomation += std::format("        Normal : {}\n", std::get<2>(buffer));
 
-                if (!model->buffers.contains(std::get<3>(buffer)))
+                if (tempPrimitive->packed)
                 {
-                    model->buffers.try_emplace(std::get<3>(buffer), CreateVertexBuffer(std::get<1>(buffer), std::get<0>(buffer)));
+                    auto packedInfo = "packed " + std::get<3>(buffer);
+                    if (!model->buffers.contains(packedInfo))
+                    {
+                        auto packed = VertexPacking::PackNormals(std::get<4>(buffer));
+                        model->buffers.try_emplace(packedInfo, CreateVertexBuffer(packed.size() * sizeof(int16_t), packed.data()));
+                    }
+
+                    tempPrimitive->normal = std::move(packedInfo);
                 }
+                else
+                {
+                    if (!model->buffers.contains(std::get<3>(buffer)))
+                    {
+                        model->buffers.try_emplace(std::get<3>(buffer), CreateVertexBuffer(std::get<1>(buffer), std::get<0>(buffer)));
+                    }
 
-                tempPrimitive->normal = std::get<3>(buffer);
+                    tempPrimitive->normal = std::get<3>(buffer);
+                }
             }
 
             if (primitive.attributes.contains("TEXCOORD_0"))
@@ -3441,18 +4446,42 @@ private:
 
                 model->attributes.infomation += std::format("        TexCoord_0 : {}\n", std::get<2>(buffer));
 
-                if (!model->buffers.contains(std::get<3>(buffer)))
+                if (STREAM_TEXTURES && TINYGLTF_COMPONENT_TYPE_FLOAT == accessor.componentType)
                 {
-                    model->buffers.try_emplace(std::get<3>(buffer), CreateVertexBuffer(std::get<1>(buffer), std::get<0>(buffer)));
+                    texCoords = std::get<4>(buffer);
+                }
+
+                if (tempPrimitive->packed)
+                {
+                    auto packedInfo = "packed " + std::get<3>(buffer);
+                    if (!model->buffers.contains(packedInfo))
+                    {
+                        auto packed = VertexPacking::PackTexCoords(std::get<4>(buffer));
+                        model->buffers.try_emplace(packedInfo, CreateVertexBuffer(packed.size() * sizeof(uint16_t), packed.data()));
+                    }
+
+                    tempPrimitive->texCoord = std::move(packedInfo);
                 }
+                else
+                {
+                    if (!model->buffers.contains(std::get<3>(buffer)))
+                    {
+                        model->buffers.try_emplace(std::get<3>(buffer), CreateVertexBuffer(std::get<1>(buffer), std::get<0>(buffer)));
+                    }
 
-                tempPrimitive->texCoord = std::get<3>(buffer);
+                    tempPrimitive->texCoord = std::get<3>(buffer);
+                }
             }
 
             if (primitive.attributes.contains("TANGENT"))
             {
             }
 
+            if (AnimationMode::Morph == tempPrimitive->animationMode)
+            {
+                CreateMorphResources(model, tempPrimitive);
+            }
+
             if (primitive.indices >= 0)
             {
                 auto accessor    = model->gltfModel.accessors[primitive.indices];
@@ -3464,6 +4493,12 @@ private:
 
                 model->attributes.infomation += std::format("        Index : {}\n", accessor.count);
 
+                if (!positions.empty() && positions.size() / 3 == texCoords.size() / 2 && TINYGLTF_MODE_TRIANGLES == primitive.mode)
+                {
+                    auto indices             = ReadTriangleIndices(model->gltfModel, accessor, positions.size() / 3);
+                    tempPrimitive->uvDensity = TextureStreamer::ComputeUvDensity(positions, texCoords, indices);
+                }
+
                 if (TINYGLTF_TARGET_ELEMENT_ARRAY_BUFFER != bufferView.target)
                 {
                     throw std::runtime_error("Only supports vkCmdDrawIndexed");
@@ -3488,7 +4523,37 @@ private:
                 }
 
                 auto bufferInfo = "ptr: " + std::to_string(reinterpret_cast<std::uintptr_t>(dataPointer)) + "\tsize: " + std::to_string(bufferSize);
-                if (!model->buffers.contains(bufferInfo))
+
+                // 有 LOD 链的静态图元使用包含所有级别的索引缓冲，索引的类型和 gltf 中相同
+                if (auto chain = model->lodChains.find(primitive.indices);
+                    chain != model->lodChains.end() && AnimationMode::None == tempPrimitive->animationMode)
+                {
+                    tempPrimitive->lods           = chain->second.levels;
+                    tempPrimitive->boundingSphere = chain->second.boundingSphere;
+
+                    model->attributes.infomation += std::format("        Lod : {}\n", tempPrimitive->lods.size());
+                    for (const auto& lod : tempPrimitive->lods)
+                    {
+                        model->attributes.infomation += std::format("            {} triangles, error {:.5f}\n", lod.indexCount / 3, lod.error);
+                    }
+
+                    bufferInfo = "lod " + bufferInfo;
+                    if (!model->buffers.contains(bufferInfo))
+                    {
+                        const auto& indices = chain->second.indices;
+                        if (VK_INDEX_TYPE_UINT32 == tempPrimitive->indexType)
+                        {
+                            model->buffers.try_emplace(bufferInfo, CreateIndexBuffer(indices.size() * sizeof(uint32_t), indices.data()));
+                        }
+                        else
+                        {
+                            std::vector<uint16_t> shortIndices(indices.size());
+                            std::ranges::transform(indices, shortIndices.begin(), [](uint32_t index) { return static_cast<uint16_t>(index); });
+                            model->buffers.try_emplace(bufferInfo, CreateIndexBuffer(shortIndices.size() * sizeof(uint16_t), shortIndices.data()));
+                        }
+                    }
+                }
+                else if (!model->buffers.contains(bufferInfo))
                 {
                     model->buffers.try_emplace(bufferInfo, CreateIndexBuffer(bufferSize, dataPointer));
                 }
@@ -3533,8 +4598,7 @@ private:
 
                     if (texture.source >= 0)
                     {
-                        const auto& image  = model->gltfModel.images[texture.source];
-                        tempTexture->image = ParseImage(model, image);
+                        tempTexture->image = ParseImage(model, texture.source);
                     }
 
                     // if (texture.sampler >= 0)
@@ -3570,8 +4634,7 @@ private:
 
                     if (texture.source >= 0)
                     {
-                        const auto& image  = model->gltfModel.images[texture.source];
-                        tempTexture->image = ParseImage(model, image);
+                        tempTexture->image = ParseImage(model, texture.source);
                     }
 
                     // if (texture.sampler >= 0)
@@ -3609,14 +4672,29 @@ private:
 
             mesh->primitives.emplace_back(std::move(tempPrimitive));
         }
+
+        // 没有动画时使用 gltf 中的默认权重
+        size_t targetCount {0};
+        for (const auto& primitive : mesh->primitives)
+        {
+            targetCount = std::max(targetCount, primitive->morphTargets.size());
+        }
+
+        mesh->weights.resize(targetCount, 0.f);
+        for (size_t i = 0; i < std::min(targetCount, gltfMesh.weights.size()); ++i)
+        {
+            mesh->weights[i] = static_cast<float>(gltfMesh.weights[i]);
+        }
     }
 
     void DrawNode(const std::unique_ptr<Model>& model, const VkCommandBuffer commandBuffer, const std::unique_ptr<Node>& node) const
     {
         if (node->mesh)
         {
-            for (const auto& primitive : node->mesh->primitives)
+            for (size_t primitiveIndex = 0; primitiveIndex < node->mesh->primitives.size(); ++primitiveIndex)
             {
+                const auto& primitive = node->mesh->primitives[primitiveIndex];
+
                 std::vector<VkBuffer> vertexBuffers {model->buffers.at(primitive->position)->buffer};
                 std::vector<VkDeviceSize> offsets {0};
 
@@ -3624,6 +4702,13 @@ private:
                 VkPipelineLayout pipelineLayout {};
                 VkPipeline pipeline {};
 
+                // 顶点属性压缩的图元使用对应的 *_Q 管线
+                auto selectPipeline = [this, &primitive, &pipeline, &pipelineLayout](PipelineType pipelineType) {
+                    const auto& selected = m_context->pipelines.at(primitive->packed ? ToPackedPipeline(pipelineType) : pipelineType);
+                    pipeline             = selected->pipeline;
+                    pipelineLayout       = selected->pipelineLayout;
+                };
+
                 switch (primitive->lightingMode)
                 {
                     case LightingMode::None:
@@ -3631,50 +4716,29 @@ private:
                         {
                             case ColoringMode::DirectRGB:
                             {
-                                if (AnimationMode::Morph == primitive->animationMode && model->attributes.animation)
-                                {
-                                    pipeline       = m_context->pipelines.at(PipelineType::DC_NL_AW2)->pipeline;
-                                    pipelineLayout = m_context->pipelines.at(PipelineType::DC_NL_AW2)->pipelineLayout;
-
-                                    descriptorSets.emplace_back(primitive->animationWeight.value()->descriptorSets->descriptorSets[m_currentFrame]);
-
-                                    auto& baseColor = primitive->material->pbrMetallicRoughness->baseColorFactor.value();
-                                    descriptorSets.emplace_back(baseColor->descriptorSets->descriptorSets[m_currentFrame]);
-
-                                    vertexBuffers.emplace_back(model->buffers.at(primitive->morphPosition.value()[0])->buffer);
-                                    vertexBuffers.emplace_back(model->buffers.at(primitive->morphPosition.value()[1])->buffer);
-                                    offsets.emplace_back(0);
-                                    offsets.emplace_back(0);
-                                }
-                                else if (AnimationMode::Skin == primitive->animationMode && model->attributes.animation)
-                                {
-                                    pipeline       = m_context->pipelines.at(PipelineType::DC_NL_AS2)->pipeline;
-                                    pipelineLayout = m_context->pipelines.at(PipelineType::DC_NL_AS2)->pipelineLayout;
+                                selectPipeline(PipelineType::DC_NL);
 
-                                    descriptorSets.emplace_back(node->skin->matrix->descriptorSets->descriptorSets[m_currentFrame]);
-
-                                    auto& baseColor = primitive->material->pbrMetallicRoughness->baseColorFactor.value();
-                                    descriptorSets.emplace_back(baseColor->descriptorSets->descriptorSets[m_currentFrame]);
+                                auto& baseColor = primitive->material->pbrMetallicRoughness->baseColorFactor.value();
+                                descriptorSets.emplace_back(baseColor->descriptorSets->descriptorSets[m_currentFrame]);
 
-                                    vertexBuffers.emplace_back(model->buffers.at(primitive->weights.value())->buffer);
-                                    vertexBuffers.emplace_back(model->buffers.at(primitive->joints.value())->buffer);
-                                    offsets.emplace_back(0);
-                                    offsets.emplace_back(0);
-                                }
-                                else
+                                // RecordVertexAnimation 已经在计算着色器中完成蒙皮或者变形，之后和静态模型一样绘制
+                                if (model->attributes.animation && !model->animations.empty())
                                 {
-                                    pipeline       = m_context->pipelines.at(PipelineType::DC_NL)->pipeline;
-                                    pipelineLayout = m_context->pipelines.at(PipelineType::DC_NL)->pipelineLayout;
-
-                                    auto& baseColor = primitive->material->pbrMetallicRoughness->baseColorFactor.value();
-                                    descriptorSets.emplace_back(baseColor->descriptorSets->descriptorSets[m_currentFrame]);
+                                    if (AnimationMode::Skin == primitive->animationMode && m_context->jointPalette.descriptorSet
+                                        && primitiveIndex < node->skinnedInstances.size() && node->skinnedInstances[primitiveIndex].descriptorSet)
+                                    {
+                                        vertexBuffers.front() = model->buffers.at(node->skinnedInstances[primitiveIndex].position)->buffer;
+                                    }
+                                    else if (AnimationMode::Morph == primitive->animationMode && primitive->morphedPosition)
+                                    {
+                                        vertexBuffers.front() = model->buffers.at(primitive->morphedPosition.value())->buffer;
+                                    }
                                 }
                             }
                             break;
                             case ColoringMode::TextureMapping:
                             {
-                                pipeline       = m_context->pipelines.at(PipelineType::TC_NL)->pipeline;
-                                pipelineLayout = m_context->pipelines.at(PipelineType::TC_NL)->pipelineLayout;
+                                selectPipeline(PipelineType::TC_NL);
 
                                 auto& baseTexture = primitive->material->pbrMetallicRoughness->baseColorTexture.value();
                                 auto& texture     = model->textures.at(baseTexture);
@@ -3696,8 +4760,7 @@ private:
                                 vertexBuffers.emplace_back(model->buffers.at(primitive->normal.value())->buffer);
                                 offsets.emplace_back(0);
 
-                                pipeline       = m_context->pipelines.at(PipelineType::DC_PL)->pipeline;
-                                pipelineLayout = m_context->pipelines.at(PipelineType::DC_PL)->pipelineLayout;
+                                selectPipeline(PipelineType::DC_PL);
 
                                 auto& rmFactor = primitive->material->pbrMetallicRoughness->roughnessMetallicFactor.value();
                                 descriptorSets.emplace_back(rmFactor->descriptorSets->descriptorSets[m_currentFrame]);
@@ -3713,8 +4776,7 @@ private:
                                 offsets.emplace_back(0);
                                 offsets.emplace_back(0);
 
-                                pipeline       = m_context->pipelines.at(PipelineType::TC_PL)->pipeline;
-                                pipelineLayout = m_context->pipelines.at(PipelineType::TC_PL)->pipelineLayout;
+                                selectPipeline(PipelineType::TC_PL);
 
                                 auto& rmFactor = primitive->material->pbrMetallicRoughness->roughnessMetallicFactor.value();
                                 descriptorSets.emplace_back(rmFactor->descriptorSets->descriptorSets[m_currentFrame]);
@@ -3745,154 +4807,458 @@ private:
                     nullptr
                 );
 
-                auto aspect = static_cast<float>(m_swapChainExtent.width) / static_cast<float>(m_swapChainExtent.height);
-
-                PushConstantVP pc {
-                    .view = glm::lookAt(m_eyePos, m_lookAt, m_viewUp),
-                    .proj = glm::perspective(glm::radians(45.f), aspect, 0.1f, 100.f),
-                };
-                pc.proj[1][1] *= -1;
+                auto pc = GetViewProjection();
                 vkCmdPushConstants(commandBuffer, pipelineLayout, VK_SHADER_STAGE_VERTEX_BIT, 0, sizeof(PushConstantVP), &pc);
 
-                if (LightingMode::None != primitive->lightingMode)
+                PushConstantDequantize pcDequantize {.offset = primitive->dequantizeOffset, .scale = primitive->dequantizeScale};
+                vkCmdPushConstants(
+                    commandBuffer,
+                    pipelineLayout,
+                    VK_SHADER_STAGE_VERTEX_BIT,
+                    sizeof(PushConstantVP) + sizeof(PushConstantCamPos),
+                    sizeof(PushConstantDequantize),
+                    &pcDequantize
+                );
+
+                if (LightingMode::None != primitive->lightingMode)
+                {
+                    PushConstantCamPos pcCamPos {.position = m_eyePos};
+                    vkCmdPushConstants(
+                        commandBuffer, pipelineLayout, VK_SHADER_STAGE_FRAGMENT_BIT, sizeof(PushConstantVP), sizeof(PushConstantCamPos), &pcCamPos
+                    );
+                }
+
+                auto lod = SelectLod(*primitive, model->hierarchy.worldMatrices[node->transform], pc.view, pc.proj);
+
+                vkCmdBindVertexBuffers(commandBuffer, 0, static_cast<uint32_t>(vertexBuffers.size()), vertexBuffers.data(), offsets.data());
+                vkCmdBindIndexBuffer(commandBuffer, model->buffers.at(primitive->index)->buffer, 0, primitive->indexType);
+                vkCmdDrawIndexed(commandBuffer, lod.indexCount, 1, lod.firstIndex, 0, 0);
+            }
+        }
+
+        for (const auto& child : node->children)
+        {
+            DrawNode(model, commandBuffer, child);
+        }
+    }
+
+    /// @brief 绘制和纹理流送使用相同的相机
+    PushConstantVP GetViewProjection() const noexcept
+    {
+        auto aspect = static_cast<float>(m_swapChainExtent.width) / static_cast<float>(m_swapChainExtent.height);
+
+        PushConstantVP pc {
+            .view = glm::lookAt(m_eyePos, m_lookAt, m_viewUp),
+            .proj = glm::perspective(glm::radians(45.f), aspect, 0.1f, 100.f),
+        };
+        pc.proj[1][1] *= -1;
+
+        return pc;
+    }
+
+    /// @brief 把每一级的几何误差投影到屏幕上，选择误差不超过 LOD_PIXEL_ERROR 像素的最简单的一级
+    /// @details 使用包围球上离相机最近的点的距离，相机在包围球内部时总是绘制原始网格
+    PrimitiveLod SelectLod(const Primitive& primitive, const glm::mat4& world, const glm::mat4& view, const glm::mat4& proj) const noexcept
+    {
+        if (primitive.lods.empty())
+        {
+            return PrimitiveLod {0, primitive.indexCount, 0.f};
+        }
+
+        auto pixelsPerUnit = ComputePixelsPerUnit(primitive, world, view, proj);
+        if (!pixelsPerUnit)
+        {
+            return primitive.lods.front();
+        }
+
+        for (auto lod = primitive.lods.rbegin(); lod != primitive.lods.rend(); ++lod)
+        {
+            if (lod->error * pixelsPerUnit.value() <= LOD_PIXEL_ERROR)
+            {
+                return *lod;
+            }
+        }
+
+        return primitive.lods.front();
+    }
+
+    /// @brief 包围球上离相机最近的点处，模型空间的一个单位在屏幕上的像素个数，相机在包围球内部时返回空
+    std::optional<float>
+    ComputePixelsPerUnit(const Primitive& primitive, const glm::mat4& world, const glm::mat4& view, const glm::mat4& proj) const noexcept
+    {
+        auto scale  = std::max({glm::length(glm::vec3(world[0])), glm::length(glm::vec3(world[1])), glm::length(glm::vec3(world[2]))});
+        auto center = view * world * glm::vec4(glm::vec3(primitive.boundingSphere), 1.f);
+        auto depth  = -center.z - primitive.boundingSphere.w * scale;
+        if (depth <= 0.f)
+        {
+            return std::nullopt;
+        }
+
+        return std::abs(proj[1][1]) * static_cast<float>(m_swapChainExtent.height) * .5f * scale / depth;
+    }
+
+    /// @brief 只在加载时使用
+    Node* FindNode(const std::unique_ptr<Model>& model, int index) const noexcept
+    {
+        std::vector<Node*> stack {};
+        for (const auto& scene : model->scenes)
+        {
+            for (const auto& node : scene->nodes)
+            {
+                stack.emplace_back(node.get());
+            }
+        }
+
+        while (!stack.empty())
+        {
+            auto node = stack.back();
+            stack.pop_back();
+
+            if (node->index == index)
+            {
+                return node;
+            }
+
+            for (const auto& child : node->children)
+            {
+                stack.emplace_back(child.get());
+            }
+        }
+
+        return nullptr;
+    }
+
+    void UpdateNodeJoint(const std::unique_ptr<Model>& model, const std::unique_ptr<Node>& node) const
+    {
+        if (node->skin)
+        {
+            const auto& hierarchy = model->hierarchy;
+
+            auto& joints              = node->skin->joints;
+            auto& inverseBindMatrices = node->skin->inverseBindMatrices;
+            std::vector<glm::mat4> jointMatrices(joints.size(), glm::mat4(1.f));
+            auto inverseTransform = glm::inverse(hierarchy.worldMatrices[node->transform]);
+
+            for (size_t i = 0; i < joints.size(); ++i)
+            {
+                // 关节可能是无效的索引，或者不在任何场景中（gltfToFlat 为 -1），这样的关节保持单位矩阵
+                if (joints[i] < 0 || joints[i] >= static_cast<int>(hierarchy.gltfToFlat.size()) || hierarchy.gltfToFlat[joints[i]] < 0)
                 {
-                    PushConstantCamPos pcCamPos {.position = m_eyePos};
-                    vkCmdPushConstants(
-                        commandBuffer, pipelineLayout, VK_SHADER_STAGE_FRAGMENT_BIT, sizeof(PushConstantVP), sizeof(PushConstantCamPos), &pcCamPos
-                    );
+                    continue;
                 }
 
-                vkCmdBindVertexBuffers(commandBuffer, 0, static_cast<uint32_t>(vertexBuffers.size()), vertexBuffers.data(), offsets.data());
-                vkCmdBindIndexBuffer(commandBuffer, model->buffers.at(primitive->index)->buffer, 0, primitive->indexType);
-                vkCmdDrawIndexed(commandBuffer, primitive->indexCount, 1, 0, 0, 0);
+                // 最初的实现按 (i + 1) % 2 取逆绑定矩阵，只适用于示例中两个关节的模型，这里保留原来的行为，只检查越界
+                auto bindIndex   = (i + 1) % 2;
+                auto inverseBind = bindIndex < inverseBindMatrices.size() ? inverseBindMatrices[bindIndex] : glm::mat4(1.f);
+
+                auto jointMatrix = hierarchy.worldMatrices[hierarchy.gltfToFlat[joints[i]]];
+                jointMatrices[i] = inverseTransform * jointMatrix * inverseBind;
+            }
+
+            auto offset = m_context->jointPalette.Allocate(m_currentFrame, jointMatrices.data(), sizeof(glm::mat4) * jointMatrices.size());
+            if (offset)
+            {
+                node->skin->paletteOffset = offset.value();
             }
         }
 
         for (const auto& child : node->children)
         {
-            DrawNode(model, commandBuffer, child);
+            UpdateNodeJoint(model, child);
         }
     }
 
-    glm::mat4 GetNodeMatrix(Node* node) const
+    /// @brief 只把世界矩阵改变过的节点写入模型矩阵的 uniform
+    /// @details 行为变化：以前模型矩阵只在加载时写入一次，节点的平移/旋转/缩放动画不会移动网格（只有蒙皮动画可见）
+    ///          现在每一帧在 UpdateAnimations 之后调用，带有节点 TRS 动画的模型中网格会跟着节点移动
+    ///          每一帧有自己的 uniform 缓冲，矩阵改变之后接下来的 MAX_FRAMES_IN_FLIGHT 帧依次写入各自的缓冲，动画暂停之后也会写完
+    void UpdateModelUniforms() const
     {
-        auto matrix = node->GetLocalMatrix();
-        auto parent = node->parent;
-        while (parent)
+        for (const auto& [_, model] : m_models)
         {
-            matrix = GetNodeMatrix(parent) * matrix;
-            parent = parent->parent;
+            if (!model)
+            {
+                continue;
+            }
+
+            for (const auto& scene : model->scenes)
+            {
+                for (const auto& node : scene->nodes)
+                {
+                    UpdateNodeUniform(model, node);
+                }
+            }
+
+            std::ranges::fill(model->hierarchy.changed, uint8_t {0});
         }
-        return matrix;
     }
 
-    Node* FindNodeForIndex(int index, Node* node) const
+    void UpdateNodeUniform(const std::unique_ptr<Model>& model, const std::unique_ptr<Node>& node) const
     {
-        if (node->index == index)
+        if (node->modelUniform)
         {
-            return node;
+            const auto& hierarchy = model->hierarchy;
+            if (hierarchy.changed[node->transform])
+            {
+                node->staleUniformFrames = MAX_FRAMES_IN_FLIGHT;
+            }
+
+            if (node->staleUniformFrames > 0)
+            {
+                node->modelUniform->UpdateUniform(m_currentFrame, &hierarchy.worldMatrices[node->transform], sizeof(glm::mat4));
+                --node->staleUniformFrames;
+            }
         }
 
         for (const auto& child : node->children)
         {
-            return FindNodeForIndex(index, child.get());
+            UpdateNodeUniform(model, child);
         }
+    }
 
-        return nullptr;
+    /// @brief 返回满足 times[i] <= t < times[i + 1] 的 i，先检查上一次的位置和下一个位置，都不满足时再二分查找
+    static size_t FindKeyframe(const std::vector<float>& times, float t, size_t& cursor) noexcept
+    {
+        if (times.size() < 2)
+        {
+            return 0;
+        }
+
+        auto last = times.size() - 2;
+        if (cursor <= last && times[cursor] <= t)
+        {
+            if (t < times[cursor + 1])
+            {
+                return cursor;
+            }
+            if (cursor + 1 <= last && t < times[cursor + 2])
+            {
+                return ++cursor;
+            }
+        }
+
+        auto upper = static_cast<size_t>(std::upper_bound(times.begin(), times.end(), t) - times.begin());
+        cursor     = std::min(upper > 0 ? upper - 1 : 0, last);
+        return cursor;
     }
 
-    void UpdateNodeJoint(const std::unique_ptr<Scene>& scene, const std::unique_ptr<Node>& node) const
+    /// @brief 返回前一个关键帧的索引，以及和后一个关键帧之间的插值系数
+    static std::pair<size_t, float> SampleTrack(AnimationTrack& track, float t) noexcept
     {
-        if (node->skin)
+        auto i = FindKeyframe(track.times, t, track.cursor);
+        if (i + 1 >= track.times.size())
         {
-            auto& joints = node->skin->joints;
-            std::vector<glm::mat4> jointMatrices(joints.size());
-            auto inverseTransform = glm::inverse(GetNodeMatrix(node.get()));
+            return {i, 0.f};
+        }
 
-            for (size_t i = 0; i < joints.size(); ++i)
+        auto a = (t - track.times[i]) / (track.times[i + 1] - track.times[i]);
+        return {i, std::clamp(a, 0.f, 1.f)};
+    }
+
+    /// @brief 按照类型批量计算所有通道，把结果写入 NodeHierarchy 和变形权重的 uniform
+    void UpdateAnimation(const std::unique_ptr<Model>& model, Animation& animation, double time) const noexcept
+    {
+        auto& hierarchy = model->hierarchy;
+        auto t          = animation.duration > 0.f ? static_cast<float>(std::fmod(time, animation.duration)) : 0.f;
+
+        for (auto& track : animation.tracks[static_cast<size_t>(AnimationPath::Translation)])
+        {
+            auto [i, a] = SampleTrack(track, t);
+            auto j      = std::min(i + 1, track.times.size() - 1);
+            hierarchy.SetTranslation(track.target, glm::mix(glm::make_vec3(&track.values[i * 3]), glm::make_vec3(&track.values[j * 3]), a));
+        }
+
+        for (auto& track : animation.tracks[static_cast<size_t>(AnimationPath::Scale)])
+        {
+            auto [i, a] = SampleTrack(track, t);
+            auto j      = std::min(i + 1, track.times.size() - 1);
+            hierarchy.SetScale(track.target, glm::mix(glm::make_vec3(&track.values[i * 3]), glm::make_vec3(&track.values[j * 3]), a));
+        }
+
+        for (auto& track : animation.tracks[static_cast<size_t>(AnimationPath::Rotation)])
+        {
+            auto [i, a] = SampleTrack(track, t);
+            auto j      = std::min(i + 1, track.times.size() - 1);
+            hierarchy.SetRotation(
+                track.target, glm::normalize(glm::slerp(glm::make_quat(&track.values[i * 4]), glm::make_quat(&track.values[j * 4]), a))
+            );
+        }
+
+        // 变形
+        for (auto& track : animation.tracks[static_cast<size_t>(AnimationPath::Weights)])
+        {
+            auto [i, a] = SampleTrack(track, t);
+            auto j      = std::min(i + 1, track.times.size() - 1);
+
+            auto& weights = track.mesh->weights;
+            for (uint32_t k = 0; k < std::min<size_t>(track.components, weights.size()); ++k)
             {
-                auto tempNode    = FindNodeForIndex(joints[i], node.get());
-                jointMatrices[i] = GetNodeMatrix(tempNode) * node->skin->inverseBindMatrices[(i + 1) % 2];
-                jointMatrices[i] = inverseTransform * jointMatrices[i];
+                weights[k] = std::lerp(track.values[i * track.components + k], track.values[j * track.components + k], a);
             }
+        }
+    }
 
-            node->skin->matrix->UpdateUniform(m_currentFrame, jointMatrices.data(), sizeof(glm::mat4) * jointMatrices.size());
+    /// @brief 更新一个模型的所有动画、节点的世界矩阵以及蒙皮的关节矩阵
+    void UpdateModelAnimation(const std::unique_ptr<Model>& model, double time) const noexcept
+    {
+        for (auto& animation : model->animations)
+        {
+            UpdateAnimation(model, animation, time);
+        }
+
+        // 动画会修改节点的 TRS，所有节点的世界矩阵更新之后蒙皮才能构造 GLSL 中使用的数据
+        model->hierarchy.Update();
+
+        for (const auto& scene : model->scenes)
+        {
+            for (const auto& node : scene->nodes)
+            {
+                UpdateNodeJoint(model, node);
+            }
         }
     }
 
-    void UpdateNodeAnimation(const std::unique_ptr<Model>& model, const std::unique_ptr<Node>& node) const noexcept
+    /// @brief 播放动画的模型分成固定个数的块，由动画线程池和当前线程一起更新，模型之间没有共享的数据
+    void UpdateAnimations()
     {
-        for (const auto& animation : model->animations)
+        std::vector<const std::unique_ptr<Model>*> models {};
+        for (const auto& [_, model] : m_models)
         {
-            for (const auto& channel : animation->channels)
+            if (model && model->attributes.visibility && model->attributes.animation && !model->animations.empty())
             {
-                auto tempNode = FindNodeForIndex(channel->node, node.get());
+                models.emplace_back(&model);
+            }
+        }
 
-                const auto& input  = animation->samplers[channel->sampler]->input;
-                const auto& output = animation->samplers[channel->sampler]->output;
+        if (models.empty())
+        {
+            return;
+        }
 
-                auto time = glfwGetTime() - model->attributes.animationStartTime;
-                auto t    = static_cast<float>(std::fmod(time, input.back() - input.front()));
+        auto now = glfwGetTime();
 
-                // 蒙皮
-                if (tempNode && channel->path == "rotation" && tempNode->matrices.contains("rotation"))
-                {
-                    for (size_t i = 1; i < input.size(); ++i)
-                    {
-                        if (input[i] > t)
-                        {
-                            auto q1 = glm::make_quat(output.data() + (i - 1) * 4);
-                            auto q2 = glm::make_quat(output.data() + i * 4);
+        m_context->jointPalette.head.store(0, std::memory_order_relaxed);
 
-                            auto a = (t - input[i - 1]) / (input[i] - input[i - 1]);
+        // 第 chunk 块包含下标为 chunk、chunk + chunkCount ... 的模型
+        auto chunkCount = std::min<size_t>(models.size(), m_animationPool.GetThreadCount() + 1);
+        auto update     = [this, &models, chunkCount, now](size_t chunk) {
+            for (auto i = chunk; i < models.size(); i += chunkCount)
+            {
+                UpdateModelAnimation(*models[i], now - (*models[i])->attributes.animationStartTime);
+            }
+        };
 
-                            tempNode->matrices["rotation"] = glm::toMat4(glm::normalize(glm::slerp(q1, q2, a)));
-                            break;
-                        }
-                    }
-                }
+        std::vector<std::future<void>> chunks {};
 
-                if (tempNode && channel->path == "translation" && tempNode->matrices.contains("translation"))
-                {
-                    for (size_t i = 1; i < input.size(); ++i)
-                    {
-                        if (input[i] > t)
-                        {
-                            auto t1 = glm::make_vec3(output.data() + (i - 1) * 3);
-                            auto t2 = glm::make_vec3(output.data() + i * 3);
+        // 任务引用了局部的 update，线程池的 future 析构时不会等待，提交或者第一块抛出异常时也要等待所有任务完成
+        auto waitChunks = [&chunks]() {
+            for (const auto& chunk : chunks)
+            {
+                chunk.wait();
+            }
+        };
 
-                            auto a = (t - input[i - 1]) / (input[i] - input[i - 1]);
+        try
+        {
+            for (size_t i = 1; i < chunkCount; ++i)
+            {
+                chunks.emplace_back(m_animationPool.Submit([&update, i]() { update(i); }));
+            }
 
-                            auto translation = glm::mix(t1, t2, a);
+            // 第一块在当前线程更新
+            update(0);
+        }
+        catch (...)
+        {
+            waitChunks();
+            throw;
+        }
 
-                            tempNode->matrices["translation"] = glm::translate(glm::mat4(1.f), translation);
-                            break;
-                        }
-                    }
-                }
+        for (auto& chunk : chunks)
+        {
+            chunk.get();
+        }
+    }
+
+    /// @brief 在渲染流程之前对所有播放动画的蒙皮、变形执行计算着色器，之后的绘制使用 SkinnedInstance::position 或者 Primitive::morphedPosition
+    void RecordVertexAnimation(const VkCommandBuffer commandBuffer) const noexcept
+    {
+        std::vector<std::pair<const Node*, size_t>> skins {};
+        std::vector<std::tuple<const Model*, const Mesh*, const Primitive*>> morphs {};
+        for (const auto& [_, model] : m_models)
+        {
+            // 和 UpdateAnimations 的条件一致，只有这些模型的关节矩阵、变形权重在这一帧写入
+            if (!model || !model->attributes.visibility || !model->attributes.animation || model->animations.empty())
+            {
+                continue;
+            }
 
-                // 变形
-                if (!node->skin && node->mesh)
+            for (const auto& scene : model->scenes)
+            {
+                for (const auto& node : scene->nodes)
                 {
-                    float weights[2] {};
-                    for (size_t i = 1; i < input.size(); ++i)
-                    {
-                        if (input[i] > t)
-                        {
-                            weights[0] = static_cast<float>(
-                                output[(i - 1) * 2] + (t - input[i - 1]) / (input[i] - input[i - 1]) * (output[i * 2] - output[(i - 1) * 2])
-                            );
-                            weights[1] = static_cast<float>(
-                                output[(i - 1) * 2 + 1]
-                                + (t - input[i - 1]) / (input[i] - input[i - 1]) * (output[i * 2 + 1] - output[(i - 1) * 2 + 1])
-                            );
-                            break;
-                        }
-                    }
+                    CollectAnimatedPrimitives(model, node, skins, morphs);
+                }
+            }
+        }
 
-                    for (const auto& primitive : node->mesh->primitives)
+        if (skins.empty() && morphs.empty())
+        {
+            return;
+        }
+
+        // 上一帧对输出的读取完成之后才能覆盖（所有帧共用一个输出缓冲，只需要执行依赖）
+        vkCmdPipelineBarrier(
+            commandBuffer,
+            VK_PIPELINE_STAGE_VERTEX_INPUT_BIT,
+            VK_PIPELINE_STAGE_COMPUTE_SHADER_BIT | VK_PIPELINE_STAGE_TRANSFER_BIT,
+            0,
+            0,
+            nullptr,
+            0,
+            nullptr,
+            0,
+            nullptr
+        );
+
+        DispatchSkinning(commandBuffer, skins);
+        DispatchMorph(commandBuffer, morphs);
+
+        // 蒙皮、变形的结果作为顶点属性读取
+        VkMemoryBarrier barrier = {};
+        barrier.sType           = VK_STRUCTURE_TYPE_MEMORY_BARRIER;
+        barrier.srcAccessMask   = VK_ACCESS_SHADER_WRITE_BIT;
+        barrier.dstAccessMask   = VK_ACCESS_VERTEX_ATTRIBUTE_READ_BIT;
+
+        vkCmdPipelineBarrier(
+            commandBuffer, VK_PIPELINE_STAGE_COMPUTE_SHADER_BIT, VK_PIPELINE_STAGE_VERTEX_INPUT_BIT, 0, 1, &barrier, 0, nullptr, 0, nullptr
+        );
+    }
+
+    void CollectAnimatedPrimitives(
+        const std::unique_ptr<Model>& model,
+        const std::unique_ptr<Node>& node,
+        std::vector<std::pair<const Node*, size_t>>& skins,
+        std::vector<std::tuple<const Model*, const Mesh*, const Primitive*>>& morphs
+    ) const noexcept
+    {
+        if (node->mesh)
+        {
+            for (size_t i = 0; i < node->mesh->primitives.size(); ++i)
+            {
+                const auto& primitive = node->mesh->primitives[i];
+                if (AnimationMode::Skin == primitive->animationMode && node->skin && i < node->skinnedInstances.size()
+                    && node->skinnedInstances[i].descriptorSet && m_context->jointPalette.descriptorSet)
+                {
+                    skins.emplace_back(node.get(), i);
+                }
+                else if (AnimationMode::Morph == primitive->animationMode && primitive->morphDescriptorSet)
+                {
+                    // 多个节点引用同一个网格时变形的结果相同，只执行一次
+                    auto recorded = std::ranges::any_of(morphs, [&primitive](const auto& morph) { return std::get<2>(morph) == primitive.get(); });
+                    if (!recorded)
                     {
-                        primitive->animationWeight.value()->UpdateUniform(m_currentFrame, weights, sizeof(float) * 2);
+                        morphs.emplace_back(model.get(), node->mesh.get(), primitive.get());
                     }
                 }
             }
@@ -3900,25 +5266,147 @@ private:
 
         for (const auto& child : node->children)
         {
-            UpdateNodeAnimation(model, child);
+            CollectAnimatedPrimitives(model, child, skins, morphs);
         }
     }
 
-    void DrawGLTFModel(const std::unique_ptr<Model>& model, const VkCommandBuffer commandBuffer) const noexcept
+    void DispatchSkinning(const VkCommandBuffer commandBuffer, const std::vector<std::pair<const Node*, size_t>>& skins) const noexcept
     {
-        if (!model->animations.empty() && model->attributes.animation)
+        if (skins.empty())
         {
-            for (const auto& scene : model->scenes)
+            return;
+        }
+
+        const auto& pipeline = m_context->pipelines.at(PipelineType::CS_SKIN);
+        vkCmdBindPipeline(commandBuffer, VK_PIPELINE_BIND_POINT_COMPUTE, pipeline->pipeline);
+
+        for (const auto& [node, primitiveIndex] : skins)
+        {
+            const auto& primitive = node->mesh->primitives[primitiveIndex];
+            const auto& instance  = node->skinnedInstances[primitiveIndex];
+
+            std::array<VkDescriptorSet, 2> descriptorSets {instance.descriptorSet, m_context->jointPalette.descriptorSet};
+            auto dynamicOffset = static_cast<uint32_t>(node->skin->paletteOffset);
+
+            vkCmdBindDescriptorSets(
+                commandBuffer,
+                VK_PIPELINE_BIND_POINT_COMPUTE,
+                pipeline->pipelineLayout,
+                0,
+                static_cast<uint32_t>(descriptorSets.size()),
+                descriptorSets.data(),
+                1,
+                &dynamicOffset
+            );
+            SkinPushConstant pc {.vertexCount = primitive->vertexCount, .jointSize = primitive->jointSize};
+            vkCmdPushConstants(commandBuffer, pipeline->pipelineLayout, VK_SHADER_STAGE_COMPUTE_BIT, 0, sizeof(SkinPushConstant), &pc);
+            vkCmdDispatch(commandBuffer, (primitive->vertexCount + 63) / 64, 1, 1);
+        }
+    }
+
+    /// @brief 先把原始位置复制到输出，然后每一轮对每个图元累加一个权重不为 0 的变形目标
+    /// @details 同一个图元的不同变形目标会写同一个顶点，所以轮与轮之间需要屏障；同一轮中不同图元的输出互不相关
+    ///          屏障的个数等于单个图元中权重不为 0 的变形目标的最大个数，和图元的个数无关
+    void DispatchMorph(
+        const VkCommandBuffer commandBuffer, const std::vector<std::tuple<const Model*, const Mesh*, const Primitive*>>& morphs
+    ) const noexcept
+    {
+        if (morphs.empty())
+        {
+            return;
+        }
+
+        for (const auto& [model, _, primitive] : morphs)
+        {
+            VkBufferCopy copyRegion = {};
+            copyRegion.size         = sizeof(Vertex::position_type) * primitive->vertexCount;
+
+            vkCmdCopyBuffer(
+                commandBuffer,
+                model->buffers.at(primitive->position)->buffer,
+                model->buffers.at(primitive->morphedPosition.value())->buffer,
+                1,
+                &copyRegion
+            );
+        }
+
+        VkMemoryBarrier copyBarrier = {};
+        copyBarrier.sType           = VK_STRUCTURE_TYPE_MEMORY_BARRIER;
+        copyBarrier.srcAccessMask   = VK_ACCESS_TRANSFER_WRITE_BIT;
+        copyBarrier.dstAccessMask   = VK_ACCESS_SHADER_READ_BIT | VK_ACCESS_SHADER_WRITE_BIT;
+
+        vkCmdPipelineBarrier(
+            commandBuffer, VK_PIPELINE_STAGE_TRANSFER_BIT, VK_PIPELINE_STAGE_COMPUTE_SHADER_BIT, 0, 1, &copyBarrier, 0, nullptr, 0, nullptr
+        );
+
+        const auto& pipeline = m_context->pipelines.at(PipelineType::CS_MORPH);
+        vkCmdBindPipeline(commandBuffer, VK_PIPELINE_BIND_POINT_COMPUTE, pipeline->pipeline);
+
+        VkMemoryBarrier roundBarrier = {};
+        roundBarrier.sType           = VK_STRUCTURE_TYPE_MEMORY_BARRIER;
+        roundBarrier.srcAccessMask   = VK_ACCESS_SHADER_WRITE_BIT;
+        roundBarrier.dstAccessMask   = VK_ACCESS_SHADER_READ_BIT | VK_ACCESS_SHADER_WRITE_BIT;
+
+        std::vector<size_t> cursors(morphs.size(), 0);
+        for (bool firstRound = true;; firstRound = false)
+        {
+            bool dispatched {false};
+            for (size_t i = 0; i < morphs.size(); ++i)
             {
-                for (const auto& node : scene->nodes)
+                const auto& [_, mesh, primitive] = morphs[i];
+                auto& cursor                     = cursors[i];
+
+                // 跳过权重为 0 或者没有位置增量的变形目标
+                while (cursor < primitive->morphTargets.size()
+                       && (0 == primitive->morphTargets[cursor].second || cursor >= mesh->weights.size() || 0.f == mesh->weights[cursor]))
                 {
-                    // 先更新动画再更新蒙皮（动画会更新所有节点的变换数据，蒙皮需要根据这些数据构造 GLSL 中使用的数据）
-                    UpdateNodeAnimation(model, node);
-                    UpdateNodeJoint(scene, node);
+                    ++cursor;
                 }
+
+                if (cursor >= primitive->morphTargets.size())
+                {
+                    continue;
+                }
+
+                if (!dispatched && !firstRound)
+                {
+                    vkCmdPipelineBarrier(
+                        commandBuffer,
+                        VK_PIPELINE_STAGE_COMPUTE_SHADER_BIT,
+                        VK_PIPELINE_STAGE_COMPUTE_SHADER_BIT,
+                        0,
+                        1,
+                        &roundBarrier,
+                        0,
+                        nullptr,
+                        0,
+                        nullptr
+                    );
+                }
+                dispatched = true;
+
+                auto [first, count] = primitive->morphTargets[cursor];
+                MorphPushConstant pushConstant {first, count, mesh->weights[cursor]};
+                ++cursor;
+
+                vkCmdBindDescriptorSets(
+                    commandBuffer, VK_PIPELINE_BIND_POINT_COMPUTE, pipeline->pipelineLayout, 0, 1, &primitive->morphDescriptorSet, 0, nullptr
+                );
+                vkCmdPushConstants(
+                    commandBuffer, pipeline->pipelineLayout, VK_SHADER_STAGE_COMPUTE_BIT, 0, sizeof(MorphPushConstant), &pushConstant
+                );
+                vkCmdDispatch(commandBuffer, (count + 63) / 64, 1, 1);
+            }
+
+            if (!dispatched)
+            {
+                break;
             }
         }
+    }
 
+    void DrawGLTFModel(const std::unique_ptr<Model>& model, const VkCommandBuffer commandBuffer) const noexcept
+    {
         for (const auto& scene : model->scenes)
         {
             for (const auto& node : scene->nodes)
@@ -3963,14 +5451,88 @@ private:
         CopyBufferToImage(stagingBuffer, image->image, width, height);
         TransitionImageLayout(image->image, format, VK_IMAGE_LAYOUT_TRANSFER_DST_OPTIMAL, VK_IMAGE_LAYOUT_SHADER_READ_ONLY_OPTIMAL);
 
-        vkDestroyBuffer(m_device, stagingBuffer, nullptr);
-        vkFreeMemory(m_device, stagingBufferMemory, nullptr);
+        ReleaseStagingBuffer(stagingBuffer, stagingBufferMemory);
 
         image->imageView = CreateImageView(image->image, format, VK_IMAGE_ASPECT_COLOR_BIT);
 
         return image;
     }
 
+    /// @brief 创建只包含 mip 链中 [firstMip, mipCount) 级的图像，所有级别通过一个暂存缓冲上传，视图包含图像的所有级别
+    void CreateStreamedImage(const Image& source, uint32_t firstMip, VkImage& image, VkImageView& imageView, VkDeviceMemory& imageMemory)
+    {
+        auto mipLevels = static_cast<uint32_t>(source.mips.size()) - firstMip;
+
+        VkDeviceSize dataSize {0};
+        for (auto level = firstMip; level < source.mips.size(); ++level)
+        {
+            dataSize += source.mips[level].size();
+        }
+
+        VkBuffer stagingBuffer {};
+        VkDeviceMemory stagingBufferMemory {};
+
+        CreateBuffer(
+            dataSize,
+            VK_BUFFER_USAGE_TRANSFER_SRC_BIT,
+            VK_MEMORY_PROPERTY_HOST_VISIBLE_BIT | VK_MEMORY_PROPERTY_HOST_COHERENT_BIT,
+            stagingBuffer,
+            stagingBufferMemory
+        );
+
+        // 每一级依次存放在暂存缓冲中，偏移都是纹素大小的倍数
+        std::vector<VkBufferImageCopy> regions {};
+        VkDeviceSize offset {0};
+
+        void* data {nullptr};
+        vkMapMemory(m_device, stagingBufferMemory, 0, dataSize, 0, &data);
+        for (uint32_t level = 0; level < mipLevels; ++level)
+        {
+            const auto& pixels = source.mips[firstMip + level];
+            std::memcpy(static_cast<char*>(data) + offset, pixels.data(), pixels.size());
+
+            VkBufferImageCopy region {};
+            region.bufferOffset                    = offset;
+            region.imageSubresource.aspectMask     = VK_IMAGE_ASPECT_COLOR_BIT;
+            region.imageSubresource.mipLevel       = level;
+            region.imageSubresource.baseArrayLayer = 0;
+            region.imageSubresource.layerCount     = 1;
+            region.imageExtent = {std::max(source.width >> (firstMip + level), 1u), std::max(source.height >> (firstMip + level), 1u), 1};
+            regions.emplace_back(region);
+
+            offset += pixels.size();
+        }
+        vkUnmapMemory(m_device, stagingBufferMemory);
+
+        auto width  = std::max(source.width >> firstMip, 1u);
+        auto height = std::max(source.height >> firstMip, 1u);
+        CreateImage(
+            width,
+            height,
+            source.format,
+            VK_IMAGE_TILING_OPTIMAL,
+            VK_IMAGE_USAGE_TRANSFER_DST_BIT | VK_IMAGE_USAGE_SAMPLED_BIT,
+            VK_MEMORY_PROPERTY_DEVICE_LOCAL_BIT,
+            image,
+            imageMemory,
+            mipLevels
+        );
+
+        TransitionImageLayout(image, source.format, VK_IMAGE_LAYOUT_UNDEFINED, VK_IMAGE_LAYOUT_TRANSFER_DST_OPTIMAL, mipLevels);
+
+        auto commandBuffer = BeginUploadCommands();
+        vkCmdCopyBufferToImage(
+            commandBuffer, stagingBuffer, image, VK_IMAGE_LAYOUT_TRANSFER_DST_OPTIMAL, static_cast<uint32_t>(regions.size()), regions.data()
+        );
+        EndUploadCommands(commandBuffer);
+
+        TransitionImageLayout(image, source.format, VK_IMAGE_LAYOUT_TRANSFER_DST_OPTIMAL, VK_IMAGE_LAYOUT_SHADER_READ_ONLY_OPTIMAL, mipLevels);
+
+        ReleaseStagingBuffer(stagingBuffer, stagingBufferMemory);
+
+        imageView = CreateImageView(image, source.format, VK_IMAGE_ASPECT_COLOR_BIT, mipLevels);
+    }
+
     VkSampler CreateTextureSampler()
     {
         VkSampler sampler {};
@@ -3991,7 +5553,7 @@ private:
         samplerInfo.mipmapMode              = VK_SAMPLER_MIPMAP_MODE_LINEAR;
         samplerInfo.mipLodBias              = 0.f;
         samplerInfo.minLod                  = 0.f;
-        samplerInfo.maxLod                  = 0.f;
+        samplerInfo.maxLod                  = VK_LOD_CLAMP_NONE; // 流送的纹理有多级 mip
 
         if (VK_SUCCESS != vkCreateSampler(m_device, &samplerInfo, nullptr, &sampler))
         {
@@ -4003,7 +5565,7 @@ private:
 
     void CopyBufferToImage(VkBuffer buffer, VkImage image, uint32_t widht, uint32_t height)
     {
-        VkCommandBuffer commandBuffer = BeginSingleTimeCommands();
+        VkCommandBuffer commandBuffer = BeginUploadCommands();
 
         VkBufferImageCopy region {};
         region.bufferOffset                    = 0;
@@ -4017,12 +5579,12 @@ private:
         region.imageExtent                     = {widht, height, 1};
 
         vkCmdCopyBufferToImage(commandBuffer, buffer, image, VK_IMAGE_LAYOUT_TRANSFER_DST_OPTIMAL, 1, &region);
-        EndSingleTimeCommands(commandBuffer);
+        EndUploadCommands(commandBuffer);
     }
 
-    void TransitionImageLayout(VkImage image, VkFormat format, VkImageLayout oldLayout, VkImageLayout newLayout)
+    void TransitionImageLayout(VkImage image, VkFormat format, VkImageLayout oldLayout, VkImageLayout newLayout, uint32_t mipLevels = 1)
     {
-        VkCommandBuffer commandBuffer = BeginSingleTimeCommands();
+        VkCommandBuffer commandBuffer = BeginUploadCommands();
 
         VkImageMemoryBarrier barrier {};
         barrier.sType                           = VK_STRUCTURE_TYPE_IMAGE_MEMORY_BARRIER;
@@ -4033,7 +5595,7 @@ private:
         barrier.image                           = image;
         barrier.subresourceRange.aspectMask     = VK_IMAGE_ASPECT_COLOR_BIT;
         barrier.subresourceRange.baseMipLevel   = 0;
-        barrier.subresourceRange.levelCount     = 1;
+        barrier.subresourceRange.levelCount     = mipLevels;
         barrier.subresourceRange.baseArrayLayer = 0;
         barrier.subresourceRange.layerCount     = 1;
         barrier.srcAccessMask                   = 0;
@@ -4058,13 +5620,41 @@ private:
             sourceStage      = VK_PIPELINE_STAGE_TRANSFER_BIT;
             destinationStage = VK_PIPELINE_STAGE_FRAGMENT_SHADER_BIT;
         }
-        else
+        else
+        {
+            throw std::invalid_argument("unsupported layout transition");
+        }
+
+        vkCmdPipelineBarrier(commandBuffer, sourceStage, destinationStage, 0, 0, nullptr, 0, nullptr, 1, &barrier);
+        EndUploadCommands(commandBuffer);
+    }
+
+    /// @brief 加载模型时返回上传批次的指令缓冲，否则创建一个单次使用的指令缓冲
+    VkCommandBuffer BeginUploadCommands() const noexcept
+    {
+        return m_uploadBatch ? m_uploadBatch->commandBuffer : BeginSingleTimeCommands();
+    }
+
+    /// @brief 加载模型时由 EndUpload 统一提交，否则立即提交并等待完成
+    void EndUploadCommands(VkCommandBuffer commandBuffer) const noexcept
+    {
+        if (!m_uploadBatch)
+        {
+            EndSingleTimeCommands(commandBuffer);
+        }
+    }
+
+    /// @brief 暂存缓冲在复制指令执行完成之后才能销毁
+    void ReleaseStagingBuffer(VkBuffer buffer, VkDeviceMemory memory) noexcept
+    {
+        if (m_uploadBatch)
         {
-            throw std::invalid_argument("unsupported layout transition");
+            m_uploadBatch->stagingBuffers.emplace_back(buffer, memory);
+            return;
         }
 
-        vkCmdPipelineBarrier(commandBuffer, sourceStage, destinationStage, 0, 0, nullptr, 0, nullptr, 1, &barrier);
-        EndSingleTimeCommands(commandBuffer);
+        vkDestroyBuffer(m_device, buffer, nullptr);
+        vkFreeMemory(m_device, memory, nullptr);
     }
 
     VkCommandBuffer BeginSingleTimeCommands() const noexcept
@@ -4104,7 +5694,10 @@ private:
     /// @brief 创建顶点缓冲
     std::unique_ptr<Buffer> CreateVertexBuffer(const VkDeviceSize bufferSize, const void* dataPointer)
     {
-        return CreateDrawableBuffer(bufferSize, dataPointer, VK_BUFFER_USAGE_VERTEX_BUFFER_BIT);
+        // 蒙皮的计算着色器会把顶点数据作为存储缓冲读取，变形时从原始的位置复制
+        return CreateDrawableBuffer(
+            bufferSize, dataPointer, VK_BUFFER_USAGE_VERTEX_BUFFER_BIT | VK_BUFFER_USAGE_STORAGE_BUFFER_BIT | VK_BUFFER_USAGE_TRANSFER_SRC_BIT
+        );
     }
 
     /// @brief 创建索引缓冲
@@ -4113,7 +5706,7 @@ private:
         return CreateDrawableBuffer(bufferSize, dataPointer, VK_BUFFER_USAGE_INDEX_BUFFER_BIT);
     }
 
-    std::unique_ptr<Buffer> CreateDrawableBuffer(const VkDeviceSize bufferSize, const void* dataPointer, VkBufferUsageFlagBits usage)
+    std::unique_ptr<Buffer> CreateDrawableBuffer(const VkDeviceSize bufferSize, const void* dataPointer, VkBufferUsageFlags usage)
     {
         auto buffer = std::make_unique<Buffer>();
 
@@ -4137,8 +5730,7 @@ private:
 
         CopyBuffer(stagingBuffer, buffer->buffer, bufferSize);
 
-        vkDestroyBuffer(m_device, stagingBuffer, nullptr);
-        vkFreeMemory(m_device, stagingBufferMemory, nullptr);
+        ReleaseStagingBuffer(stagingBuffer, stagingBufferMemory);
 
         return buffer;
     }
@@ -4275,6 +5867,14 @@ private:
             }
         }
 
+        if (STREAM_TEXTURES)
+        {
+            constexpr double megabyte = 1024.0 * 1024.0;
+            ImGui::Text(
+                "Texture: %.1f / %.1f MB", m_textureStreamer.GetResidentSize() / megabyte, m_textureStreamer.GetFullSize() / megabyte
+            );
+        }
+
         ImGui::End();
 
         ImGui::Render();
@@ -4502,8 +6102,8 @@ private:
 
         for (uint32_t i = 0; i < queueFamilies.size(); ++i)
         {
-            // 图形队列族
-            if (queueFamilies.at(i).queueFlags & VK_QUEUE_GRAPHICS_BIT)
+            // 图形队列族，蒙皮的计算着色器也提交到这个队列
+            if ((queueFamilies.at(i).queueFlags & VK_QUEUE_GRAPHICS_BIT) && (queueFamilies.at(i).queueFlags & VK_QUEUE_COMPUTE_BIT))
             {
                 indices.graphicsFamily = i;
             }
@@ -4534,8 +6134,16 @@ private:
         std::vector<VkDeviceQueueCreateInfo> queueCreateInfos;
         std::set<uint32_t> uniqueQueueFamilies {indices.graphicsFamily.value(), indices.presentFamily.value()};
 
+        // 图形队列族有多个队列时，使用第二个队列上传模型数据，上传和绘制的提交互不等待
+        // 和图形队列在同一个队列族，缓冲和图像不需要转移所有权
+        uint32_t queueFamilyCount {0};
+        vkGetPhysicalDeviceQueueFamilyProperties(m_physicalDevice, &queueFamilyCount, nullptr);
+        std::vector<VkQueueFamilyProperties> queueFamilies(queueFamilyCount);
+        vkGetPhysicalDeviceQueueFamilyProperties(m_physicalDevice, &queueFamilyCount, queueFamilies.data());
+        auto graphicsQueueCount = std::min(queueFamilies.at(indices.graphicsFamily.value()).queueCount, 2u);
+
         // 控制指令缓存执行顺序的优先级，即使只有一个队列也要显示指定优先级，范围：[0.0, 1.0]
-        float queuePriority {1.f};
+        std::array<float, 2> queuePriorities {1.f, 1.f};
         for (auto queueFamily : uniqueQueueFamilies)
         {
             // 描述队列簇中预要申请使用的队列数量
@@ -4544,8 +6152,8 @@ private:
             VkDeviceQueueCreateInfo queueCreateInfo {};
             queueCreateInfo.sType            = VK_STRUCTURE_TYPE_DEVICE_QUEUE_CREATE_INFO;
             queueCreateInfo.queueFamilyIndex = queueFamily;
-            queueCreateInfo.queueCount       = 1;
-            queueCreateInfo.pQueuePriorities = &queuePriority;
+            queueCreateInfo.queueCount       = indices.graphicsFamily.value() == queueFamily ? graphicsQueueCount : 1;
+            queueCreateInfo.pQueuePriorities = queuePriorities.data();
             queueCreateInfos.push_back(queueCreateInfo);
         }
 
@@ -4585,6 +6193,7 @@ private:
         // 4.用来存储返回的队列句柄的内存地址
         vkGetDeviceQueue(m_device, indices.graphicsFamily.value(), 0, &m_graphicsQueue);
         vkGetDeviceQueue(m_device, indices.presentFamily.value(), 0, &m_presentQueue);
+        vkGetDeviceQueue(m_device, indices.graphicsFamily.value(), graphicsQueueCount - 1, &m_transferQueue);
     }
 
     /// @brief 创建表面，需要在程序退出前清理
@@ -4866,18 +6475,92 @@ private:
         );
 
         m_context->pipelines.try_emplace(
-            PipelineType::DC_NL_AW2,
-            CreateGraphicsPipeline(
-                PipelineType::DC_NL_AW2, "../resources/shaders/01_06_dc_nl_aw2_vert.spv", "../resources/shaders/01_06_dc_nl_aw2_frag.spv"
+            PipelineType::CS_SKIN,
+            CreateComputePipeline(
+                "../resources/shaders/01_06_skin_comp.spv",
+                {"storage_skinning", "storage_joint_palette"},
+                static_cast<uint32_t>(sizeof(SkinPushConstant))
             )
         );
 
         m_context->pipelines.try_emplace(
-            PipelineType::DC_NL_AS2,
-            CreateGraphicsPipeline(
-                PipelineType::DC_NL_AS2, "../resources/shaders/01_06_dc_nl_as2_vert.spv", "../resources/shaders/01_06_dc_nl_as2_frag.spv"
-            )
+            PipelineType::CS_MORPH,
+            CreateComputePipeline("../resources/shaders/01_06_morph_comp.spv", {"storage_morph"}, static_cast<uint32_t>(sizeof(MorphPushConstant)))
+        );
+
+        // 压缩的顶点使用相同的着色器，只有顶点输入格式和特化常量不同
+        m_context->pipelines.try_emplace(
+            PipelineType::DC_NL_Q,
+            CreateGraphicsPipeline(PipelineType::DC_NL_Q, "../resources/shaders/01_06_dc_nl_vert.spv", "../resources/shaders/01_06_dc_nl_frag.spv")
+        );
+
+        m_context->pipelines.try_emplace(
+            PipelineType::DC_PL_Q,
+            CreateGraphicsPipeline(PipelineType::DC_PL_Q, "../resources/shaders/01_06_dc_pl_vert.spv", "../resources/shaders/01_06_dc_pl_frag.spv")
+        );
+
+        m_context->pipelines.try_emplace(
+            PipelineType::TC_NL_Q,
+            CreateGraphicsPipeline(PipelineType::TC_NL_Q, "../resources/shaders/01_06_tc_nl_vert.spv", "../resources/shaders/01_06_tc_nl_frag.spv")
         );
+
+        m_context->pipelines.try_emplace(
+            PipelineType::TC_PL_Q,
+            CreateGraphicsPipeline(PipelineType::TC_PL_Q, "../resources/shaders/01_06_tc_pl_vert.spv", "../resources/shaders/01_06_tc_pl_frag.spv")
+        );
+    }
+
+    /// @brief 创建顶点动画（蒙皮、变形）的计算管线，每一帧在渲染流程之前把播放动画的顶点写入 SkinnedInstance::position、Primitive::morphedPosition
+    std::unique_ptr<Pipeline>
+    CreateComputePipeline(const std::string& compPath, const std::vector<std::string>& setLayoutNames, uint32_t pushConstantSize)
+    {
+        auto pipeline = std::make_unique<Pipeline>();
+
+        auto compShaderCode             = ReadFile(compPath);
+        VkShaderModule compShaderModule = CreateShaderModule(compShaderCode);
+
+        VkPipelineShaderStageCreateInfo compShaderStageInfo = {};
+        compShaderStageInfo.sType                           = VK_STRUCTURE_TYPE_PIPELINE_SHADER_STAGE_CREATE_INFO;
+        compShaderStageInfo.stage                           = VK_SHADER_STAGE_COMPUTE_BIT;
+        compShaderStageInfo.module                          = compShaderModule;
+        compShaderStageInfo.pName                           = "main";
+
+        std::vector<VkDescriptorSetLayout> descriptorSetLayouts {};
+        for (const auto& name : setLayoutNames)
+        {
+            descriptorSetLayouts.emplace_back(m_context->descriptorSetLayouts.at(name)->descriptorSetLayout);
+        }
+
+        VkPushConstantRange pushConstantRange = {};
+        pushConstantRange.stageFlags          = VK_SHADER_STAGE_COMPUTE_BIT;
+        pushConstantRange.offset              = 0;
+        pushConstantRange.size                = pushConstantSize;
+
+        VkPipelineLayoutCreateInfo pipelineLayoutInfo {};
+        pipelineLayoutInfo.sType                  = VK_STRUCTURE_TYPE_PIPELINE_LAYOUT_CREATE_INFO;
+        pipelineLayoutInfo.setLayoutCount         = static_cast<uint32_t>(descriptorSetLayouts.size());
+        pipelineLayoutInfo.pSetLayouts            = descriptorSetLayouts.data();
+        pipelineLayoutInfo.pushConstantRangeCount = 1;
+        pipelineLayoutInfo.pPushConstantRanges    = &pushConstantRange;
+
+        if (VK_SUCCESS != vkCreatePipelineLayout(m_device, &pipelineLayoutInfo, nullptr, &pipeline->pipelineLayout))
+        {
+            throw std::runtime_error("failed to create pipeline layout");
+        }
+
+        VkComputePipelineCreateInfo pipelineInfo = {};
+        pipelineInfo.sType                       = VK_STRUCTURE_TYPE_COMPUTE_PIPELINE_CREATE_INFO;
+        pipelineInfo.layout                      = pipeline->pipelineLayout;
+        pipelineInfo.stage                       = compShaderStageInfo;
+
+        if (VK_SUCCESS != vkCreateComputePipelines(m_device, VK_NULL_HANDLE, 1, &pipelineInfo, nullptr, &pipeline->pipeline))
+        {
+            throw std::runtime_error("failed to create compute pipeline");
+        }
+
+        vkDestroyShaderModule(m_device, compShaderModule, nullptr);
+
+        return pipeline;
     }
 
     /// @brief 创建图形管线
@@ -4892,12 +6575,22 @@ private:
         VkShaderModule vertShaderModule = CreateShaderModule(vertShaderCode);
         VkShaderModule fragShaderModule = CreateShaderModule(fragShaderCode);
 
+        // constant_id = 0：法线是否使用八面体映射压缩，没有读取法线的着色器会忽略这个常量
+        VkBool32 packedNormal = IsPackedPipeline(pipelineType) ? VK_TRUE : VK_FALSE;
+        VkSpecializationMapEntry specializationEntry {0, 0, sizeof(VkBool32)};
+
+        VkSpecializationInfo specializationInfo {};
+        specializationInfo.mapEntryCount = 1;
+        specializationInfo.pMapEntries   = &specializationEntry;
+        specializationInfo.dataSize      = sizeof(VkBool32);
+        specializationInfo.pData         = &packedNormal;
+
         VkPipelineShaderStageCreateInfo vertShaderStageInfo = {};
         vertShaderStageInfo.sType                           = VK_STRUCTURE_TYPE_PIPELINE_SHADER_STAGE_CREATE_INFO;
         vertShaderStageInfo.stage                           = VK_SHADER_STAGE_VERTEX_BIT;
         vertShaderStageInfo.module                          = vertShaderModule;
-        vertShaderStageInfo.pName                           = "main";  // 指定调用的着色器函数，同一份代码可以实现多个着色器
-        vertShaderStageInfo.pSpecializationInfo             = nullptr; // 设置着色器常量
+        vertShaderStageInfo.pName                           = "main";              // 指定调用的着色器函数，同一份代码可以实现多个着色器
+        vertShaderStageInfo.pSpecializationInfo             = &specializationInfo; // 设置着色器常量
 
         VkPipelineShaderStageCreateInfo fragShaderStageInfo = {};
         fragShaderStageInfo.sType                           = VK_STRUCTURE_TYPE_PIPELINE_SHADER_STAGE_CREATE_INFO;
@@ -5014,22 +6707,33 @@ private:
 
         pushConstantRanges.emplace_back(pushConstantRangeVP);
 
+        // 在 PushConstantCamPos 之后，所有图形管线都有这一段，没有压缩的图元写入 offset = 0, scale = 1
+        VkPushConstantRange pushConstantRangeDequantize = {};
+        pushConstantRangeDequantize.stageFlags          = VK_SHADER_STAGE_VERTEX_BIT;
+        pushConstantRangeDequantize.offset              = sizeof(PushConstantVP) + sizeof(PushConstantCamPos);
+        pushConstantRangeDequantize.size                = sizeof(PushConstantDequantize);
+
+        pushConstantRanges.emplace_back(pushConstantRangeDequantize);
+
         std::vector<VkDescriptorSetLayout> descriptorSetLayouts {};
         descriptorSetLayouts.emplace_back(m_context->descriptorSetLayouts.at("uniform_model")->descriptorSetLayout);
 
         switch (pipelineType)
         {
             case PipelineType::DC_NL:
+            case PipelineType::DC_NL_Q:
             {
                 descriptorSetLayouts.emplace_back(m_context->descriptorSetLayouts.at("uniform_color")->descriptorSetLayout);
             }
             break;
             case PipelineType::TC_NL:
+            case PipelineType::TC_NL_Q:
             {
                 descriptorSetLayouts.emplace_back(m_context->descriptorSetLayouts.at("uniform_sampler")->descriptorSetLayout);
             }
             break;
             case PipelineType::DC_PL:
+            case PipelineType::DC_PL_Q:
             {
                 VkPushConstantRange pushConstantRangeCamPos = {};
                 pushConstantRangeCamPos.stageFlags          = VK_SHADER_STAGE_FRAGMENT_BIT;
@@ -5043,6 +6747,7 @@ private:
             }
             break;
             case PipelineType::TC_PL:
+            case PipelineType::TC_PL_Q:
             {
                 VkPushConstantRange pushConstantRangeCamPos = {};
                 pushConstantRangeCamPos.stageFlags          = VK_SHADER_STAGE_FRAGMENT_BIT;
@@ -5055,18 +6760,6 @@ private:
                 descriptorSetLayouts.emplace_back(m_context->descriptorSetLayouts.at("uniform_sampler")->descriptorSetLayout);
             }
             break;
-            case PipelineType::DC_NL_AW2:
-            {
-                descriptorSetLayouts.emplace_back(m_context->descriptorSetLayouts.at("uniform_animation_morph")->descriptorSetLayout);
-                descriptorSetLayouts.emplace_back(m_context->descriptorSetLayouts.at("uniform_color")->descriptorSetLayout);
-            }
-            break;
-            case PipelineType::DC_NL_AS2:
-            {
-                descriptorSetLayouts.emplace_back(m_context->descriptorSetLayouts.at("uniform_animation_skin")->descriptorSetLayout);
-                descriptorSetLayouts.emplace_back(m_context->descriptorSetLayouts.at("uniform_color")->descriptorSetLayout);
-            }
-            break;
             default:
                 break;
         }
@@ -5324,6 +7017,9 @@ private:
             throw std::runtime_error("failed to begin recording command buffer");
         }
 
+        // 蒙皮、变形必须在渲染流程之外执行
+        RecordVertexAnimation(commandBuffer);
+
         // 清除色，相当于背景色
         std::array<VkClearValue, 2> clearValues {};
         clearValues.at(0).color = {
@@ -5414,6 +7110,11 @@ private:
             throw std::runtime_error("failed to acquire swap chain image");
         }
 
+        // 栅栏已经发出信号，这一帧的蒙皮和变形 uniform 可以直接写入，流送纹理的描述符集也可以更新
+        UpdateAnimations();
+        UpdateModelUniforms();
+        UpdateStreamedDescriptors();
+
         // 手动将栅栏重置为未发出信号的状态（必须手动设置）
         vkResetFences(m_device, 1, &m_inFlightFences.at(m_currentFrame));
         vkResetCommandBuffer(m_commandBuffers.at(imageIndex), 0);
@@ -5601,41 +7302,19 @@ private:
     /// @param size
     void CopyBuffer(VkBuffer srcBuffer, VkBuffer dstBuffer, VkDeviceSize size) const noexcept
     {
-        VkCommandBufferAllocateInfo allocInfo = {};
-        allocInfo.sType                       = VK_STRUCTURE_TYPE_COMMAND_BUFFER_ALLOCATE_INFO;
-        allocInfo.level                       = VK_COMMAND_BUFFER_LEVEL_PRIMARY;
-        allocInfo.commandPool                 = m_commandPool;
-        allocInfo.commandBufferCount          = 1;
-
-        VkCommandBuffer commandBuffer {};
-        vkAllocateCommandBuffers(m_device, &allocInfo, &commandBuffer);
-
-        VkCommandBufferBeginInfo beginInfo = {};
-        beginInfo.sType                    = VK_STRUCTURE_TYPE_COMMAND_BUFFER_BEGIN_INFO;
-        beginInfo.flags                    = VK_COMMAND_BUFFER_USAGE_ONE_TIME_SUBMIT_BIT; // 指定如何使用这个指令缓冲
+        VkCommandBuffer commandBuffer = BeginUploadCommands();
 
-        vkBeginCommandBuffer(commandBuffer, &beginInfo);
         VkBufferCopy copyRegion = {};
         copyRegion.srcOffset    = 0;
         copyRegion.dstOffset    = 0;
         copyRegion.size         = size;
         vkCmdCopyBuffer(commandBuffer, srcBuffer, dstBuffer, 1, &copyRegion);
-        vkEndCommandBuffer(commandBuffer);
-
-        VkSubmitInfo submitInfo       = {};
-        submitInfo.sType              = VK_STRUCTURE_TYPE_SUBMIT_INFO;
-        submitInfo.commandBufferCount = 1;
-        submitInfo.pCommandBuffers    = &commandBuffer;
-
-        // 提交到内存传输指令队列执行内存传输
-        vkQueueSubmit(m_graphicsQueue, 1, &submitInfo, nullptr);
-        // 等待传输操作完成，也可以使用栅栏，栅栏可以同步多个不同的内存传输操作，给驱动程序的优化空间也更大
-        vkQueueWaitIdle(m_graphicsQueue);
 
-        vkFreeCommandBuffers(m_device, m_commandPool, 1, &commandBuffer);
+        // 加载模型时和同一个模型的其他复制一起提交，用 fence 等待，不阻塞主循环
+        EndUploadCommands(commandBuffer);
     }
 
-    VkImageView CreateImageView(VkImage image, VkFormat format, VkImageAspectFlags aspectFlags)
+    VkImageView CreateImageView(VkImage image, VkFormat format, VkImageAspectFlags aspectFlags, uint32_t mipLevels = 1)
     {
         VkImageViewCreateInfo viewInfo {};
         viewInfo.sType                           = VK_STRUCTURE_TYPE_IMAGE_VIEW_CREATE_INFO;
@@ -5644,7 +7323,7 @@ private:
         viewInfo.format                          = format;
         viewInfo.subresourceRange.aspectMask     = aspectFlags;
         viewInfo.subresourceRange.baseMipLevel   = 0;
-        viewInfo.subresourceRange.levelCount     = 1;
+        viewInfo.subresourceRange.levelCount     = mipLevels;
         viewInfo.subresourceRange.baseArrayLayer = 0;
         viewInfo.subresourceRange.layerCount     = 1;
 
@@ -5710,34 +7389,66 @@ private:
         {
             auto descriptorSetLayout = std::make_unique<DescriptorSetLayout>();
 
-            VkDescriptorSetLayoutBinding uboLayoutBinding = {};
-            uboLayoutBinding.binding                      = 0;
-            uboLayoutBinding.descriptorType               = VK_DESCRIPTOR_TYPE_UNIFORM_BUFFER;
-            uboLayoutBinding.descriptorCount              = 1;
-            uboLayoutBinding.stageFlags                   = VK_SHADER_STAGE_VERTEX_BIT;
-            uboLayoutBinding.pImmutableSamplers           = nullptr;
+            // 变形的输入：稀疏的位置增量，输出：变形之后的位置
+            std::array<VkDescriptorSetLayoutBinding, 2> bindings {};
+            for (uint32_t i = 0; i < bindings.size(); ++i)
+            {
+                bindings[i].binding            = i;
+                bindings[i].descriptorType     = VK_DESCRIPTOR_TYPE_STORAGE_BUFFER;
+                bindings[i].descriptorCount    = 1;
+                bindings[i].stageFlags         = VK_SHADER_STAGE_COMPUTE_BIT;
+                bindings[i].pImmutableSamplers = nullptr;
+            }
 
             VkDescriptorSetLayoutCreateInfo layoutInfo = {};
             layoutInfo.sType                           = VK_STRUCTURE_TYPE_DESCRIPTOR_SET_LAYOUT_CREATE_INFO;
-            layoutInfo.bindingCount                    = 1;
-            layoutInfo.pBindings                       = &uboLayoutBinding;
+            layoutInfo.bindingCount                    = static_cast<uint32_t>(bindings.size());
+            layoutInfo.pBindings                       = bindings.data();
+
+            if (VK_SUCCESS != vkCreateDescriptorSetLayout(m_device, &layoutInfo, nullptr, &descriptorSetLayout->descriptorSetLayout))
+            {
+                throw std::runtime_error("failed to create descriptor set layout");
+            }
+
+            m_context->descriptorSetLayouts.try_emplace("storage_morph", std::move(descriptorSetLayout));
+        }
+
+        {
+            auto descriptorSetLayout = std::make_unique<DescriptorSetLayout>();
+
+            // 蒙皮的输入：位置、权重、关节索引，输出：蒙皮之后的位置
+            std::array<VkDescriptorSetLayoutBinding, 4> bindings {};
+            for (uint32_t i = 0; i < bindings.size(); ++i)
+            {
+                bindings[i].binding            = i;
+                bindings[i].descriptorType     = VK_DESCRIPTOR_TYPE_STORAGE_BUFFER;
+                bindings[i].descriptorCount    = 1;
+                bindings[i].stageFlags         = VK_SHADER_STAGE_COMPUTE_BIT;
+                bindings[i].pImmutableSamplers = nullptr;
+            }
+
+            VkDescriptorSetLayoutCreateInfo layoutInfo = {};
+            layoutInfo.sType                           = VK_STRUCTURE_TYPE_DESCRIPTOR_SET_LAYOUT_CREATE_INFO;
+            layoutInfo.bindingCount                    = static_cast<uint32_t>(bindings.size());
+            layoutInfo.pBindings                       = bindings.data();
 
             if (VK_SUCCESS != vkCreateDescriptorSetLayout(m_device, &layoutInfo, nullptr, &descriptorSetLayout->descriptorSetLayout))
             {
                 throw std::runtime_error("failed to create descriptor set layout");
             }
 
-            m_context->descriptorSetLayouts.try_emplace("uniform_animation_morph", std::move(descriptorSetLayout));
+            m_context->descriptorSetLayouts.try_emplace("storage_skinning", std::move(descriptorSetLayout));
         }
 
         {
             auto descriptorSetLayout = std::make_unique<DescriptorSetLayout>();
 
+            // 关节矩阵的环形缓冲，使用动态偏移选择这一帧的某一个蒙皮
             VkDescriptorSetLayoutBinding uboLayoutBinding = {};
             uboLayoutBinding.binding                      = 0;
-            uboLayoutBinding.descriptorType               = VK_DESCRIPTOR_TYPE_STORAGE_BUFFER;
+            uboLayoutBinding.descriptorType               = VK_DESCRIPTOR_TYPE_STORAGE_BUFFER_DYNAMIC;
             uboLayoutBinding.descriptorCount              = 1;
-            uboLayoutBinding.stageFlags                   = VK_SHADER_STAGE_VERTEX_BIT;
+            uboLayoutBinding.stageFlags                   = VK_SHADER_STAGE_COMPUTE_BIT;
             uboLayoutBinding.pImmutableSamplers           = nullptr;
 
             VkDescriptorSetLayoutCreateInfo layoutInfo = {};
@@ -5750,7 +7461,7 @@ private:
                 throw std::runtime_error("failed to create descriptor set layout");
             }
 
-            m_context->descriptorSetLayouts.try_emplace("uniform_animation_skin", std::move(descriptorSetLayout));
+            m_context->descriptorSetLayouts.try_emplace("storage_joint_palette", std::move(descriptorSetLayout));
         }
 
         {
@@ -5844,30 +7555,39 @@ private:
 
         for (size_t i = 0; i < MAX_FRAMES_IN_FLIGHT; ++i)
         {
-            VkDescriptorImageInfo imageInfo {};
-            imageInfo.imageLayout = VK_IMAGE_LAYOUT_SHADER_READ_ONLY_OPTIMAL;
-            imageInfo.imageView   = model->images.at(texture->image)->imageView;
-            imageInfo.sampler     = model->samplers.at(texture->sampler)->sampler;
+            WriteTextureDescriptor(*model, *texture, i);
+        }
+    }
 
-            VkWriteDescriptorSet descriptorWrite {};
-            descriptorWrite.sType            = VK_STRUCTURE_TYPE_WRITE_DESCRIPTOR_SET;
-            descriptorWrite.dstSet           = texture->descriptorSets->descriptorSets[i];
-            descriptorWrite.dstBinding       = 0;
-            descriptorWrite.dstArrayElement  = 0;
-            descriptorWrite.descriptorType   = VK_DESCRIPTOR_TYPE_COMBINED_IMAGE_SAMPLER;
-            descriptorWrite.descriptorCount  = 1;
-            descriptorWrite.pBufferInfo      = nullptr;
-            descriptorWrite.pImageInfo       = &imageInfo;
-            descriptorWrite.pTexelBufferView = nullptr;
+    /// @brief 纹理流送替换图像之后也通过这个函数更新描述符集
+    void WriteTextureDescriptor(const Model& model, const Texture& texture, size_t frame)
+    {
+        VkDescriptorImageInfo imageInfo {};
+        imageInfo.imageLayout = VK_IMAGE_LAYOUT_SHADER_READ_ONLY_OPTIMAL;
+        imageInfo.imageView   = model.images.at(texture.image)->imageView;
+        imageInfo.sampler     = model.samplers.at(texture.sampler)->sampler;
 
-            vkUpdateDescriptorSets(m_device, 1, &descriptorWrite, 0, nullptr);
-        }
+        VkWriteDescriptorSet descriptorWrite {};
+        descriptorWrite.sType            = VK_STRUCTURE_TYPE_WRITE_DESCRIPTOR_SET;
+        descriptorWrite.dstSet           = texture.descriptorSets->descriptorSets[frame];
+        descriptorWrite.dstBinding       = 0;
+        descriptorWrite.dstArrayElement  = 0;
+        descriptorWrite.descriptorType   = VK_DESCRIPTOR_TYPE_COMBINED_IMAGE_SAMPLER;
+        descriptorWrite.descriptorCount  = 1;
+        descriptorWrite.pBufferInfo      = nullptr;
+        descriptorWrite.pImageInfo       = &imageInfo;
+        descriptorWrite.pTexelBufferView = nullptr;
+
+        vkUpdateDescriptorSets(m_device, 1, &descriptorWrite, 0, nullptr);
     }
 
-    std::unique_ptr<Uniform> CreateStorageBuffer(const void* data, VkDeviceSize bufferSize, VkDescriptorSetLayout descriptorSetLayout)
+    template <typename T>
+    std::unique_ptr<Uniform> CreateUniforms(const T& data, VkDescriptorSetLayout descriptorSetLayout)
     {
         auto uniform = std::make_unique<Uniform>();
 
+        VkDeviceSize bufferSize = sizeof(T);
+
         uniform->buffers.resize(MAX_FRAMES_IN_FLIGHT);
         uniform->memorys.resize(MAX_FRAMES_IN_FLIGHT);
         uniform->mappeds.resize(MAX_FRAMES_IN_FLIGHT);
@@ -5876,7 +7596,7 @@ private:
         {
             CreateBuffer(
                 bufferSize,
-                VK_BUFFER_USAGE_STORAGE_BUFFER_BIT,
+                VK_BUFFER_USAGE_UNIFORM_BUFFER_BIT,
                 VK_MEMORY_PROPERTY_HOST_VISIBLE_BIT | VK_MEMORY_PROPERTY_HOST_COHERENT_BIT,
                 uniform->buffers[i],
                 uniform->memorys[i]
@@ -5887,7 +7607,7 @@ private:
         //---------------------------------------------------------------------
         for (size_t i = 0; i < MAX_FRAMES_IN_FLIGHT; ++i)
         {
-            std::memcpy(uniform->mappeds[i], data, bufferSize);
+            std::memcpy(uniform->mappeds[i], &data, sizeof(T));
         }
 
         //---------------------------------------------------------------------
@@ -5910,14 +7630,14 @@ private:
             VkDescriptorBufferInfo bufferInfo {};
             bufferInfo.buffer = uniform->buffers[i];
             bufferInfo.offset = 0;
-            bufferInfo.range  = bufferSize;
+            bufferInfo.range  = sizeof(T);
 
             VkWriteDescriptorSet descriptorWrite {};
             descriptorWrite.sType            = VK_STRUCTURE_TYPE_WRITE_DESCRIPTOR_SET;
             descriptorWrite.dstSet           = uniform->descriptorSets->descriptorSets[i];
             descriptorWrite.dstBinding       = 0;
             descriptorWrite.dstArrayElement  = 0;
-            descriptorWrite.descriptorType   = VK_DESCRIPTOR_TYPE_STORAGE_BUFFER;
+            descriptorWrite.descriptorType   = VK_DESCRIPTOR_TYPE_UNIFORM_BUFFER;
             descriptorWrite.descriptorCount  = 1;
             descriptorWrite.pBufferInfo      = &bufferInfo;
             descriptorWrite.pImageInfo       = nullptr;
@@ -5929,84 +7649,200 @@ private:
         return uniform;
     }
 
-    template <typename T>
-    std::unique_ptr<Uniform> CreateUniforms(const T& data, VkDescriptorSetLayout descriptorSetLayout)
+    /// @brief 创建一个节点的一个图元蒙皮输出的顶点缓冲以及计算着色器使用的描述符集
+    SkinnedInstance CreateSkinningResources(
+        const std::unique_ptr<Model>& model, const std::unique_ptr<Node>& node, const std::unique_ptr<Primitive>& primitive
+    )
     {
-        auto uniform = std::make_unique<Uniform>();
+        SkinnedInstance instance {};
+        if (AnimationMode::Skin != primitive->animationMode || !primitive->weights || !primitive->joints
+            || !model->buffers.contains(primitive->joints.value()) || 0 == primitive->vertexCount)
+        {
+            return instance;
+        }
 
-        VkDeviceSize bufferSize = sizeof(T);
+        // 每个（节点，图元）独立的输出缓冲，同一个网格被多个蒙皮节点引用时输出也不会互相覆盖
+        auto skinnedBuffer = std::make_unique<Buffer>();
+        auto bufferSize    = static_cast<VkDeviceSize>(sizeof(Vertex::position_type) * primitive->vertexCount);
 
-        uniform->buffers.resize(MAX_FRAMES_IN_FLIGHT);
-        uniform->memorys.resize(MAX_FRAMES_IN_FLIGHT);
-        uniform->mappeds.resize(MAX_FRAMES_IN_FLIGHT);
+        CreateBuffer(
+            bufferSize,
+            VK_BUFFER_USAGE_STORAGE_BUFFER_BIT | VK_BUFFER_USAGE_VERTEX_BUFFER_BIT,
+            VK_MEMORY_PROPERTY_DEVICE_LOCAL_BIT,
+            skinnedBuffer->buffer,
+            skinnedBuffer->bufferMemory
+        );
 
-        for (size_t i = 0; i < MAX_FRAMES_IN_FLIGHT; ++i)
+        auto skinnedInfo = std::format(
+            "skinned node: {} primitive: {}", reinterpret_cast<std::uintptr_t>(node.get()), reinterpret_cast<std::uintptr_t>(primitive.get())
+        );
+        std::array<VkBuffer, 4> buffers {
+            model->buffers.at(primitive->position)->buffer,
+            model->buffers.at(primitive->weights.value())->buffer,
+            model->buffers.at(primitive->joints.value())->buffer,
+            skinnedBuffer->buffer,
+        };
+        model->buffers.try_emplace(skinnedInfo, std::move(skinnedBuffer));
+        instance.position = std::move(skinnedInfo);
+
+        auto layout = m_context->descriptorSetLayouts.at("storage_skinning")->descriptorSetLayout;
+
+        VkDescriptorSetAllocateInfo allocInfo {};
+        allocInfo.sType              = VK_STRUCTURE_TYPE_DESCRIPTOR_SET_ALLOCATE_INFO;
+        allocInfo.descriptorPool     = m_descriptorPool;
+        allocInfo.descriptorSetCount = 1;
+        allocInfo.pSetLayouts        = &layout;
+
+        if (VK_SUCCESS != vkAllocateDescriptorSets(m_device, &allocInfo, &instance.descriptorSet))
         {
-            CreateBuffer(
-                bufferSize,
-                VK_BUFFER_USAGE_UNIFORM_BUFFER_BIT,
-                VK_MEMORY_PROPERTY_HOST_VISIBLE_BIT | VK_MEMORY_PROPERTY_HOST_COHERENT_BIT,
-                uniform->buffers[i],
-                uniform->memorys[i]
-            );
-            vkMapMemory(m_device, uniform->memorys[i], 0, bufferSize, 0, &uniform->mappeds[i]);
+            throw std::runtime_error("failed to allocate descriptor sets");
         }
 
-        //---------------------------------------------------------------------
-        for (size_t i = 0; i < MAX_FRAMES_IN_FLIGHT; ++i)
+        std::array<VkDescriptorBufferInfo, 4> bufferInfos {};
+        std::array<VkWriteDescriptorSet, 4> descriptorWrites {};
+        for (uint32_t i = 0; i < buffers.size(); ++i)
         {
-            std::memcpy(uniform->mappeds[i], &data, sizeof(T));
+            bufferInfos[i].buffer = buffers[i];
+            bufferInfos[i].offset = 0;
+            bufferInfos[i].range  = VK_WHOLE_SIZE;
+
+            descriptorWrites[i].sType           = VK_STRUCTURE_TYPE_WRITE_DESCRIPTOR_SET;
+            descriptorWrites[i].dstSet          = instance.descriptorSet;
+            descriptorWrites[i].dstBinding      = i;
+            descriptorWrites[i].dstArrayElement = 0;
+            descriptorWrites[i].descriptorType  = VK_DESCRIPTOR_TYPE_STORAGE_BUFFER;
+            descriptorWrites[i].descriptorCount = 1;
+            descriptorWrites[i].pBufferInfo     = &bufferInfos[i];
         }
 
-        //---------------------------------------------------------------------
-        std::vector<VkDescriptorSetLayout> layouts(MAX_FRAMES_IN_FLIGHT, descriptorSetLayout);
+        vkUpdateDescriptorSets(m_device, static_cast<uint32_t>(descriptorWrites.size()), descriptorWrites.data(), 0, nullptr);
+
+        return instance;
+    }
+
+    /// @brief 创建变形的输出缓冲和描述符集，每帧先复制原始位置，然后累加权重不为 0 的变形目标
+    void CreateMorphResources(const std::unique_ptr<Model>& model, const std::unique_ptr<Primitive>& primitive)
+    {
+        if (!primitive->morphDelta || 0 == primitive->vertexCount)
+        {
+            return;
+        }
+
+        auto morphedBuffer = std::make_unique<Buffer>();
+        auto bufferSize    = static_cast<VkDeviceSize>(sizeof(Vertex::position_type) * primitive->vertexCount);
+
+        CreateBuffer(
+            bufferSize,
+            VK_BUFFER_USAGE_STORAGE_BUFFER_BIT | VK_BUFFER_USAGE_VERTEX_BUFFER_BIT | VK_BUFFER_USAGE_TRANSFER_DST_BIT,
+            VK_MEMORY_PROPERTY_DEVICE_LOCAL_BIT,
+            morphedBuffer->buffer,
+            morphedBuffer->bufferMemory
+        );
+
+        auto morphedInfo = "morphed ptr: " + std::to_string(reinterpret_cast<std::uintptr_t>(primitive.get()));
+        std::array<VkBuffer, 2> buffers {
+            model->buffers.at(primitive->morphDelta.value())->buffer,
+            morphedBuffer->buffer,
+        };
+        model->buffers.try_emplace(morphedInfo, std::move(morphedBuffer));
+        primitive->morphedPosition = morphedInfo;
+
+        auto layout = m_context->descriptorSetLayouts.at("storage_morph")->descriptorSetLayout;
 
         VkDescriptorSetAllocateInfo allocInfo {};
         allocInfo.sType              = VK_STRUCTURE_TYPE_DESCRIPTOR_SET_ALLOCATE_INFO;
         allocInfo.descriptorPool     = m_descriptorPool;
-        allocInfo.descriptorSetCount = static_cast<uint32_t>(MAX_FRAMES_IN_FLIGHT);
-        allocInfo.pSetLayouts        = layouts.data();
+        allocInfo.descriptorSetCount = 1;
+        allocInfo.pSetLayouts        = &layout;
 
-        uniform->descriptorSets->descriptorSets.resize(MAX_FRAMES_IN_FLIGHT);
-        if (VK_SUCCESS != vkAllocateDescriptorSets(m_device, &allocInfo, uniform->descriptorSets->descriptorSets.data()))
+        if (VK_SUCCESS != vkAllocateDescriptorSets(m_device, &allocInfo, &primitive->morphDescriptorSet))
         {
             throw std::runtime_error("failed to allocate descriptor sets");
         }
 
-        for (size_t i = 0; i < MAX_FRAMES_IN_FLIGHT; ++i)
+        std::array<VkDescriptorBufferInfo, 2> bufferInfos {};
+        std::array<VkWriteDescriptorSet, 2> descriptorWrites {};
+        for (uint32_t i = 0; i < buffers.size(); ++i)
         {
-            VkDescriptorBufferInfo bufferInfo {};
-            bufferInfo.buffer = uniform->buffers[i];
-            bufferInfo.offset = 0;
-            bufferInfo.range  = sizeof(T);
+            bufferInfos[i].buffer = buffers[i];
+            bufferInfos[i].offset = 0;
+            bufferInfos[i].range  = VK_WHOLE_SIZE;
 
-            VkWriteDescriptorSet descriptorWrite {};
-            descriptorWrite.sType            = VK_STRUCTURE_TYPE_WRITE_DESCRIPTOR_SET;
-            descriptorWrite.dstSet           = uniform->descriptorSets->descriptorSets[i];
-            descriptorWrite.dstBinding       = 0;
-            descriptorWrite.dstArrayElement  = 0;
-            descriptorWrite.descriptorType   = VK_DESCRIPTOR_TYPE_UNIFORM_BUFFER;
-            descriptorWrite.descriptorCount  = 1;
-            descriptorWrite.pBufferInfo      = &bufferInfo;
-            descriptorWrite.pImageInfo       = nullptr;
-            descriptorWrite.pTexelBufferView = nullptr;
+            descriptorWrites[i].sType           = VK_STRUCTURE_TYPE_WRITE_DESCRIPTOR_SET;
+            descriptorWrites[i].dstSet          = primitive->morphDescriptorSet;
+            descriptorWrites[i].dstBinding      = i;
+            descriptorWrites[i].dstArrayElement = 0;
+            descriptorWrites[i].descriptorType  = VK_DESCRIPTOR_TYPE_STORAGE_BUFFER;
+            descriptorWrites[i].descriptorCount = 1;
+            descriptorWrites[i].pBufferInfo     = &bufferInfos[i];
+        }
 
-            vkUpdateDescriptorSets(m_device, 1, &descriptorWrite, 0, nullptr);
+        vkUpdateDescriptorSets(m_device, static_cast<uint32_t>(descriptorWrites.size()), descriptorWrites.data(), 0, nullptr);
+    }
+
+    /// @brief 所有模型加载完成之后，根据蒙皮的总大小创建关节矩阵的环形缓冲
+    void CreateJointPalette()
+    {
+        auto& palette = m_context->jointPalette;
+        if (0 == palette.frameSize)
+        {
+            return;
         }
 
-        return uniform;
+        // 最后一段之后预留一个蒙皮的大小，动态偏移加上描述符的 range 不会超出缓冲
+        auto bufferSize = palette.frameSize * MAX_FRAMES_IN_FLIGHT + palette.maxSkinSize;
+
+        CreateBuffer(
+            bufferSize,
+            VK_BUFFER_USAGE_STORAGE_BUFFER_BIT,
+            VK_MEMORY_PROPERTY_HOST_VISIBLE_BIT | VK_MEMORY_PROPERTY_HOST_COHERENT_BIT,
+            palette.buffer,
+            palette.memory
+        );
+        vkMapMemory(m_device, palette.memory, 0, bufferSize, 0, &palette.mapped);
+
+        auto layout = m_context->descriptorSetLayouts.at("storage_joint_palette")->descriptorSetLayout;
+
+        VkDescriptorSetAllocateInfo allocInfo {};
+        allocInfo.sType              = VK_STRUCTURE_TYPE_DESCRIPTOR_SET_ALLOCATE_INFO;
+        allocInfo.descriptorPool     = m_descriptorPool;
+        allocInfo.descriptorSetCount = 1;
+        allocInfo.pSetLayouts        = &layout;
+
+        if (VK_SUCCESS != vkAllocateDescriptorSets(m_device, &allocInfo, &palette.descriptorSet))
+        {
+            throw std::runtime_error("failed to allocate descriptor sets");
+        }
+
+        VkDescriptorBufferInfo bufferInfo {};
+        bufferInfo.buffer = palette.buffer;
+        bufferInfo.offset = 0;
+        bufferInfo.range  = palette.maxSkinSize;
+
+        VkWriteDescriptorSet descriptorWrite {};
+        descriptorWrite.sType           = VK_STRUCTURE_TYPE_WRITE_DESCRIPTOR_SET;
+        descriptorWrite.dstSet          = palette.descriptorSet;
+        descriptorWrite.dstBinding      = 0;
+        descriptorWrite.dstArrayElement = 0;
+        descriptorWrite.descriptorType  = VK_DESCRIPTOR_TYPE_STORAGE_BUFFER_DYNAMIC;
+        descriptorWrite.descriptorCount = 1;
+        descriptorWrite.pBufferInfo     = &bufferInfo;
+
+        vkUpdateDescriptorSets(m_device, 1, &descriptorWrite, 0, nullptr);
     }
 
     /// @brief 创建描述符池，描述符集需要通过描述符池来创建
     void CreateDescriptorPool()
     {
-        std::array<VkDescriptorPoolSize, 3> poolSizes {};
+        std::array<VkDescriptorPoolSize, 4> poolSizes {};
         poolSizes[0].type            = VK_DESCRIPTOR_TYPE_UNIFORM_BUFFER;
         poolSizes[0].descriptorCount = static_cast<uint32_t>(MAX_FRAMES_IN_FLIGHT) * 100;
         poolSizes[1].type            = VK_DESCRIPTOR_TYPE_COMBINED_IMAGE_SAMPLER;
         poolSizes[1].descriptorCount = static_cast<uint32_t>(MAX_FRAMES_IN_FLIGHT) * 100;
         poolSizes[2].type            = VK_DESCRIPTOR_TYPE_STORAGE_BUFFER;
         poolSizes[2].descriptorCount = static_cast<uint32_t>(MAX_FRAMES_IN_FLIGHT) * 100;
+        poolSizes[3].type            = VK_DESCRIPTOR_TYPE_STORAGE_BUFFER_DYNAMIC;
+        poolSizes[3].descriptorCount = 1;
 
         VkDescriptorPoolCreateInfo poolInfo {};
         poolInfo.sType         = VK_STRUCTURE_TYPE_DESCRIPTOR_POOL_CREATE_INFO;
@@ -6030,6 +7866,7 @@ private:
     /// @param properties
     /// @param image
     /// @param imageMemory
+    /// @param mipLevels
     void CreateImage(
         uint32_t width,
         uint32_t height,
@@ -6038,7 +7875,8 @@ private:
         VkImageUsageFlags usage,
         VkMemoryPropertyFlags properties,
         VkImage& image,
-        VkDeviceMemory& imageMemory
+        VkDeviceMemory& imageMemory,
+        uint32_t mipLevels = 1
     )
 
     {
@@ -6052,7 +7890,7 @@ private:
         imageInfo.extent.width  = static_cast<uint32_t>(width);
         imageInfo.extent.height = static_cast<uint32_t>(height);
         imageInfo.extent.depth  = 1;
-        imageInfo.mipLevels     = 1;
+        imageInfo.mipLevels     = mipLevels;
         imageInfo.arrayLayers   = 1;
         imageInfo.format        = format;
         imageInfo.tiling        = tiling;                    // 设置之后不可修改
@@ -6405,6 +8243,7 @@ private:
     VkPhysicalDevice m_physicalDevice {nullptr};
     VkDevice m_device {nullptr};
     VkQueue m_graphicsQueue {nullptr}; // 图形队列
+    VkQueue m_transferQueue {nullptr}; // 上传模型数据的队列，图形队列族只有一个队列时和 m_graphicsQueue 相同
     VkSurfaceKHR m_surface {nullptr};
     VkQueue m_presentQueue {nullptr};  // 呈现队列
     VkSwapchainKHR m_swapChain {nullptr};
@@ -6441,7 +8280,16 @@ private:
     std::unique_ptr<Context> m_context {std::make_unique<Context>()};
     std::unordered_map<std::string, std::unique_ptr<Model>> m_models {};
 
-    tinygltf::TinyGLTF m_gltfLoader {};
+    ThreadPool m_decodePool {IMAGE_DECODE_THREADS}; // 在 m_filePool 之后析构，解析文件的任务在析构时仍然可以提交解码
+    ThreadPool m_filePool {MODEL_FILE_THREADS};
+    std::vector<LoadingModel> m_loadingModels {};
+    ThreadPool m_animationPool {ANIMATION_THREADS}; // 线程只在构造时创建一次，每一帧只提交任务
+    UploadBatch* m_uploadBatch {nullptr}; // 不为空时缓冲、纹理的复制指令录制到这个批次中
+
+    TextureStreamer m_textureStreamer {};
+    std::vector<std::pair<Model*, std::string>> m_streamedImages {}; // 下标是 TextureStreamer 中的编号，值是模型和 images 的键
+    std::vector<StreamingUpload> m_streamingUploads {};
+    std::vector<StreamingImage> m_retiredImages {}; // 已经被替换的图像，等待所有帧的描述符集更新
 };
 
 int main()
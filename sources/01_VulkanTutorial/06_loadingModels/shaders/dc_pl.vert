@@ -7,23 +7,46 @@ layout(location = 0) out vec3 outWorldPos;
 layout(location = 1) out vec3 outViewPos;
 layout(location = 2) out vec3 outNormal;
 
+// offset 128 是片段着色器使用的相机位置
 layout(push_constant) uniform Pushconstant{
     mat4 view;
     mat4 proj;
+    layout(offset = 144) vec4 dequantizeOffset;
+    vec4 dequantizeScale;
 } PC;
 
 layout(set = 0, binding = 0) uniform UniformBufferObject_0 {
     mat4 model;
 } UBO_Model;
 
+// 顶点属性压缩时法线使用八面体映射，见 VertexPacking.h
+layout(constant_id = 0) const bool PACKED_NORMAL = false;
+
+vec3 DecodeNormal(vec3 normal)
+{
+    if (!PACKED_NORMAL)
+    {
+        return normal;
+    }
+
+    vec3 n = vec3(normal.xy, 1. - abs(normal.x) - abs(normal.y));
+    float t = max(-n.z, 0.);
+    n.x += n.x >= 0. ? -t : t;
+    n.y += n.y >= 0. ? -t : t;
+    return normalize(n);
+}
+
 void main() 
 {
-    vec4 worldPos = UBO_Model.model * vec4(inPos, 1.);
+    // 没有压缩的位置 offset 为 0，scale 为 1
+    vec3 pos = PC.dequantizeOffset.xyz + inPos * PC.dequantizeScale.xyz;
+
+    vec4 worldPos = UBO_Model.model * vec4(pos, 1.);
     vec4 viewPos  = PC.view * worldPos;
 
     gl_Position = PC.proj * viewPos;
 
-    outNormal    = mat3(transpose(inverse(UBO_Model.model))) * inNormal;
+    outNormal    = mat3(transpose(inverse(UBO_Model.model))) * DecodeNormal(inNormal);
     outViewPos   = vec3(viewPos);
     outWorldPos  = vec3(worldPos);
 }
@@ -6,9 +6,12 @@ layout(location = 1) in vec2 inTexCoord;
 layout(location = 0) out vec3 outViewPos;
 layout(location = 1) out vec2 outTexCoord;
 
+// offset 128 是片段着色器使用的相机位置
 layout(push_constant) uniform Pushconstant{
     mat4 view;
     mat4 proj;
+    layout(offset = 144) vec4 dequantizeOffset;
+    vec4 dequantizeScale;
 } PC;
 
 layout(set = 0, binding = 0) uniform UniformBufferObject {
@@ -17,7 +20,10 @@ layout(set = 0, binding = 0) uniform UniformBufferObject {
 
 void main() 
 {
-    vec4 viewPos = PC.view * UBO_Model.model * vec4(inPos, 1.);
+    // 没有压缩的位置 offset 为 0，scale 为 1
+    vec3 pos = PC.dequantizeOffset.xyz + inPos * PC.dequantizeScale.xyz;
+
+    vec4 viewPos = PC.view * UBO_Model.model * vec4(pos, 1.);
     gl_Position  = PC.proj * viewPos;
     outViewPos   = vec3(viewPos);
     outTexCoord  = inTexCoord;
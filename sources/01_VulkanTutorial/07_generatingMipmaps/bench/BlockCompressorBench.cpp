@@ -0,0 +1,114 @@
+#define STB_IMAGE_IMPLEMENTATION
+#include <stb_image.h>
+
+#include "Benchmark.h"
+#include "BlockCompressor.h"
+#include <chrono>
+#include <cmath>
+#include <stdexcept>
+#include <string>
+#include <vector>
+
+namespace {
+constexpr char VikingRoom[] = "../resources/models/viking_room/viking_room.png";
+constexpr char NightSky[]   = "../resources/textures/nightsky.png";
+constexpr char AlphaImage[] = "../resources/textures/alpha.png"; // 只有 8 种颜色，用于检查 alpha 通道
+
+// 每一帧压缩一次整张图片，指标中记录吞吐量（MPix/s）和解码之后相对原图的 PSNR
+template <BlockCompressor::Format Format, BlockCompressor::Quality Quality, const char* ImageName>
+class BlockCompressorScene : public BenchmarkScene
+{
+public:
+    void Setup() override
+    {
+        int width {0}, height {0}, channels {0};
+        auto pixels = stbi_load(ImageName, &width, &height, &channels, STBI_rgb_alpha);
+        if (!pixels)
+        {
+            throw std::runtime_error(std::string("failed to load image: ") + ImageName);
+        }
+
+        m_width  = static_cast<uint32_t>(width);
+        m_height = static_cast<uint32_t>(height);
+        m_pixels.assign(pixels, pixels + static_cast<size_t>(width) * height * 4);
+        stbi_image_free(pixels);
+    }
+
+    void RenderFrame() override
+    {
+        auto start = std::chrono::steady_clock::now();
+        m_blocks   = BlockCompressor::Compress(m_pixels.data(), m_width, m_height, {Format, Quality});
+        m_seconds += std::chrono::duration<double>(std::chrono::steady_clock::now() - start).count();
+        ++m_frames;
+    }
+
+    uint32_t GetFrameLimit() const override
+    {
+        return 10;
+    }
+
+    std::vector<std::pair<std::string, double>> GetMetrics() const override
+    {
+        auto decoded = BlockCompressor::Decompress(m_blocks.data(), m_width, m_height, Format);
+
+        // BC1 不保存 alpha，BC5 只保存 R、G
+        auto channelCount = BlockCompressor::Format::BC1 == Format ? 3u : BlockCompressor::Format::BC5 == Format ? 2u : 4u;
+
+        double squaredError {0.0};
+        for (size_t i = 0; i < m_pixels.size(); ++i)
+        {
+            if (i % 4 < channelCount)
+            {
+                double difference = static_cast<double>(m_pixels[i]) - decoded[i];
+                squaredError += difference * difference;
+            }
+        }
+
+        auto pixelCount = static_cast<double>(m_width) * m_height;
+        auto mse        = squaredError / (pixelCount * channelCount);
+        auto psnr       = mse > 0.0 ? 10.0 * std::log10(255.0 * 255.0 / mse) : 99.0;
+
+        return {
+            {"pixels", pixelCount},
+            {"megapixelsPerSecond", m_seconds > 0.0 ? pixelCount * m_frames / m_seconds / 1e6 : 0.0},
+            {"psnr", psnr},
+            {"bitsPerPixel", static_cast<double>(m_blocks.size()) * 8.0 / pixelCount},
+        };
+    }
+
+private:
+    uint32_t m_width {0};
+    uint32_t m_height {0};
+    std::vector<uint8_t> m_pixels {};
+    std::vector<uint8_t> m_blocks {};
+    double m_seconds {0.0};
+    uint32_t m_frames {0};
+};
+
+using Format  = BlockCompressor::Format;
+using Quality = BlockCompressor::Quality;
+
+using Bc1Fast   = BlockCompressorScene<Format::BC1, Quality::Fast, VikingRoom>;
+using Bc1Normal = BlockCompressorScene<Format::BC1, Quality::Normal, VikingRoom>;
+using Bc1High   = BlockCompressorScene<Format::BC1, Quality::High, VikingRoom>;
+using Bc5Normal = BlockCompressorScene<Format::BC5, Quality::Normal, VikingRoom>;
+using Bc7Fast   = BlockCompressorScene<Format::BC7, Quality::Fast, VikingRoom>;
+using Bc7Normal = BlockCompressorScene<Format::BC7, Quality::Normal, VikingRoom>;
+using Bc7High   = BlockCompressorScene<Format::BC7, Quality::High, VikingRoom>;
+using Bc1Night  = BlockCompressorScene<Format::BC1, Quality::Normal, NightSky>;
+using Bc7Night  = BlockCompressorScene<Format::BC7, Quality::Normal, NightSky>;
+using Bc3Alpha  = BlockCompressorScene<Format::BC3, Quality::Normal, AlphaImage>;
+using Bc7Alpha  = BlockCompressorScene<Format::BC7, Quality::Normal, AlphaImage>;
+} // namespace
+
+BENCHMARK_SCENE(Bc1Fast, "bc1_fast_viking_room");
+BENCHMARK_SCENE(Bc1Normal, "bc1_normal_viking_room");
+BENCHMARK_SCENE(Bc1High, "bc1_high_viking_room");
+BENCHMARK_SCENE(Bc5Normal, "bc5_normal_viking_room");
+BENCHMARK_SCENE(Bc7Fast, "bc7_fast_viking_room");
+BENCHMARK_SCENE(Bc7Normal, "bc7_normal_viking_room");
+BENCHMARK_SCENE(Bc7High, "bc7_high_viking_room");
+BENCHMARK_SCENE(Bc1Night, "bc1_normal_nightsky");
+BENCHMARK_SCENE(Bc7Night, "bc7_normal_nightsky");
+BENCHMARK_SCENE(Bc3Alpha, "bc3_normal_alpha");
+BENCHMARK_SCENE(Bc7Alpha, "bc7_normal_alpha");
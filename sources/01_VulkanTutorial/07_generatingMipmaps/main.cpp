@@ -6,8 +6,6 @@
 #define GLM_FORCE_DEPTH_ZERO_TO_ONE // 透视矩阵深度值范围 [-1, 1] => [0, 1]
 #include <glm/glm.hpp>
 #include <glm/gtc/matrix_transform.hpp>
-#define GLM_ENABLE_EXPERIMENTAL
-#include <glm/gtx/hash.hpp>
 
 #define STB_IMAGE_IMPLEMENTATION
 #include <stb_image.h>
@@ -17,14 +15,21 @@
 
 #include <algorithm>
 #include <array>
+#include <filesystem>
 #include <fstream>
 #include <iostream>
+#include <limits>
 #include <optional>
 #include <set>
+#include <span>
 #include <stdexcept>
-#include <unordered_map>
 #include <vector>
 
+#include "BlockCompressor.h"
+#include "MeshFile.h"
+#include "MipChain.h"
+#include "TextureFile.h"
+
 // 窗口默认大小
 constexpr uint32_t WIDTH  = 800;
 constexpr uint32_t HEIGHT = 600;
@@ -32,6 +37,13 @@ constexpr uint32_t HEIGHT = 600;
 // 同时并行处理的帧数
 constexpr int MAX_FRAMES_IN_FLIGHT = 2;
 
+// 加载 cook 之后的纹理（所有 mip 已经预先生成），false 时加载 png 并在 GPU 上生成 mip
+constexpr bool USE_COOKED_TEXTURE = true;
+
+// 计算着色器一次生成的最大 mip 个数（不包括第 0 级）和一个工作组处理的区域，和 downsample.comp 一致
+constexpr uint32_t DOWNSAMPLE_MAX_MIPS  = 12;
+constexpr uint32_t DOWNSAMPLE_TILE_SIZE = 64;
+
 // 需要开启的校验层的名称
 const std::vector<const char*> g_validationLayers = { "VK_LAYER_KHRONOS_validation" };
 // 交换链扩展
@@ -89,17 +101,6 @@ struct Vertex
     }
 };
 
-namespace std {
-template <>
-struct hash<Vertex>
-{
-    size_t operator()(Vertex const& vertex) const
-    {
-        return ((hash<glm::vec3>()(vertex.pos) ^ (hash<glm::vec3>()(vertex.color) << 1)) >> 1) ^ (hash<glm::vec2>()(vertex.texCoord) << 1);
-    }
-};
-} // namespace std
-
 struct UniformBufferObject
 {
     glm::mat4 model { glm::mat4(1.f) };
@@ -107,6 +108,24 @@ struct UniformBufferObject
     glm::mat4 proj { glm::mat4(1.f) };
 };
 
+/// @brief 生成 mip 时 2x2 个值的归约方式，颜色纹理、泛光链使用平均值，深度金字塔使用最小值或最大值
+enum class DownsampleReduction : uint32_t
+{
+    Average = 0,
+    Min     = 1,
+    Max     = 2,
+};
+
+/// @brief 和 downsample.comp 的 PushConstant 一致
+struct DownsamplePushConstant
+{
+    glm::ivec2 srcSize { 0, 0 };
+    uint32_t mipCount { 0 };
+    uint32_t workGroupCount { 0 };
+    uint32_t reduction { 0 };
+    uint32_t srgb { 0 };
+};
+
 /// @brief 支持图形和呈现的队列族
 struct QueueFamilyIndices
 {
@@ -168,6 +187,7 @@ private:
         CreateDescriptorSetLayout();
         CreateGraphicsPipeline();
         CreateCommandPool();
+        CreateDownsamplePipeline();
         CreateDepthResources();
         CreateFramebuffers();
         CreateTextureImage();
@@ -212,6 +232,14 @@ private:
 
         vkDestroyPipeline(m_device, m_graphicsPipeline, nullptr);
         vkDestroyPipelineLayout(m_device, m_pipelineLayout, nullptr);
+
+        vkDestroyPipeline(m_device, m_downsamplePipeline, nullptr);
+        vkDestroyPipelineLayout(m_device, m_downsamplePipelineLayout, nullptr);
+        vkDestroyDescriptorPool(m_device, m_downsampleDescriptorPool, nullptr);
+        vkDestroyDescriptorSetLayout(m_device, m_downsampleDescriptorSetLayout, nullptr);
+        vkDestroySampler(m_device, m_downsampleSampler, nullptr);
+        vkDestroyBuffer(m_device, m_downsampleBuffer, nullptr);
+        vkFreeMemory(m_device, m_downsampleBufferMemory, nullptr);
         vkDestroyRenderPass(m_device, m_renderPass, nullptr);
 
         for (size_t i = 0; i < MAX_FRAMES_IN_FLIGHT; ++i)
@@ -523,6 +551,16 @@ private:
         VkPhysicalDeviceFeatures deviceFeatures = {};
         deviceFeatures.samplerAnisotropy        = VK_TRUE;
 
+        // 支持时开启 BC 纹理压缩，纹理使用的格式由 SelectTextureFormat 根据格式特性选择
+        VkPhysicalDeviceFeatures supportedFeatures {};
+        vkGetPhysicalDeviceFeatures(m_physicalDevice, &supportedFeatures);
+        deviceFeatures.textureCompressionBC = supportedFeatures.textureCompressionBC;
+
+        // 计算着色器生成 mip 时写入不指定格式的存储图像数组，不支持时使用 vkCmdBlitImage 生成
+        m_downsampleSupported = supportedFeatures.shaderStorageImageWriteWithoutFormat && supportedFeatures.shaderStorageImageArrayDynamicIndexing;
+        deviceFeatures.shaderStorageImageWriteWithoutFormat   = m_downsampleSupported;
+        deviceFeatures.shaderStorageImageArrayDynamicIndexing = m_downsampleSupported;
+
         VkDeviceCreateInfo createInfo      = {};
         createInfo.sType                   = VK_STRUCTURE_TYPE_DEVICE_CREATE_INFO;
         createInfo.queueCreateInfoCount    = static_cast<uint32_t>(queueCreateInfos.size());
@@ -1718,6 +1756,12 @@ private:
 
     void CreateTextureImage()
     {
+        if constexpr (USE_COOKED_TEXTURE)
+        {
+            LoadCookedTexture();
+            return;
+        }
+
         // STBI_rgb_alpha 强制使用alpha通道，如果没有会被添加一个默认的alpha值，texChannels返回图像实际的通道数
         int texWidth { 0 }, texHeight { 0 }, texChannels { 0 };
         auto pixels = stbi_load("../resources/models/viking_room/viking_room.png", &texWidth, &texHeight, &texChannels, STBI_rgb_alpha);
@@ -1746,9 +1790,14 @@ private:
 
         stbi_image_free(pixels);
 
-        CreateImage(texWidth, texHeight, m_mipLevels, VK_FORMAT_R8G8B8A8_SRGB, VK_IMAGE_TILING_OPTIMAL,
-            VK_IMAGE_USAGE_TRANSFER_SRC_BIT | VK_IMAGE_USAGE_TRANSFER_DST_BIT | VK_IMAGE_USAGE_SAMPLED_BIT, VK_MEMORY_PROPERTY_DEVICE_LOCAL_BIT,
-            m_textureImage, m_textureImageMemory);
+        // 优先使用计算着色器生成 mip，此时图像以 UNORM 格式创建（sRGB 格式通常不支持存储图像），采样时使用 sRGB 视图
+        auto computeMipmaps          = CanDownsample(VK_FORMAT_R8G8B8A8_SRGB, texWidth, texHeight, m_mipLevels);
+        auto imageFormat             = computeMipmaps ? GetStorageFormat(VK_FORMAT_R8G8B8A8_SRGB) : VK_FORMAT_R8G8B8A8_SRGB;
+        VkImageUsageFlags imageUsage = VK_IMAGE_USAGE_TRANSFER_SRC_BIT | VK_IMAGE_USAGE_TRANSFER_DST_BIT | VK_IMAGE_USAGE_SAMPLED_BIT;
+
+        CreateImage(texWidth, texHeight, m_mipLevels, imageFormat, VK_IMAGE_TILING_OPTIMAL,
+            computeMipmaps ? imageUsage | VK_IMAGE_USAGE_STORAGE_BIT : imageUsage, VK_MEMORY_PROPERTY_DEVICE_LOCAL_BIT, m_textureImage,
+            m_textureImageMemory, computeMipmaps ? VK_IMAGE_CREATE_MUTABLE_FORMAT_BIT : 0);
 
         // 图像布局的适用场合：
         // VK_IMAGE_LAYOUT_PRESENT_SRC_KHR 适合呈现操作
@@ -1769,7 +1818,164 @@ private:
         vkDestroyBuffer(m_device, stagingBuffer, nullptr);
         vkFreeMemory(m_device, stagingBufferMemory, nullptr);
 
-        GenerateMipmaps(m_textureImage, VK_FORMAT_R8G8B8A8_SRGB, texWidth, texHeight, m_mipLevels);
+        if (computeMipmaps)
+        {
+            GenerateMipmapsCompute(m_textureImage, VK_FORMAT_R8G8B8A8_SRGB, texWidth, texHeight, m_mipLevels);
+        }
+        else
+        {
+            GenerateMipmaps(m_textureImage, VK_FORMAT_R8G8B8A8_SRGB, texWidth, texHeight, m_mipLevels);
+        }
+    }
+
+    /// @brief 加载 cook 之后的纹理：映射文件，整个数据段一次复制到暂存缓冲，每个 mip 一个复制区域，不需要解码，也不需要在 GPU 上生成 mip
+    void LoadCookedTexture()
+    {
+        const std::string imageName  = "../resources/models/viking_room/viking_room.png";
+        const std::string cookedName = "../resources/models/viking_room/viking_room.tex";
+
+        // 和网格一样，没有 cook 过、png 比 cook 之后的文件新或者文件格式不一致时重新 cook
+        auto stale = !std::filesystem::exists(cookedName)
+            || (std::filesystem::exists(imageName) && std::filesystem::last_write_time(imageName) > std::filesystem::last_write_time(cookedName));
+
+        // 换到不支持 BC7 的设备上运行时格式不一致，也会重新 cook
+        m_textureFormat = SelectTextureFormat();
+
+        TextureFile textureFile {};
+        if (stale || !textureFile.Open(cookedName, m_textureFormat))
+        {
+            CookTexture(imageName, cookedName, m_textureFormat);
+
+            if (!textureFile.Open(cookedName, m_textureFormat))
+            {
+                throw std::runtime_error("failed to load texture file: " + cookedName);
+            }
+        }
+
+        const auto& header = textureFile.GetHeader();
+        auto levels        = textureFile.GetLevels();
+        auto data          = textureFile.GetData();
+
+        m_mipLevels = header.levelCount;
+        std::cout << "image extent: " << header.width << '\t' << header.height << "\tmip levels: " << m_mipLevels << '\n';
+
+        // 每个 mip 的偏移在 cook 时按固定值对齐，不满足设备建议的对齐时复制结果仍然正确，只是可能变慢
+        VkPhysicalDeviceProperties properties {};
+        vkGetPhysicalDeviceProperties(m_physicalDevice, &properties);
+        if (0 != header.alignment % properties.limits.optimalBufferCopyOffsetAlignment)
+        {
+            std::cerr << "texture file alignment " << header.alignment << " does not match optimalBufferCopyOffsetAlignment "
+                      << properties.limits.optimalBufferCopyOffsetAlignment << '\n';
+        }
+
+        VkBuffer stagingBuffer {};
+        VkDeviceMemory stagingBufferMemory {};
+
+        CreateBuffer(data.size(), VK_BUFFER_USAGE_TRANSFER_SRC_BIT, VK_MEMORY_PROPERTY_HOST_VISIBLE_BIT | VK_MEMORY_PROPERTY_HOST_COHERENT_BIT,
+            stagingBuffer, stagingBufferMemory);
+
+        // 文件中的数据段就是暂存缓冲的布局，只需要一次复制
+        void* mapped { nullptr };
+        vkMapMemory(m_device, stagingBufferMemory, 0, data.size(), 0, &mapped);
+        std::memcpy(mapped, data.data(), data.size());
+        vkUnmapMemory(m_device, stagingBufferMemory);
+
+        CreateImage(header.width, header.height, m_mipLevels, m_textureFormat, VK_IMAGE_TILING_OPTIMAL,
+            VK_IMAGE_USAGE_TRANSFER_DST_BIT | VK_IMAGE_USAGE_SAMPLED_BIT, VK_MEMORY_PROPERTY_DEVICE_LOCAL_BIT, m_textureImage, m_textureImageMemory);
+
+        std::vector<VkBufferImageCopy> regions(levels.size());
+        for (uint32_t i = 0; i < levels.size(); ++i)
+        {
+            regions[i].bufferOffset                    = levels[i].offset;
+            regions[i].bufferRowLength                 = 0;
+            regions[i].bufferImageHeight               = 0;
+            regions[i].imageSubresource.aspectMask     = VK_IMAGE_ASPECT_COLOR_BIT;
+            regions[i].imageSubresource.mipLevel       = i;
+            regions[i].imageSubresource.baseArrayLayer = 0;
+            regions[i].imageSubresource.layerCount     = header.faceCount;
+            regions[i].imageOffset                     = { 0, 0, 0 };
+            regions[i].imageExtent                     = { levels[i].width, levels[i].height, 1 };
+        }
+
+        // 布局变换、复制所有 mip、变换为着色器读取的布局都记录在同一个指令缓冲中，只提交一次
+        VkCommandBuffer commandBuffer = BeginSingleTimeCommands();
+
+        VkImageMemoryBarrier barrier {};
+        barrier.sType                           = VK_STRUCTURE_TYPE_IMAGE_MEMORY_BARRIER;
+        barrier.oldLayout                       = VK_IMAGE_LAYOUT_UNDEFINED;
+        barrier.newLayout                       = VK_IMAGE_LAYOUT_TRANSFER_DST_OPTIMAL;
+        barrier.srcQueueFamilyIndex             = VK_QUEUE_FAMILY_IGNORED;
+        barrier.dstQueueFamilyIndex             = VK_QUEUE_FAMILY_IGNORED;
+        barrier.image                           = m_textureImage;
+        barrier.subresourceRange.aspectMask     = VK_IMAGE_ASPECT_COLOR_BIT;
+        barrier.subresourceRange.baseMipLevel   = 0;
+        barrier.subresourceRange.levelCount     = m_mipLevels;
+        barrier.subresourceRange.baseArrayLayer = 0;
+        barrier.subresourceRange.layerCount     = header.faceCount;
+        barrier.srcAccessMask                   = 0;
+        barrier.dstAccessMask                   = VK_ACCESS_TRANSFER_WRITE_BIT;
+        vkCmdPipelineBarrier(
+            commandBuffer, VK_PIPELINE_STAGE_TOP_OF_PIPE_BIT, VK_PIPELINE_STAGE_TRANSFER_BIT, 0, 0, nullptr, 0, nullptr, 1, &barrier);
+
+        vkCmdCopyBufferToImage(commandBuffer, stagingBuffer, m_textureImage, VK_IMAGE_LAYOUT_TRANSFER_DST_OPTIMAL,
+            static_cast<uint32_t>(regions.size()), regions.data());
+
+        barrier.oldLayout     = VK_IMAGE_LAYOUT_TRANSFER_DST_OPTIMAL;
+        barrier.newLayout     = VK_IMAGE_LAYOUT_SHADER_READ_ONLY_OPTIMAL;
+        barrier.srcAccessMask = VK_ACCESS_TRANSFER_WRITE_BIT;
+        barrier.dstAccessMask = VK_ACCESS_SHADER_READ_BIT;
+        vkCmdPipelineBarrier(
+            commandBuffer, VK_PIPELINE_STAGE_TRANSFER_BIT, VK_PIPELINE_STAGE_FRAGMENT_SHADER_BIT, 0, 0, nullptr, 0, nullptr, 1, &barrier);
+
+        EndSingleTimeCommands(commandBuffer);
+
+        vkDestroyBuffer(m_device, stagingBuffer, nullptr);
+        vkFreeMemory(m_device, stagingBufferMemory, nullptr);
+    }
+
+    /// @brief 设备支持 BC7 时使用块压缩格式（每个纹素 1 字节，显存和采样带宽是 RGBA8 的 1/4），否则使用未压缩的 RGBA8
+    VkFormat SelectTextureFormat() const noexcept
+    {
+        VkFormatProperties formatProperties {};
+        vkGetPhysicalDeviceFormatProperties(m_physicalDevice, VK_FORMAT_BC7_SRGB_BLOCK, &formatProperties);
+
+        constexpr VkFormatFeatureFlags required = VK_FORMAT_FEATURE_SAMPLED_IMAGE_BIT | VK_FORMAT_FEATURE_SAMPLED_IMAGE_FILTER_LINEAR_BIT;
+        return required == (formatProperties.optimalTilingFeatures & required) ? VK_FORMAT_BC7_SRGB_BLOCK : VK_FORMAT_R8G8B8A8_SRGB;
+    }
+
+    /// @brief 离线预处理：解码 png 并在 CPU 上生成完整的 mip 链（线性空间中求平均），按照上传的顺序写入纹理文件
+    /// @param format VK_FORMAT_BC7_SRGB_BLOCK 时每个 mip 都压缩为 BC7，否则保存 RGBA8
+    static void CookTexture(const std::string& imageName, const std::string& cookedName, VkFormat format)
+    {
+        int texWidth { 0 }, texHeight { 0 }, texChannels { 0 };
+        auto pixels = stbi_load(imageName.c_str(), &texWidth, &texHeight, &texChannels, STBI_rgb_alpha);
+        if (!pixels)
+        {
+            throw std::runtime_error("failed to load texture image");
+        }
+
+        auto width  = static_cast<uint32_t>(texWidth);
+        auto height = static_cast<uint32_t>(texHeight);
+
+        std::vector<std::vector<std::vector<uint8_t>>> faces {};
+        faces.emplace_back(MipChain::Generate(pixels, width, height, 4, true));
+        stbi_image_free(pixels);
+
+        if (VK_FORMAT_BC7_SRGB_BLOCK != format)
+        {
+            TextureFile::Write(cookedName, format, width, height, faces);
+            return;
+        }
+
+        // 在 sRGB 编码之后的值上压缩，和采样时硬件解码的顺序一致
+        constexpr BlockCompressor::Options options { BlockCompressor::Format::BC7, BlockCompressor::Quality::High };
+        auto& levels = faces.front();
+        for (uint32_t level = 0; level < levels.size(); ++level)
+        {
+            levels[level] = BlockCompressor::Compress(levels[level].data(), std::max(width >> level, 1u), std::max(height >> level, 1u), options);
+        }
+
+        TextureFile::Write(cookedName, format, width, height, faces, BlockCompressor::BlockExtent, BlockCompressor::GetBlockSize(options.format));
     }
 
     /// @brief 创建指定格式的图像对象
@@ -1781,8 +1987,9 @@ private:
     /// @param properties
     /// @param image
     /// @param imageMemory
+    /// @param flags 计算着色器生成 mip 时需要 VK_IMAGE_CREATE_MUTABLE_FORMAT_BIT，用 sRGB 视图采样、UNORM 视图写入
     void CreateImage(uint32_t width, uint32_t height, uint32_t mipLevels, VkFormat format, VkImageTiling tiling, VkImageUsageFlags usage,
-        VkMemoryPropertyFlags properties, VkImage& image, VkDeviceMemory& imageMemory)
+        VkMemoryPropertyFlags properties, VkImage& image, VkDeviceMemory& imageMemory, VkImageCreateFlags flags = 0)
 
     {
         // tiling成员变量可以是 VK_IMAGE_TILING_LINEAR 纹素以行主序的方式排列，可以直接访问图像
@@ -1803,7 +2010,7 @@ private:
         imageInfo.usage         = usage;
         imageInfo.sharingMode = VK_SHARING_MODE_EXCLUSIVE; // 只被一个队列族使用（支持传输操作的队列族），所以使用独占模式
         imageInfo.samples = VK_SAMPLE_COUNT_1_BIT;         // 设置多重采样，只对用作附着的图像对象有效
-        imageInfo.flags   = 0; // 可以用来设置稀疏图像的优化，比如体素地形没必要为“空气”部分分配内存
+        imageInfo.flags   = flags; // 可以用来设置稀疏图像的优化，比如体素地形没必要为“空气”部分分配内存
 
         if (VK_SUCCESS != vkCreateImage(m_device, &imageInfo, nullptr, &image))
         {
@@ -1909,7 +2116,7 @@ private:
 
     void CreateTextureImageView()
     {
-        m_textureImageView = CreateImageView(m_textureImage, VK_FORMAT_R8G8B8A8_SRGB, VK_IMAGE_ASPECT_COLOR_BIT, m_mipLevels);
+        m_textureImageView = CreateImageView(m_textureImage, m_textureFormat, VK_IMAGE_ASPECT_COLOR_BIT, m_mipLevels);
     }
 
     VkImageView CreateImageView(VkImage image, VkFormat format, VkImageAspectFlags aspectFlags, uint32_t mipLevels)
@@ -2015,41 +2222,29 @@ private:
 
     void LoadModel()
     {
-        tinyobj::attrib_t attrib {};
-        std::vector<tinyobj::shape_t> shapes {};
-        std::vector<tinyobj::material_t> materials {};
-        std::string warn {}, err {};
+        const std::string objName    = "../resources/models/viking_room/viking_room.obj";
+        const std::string cookedName = "../resources/models/viking_room/viking_room.mesh";
 
-        if (!tinyobj::LoadObj(&attrib, &shapes, &materials, &warn, &err, "../resources/models/viking_room/viking_room.obj"))
-        {
-            throw std::runtime_error(warn + err);
-        }
-
-        std::unordered_map<Vertex, uint32_t> uniqueVertices {};
+        // 没有 cook 过、obj 比 cook 之后的文件新或者文件格式不一致时重新 cook，之后的启动只需要映射文件
+        auto stale = !std::filesystem::exists(cookedName)
+            || (std::filesystem::exists(objName) && std::filesystem::last_write_time(objName) > std::filesystem::last_write_time(cookedName));
 
-        for (const auto& shape : shapes)
+        if (stale || !m_meshFile.Open(cookedName, static_cast<uint32_t>(sizeof(Vertex))))
         {
-            for (const auto& index : shape.mesh.indices)
-            {
-                Vertex vertex {};
-
-                vertex.pos = { attrib.vertices[3 * index.vertex_index + 0], attrib.vertices[3 * index.vertex_index + 1],
-                    attrib.vertices[3 * index.vertex_index + 2] };
-
-                vertex.texCoord = { attrib.texcoords[2 * index.texcoord_index + 0], 1.0f - attrib.texcoords[2 * index.texcoord_index + 1] };
-
-                vertex.color = { 1.0f, 1.0f, 1.0f };
+            auto statistics = MeshFile::Cook<Vertex>(objName, cookedName);
+            std::cout << "ACMR: " << statistics.cacheBefore.acmr << " => " << statistics.cacheAfter.acmr
+                      << "\tvertex fetch: " << statistics.fetchBefore.overfetch << " => " << statistics.fetchAfter.overfetch << '\n';
 
-                if (uniqueVertices.count(vertex) == 0)
-                {
-                    uniqueVertices[vertex] = static_cast<uint32_t>(m_vertices.size());
-                    m_vertices.push_back(vertex);
-                }
-
-                m_indices.push_back(uniqueVertices[vertex]);
+            if (!m_meshFile.Open(cookedName, static_cast<uint32_t>(sizeof(Vertex))))
+            {
+                throw std::runtime_error("failed to load mesh file: " + cookedName);
             }
         }
 
+        // 顶点和索引直接指向映射的内存，创建缓冲时从这里复制到暂存缓冲
+        m_vertices = m_meshFile.GetVertices<Vertex>();
+        m_indices  = m_meshFile.GetIndices();
+
         std::cout << "vertices size: " << m_vertices.size() << "\tindices size: " << m_indices.size() << '\n';
     }
 
@@ -2151,6 +2346,317 @@ private:
         EndSingleTimeCommands(commandBuffer);
     }
 
+    /// @brief 创建单次 dispatch 生成 mip 的计算管线（downsample.comp），设备不支持需要的特性时不创建
+    void CreateDownsamplePipeline()
+    {
+        if (!m_downsampleSupported)
+        {
+            return;
+        }
+
+        VkDescriptorSetLayoutBinding srcBinding = {};
+        srcBinding.binding                      = 0;
+        srcBinding.descriptorType               = VK_DESCRIPTOR_TYPE_COMBINED_IMAGE_SAMPLER;
+        srcBinding.descriptorCount              = 1;
+        srcBinding.stageFlags                   = VK_SHADER_STAGE_COMPUTE_BIT;
+
+        VkDescriptorSetLayoutBinding dstBinding = {};
+        dstBinding.binding                      = 1;
+        dstBinding.descriptorType               = VK_DESCRIPTOR_TYPE_STORAGE_IMAGE;
+        dstBinding.descriptorCount              = DOWNSAMPLE_MAX_MIPS;
+        dstBinding.stageFlags                   = VK_SHADER_STAGE_COMPUTE_BIT;
+
+        VkDescriptorSetLayoutBinding bufferBinding = {};
+        bufferBinding.binding                      = 2;
+        bufferBinding.descriptorType               = VK_DESCRIPTOR_TYPE_STORAGE_BUFFER;
+        bufferBinding.descriptorCount              = 1;
+        bufferBinding.stageFlags                   = VK_SHADER_STAGE_COMPUTE_BIT;
+
+        std::array bindings { srcBinding, dstBinding, bufferBinding };
+
+        VkDescriptorSetLayoutCreateInfo layoutInfo = {};
+        layoutInfo.sType                           = VK_STRUCTURE_TYPE_DESCRIPTOR_SET_LAYOUT_CREATE_INFO;
+        layoutInfo.bindingCount                    = static_cast<uint32_t>(bindings.size());
+        layoutInfo.pBindings                       = bindings.data();
+
+        if (VK_SUCCESS != vkCreateDescriptorSetLayout(m_device, &layoutInfo, nullptr, &m_downsampleDescriptorSetLayout))
+        {
+            throw std::runtime_error("failed to create downsample descriptor set layout");
+        }
+
+        VkPushConstantRange pushConstantRange = {};
+        pushConstantRange.stageFlags          = VK_SHADER_STAGE_COMPUTE_BIT;
+        pushConstantRange.offset              = 0;
+        pushConstantRange.size                = sizeof(DownsamplePushConstant);
+
+        VkPipelineLayoutCreateInfo pipelineLayoutInfo {};
+        pipelineLayoutInfo.sType                  = VK_STRUCTURE_TYPE_PIPELINE_LAYOUT_CREATE_INFO;
+        pipelineLayoutInfo.setLayoutCount         = 1;
+        pipelineLayoutInfo.pSetLayouts            = &m_downsampleDescriptorSetLayout;
+        pipelineLayoutInfo.pushConstantRangeCount = 1;
+        pipelineLayoutInfo.pPushConstantRanges    = &pushConstantRange;
+
+        if (VK_SUCCESS != vkCreatePipelineLayout(m_device, &pipelineLayoutInfo, nullptr, &m_downsamplePipelineLayout))
+        {
+            throw std::runtime_error("failed to create downsample pipeline layout");
+        }
+
+        auto computeShaderCode             = ReadFile("../resources/shaders/01_07_downsample_comp.spv");
+        VkShaderModule computeShaderModule = CreateShaderModule(computeShaderCode);
+
+        VkPipelineShaderStageCreateInfo computeShaderStageInfo {};
+        computeShaderStageInfo.sType  = VK_STRUCTURE_TYPE_PIPELINE_SHADER_STAGE_CREATE_INFO;
+        computeShaderStageInfo.stage  = VK_SHADER_STAGE_COMPUTE_BIT;
+        computeShaderStageInfo.module = computeShaderModule;
+        computeShaderStageInfo.pName  = "main";
+
+        VkComputePipelineCreateInfo pipelineInfo {};
+        pipelineInfo.sType  = VK_STRUCTURE_TYPE_COMPUTE_PIPELINE_CREATE_INFO;
+        pipelineInfo.layout = m_downsamplePipelineLayout;
+        pipelineInfo.stage  = computeShaderStageInfo;
+
+        if (VK_SUCCESS != vkCreateComputePipelines(m_device, VK_NULL_HANDLE, 1, &pipelineInfo, nullptr, &m_downsamplePipeline))
+        {
+            throw std::runtime_error("failed to create downsample pipeline");
+        }
+
+        vkDestroyShaderModule(m_device, computeShaderModule, nullptr);
+
+        // 每次生成 mip 分配一个描述符集，命令执行完成之后重置整个描述符池
+        std::array<VkDescriptorPoolSize, 3> poolSizes {};
+        poolSizes.at(0).type            = VK_DESCRIPTOR_TYPE_COMBINED_IMAGE_SAMPLER;
+        poolSizes.at(0).descriptorCount = 1;
+        poolSizes.at(1).type            = VK_DESCRIPTOR_TYPE_STORAGE_IMAGE;
+        poolSizes.at(1).descriptorCount = DOWNSAMPLE_MAX_MIPS;
+        poolSizes.at(2).type            = VK_DESCRIPTOR_TYPE_STORAGE_BUFFER;
+        poolSizes.at(2).descriptorCount = 1;
+
+        VkDescriptorPoolCreateInfo poolInfo {};
+        poolInfo.sType         = VK_STRUCTURE_TYPE_DESCRIPTOR_POOL_CREATE_INFO;
+        poolInfo.poolSizeCount = static_cast<uint32_t>(poolSizes.size());
+        poolInfo.pPoolSizes    = poolSizes.data();
+        poolInfo.maxSets       = 1;
+
+        if (VK_SUCCESS != vkCreateDescriptorPool(m_device, &poolInfo, nullptr, &m_downsampleDescriptorPool))
+        {
+            throw std::runtime_error("failed to create downsample descriptor pool");
+        }
+
+        // 只使用 texelFetch 读取第 0 级，不需要过滤
+        VkSamplerCreateInfo samplerInfo {};
+        samplerInfo.sType        = VK_STRUCTURE_TYPE_SAMPLER_CREATE_INFO;
+        samplerInfo.magFilter    = VK_FILTER_NEAREST;
+        samplerInfo.minFilter    = VK_FILTER_NEAREST;
+        samplerInfo.mipmapMode   = VK_SAMPLER_MIPMAP_MODE_NEAREST;
+        samplerInfo.addressModeU = VK_SAMPLER_ADDRESS_MODE_CLAMP_TO_EDGE;
+        samplerInfo.addressModeV = VK_SAMPLER_ADDRESS_MODE_CLAMP_TO_EDGE;
+        samplerInfo.addressModeW = VK_SAMPLER_ADDRESS_MODE_CLAMP_TO_EDGE;
+        samplerInfo.maxLod       = 0.f;
+
+        if (VK_SUCCESS != vkCreateSampler(m_device, &samplerInfo, nullptr, &m_downsampleSampler))
+        {
+            throw std::runtime_error("failed to create downsample sampler");
+        }
+
+        // 工作组计数（按 vec4 对齐）和 64x64 个 mip 6 的值，计数只需要在创建时清零一次，之后由最后一个工作组重置
+        VkDeviceSize bufferSize = sizeof(glm::vec4) * (1 + DOWNSAMPLE_TILE_SIZE * DOWNSAMPLE_TILE_SIZE);
+        CreateBuffer(bufferSize, VK_BUFFER_USAGE_STORAGE_BUFFER_BIT | VK_BUFFER_USAGE_TRANSFER_DST_BIT, VK_MEMORY_PROPERTY_DEVICE_LOCAL_BIT,
+            m_downsampleBuffer, m_downsampleBufferMemory);
+
+        VkCommandBuffer commandBuffer = BeginSingleTimeCommands();
+        vkCmdFillBuffer(commandBuffer, m_downsampleBuffer, 0, VK_WHOLE_SIZE, 0);
+        EndSingleTimeCommands(commandBuffer);
+    }
+
+    /// @brief sRGB 格式通常不支持存储图像，写入时使用对应的 UNORM 格式，由着色器编码
+    static constexpr VkFormat GetStorageFormat(VkFormat format) noexcept
+    {
+        switch (format)
+        {
+            case VK_FORMAT_R8G8B8A8_SRGB:
+                return VK_FORMAT_R8G8B8A8_UNORM;
+            case VK_FORMAT_B8G8R8A8_SRGB:
+                return VK_FORMAT_B8G8R8A8_UNORM;
+            case VK_FORMAT_A8B8G8R8_SRGB_PACK32:
+                return VK_FORMAT_A8B8G8R8_UNORM_PACK32;
+            default:
+                return format;
+        }
+    }
+
+    /// @brief 是否可以用计算着色器生成 mip：需要设备特性、格式（或对应的 UNORM 格式）支持存储图像，并且源图像不大于 4096x4096
+    bool CanDownsample(VkFormat format, int32_t width, int32_t height, uint32_t mipLevels) const
+    {
+        auto maxSize = DOWNSAMPLE_TILE_SIZE * DOWNSAMPLE_TILE_SIZE;
+        if (!m_downsamplePipeline || mipLevels < 2 || mipLevels - 1 > DOWNSAMPLE_MAX_MIPS || static_cast<uint32_t>(std::max(width, height)) > maxSize)
+        {
+            return false;
+        }
+
+        VkFormatProperties formatProperties {};
+        vkGetPhysicalDeviceFormatProperties(m_physicalDevice, format, &formatProperties);
+        VkFormatProperties storageProperties {};
+        vkGetPhysicalDeviceFormatProperties(m_physicalDevice, GetStorageFormat(format), &storageProperties);
+
+        return (formatProperties.optimalTilingFeatures & VK_FORMAT_FEATURE_SAMPLED_IMAGE_BIT)
+            && (storageProperties.optimalTilingFeatures & VK_FORMAT_FEATURE_STORAGE_IMAGE_BIT);
+    }
+
+    /// @brief 记录一次 dispatch，把 srcView（第 0 级）降采样到 dstViews（从第 1 级开始，每个视图一个 mip，最多 12 个）
+    /// @details 调用者负责布局变换：srcView 为 VK_IMAGE_LAYOUT_SHADER_READ_ONLY_OPTIMAL，dstViews 为 VK_IMAGE_LAYOUT_GENERAL
+    ///          源和目标可以是不同的图像，例如深度缓冲降采样到 R32 的深度金字塔（Min / Max），或者 HDR 颜色降采样为泛光链
+    ///          多次调用共用中间缓冲，两次 dispatch 之间需要计算着色器到计算着色器的屏障，描述符集在 m_downsampleDescriptorPool 重置之前有效
+    /// @param srgb 为 true 时 dstViews 是 sRGB 图像的 UNORM 视图，在线性空间中归约，写入之前编码
+    void RecordDownsample(VkCommandBuffer commandBuffer, VkImageView srcView, uint32_t srcWidth, uint32_t srcHeight,
+        std::span<const VkImageView> dstViews, DownsampleReduction reduction, bool srgb) const
+    {
+        VkDescriptorSetAllocateInfo allocInfo {};
+        allocInfo.sType              = VK_STRUCTURE_TYPE_DESCRIPTOR_SET_ALLOCATE_INFO;
+        allocInfo.descriptorPool     = m_downsampleDescriptorPool;
+        allocInfo.descriptorSetCount = 1;
+        allocInfo.pSetLayouts        = &m_downsampleDescriptorSetLayout;
+
+        VkDescriptorSet descriptorSet { nullptr };
+        if (VK_SUCCESS != vkAllocateDescriptorSets(m_device, &allocInfo, &descriptorSet))
+        {
+            throw std::runtime_error("failed to allocate downsample descriptor set");
+        }
+
+        VkDescriptorImageInfo srcInfo {};
+        srcInfo.sampler     = m_downsampleSampler;
+        srcInfo.imageView   = srcView;
+        srcInfo.imageLayout = VK_IMAGE_LAYOUT_SHADER_READ_ONLY_OPTIMAL;
+
+        // 数组中的每个元素都必须有效，多余的元素使用最后一个 mip 填充，着色器不会写入它们
+        std::array<VkDescriptorImageInfo, DOWNSAMPLE_MAX_MIPS> dstInfos {};
+        for (size_t i = 0; i < dstInfos.size(); ++i)
+        {
+            dstInfos.at(i).imageView   = dstViews[std::min(i, dstViews.size() - 1)];
+            dstInfos.at(i).imageLayout = VK_IMAGE_LAYOUT_GENERAL;
+        }
+
+        VkDescriptorBufferInfo bufferInfo {};
+        bufferInfo.buffer = m_downsampleBuffer;
+        bufferInfo.offset = 0;
+        bufferInfo.range  = VK_WHOLE_SIZE;
+
+        std::array<VkWriteDescriptorSet, 3> descriptorWrites {};
+        for (uint32_t i = 0; i < descriptorWrites.size(); ++i)
+        {
+            descriptorWrites.at(i).sType      = VK_STRUCTURE_TYPE_WRITE_DESCRIPTOR_SET;
+            descriptorWrites.at(i).dstSet     = descriptorSet;
+            descriptorWrites.at(i).dstBinding = i;
+        }
+
+        descriptorWrites.at(0).descriptorType  = VK_DESCRIPTOR_TYPE_COMBINED_IMAGE_SAMPLER;
+        descriptorWrites.at(0).descriptorCount = 1;
+        descriptorWrites.at(0).pImageInfo      = &srcInfo;
+        descriptorWrites.at(1).descriptorType  = VK_DESCRIPTOR_TYPE_STORAGE_IMAGE;
+        descriptorWrites.at(1).descriptorCount = static_cast<uint32_t>(dstInfos.size());
+        descriptorWrites.at(1).pImageInfo      = dstInfos.data();
+        descriptorWrites.at(2).descriptorType  = VK_DESCRIPTOR_TYPE_STORAGE_BUFFER;
+        descriptorWrites.at(2).descriptorCount = 1;
+        descriptorWrites.at(2).pBufferInfo     = &bufferInfo;
+
+        vkUpdateDescriptorSets(m_device, static_cast<uint32_t>(descriptorWrites.size()), descriptorWrites.data(), 0, nullptr);
+
+        // 每个工作组处理源图像中 64x64 的区域
+        auto groupCountX = (srcWidth + DOWNSAMPLE_TILE_SIZE - 1) / DOWNSAMPLE_TILE_SIZE;
+        auto groupCountY = (srcHeight + DOWNSAMPLE_TILE_SIZE - 1) / DOWNSAMPLE_TILE_SIZE;
+
+        DownsamplePushConstant pushConstant {};
+        pushConstant.srcSize        = glm::ivec2 { srcWidth, srcHeight };
+        pushConstant.mipCount       = static_cast<uint32_t>(dstViews.size());
+        pushConstant.workGroupCount = groupCountX * groupCountY;
+        pushConstant.reduction      = static_cast<uint32_t>(reduction);
+        pushConstant.srgb           = srgb ? 1 : 0;
+
+        vkCmdBindPipeline(commandBuffer, VK_PIPELINE_BIND_POINT_COMPUTE, m_downsamplePipeline);
+        vkCmdBindDescriptorSets(commandBuffer, VK_PIPELINE_BIND_POINT_COMPUTE, m_downsamplePipelineLayout, 0, 1, &descriptorSet, 0, nullptr);
+        vkCmdPushConstants(commandBuffer, m_downsamplePipelineLayout, VK_SHADER_STAGE_COMPUTE_BIT, 0, sizeof(DownsamplePushConstant), &pushConstant);
+        vkCmdDispatch(commandBuffer, groupCountX, groupCountY, 1);
+    }
+
+    /// @brief 使用计算着色器生成所有 mip，只需要一次 dispatch 和前后两个屏障，不要求格式支持线性过滤
+    /// @details 调用之前所有 mip 处于 VK_IMAGE_LAYOUT_TRANSFER_DST_OPTIMAL，第 0 级已经写入，图像使用 GetStorageFormat(imageFormat) 创建
+    /// @param imageFormat 采样使用的格式，sRGB 格式时在线性空间中求平均
+    void GenerateMipmapsCompute(VkImage image, VkFormat imageFormat, int32_t texWidth, int32_t texHeight, uint32_t mipLevels)
+    {
+        auto storageFormat = GetStorageFormat(imageFormat);
+
+        // 第 0 级使用采样格式的视图读取，其余每一级一个存储图像视图
+        std::vector<VkImageView> views {};
+        for (uint32_t i = 0; i < mipLevels; ++i)
+        {
+            VkImageViewCreateInfo viewInfo {};
+            viewInfo.sType                           = VK_STRUCTURE_TYPE_IMAGE_VIEW_CREATE_INFO;
+            viewInfo.image                           = image;
+            viewInfo.viewType                        = VK_IMAGE_VIEW_TYPE_2D;
+            viewInfo.format                          = 0 == i ? imageFormat : storageFormat;
+            viewInfo.subresourceRange.aspectMask     = VK_IMAGE_ASPECT_COLOR_BIT;
+            viewInfo.subresourceRange.baseMipLevel   = i;
+            viewInfo.subresourceRange.levelCount     = 1;
+            viewInfo.subresourceRange.baseArrayLayer = 0;
+            viewInfo.subresourceRange.layerCount     = 1;
+
+            if (VK_SUCCESS != vkCreateImageView(m_device, &viewInfo, nullptr, &views.emplace_back()))
+            {
+                throw std::runtime_error("failed to create downsample image view");
+            }
+        }
+
+        VkCommandBuffer commandBuffer = BeginSingleTimeCommands();
+
+        std::array<VkImageMemoryBarrier, 2> barriers {};
+        for (auto& barrier : barriers)
+        {
+            barrier.sType                           = VK_STRUCTURE_TYPE_IMAGE_MEMORY_BARRIER;
+            barrier.image                           = image;
+            barrier.srcQueueFamilyIndex             = VK_QUEUE_FAMILY_IGNORED;
+            barrier.dstQueueFamilyIndex             = VK_QUEUE_FAMILY_IGNORED;
+            barrier.subresourceRange.aspectMask     = VK_IMAGE_ASPECT_COLOR_BIT;
+            barrier.subresourceRange.baseArrayLayer = 0;
+            barrier.subresourceRange.layerCount     = 1;
+        }
+
+        // 第 0 级等待复制完成之后在计算着色器中读取，其余的 mip 之前的内容不需要保留
+        barriers.at(0).subresourceRange.baseMipLevel = 0;
+        barriers.at(0).subresourceRange.levelCount   = 1;
+        barriers.at(0).oldLayout                     = VK_IMAGE_LAYOUT_TRANSFER_DST_OPTIMAL;
+        barriers.at(0).newLayout                     = VK_IMAGE_LAYOUT_SHADER_READ_ONLY_OPTIMAL;
+        barriers.at(0).srcAccessMask                 = VK_ACCESS_TRANSFER_WRITE_BIT;
+        barriers.at(0).dstAccessMask                 = VK_ACCESS_SHADER_READ_BIT;
+        barriers.at(1).subresourceRange.baseMipLevel = 1;
+        barriers.at(1).subresourceRange.levelCount   = mipLevels - 1;
+        barriers.at(1).oldLayout                     = VK_IMAGE_LAYOUT_UNDEFINED;
+        barriers.at(1).newLayout                     = VK_IMAGE_LAYOUT_GENERAL;
+        barriers.at(1).srcAccessMask                 = 0;
+        barriers.at(1).dstAccessMask                 = VK_ACCESS_SHADER_WRITE_BIT;
+
+        vkCmdPipelineBarrier(commandBuffer, VK_PIPELINE_STAGE_TRANSFER_BIT, VK_PIPELINE_STAGE_COMPUTE_SHADER_BIT, 0, 0, nullptr, 0, nullptr,
+            static_cast<uint32_t>(barriers.size()), barriers.data());
+
+        RecordDownsample(commandBuffer, views.front(), static_cast<uint32_t>(texWidth), static_cast<uint32_t>(texHeight),
+            std::span(views).subspan(1), DownsampleReduction::Average, storageFormat != imageFormat);
+
+        // 生成的 mip 在片段着色器中采样，第 0 级已经是 VK_IMAGE_LAYOUT_SHADER_READ_ONLY_OPTIMAL
+        barriers.at(1).oldLayout     = VK_IMAGE_LAYOUT_GENERAL;
+        barriers.at(1).newLayout     = VK_IMAGE_LAYOUT_SHADER_READ_ONLY_OPTIMAL;
+        barriers.at(1).srcAccessMask = VK_ACCESS_SHADER_WRITE_BIT;
+        barriers.at(1).dstAccessMask = VK_ACCESS_SHADER_READ_BIT;
+
+        vkCmdPipelineBarrier(commandBuffer, VK_PIPELINE_STAGE_COMPUTE_SHADER_BIT, VK_PIPELINE_STAGE_FRAGMENT_SHADER_BIT, 0, 0, nullptr, 0, nullptr, 1,
+            &barriers.at(1));
+
+        EndSingleTimeCommands(commandBuffer);
+
+        vkResetDescriptorPool(m_device, m_downsampleDescriptorPool, 0);
+        for (auto view : views)
+        {
+            vkDestroyImageView(m_device, view, nullptr);
+        }
+    }
+
 private:
     /// @brief 接受调试信息的回调函数
     /// @param messageSeverity 消息的级别：诊断、资源创建、警告、不合法或可能造成崩溃的操作
@@ -2265,6 +2771,7 @@ private:
     VkDescriptorPool m_descriptorPool { nullptr };
     std::vector<VkDescriptorSet> m_descriptorSets {};
     uint32_t m_mipLevels { 0 };
+    VkFormat m_textureFormat { VK_FORMAT_R8G8B8A8_SRGB };
     VkImage m_textureImage { nullptr };
     VkDeviceMemory m_textureImageMemory { nullptr };
     VkImageView m_textureImageView { nullptr };
@@ -2272,8 +2779,17 @@ private:
     VkImage m_depthImage { nullptr };
     VkDeviceMemory m_depthImageMemory { nullptr };
     VkImageView m_depthImageView { nullptr };
-    std::vector<Vertex> m_vertices {};
-    std::vector<uint32_t> m_indices {};
+    bool m_downsampleSupported { false };
+    VkDescriptorSetLayout m_downsampleDescriptorSetLayout { nullptr };
+    VkPipelineLayout m_downsamplePipelineLayout { nullptr };
+    VkPipeline m_downsamplePipeline { nullptr };
+    VkDescriptorPool m_downsampleDescriptorPool { nullptr };
+    VkSampler m_downsampleSampler { nullptr };
+    VkBuffer m_downsampleBuffer { nullptr }; // 工作组计数和 mip 6 的中间结果
+    VkDeviceMemory m_downsampleBufferMemory { nullptr };
+    MeshFile m_meshFile {};
+    std::span<const Vertex> m_vertices {};
+    std::span<const uint32_t> m_indices {};
 };
 
 int main()
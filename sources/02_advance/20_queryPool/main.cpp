@@ -51,6 +51,17 @@ const bool g_enableValidationLayers = false;
 const bool g_enableValidationLayers = true;
 #endif // NDEBUG
 
+// 每个 pass 一个遮挡查询，查询的序号就是 pass 在数组中的序号
+constexpr std::array<const char*, 2> QueryPassNames = { "Cube", "Tetra" };
+
+// 每个 pass 的查询结果，latest 是最近一次可用的结果，total / frames 是平均值
+struct QueryPassResult
+{
+    uint64_t latest { 0 };
+    uint64_t total { 0 };
+    uint64_t frames { 0 };
+};
+
 struct Drawable
 {
     VkBuffer vertexBuffer { nullptr };
@@ -257,7 +268,10 @@ private:
         DestroyDrawable(m_drawablePlane);
         DestroyDrawable(m_drawableTetra);
 
-        vkDestroyQueryPool(m_device, m_queryPool, nullptr);
+        for (auto queryPool : m_queryPools)
+        {
+            vkDestroyQueryPool(m_device, queryPool, nullptr);
+        }
 
         vkDestroyPipeline(m_device, m_graphicsPipeline, nullptr);
         vkDestroyPipelineLayout(m_device, m_pipelineLayout, nullptr);
@@ -303,8 +317,13 @@ private:
         ImGui::NewFrame();
 
         ImGui::Begin("Display Infomation");
-        ImGui::Text("Cube passed samples: %llu", m_passedSamples[0]);
-        ImGui::Text("Tetra passed samples: %llu", m_passedSamples[1]);
+        ImGui::Text("Results are %llu frames late", m_frameNumber - m_resultFrameNumber);
+        for (size_t i = 0; i < QueryPassNames.size(); ++i)
+        {
+            const auto& result = m_passResults.at(i);
+            auto average       = result.frames > 0 ? static_cast<double>(result.total) / static_cast<double>(result.frames) : 0.0;
+            ImGui::Text("%s passed samples: %llu (average %.1f)", QueryPassNames.at(i), result.latest, average);
+        }
         ImGui::End();
 
         ImGui::Render();
@@ -1197,26 +1216,58 @@ private:
         ImGui_ImplVulkan_DestroyFontUploadObjects();
     }
 
-    void GetQueryResult()
+    /// @brief 读取 frameIndex 对应的查询池上一次写入的结果，结果比当前帧晚 MAX_FRAMES_IN_FLIGHT 帧
+    /// @details 不使用 VK_QUERY_RESULT_WAIT_BIT，每个查询的结果后面跟一个可用性的值，不可用的查询直接跳过，CPU 永远不会等待 GPU
+    void GetQueryResult(const size_t frameIndex)
     {
+        // 还没有写入过的查询池不能读取，读取之后清除标记，避免同一帧的结果被统计两次
+        if (!m_queryPoolWritten.at(frameIndex))
+        {
+            return;
+        }
+        m_queryPoolWritten.at(frameIndex) = false;
+
         // 3. 初始查询索引，从这个索引开始读取结果
         // 4. 要读取的查询数量
         // 5. 缓冲区的大小（以字节为单位）
         // 6. 存储结果的指针
-        // 7. 每个查询结果之间的字节跨度
-        // 8. 结果的返回方式和时机
-        vkGetQueryPoolResults(m_device, m_queryPool, 0, 2, sizeof(m_passedSamples), m_passedSamples.data(), sizeof(uint64_t),
-            VK_QUERY_RESULT_64_BIT | VK_QUERY_RESULT_WAIT_BIT);
+        // 7. 每个查询结果之间的字节跨度，[结果, 可用性]
+        // 8. 结果的返回方式和时机，有查询不可用时返回 VK_NOT_READY，不是错误
+        std::array<std::array<uint64_t, 2>, QueryPassNames.size()> results {};
+        vkGetQueryPoolResults(m_device, m_queryPools.at(frameIndex), 0, static_cast<uint32_t>(results.size()), sizeof(results), results.data(),
+            sizeof(results[0]), VK_QUERY_RESULT_64_BIT | VK_QUERY_RESULT_WITH_AVAILABILITY_BIT);
+
+        for (size_t i = 0; i < results.size(); ++i)
+        {
+            const auto [passedSamples, available] = results.at(i);
+            if (0 == available)
+            {
+                continue;
+            }
+
+            auto& result  = m_passResults.at(i);
+            result.latest = passedSamples;
+            result.total += passedSamples;
+            result.frames++;
+        }
+
+        m_resultFrameNumber = m_queryFrameNumbers.at(frameIndex);
     }
 
     void CreateQueryPool()
     {
         VkQueryPoolCreateInfo queryPoolInfo = {};
         queryPoolInfo.sType                 = VK_STRUCTURE_TYPE_QUERY_POOL_CREATE_INFO;
-        queryPoolInfo.queryType             = VK_QUERY_TYPE_OCCLUSION; // 查询类型，包括：遮挡、管线统计、时间戳等
-        queryPoolInfo.queryCount            = 2;                       // 查询池中查询的数量
+        queryPoolInfo.queryType             = VK_QUERY_TYPE_OCCLUSION;                     // 查询类型，包括：遮挡、管线统计、时间戳等
+        queryPoolInfo.queryCount            = static_cast<uint32_t>(QueryPassNames.size()); // 查询池中查询的数量，每个 pass 一个
 
-        vkCreateQueryPool(m_device, &queryPoolInfo, nullptr, &m_queryPool);
+        for (auto& queryPool : m_queryPools)
+        {
+            if (VK_SUCCESS != vkCreateQueryPool(m_device, &queryPoolInfo, nullptr, &queryPool))
+            {
+                throw std::runtime_error("failed to create query pool");
+            }
+        }
     }
 
     /// @brief 创建指令池，用于管理指令缓冲对象使用的内存，并负责指令缓冲对象的分配
@@ -1285,8 +1336,9 @@ private:
 
         // 所有可以记录指令到指令缓冲的函数，函数名都带有一个 vkCmd 前缀
 
-        // 必须在 RenderPass 之外重置
-        vkCmdResetQueryPool(commandBuffer, m_queryPool, 0, 2);
+        // 必须在 RenderPass 之外重置，只重置当前帧的查询池，其他帧的结果仍然可以读取
+        const auto queryPool = m_queryPools.at(m_currentFrame);
+        vkCmdResetQueryPool(commandBuffer, queryPool, 0, static_cast<uint32_t>(QueryPassNames.size()));
 
         // 开始一个渲染流程
         // 1.用于记录指令的指令缓冲对象
@@ -1325,7 +1377,7 @@ private:
         vkCmdBindIndexBuffer(commandBuffer, m_drawablePlane.indexBuffer, 0, VK_INDEX_TYPE_UINT16);
         vkCmdDrawIndexed(commandBuffer, m_drawablePlane.indexCount, 1, 0, 0, 0);
 
-        vkCmdBeginQuery(commandBuffer, m_queryPool, 0, 0);
+        vkCmdBeginQuery(commandBuffer, queryPool, 0, 0);
         {
             // 绘制立方体
             VkBuffer vertexBuffersCube[] = { m_drawableCube.vertexBuffer };
@@ -1333,9 +1385,9 @@ private:
             vkCmdBindIndexBuffer(commandBuffer, m_drawableCube.indexBuffer, 0, VK_INDEX_TYPE_UINT16);
             vkCmdDrawIndexed(commandBuffer, m_drawableCube.indexCount, 1, 0, 0, 0);
         }
-        vkCmdEndQuery(commandBuffer, m_queryPool, 0);
+        vkCmdEndQuery(commandBuffer, queryPool, 0);
 
-        vkCmdBeginQuery(commandBuffer, m_queryPool, 1, 0);
+        vkCmdBeginQuery(commandBuffer, queryPool, 1, 0);
         {
             // 绘制四面体
             VkBuffer vertexBuffersTetra[] = { m_drawableTetra.vertexBuffer };
@@ -1343,7 +1395,7 @@ private:
             vkCmdBindIndexBuffer(commandBuffer, m_drawableTetra.indexBuffer, 0, VK_INDEX_TYPE_UINT16);
             vkCmdDrawIndexed(commandBuffer, m_drawableTetra.indexCount, 1, 0, 0, 0);
         }
-        vkCmdEndQuery(commandBuffer, m_queryPool, 1);
+        vkCmdEndQuery(commandBuffer, queryPool, 1);
 
         // 绘制ImGui
         ImGui_ImplVulkan_RenderDrawData(ImGui::GetDrawData(), commandBuffer);
@@ -1366,6 +1418,9 @@ private:
         // 使用栅栏可以进行CPU与GPU之间的同步，防止超过 MAX_FRAMES_IN_FLIGHT 帧的指令同时被提交执行
         vkWaitForFences(m_device, 1, &m_inFlightFences.at(m_currentFrame), VK_TRUE, std::numeric_limits<uint64_t>::max());
 
+        // 栅栏已经发出信号，MAX_FRAMES_IN_FLIGHT 帧之前写入 m_queryPools[m_currentFrame] 的查询一定已经结束，读取时不会阻塞
+        GetQueryResult(m_currentFrame);
+
         // 从交换链获取一张图像
         uint32_t imageIndex { 0 };
         // 3.获取图像的超时时间，此处禁用图像获取超时
@@ -1393,6 +1448,8 @@ private:
         vkResetFences(m_device, 1, &m_inFlightFences.at(m_currentFrame));
         vkResetCommandBuffer(m_commandBuffers.at(imageIndex), 0);
         RecordCommandBuffer(m_commandBuffers.at(imageIndex), m_swapChainFramebuffers.at(imageIndex));
+        m_queryPoolWritten.at(m_currentFrame)  = true;
+        m_queryFrameNumbers.at(m_currentFrame) = m_frameNumber;
 
         VkPipelineStageFlags waitStages[] = { VK_PIPELINE_STAGE_COLOR_ATTACHMENT_OUTPUT_BIT };
 
@@ -1415,8 +1472,6 @@ private:
             throw std::runtime_error("failed to submit draw command buffer");
         }
 
-        GetQueryResult();
-
         VkPresentInfoKHR presentInfo   = {};
         presentInfo.sType              = VK_STRUCTURE_TYPE_PRESENT_INFO_KHR;
         presentInfo.waitSemaphoreCount = 1;
@@ -1442,6 +1497,7 @@ private:
 
         // 更新当前帧索引
         m_currentFrame = (m_currentFrame + 1) % MAX_FRAMES_IN_FLIGHT;
+        ++m_frameNumber;
     }
 
     /// @brief 创建同步对象，用于发出图像已经被获取可以开始渲染和渲染已经结束可以开始呈现的信号
@@ -2213,7 +2269,11 @@ private:
     VkPipeline m_graphicsPipeline { nullptr };
     std::vector<VkFramebuffer> m_swapChainFramebuffers {};
     VkCommandPool m_commandPool { nullptr };
-    VkQueryPool m_queryPool { nullptr };
+    std::array<VkQueryPool, MAX_FRAMES_IN_FLIGHT> m_queryPools {}; // 每一个同时处理的帧使用一个独立的查询池
+    std::array<bool, MAX_FRAMES_IN_FLIGHT> m_queryPoolWritten {};
+    std::array<uint64_t, MAX_FRAMES_IN_FLIGHT> m_queryFrameNumbers {};
+    uint64_t m_frameNumber { 0 };
+    uint64_t m_resultFrameNumber { 0 }; // 当前显示的查询结果属于哪一帧
     std::vector<VkCommandBuffer> m_commandBuffers {};
     std::vector<VkSemaphore> m_imageAvailableSemaphores {};
     std::vector<VkSemaphore> m_renderFinishedSemaphores {};
@@ -2233,7 +2293,7 @@ private:
     VkDeviceMemory m_depthImageMemory { nullptr };
     VkImageView m_depthImageView { nullptr };
 
-    std::array<uint64_t, 2> m_passedSamples {};
+    std::array<QueryPassResult, QueryPassNames.size()> m_passResults {};
     glm::vec3 m_viewUp { 0.f, 1.f, 0.f };
     glm::vec3 m_eyePos { 0.f, 0.f, -3.f };
     glm::vec3 m_lookAt { 0.f };
@@ -2310,6 +2370,27 @@ const bool g_enableValidationLayers = false;
 const bool g_enableValidationLayers = true;
 #endif // NDEBUG
 
+// 每个 pass 一个管线统计查询，查询的序号就是 pass 在数组中的序号
+constexpr std::array<const char*, 3> QueryPassNames = { "Plane", "Cube", "Tetra" };
+
+// 和 CreateQueryPool 中 pipelineStatistics 的 bit 顺序一致
+constexpr std::array<const char*, 6> PipelineStatisticNames = {
+    "INPUT_ASSEMBLY_VERTICES",     // 输入装配阶段处理的顶点个数
+    "INPUT_ASSEMBLY_PRIMITIVES",   // 输入装配阶段处理的原始图形数量
+    "VERTEX_SHADER_INVOCATIONS",   // 顶点着色器的调用次数
+    "CLIPPING_INVOCATIONS",        // 裁剪阶段处理的原始图形数量
+    "CLIPPING_PRIMITIVES",         // 裁剪阶段输出的原始图形数量
+    "FRAGMENT_SHADER_INVOCATIONS", // 片段着色器的调用次数
+};
+
+// 每个 pass 的查询结果，latest 是最近一次可用的结果，total / frames 是平均值
+struct QueryPassResult
+{
+    std::array<uint64_t, PipelineStatisticNames.size()> latest {};
+    std::array<uint64_t, PipelineStatisticNames.size()> total {};
+    uint64_t frames { 0 };
+};
+
 struct Drawable
 {
     VkBuffer vertexBuffer { nullptr };
@@ -2516,7 +2597,10 @@ private:
         DestroyDrawable(m_drawablePlane);
         DestroyDrawable(m_drawableTetra);
 
-        vkDestroyQueryPool(m_device, m_queryPool, nullptr);
+        for (auto queryPool : m_queryPools)
+        {
+            vkDestroyQueryPool(m_device, queryPool, nullptr);
+        }
 
         vkDestroyPipeline(m_device, m_graphicsPipeline, nullptr);
         vkDestroyPipelineLayout(m_device, m_pipelineLayout, nullptr);
@@ -2562,12 +2646,33 @@ private:
         ImGui::NewFrame();
 
         ImGui::Begin("Display Infomation");
-        ImGui::Text("INPUT_ASSEMBLY_VERTICES: %llu", m_pipelineStats[0]);     // 输入装配阶段处理的顶点个数
-        ImGui::Text("INPUT_ASSEMBLY_PRIMITIVES: %llu", m_pipelineStats[1]);   // 输入装配阶段处理的原始图形数量
-        ImGui::Text("VERTEX_SHADER_INVOCATIONS: %llu", m_pipelineStats[2]);   // 顶点着色器的调用次数
-        ImGui::Text("CLIPPING_INVOCATIONS: %llu", m_pipelineStats[3]);        // 裁剪阶段处理的原始图形数量
-        ImGui::Text("CLIPPING_PRIMITIVES: %llu", m_pipelineStats[4]);         // 裁剪阶段输出的原始图形数量
-        ImGui::Text("FRAGMENT_SHADER_INVOCATIONS: %llu", m_pipelineStats[5]); // 片段着色器的调用次数
+        ImGui::Text("Results are %llu frames late", m_frameNumber - m_resultFrameNumber);
+
+        // 每一行是一个统计项，每一列是一个 pass 最近一次的结果，括号中是平均值
+        if (ImGui::BeginTable("PipelineStatistics", static_cast<int>(QueryPassNames.size()) + 1, ImGuiTableFlags_Borders))
+        {
+            ImGui::TableSetupColumn("");
+            for (auto name : QueryPassNames)
+            {
+                ImGui::TableSetupColumn(name);
+            }
+            ImGui::TableHeadersRow();
+
+            for (size_t i = 0; i < PipelineStatisticNames.size(); ++i)
+            {
+                ImGui::TableNextRow();
+                ImGui::TableNextColumn();
+                ImGui::TextUnformatted(PipelineStatisticNames.at(i));
+                for (const auto& result : m_passResults)
+                {
+                    auto average = result.frames > 0 ? static_cast<double>(result.total.at(i)) / static_cast<double>(result.frames) : 0.0;
+                    ImGui::TableNextColumn();
+                    ImGui::Text("%llu (%.0f)", result.latest.at(i), average);
+                }
+            }
+
+            ImGui::EndTable();
+        }
         ImGui::End();
 
         ImGui::Render();
@@ -3461,29 +3566,66 @@ private:
         ImGui_ImplVulkan_DestroyFontUploadObjects();
     }
 
-    void GetQueryResult()
+    /// @brief 读取 frameIndex 对应的查询池上一次写入的结果，结果比当前帧晚 MAX_FRAMES_IN_FLIGHT 帧
+    /// @details 不使用 VK_QUERY_RESULT_WAIT_BIT，每个查询的结果后面跟一个可用性的值，不可用的查询直接跳过，CPU 永远不会等待 GPU
+    void GetQueryResult(const size_t frameIndex)
     {
+        // 还没有写入过的查询池不能读取，读取之后清除标记，避免同一帧的结果被统计两次
+        if (!m_queryPoolWritten.at(frameIndex))
+        {
+            return;
+        }
+        m_queryPoolWritten.at(frameIndex) = false;
+
         // 3. 初始查询索引，从这个索引开始读取结果
         // 4. 要读取的查询数量
         // 5. 缓冲区的大小（以字节为单位）
         // 6. 存储结果的指针
-        // 7. 每个查询结果之间的字节跨度
-        // 8. 结果的返回方式和时机
-        vkGetQueryPoolResults(m_device, m_queryPool, 0, 1, sizeof(m_pipelineStats), m_pipelineStats.data(), sizeof(uint64_t), VK_QUERY_RESULT_64_BIT);
+        // 7. 每个查询结果之间的字节跨度，一个管线统计查询按照 bit 的顺序写入所有开启的统计项，最后是可用性
+        // 8. 结果的返回方式和时机，有查询不可用时返回 VK_NOT_READY，不是错误
+        std::array<std::array<uint64_t, PipelineStatisticNames.size() + 1>, QueryPassNames.size()> results {};
+        vkGetQueryPoolResults(m_device, m_queryPools.at(frameIndex), 0, static_cast<uint32_t>(results.size()), sizeof(results), results.data(),
+            sizeof(results[0]), VK_QUERY_RESULT_64_BIT | VK_QUERY_RESULT_WITH_AVAILABILITY_BIT);
+
+        for (size_t i = 0; i < results.size(); ++i)
+        {
+            const auto& values = results.at(i);
+            if (0 == values.back())
+            {
+                continue;
+            }
+
+            auto& result = m_passResults.at(i);
+            for (size_t j = 0; j < PipelineStatisticNames.size(); ++j)
+            {
+                result.latest.at(j) = values.at(j);
+                result.total.at(j) += values.at(j);
+            }
+            result.frames++;
+        }
+
+        m_resultFrameNumber = m_queryFrameNumbers.at(frameIndex);
     }
 
     void CreateQueryPool()
     {
+        // 一个管线统计查询包含 pipelineStatistics 中开启的所有统计项，每个 pass 只需要一个查询
         VkQueryPoolCreateInfo queryPoolInfo = {};
         queryPoolInfo.sType                 = VK_STRUCTURE_TYPE_QUERY_POOL_CREATE_INFO;
-        queryPoolInfo.queryType             = VK_QUERY_TYPE_PIPELINE_STATISTICS; // 查询类型，包括：遮挡、管线统计、时间戳等
-        queryPoolInfo.queryCount            = 6;                                 // 查询池中查询的数量
+        queryPoolInfo.queryType             = VK_QUERY_TYPE_PIPELINE_STATISTICS;             // 查询类型，包括：遮挡、管线统计、时间戳等
+        queryPoolInfo.queryCount            = static_cast<uint32_t>(QueryPassNames.size()); // 查询池中查询的数量
         queryPoolInfo.pipelineStatistics    = VK_QUERY_PIPELINE_STATISTIC_INPUT_ASSEMBLY_VERTICES_BIT
             | VK_QUERY_PIPELINE_STATISTIC_INPUT_ASSEMBLY_PRIMITIVES_BIT | VK_QUERY_PIPELINE_STATISTIC_VERTEX_SHADER_INVOCATIONS_BIT
             | VK_QUERY_PIPELINE_STATISTIC_CLIPPING_INVOCATIONS_BIT | VK_QUERY_PIPELINE_STATISTIC_CLIPPING_PRIMITIVES_BIT
             | VK_QUERY_PIPELINE_STATISTIC_FRAGMENT_SHADER_INVOCATIONS_BIT;
 
-        vkCreateQueryPool(m_device, &queryPoolInfo, nullptr, &m_queryPool);
+        for (auto& queryPool : m_queryPools)
+        {
+            if (VK_SUCCESS != vkCreateQueryPool(m_device, &queryPoolInfo, nullptr, &queryPool))
+            {
+                throw std::runtime_error("failed to create query pool");
+            }
+        }
     }
 
     /// @brief 创建指令池，用于管理指令缓冲对象使用的内存，并负责指令缓冲对象的分配
@@ -3552,8 +3694,9 @@ private:
 
         // 所有可以记录指令到指令缓冲的函数，函数名都带有一个 vkCmd 前缀
 
-        // 必须在 RenderPass 之外重置
-        vkCmdResetQueryPool(commandBuffer, m_queryPool, 0, static_cast<uint32_t>(m_pipelineStats.size()));
+        // 必须在 RenderPass 之外重置，只重置当前帧的查询池，其他帧的结果仍然可以读取
+        const auto queryPool = m_queryPools.at(m_currentFrame);
+        vkCmdResetQueryPool(commandBuffer, queryPool, 0, static_cast<uint32_t>(QueryPassNames.size()));
 
         // 开始一个渲染流程
         // 1.用于记录指令的指令缓冲对象
@@ -3586,27 +3729,36 @@ private:
 
         VkDeviceSize offsets[] = { 0 };
 
-        vkCmdBeginQuery(commandBuffer, m_queryPool, 0, 0);
+        // 每个 pass 使用一个查询，分别统计
+        vkCmdBeginQuery(commandBuffer, queryPool, 0, 0);
         {
             // 绘制平面
             VkBuffer vertexBuffersPlane[] = { m_drawablePlane.vertexBuffer };
             vkCmdBindVertexBuffers(commandBuffer, 0, 1, vertexBuffersPlane, offsets);
             vkCmdBindIndexBuffer(commandBuffer, m_drawablePlane.indexBuffer, 0, VK_INDEX_TYPE_UINT16);
             vkCmdDrawIndexed(commandBuffer, m_drawablePlane.indexCount, 1, 0, 0, 0);
+        }
+        vkCmdEndQuery(commandBuffer, queryPool, 0);
 
+        vkCmdBeginQuery(commandBuffer, queryPool, 1, 0);
+        {
             // 绘制立方体
             VkBuffer vertexBuffersCube[] = { m_drawableCube.vertexBuffer };
             vkCmdBindVertexBuffers(commandBuffer, 0, 1, vertexBuffersCube, offsets);
             vkCmdBindIndexBuffer(commandBuffer, m_drawableCube.indexBuffer, 0, VK_INDEX_TYPE_UINT16);
             vkCmdDrawIndexed(commandBuffer, m_drawableCube.indexCount, 1, 0, 0, 0);
+        }
+        vkCmdEndQuery(commandBuffer, queryPool, 1);
 
+        vkCmdBeginQuery(commandBuffer, queryPool, 2, 0);
+        {
             // 绘制四面体
             VkBuffer vertexBuffersTetra[] = { m_drawableTetra.vertexBuffer };
             vkCmdBindVertexBuffers(commandBuffer, 0, 1, vertexBuffersTetra, offsets);
             vkCmdBindIndexBuffer(commandBuffer, m_drawableTetra.indexBuffer, 0, VK_INDEX_TYPE_UINT16);
             vkCmdDrawIndexed(commandBuffer, m_drawableTetra.indexCount, 1, 0, 0, 0);
         }
-        vkCmdEndQuery(commandBuffer, m_queryPool, 0);
+        vkCmdEndQuery(commandBuffer, queryPool, 2);
 
         // 绘制ImGui
         ImGui_ImplVulkan_RenderDrawData(ImGui::GetDrawData(), commandBuffer);
@@ -3629,6 +3781,9 @@ private:
         // 使用栅栏可以进行CPU与GPU之间的同步，防止超过 MAX_FRAMES_IN_FLIGHT 帧的指令同时被提交执行
         vkWaitForFences(m_device, 1, &m_inFlightFences.at(m_currentFrame), VK_TRUE, std::numeric_limits<uint64_t>::max());
 
+        // 栅栏已经发出信号，MAX_FRAMES_IN_FLIGHT 帧之前写入 m_queryPools[m_currentFrame] 的查询一定已经结束，读取时不会阻塞
+        GetQueryResult(m_currentFrame);
+
         // 从交换链获取一张图像
         uint32_t imageIndex { 0 };
         // 3.获取图像的超时时间，此处禁用图像获取超时
@@ -3656,6 +3811,8 @@ private:
         vkResetFences(m_device, 1, &m_inFlightFences.at(m_currentFrame));
         vkResetCommandBuffer(m_commandBuffers.at(imageIndex), 0);
         RecordCommandBuffer(m_commandBuffers.at(imageIndex), m_swapChainFramebuffers.at(imageIndex));
+        m_queryPoolWritten.at(m_currentFrame)  = true;
+        m_queryFrameNumbers.at(m_currentFrame) = m_frameNumber;
 
         VkPipelineStageFlags waitStages[] = { VK_PIPELINE_STAGE_COLOR_ATTACHMENT_OUTPUT_BIT };
 
@@ -3678,8 +3835,6 @@ private:
             throw std::runtime_error("failed to submit draw command buffer");
         }
 
-        GetQueryResult();
-
         VkPresentInfoKHR presentInfo   = {};
         presentInfo.sType              = VK_STRUCTURE_TYPE_PRESENT_INFO_KHR;
         presentInfo.waitSemaphoreCount = 1;
@@ -3705,6 +3860,7 @@ private:
 
         // 更新当前帧索引
         m_currentFrame = (m_currentFrame + 1) % MAX_FRAMES_IN_FLIGHT;
+        ++m_frameNumber;
     }
 
     /// @brief 创建同步对象，用于发出图像已经被获取可以开始渲染和渲染已经结束可以开始呈现的信号
@@ -4476,7 +4632,11 @@ private:
     VkPipeline m_graphicsPipeline { nullptr };
     std::vector<VkFramebuffer> m_swapChainFramebuffers {};
     VkCommandPool m_commandPool { nullptr };
-    VkQueryPool m_queryPool { nullptr };
+    std::array<VkQueryPool, MAX_FRAMES_IN_FLIGHT> m_queryPools {}; // 每一个同时处理的帧使用一个独立的查询池
+    std::array<bool, MAX_FRAMES_IN_FLIGHT> m_queryPoolWritten {};
+    std::array<uint64_t, MAX_FRAMES_IN_FLIGHT> m_queryFrameNumbers {};
+    uint64_t m_frameNumber { 0 };
+    uint64_t m_resultFrameNumber { 0 }; // 当前显示的查询结果属于哪一帧
     std::vector<VkCommandBuffer> m_commandBuffers {};
     std::vector<VkSemaphore> m_imageAvailableSemaphores {};
     std::vector<VkSemaphore> m_renderFinishedSemaphores {};
@@ -4496,7 +4656,7 @@ private:
     VkDeviceMemory m_depthImageMemory { nullptr };
     VkImageView m_depthImageView { nullptr };
 
-    std::array<uint64_t, 6> m_pipelineStats {};
+    std::array<QueryPassResult, QueryPassNames.size()> m_passResults {};
     glm::vec3 m_viewUp { 0.f, 1.f, 0.f };
     glm::vec3 m_eyePos { 0.f, 0.f, -3.f };
     glm::vec3 m_lookAt { 0.f };
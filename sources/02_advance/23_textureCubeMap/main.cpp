@@ -18,14 +18,20 @@
 
 #include <algorithm>
 #include <array>
+#include <filesystem>
 #include <fstream>
 #include <iostream>
 #include <numbers>
 #include <optional>
 #include <set>
+#include <span>
 #include <stdexcept>
 #include <vector>
 
+#include "BlockCompressor.h"
+#include "MipChain.h"
+#include "TextureFile.h"
+
 // 窗口默认大小
 constexpr uint32_t WIDTH  = 800;
 constexpr uint32_t HEIGHT = 600;
@@ -130,6 +136,8 @@ struct Texture
     VkImage image {nullptr};
     VkDeviceMemory memory {nullptr};
     VkImageView imageView {nullptr};
+    uint32_t mipLevels {1};
+    VkFormat format {VK_FORMAT_R8G8B8A8_SRGB};
 };
 
 class HelloTriangleApplication
@@ -295,7 +303,7 @@ private:
         samplerInfo.mipmapMode              = VK_SAMPLER_MIPMAP_MODE_LINEAR;    // 设置分级细化，可以看作是过滤操作的一种
         samplerInfo.mipLodBias              = 0.f;
         samplerInfo.minLod                  = 0.f;
-        samplerInfo.maxLod                  = 0.f;
+        samplerInfo.maxLod                  = VK_LOD_CLAMP_NONE; // 由图像视图限制可用的 mip
 
         if (VK_SUCCESS != vkCreateSampler(m_device, &samplerInfo, nullptr, &sampler))
         {
@@ -303,24 +311,27 @@ private:
         }
     }
 
-    std::array<std::tuple<VkBuffer, VkDeviceMemory, uint32_t, uint32_t>, 6> LoadCubeMap()
+    /// @brief 天空盒不透明，设备支持时使用 BC1（每个纹素 4 位，是 RGBA8 的 1/8），否则使用未压缩的 RGBA8
+    VkFormat SelectTextureFormat() const noexcept
     {
-        std::array<std::string, 6> cubeTextureNames {
-            "../resources/textures/skybox/skybox_right.jpg",
-            "../resources/textures/skybox/skybox_left.jpg",
-            "../resources/textures/skybox/skybox_top.jpg",
-            "../resources/textures/skybox/skybox_bottom.jpg",
-            "../resources/textures/skybox/skybox_front.jpg",
-            "../resources/textures/skybox/skybox_back.jpg",
-        };
+        VkFormatProperties formatProperties {};
+        vkGetPhysicalDeviceFormatProperties(m_physicalDevice, VK_FORMAT_BC1_RGB_SRGB_BLOCK, &formatProperties);
 
-        std::array<std::tuple<VkBuffer, VkDeviceMemory, uint32_t, uint32_t>, 6> retVal {};
+        constexpr VkFormatFeatureFlags required = VK_FORMAT_FEATURE_SAMPLED_IMAGE_BIT | VK_FORMAT_FEATURE_SAMPLED_IMAGE_FILTER_LINEAR_BIT;
+        return required == (formatProperties.optimalTilingFeatures & required) ? VK_FORMAT_BC1_RGB_SRGB_BLOCK : VK_FORMAT_R8G8B8A8_SRGB;
+    }
+
+    /// @brief 离线预处理：解码 6 张图片并生成完整的 mip 链，按照上传的顺序写入纹理文件
+    /// @param format VK_FORMAT_BC1_RGB_SRGB_BLOCK 时每个面的每个 mip 都压缩为 BC1，否则保存 RGBA8
+    static void CookCubeMap(std::span<const std::string> faceNames, const std::string& cookedName, VkFormat format)
+    {
+        std::vector<std::vector<std::vector<uint8_t>>> faces {};
 
         int width {0}, height {0};
-        for (uint32_t i = 0; i < 6; ++i)
+        for (const auto& faceName : faceNames)
         {
             int texWidth {0}, texHeight {0}, texChannels {0};
-            auto pixels = stbi_load(cubeTextureNames[i].c_str(), &texWidth, &texHeight, &texChannels, STBI_rgb_alpha);
+            auto pixels = stbi_load(faceName.c_str(), &texWidth, &texHeight, &texChannels, STBI_rgb_alpha);
 
             if (width == 0 && height == 0)
             {
@@ -334,64 +345,147 @@ private:
                 throw std::runtime_error("failed to load texture image");
             }
 
-            VkDeviceSize imageSize = texWidth * texHeight * 4;
-
-            VkBuffer stagingBuffer {};
-            VkDeviceMemory stagingBufferMemory {};
-
-            CreateBuffer(
-                imageSize,
-                VK_BUFFER_USAGE_TRANSFER_SRC_BIT,
-                VK_MEMORY_PROPERTY_HOST_VISIBLE_BIT | VK_MEMORY_PROPERTY_HOST_COHERENT_BIT,
-                stagingBuffer,
-                stagingBufferMemory
-            );
-
-            void* data {nullptr};
-            vkMapMemory(m_device, stagingBufferMemory, 0, imageSize, 0, &data);
-            std::memcpy(data, pixels, static_cast<size_t>(imageSize));
-            vkUnmapMemory(m_device, stagingBufferMemory);
-
+            faces.emplace_back(MipChain::Generate(pixels, static_cast<uint32_t>(width), static_cast<uint32_t>(height), 4, true));
             stbi_image_free(pixels);
+        }
 
-            retVal[i] = std::forward_as_tuple(stagingBuffer, stagingBufferMemory, static_cast<uint32_t>(width), static_cast<uint32_t>(height));
+        if (VK_FORMAT_BC1_RGB_SRGB_BLOCK != format)
+        {
+            TextureFile::Write(cookedName, format, static_cast<uint32_t>(width), static_cast<uint32_t>(height), faces);
+            return;
         }
 
-        return retVal;
+        constexpr BlockCompressor::Options options {BlockCompressor::Format::BC1, BlockCompressor::Quality::Normal};
+        for (auto& levels : faces)
+        {
+            for (uint32_t level = 0; level < levels.size(); ++level)
+            {
+                auto levelWidth  = std::max(static_cast<uint32_t>(width) >> level, 1u);
+                auto levelHeight = std::max(static_cast<uint32_t>(height) >> level, 1u);
+                levels[level]    = BlockCompressor::Compress(levels[level].data(), levelWidth, levelHeight, options);
+            }
+        }
+
+        TextureFile::Write(
+            cookedName,
+            format,
+            static_cast<uint32_t>(width),
+            static_cast<uint32_t>(height),
+            faces,
+            BlockCompressor::BlockExtent,
+            BlockCompressor::GetBlockSize(options.format)
+        );
     }
 
+    /// @brief 加载 cook 之后的立方体贴图，第一次运行或者图片更新之后重新 cook
+    /// @details 文件的数据段一次复制到暂存缓冲，每个 mip 一个复制区域，同时复制 6 个面
     void CreateTexture(Texture& texture)
     {
-        auto cubeMap = LoadCubeMap();
-        auto width   = std::get<2>(cubeMap.front());
-        auto height  = std::get<3>(cubeMap.front());
+        const std::array<std::string, 6> cubeTextureNames {
+            "../resources/textures/skybox/skybox_right.jpg",
+            "../resources/textures/skybox/skybox_left.jpg",
+            "../resources/textures/skybox/skybox_top.jpg",
+            "../resources/textures/skybox/skybox_bottom.jpg",
+            "../resources/textures/skybox/skybox_front.jpg",
+            "../resources/textures/skybox/skybox_back.jpg",
+        };
+        const std::string cookedName = "../resources/textures/skybox/skybox.tex";
+
+        auto stale = !std::filesystem::exists(cookedName);
+        for (const auto& name : cubeTextureNames)
+        {
+            stale = stale || (std::filesystem::exists(name) && std::filesystem::last_write_time(name) > std::filesystem::last_write_time(cookedName));
+        }
+
+        texture.format = SelectTextureFormat();
+
+        TextureFile textureFile {};
+        if (stale || !textureFile.Open(cookedName, texture.format) || 6 != textureFile.GetHeader().faceCount)
+        {
+            CookCubeMap(cubeTextureNames, cookedName, texture.format);
+
+            if (!textureFile.Open(cookedName, texture.format))
+            {
+                throw std::runtime_error("failed to load texture file: " + cookedName);
+            }
+        }
+
+        const auto& header = textureFile.GetHeader();
+        auto levels        = textureFile.GetLevels();
+        auto data          = textureFile.GetData();
+        texture.mipLevels  = header.levelCount;
+
+        // 每个 mip 的偏移在 cook 时按固定值对齐，不满足设备建议的对齐时复制结果仍然正确，只是可能变慢
+        VkPhysicalDeviceProperties properties {};
+        vkGetPhysicalDeviceProperties(m_physicalDevice, &properties);
+        if (0 != header.alignment % properties.limits.optimalBufferCopyOffsetAlignment)
+        {
+            std::cerr << "texture file alignment " << header.alignment << " does not match optimalBufferCopyOffsetAlignment "
+                      << properties.limits.optimalBufferCopyOffsetAlignment << '\n';
+        }
+
+        VkBuffer stagingBuffer {};
+        VkDeviceMemory stagingBufferMemory {};
+
+        CreateBuffer(
+            data.size(),
+            VK_BUFFER_USAGE_TRANSFER_SRC_BIT,
+            VK_MEMORY_PROPERTY_HOST_VISIBLE_BIT | VK_MEMORY_PROPERTY_HOST_COHERENT_BIT,
+            stagingBuffer,
+            stagingBufferMemory
+        );
+
+        void* mapped {nullptr};
+        vkMapMemory(m_device, stagingBufferMemory, 0, data.size(), 0, &mapped);
+        std::memcpy(mapped, data.data(), data.size());
+        vkUnmapMemory(m_device, stagingBufferMemory);
 
         CreateImage(
-            width,
-            height,
-            VK_FORMAT_R8G8B8A8_SRGB,
+            header.width,
+            header.height,
+            texture.format,
             VK_IMAGE_TILING_OPTIMAL,
             VK_IMAGE_USAGE_TRANSFER_DST_BIT | VK_IMAGE_USAGE_SAMPLED_BIT,
             VK_MEMORY_PROPERTY_DEVICE_LOCAL_BIT,
             texture.image,
             texture.memory,
-            true
+            true,
+            texture.mipLevels
         );
 
-        TransitionImageLayout(texture.image, VK_FORMAT_R8G8B8A8_SRGB, VK_IMAGE_LAYOUT_UNDEFINED, VK_IMAGE_LAYOUT_TRANSFER_DST_OPTIMAL, true);
-        for (uint32_t i = 0; i < 6; ++i)
+        // 同一个 mip 的 6 个面在文件中紧密排列，一个复制区域就可以覆盖所有的面
+        std::vector<VkBufferImageCopy> regions(levels.size());
+        for (uint32_t i = 0; i < levels.size(); ++i)
         {
-            CopyBufferToImage(std::get<0>(cubeMap[i]), texture.image, width, height, i);
-
-            vkDestroyBuffer(m_device, std::get<0>(cubeMap[i]), nullptr);
-            vkFreeMemory(m_device, std::get<1>(cubeMap[i]), nullptr);
+            regions[i].bufferOffset                    = levels[i].offset;
+            regions[i].bufferRowLength                 = 0;
+            regions[i].bufferImageHeight               = 0;
+            regions[i].imageSubresource.aspectMask     = VK_IMAGE_ASPECT_COLOR_BIT;
+            regions[i].imageSubresource.mipLevel       = i;
+            regions[i].imageSubresource.baseArrayLayer = 0;
+            regions[i].imageSubresource.layerCount     = header.faceCount;
+            regions[i].imageOffset                     = {0, 0, 0};
+            regions[i].imageExtent                     = {levels[i].width, levels[i].height, 1};
         }
 
         TransitionImageLayout(
-            texture.image, VK_FORMAT_R8G8B8A8_SRGB, VK_IMAGE_LAYOUT_TRANSFER_DST_OPTIMAL, VK_IMAGE_LAYOUT_SHADER_READ_ONLY_OPTIMAL, true
+            texture.image, texture.format, VK_IMAGE_LAYOUT_UNDEFINED, VK_IMAGE_LAYOUT_TRANSFER_DST_OPTIMAL, true, texture.mipLevels
+        );
+        CopyBufferToImage(stagingBuffer, texture.image, regions);
+        TransitionImageLayout(
+            texture.image,
+            texture.format,
+            VK_IMAGE_LAYOUT_TRANSFER_DST_OPTIMAL,
+            VK_IMAGE_LAYOUT_SHADER_READ_ONLY_OPTIMAL,
+            true,
+            texture.mipLevels
         );
 
-        texture.imageView = CreateImageView(texture.image, VK_FORMAT_R8G8B8A8_SRGB, VK_IMAGE_ASPECT_COLOR_BIT, VK_IMAGE_VIEW_TYPE_CUBE);
+        vkDestroyBuffer(m_device, stagingBuffer, nullptr);
+        vkFreeMemory(m_device, stagingBufferMemory, nullptr);
+
+        texture.imageView
+            = CreateImageView(texture.image, texture.format, VK_IMAGE_ASPECT_COLOR_BIT, VK_IMAGE_VIEW_TYPE_CUBE, texture.mipLevels);
     }
 
     VkCommandBuffer BeginSingleTimeCommands() const noexcept
@@ -428,26 +522,18 @@ private:
         vkFreeCommandBuffers(m_device, m_commandPool, 1, &commandBuffer);
     }
 
-    void CopyBufferToImage(VkBuffer buffer, VkImage image, uint32_t widht, uint32_t height, uint32_t layer)
+    void CopyBufferToImage(VkBuffer buffer, VkImage image, std::span<const VkBufferImageCopy> regions)
     {
         VkCommandBuffer commandBuffer = BeginSingleTimeCommands();
-
-        VkBufferImageCopy region {};
-        region.bufferOffset                    = 0;
-        region.bufferRowLength                 = 0;
-        region.bufferImageHeight               = 0;
-        region.imageSubresource.aspectMask     = VK_IMAGE_ASPECT_COLOR_BIT;
-        region.imageSubresource.mipLevel       = 0;
-        region.imageSubresource.baseArrayLayer = layer;
-        region.imageSubresource.layerCount     = 1;
-        region.imageOffset                     = {0, 0, 0};
-        region.imageExtent                     = {widht, height, 1};
-
-        vkCmdCopyBufferToImage(commandBuffer, buffer, image, VK_IMAGE_LAYOUT_TRANSFER_DST_OPTIMAL, 1, &region);
+        vkCmdCopyBufferToImage(
+            commandBuffer, buffer, image, VK_IMAGE_LAYOUT_TRANSFER_DST_OPTIMAL, static_cast<uint32_t>(regions.size()), regions.data()
+        );
         EndSingleTimeCommands(commandBuffer);
     }
 
-    void TransitionImageLayout(VkImage image, VkFormat format, VkImageLayout oldLayout, VkImageLayout newLayout, bool cubeMap = false)
+    void TransitionImageLayout(
+        VkImage image, VkFormat format, VkImageLayout oldLayout, VkImageLayout newLayout, bool cubeMap = false, uint32_t mipLevels = 1
+    )
     {
         VkCommandBuffer commandBuffer = BeginSingleTimeCommands();
 
@@ -460,7 +546,7 @@ private:
         barrier.image                           = image;
         barrier.subresourceRange.aspectMask     = VK_IMAGE_ASPECT_COLOR_BIT; // 设置布局变换影响的范围
         barrier.subresourceRange.baseMipLevel   = 0;
-        barrier.subresourceRange.levelCount     = 1;
+        barrier.subresourceRange.levelCount     = mipLevels;
         barrier.subresourceRange.baseArrayLayer = 0;
         barrier.subresourceRange.layerCount     = cubeMap ? 6 : 1;
         barrier.srcAccessMask                   = 0;
@@ -855,6 +941,11 @@ private:
         // 指定应用程序使用的设备特性（例如几何着色器）
         VkPhysicalDeviceFeatures deviceFeatures = {};
 
+        // 支持时开启 BC 纹理压缩，天空盒使用 BC1
+        VkPhysicalDeviceFeatures supportedFeatures {};
+        vkGetPhysicalDeviceFeatures(m_physicalDevice, &supportedFeatures);
+        deviceFeatures.textureCompressionBC = supportedFeatures.textureCompressionBC;
+
         VkDeviceCreateInfo createInfo      = {};
         createInfo.sType                   = VK_STRUCTURE_TYPE_DEVICE_CREATE_INFO;
         createInfo.queueCreateInfoCount    = static_cast<uint32_t>(queueCreateInfos.size());
@@ -1863,7 +1954,9 @@ private:
         vkFreeCommandBuffers(m_device, m_commandPool, 1, &commandBuffer);
     }
 
-    VkImageView CreateImageView(VkImage image, VkFormat format, VkImageAspectFlags aspectFlags, VkImageViewType type = VK_IMAGE_VIEW_TYPE_2D)
+    VkImageView CreateImageView(
+        VkImage image, VkFormat format, VkImageAspectFlags aspectFlags, VkImageViewType type = VK_IMAGE_VIEW_TYPE_2D, uint32_t mipLevels = 1
+    )
     {
         VkImageViewCreateInfo viewInfo {};
         viewInfo.sType                           = VK_STRUCTURE_TYPE_IMAGE_VIEW_CREATE_INFO;
@@ -1872,7 +1965,7 @@ private:
         viewInfo.format                          = format;
         viewInfo.subresourceRange.aspectMask     = aspectFlags;
         viewInfo.subresourceRange.baseMipLevel   = 0;
-        viewInfo.subresourceRange.levelCount     = 1;
+        viewInfo.subresourceRange.levelCount     = mipLevels;
         viewInfo.subresourceRange.baseArrayLayer = 0;
         viewInfo.subresourceRange.layerCount     = type == VK_IMAGE_VIEW_TYPE_CUBE ? 6 : 1;
 
@@ -2078,7 +2171,8 @@ private:
         VkMemoryPropertyFlags properties,
         VkImage& image,
         VkDeviceMemory& imageMemory,
-        bool cubeMap = false
+        bool cubeMap       = false,
+        uint32_t mipLevels = 1
     )
     {
         VkImageCreateInfo imageInfo {};
@@ -2087,7 +2181,7 @@ private:
         imageInfo.extent.width  = static_cast<uint32_t>(width);
         imageInfo.extent.height = static_cast<uint32_t>(height);
         imageInfo.extent.depth  = 1;
-        imageInfo.mipLevels     = 1;
+        imageInfo.mipLevels     = mipLevels;
         imageInfo.arrayLayers   = cubeMap ? 6 : 1;
         imageInfo.format        = format;
         imageInfo.tiling        = tiling;
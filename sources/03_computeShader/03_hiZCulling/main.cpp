@@ -0,0 +1,2824 @@
+/**
+ * Hi-Z 遮挡剔除：计算着色器构建深度金字塔，剔除结果写入间接绘制命令
+ * 1. 第一阶段：用上一帧的深度金字塔和上一帧的 viewProj 测试所有视锥内的物体，通过的物体写入第一个间接绘制命令并绘制
+ * 2. 从第一阶段的深度缓冲构建本帧的深度金字塔，每一层是上一层 2x2 的最大深度（最远的深度，遮挡测试是保守的）
+ * 3. 第二阶段：只重新测试第一阶段被剔除的物体，使用本帧的深度金字塔，通过的物体写入第二个间接绘制命令并绘制
+ * 上一帧被遮挡、这一帧重新可见的物体会在第二阶段被绘制，不会像 06_extensions/04_occlusionCulling 一样晚一帧出现
+ * 所有物体共用一个立方体网格，每个阶段只有一次 vkCmdDrawIndexedIndirect，CPU 的开销和物体数量无关
+ */
+
+#define GLFW_INCLUDE_VULKAN         // 定义这个宏之后 glfw3.h 文件就会包含 Vulkan 的头文件
+#include <GLFW/glfw3.h>
+
+#define GLM_FORCE_RADIANS           // glm函数的参数使用弧度
+#define GLM_FORCE_DEPTH_ZERO_TO_ONE // 透视矩阵深度值范围 [-1, 1] => [0, 1]
+#include <glm/glm.hpp>
+#include <glm/gtc/matrix_transform.hpp>
+#define GLM_ENABLE_EXPERIMENTAL
+#include <glm/gtx/quaternion.hpp>
+
+#include <imgui.h>
+#include <imgui_impl_glfw.h>
+#include <imgui_impl_vulkan.h>
+
+#include <algorithm>
+#include <array>
+#include <bit>
+#include <cmath>
+#include <cstring>
+#include <fstream>
+#include <iostream>
+#include <numbers>
+#include <optional>
+#include <random>
+#include <set>
+#include <stdexcept>
+#include <vector>
+
+// 窗口默认大小
+constexpr uint32_t WIDTH  = 800;
+constexpr uint32_t HEIGHT = 600;
+
+// 同时并行处理的帧数
+constexpr int MAX_FRAMES_IN_FLIGHT = 2;
+
+// 需要开启的校验层的名称
+const std::vector<const char*> g_validationLayers = { "VK_LAYER_KHRONOS_validation" };
+// 交换链扩展
+const std::vector<const char*> g_deviceExtensions = { VK_KHR_SWAPCHAIN_EXTENSION_NAME };
+
+// 是否启用校验层
+#ifdef NDEBUG
+const bool g_enableValidationLayers = false;
+#else
+const bool g_enableValidationLayers = true;
+#endif // NDEBUG
+
+// 物体按照 GRID_SIZE x GRID_SIZE 的网格摆放在地面上，其中一部分是高大的建筑，作为主要的遮挡物
+constexpr uint32_t GRID_SIZE       = 320;
+constexpr uint32_t OBJECT_COUNT    = GRID_SIZE * GRID_SIZE; // 102400
+constexpr float OBJECT_SPACING     = 2.f;
+constexpr float BUILDING_CHANCE    = 0.03f;
+constexpr uint32_t CULL_GROUP_SIZE = 64; // 和 cull.comp 的 local_size_x 一致
+constexpr uint32_t HIZ_GROUP_SIZE  = 8;  // 和 hiz.comp 的 local_size_x/y 一致
+
+struct Drawable
+{
+    VkBuffer vertexBuffer { nullptr };
+    VkDeviceMemory vertexBufferMemory { nullptr };
+    VkBuffer indexBuffer { nullptr };
+    VkDeviceMemory indexBufferMemory { nullptr };
+    uint32_t indexCount { 0 };
+};
+
+struct Vertex
+{
+    glm::vec3 pos { 0.f, 0.f, 0.f };
+    glm::vec3 color { 0.f, 0.f, 0.f };
+
+    static constexpr VkVertexInputBindingDescription GetBindingDescription() noexcept
+    {
+        VkVertexInputBindingDescription bindingDescription {};
+
+        bindingDescription.binding   = 0;
+        bindingDescription.stride    = sizeof(Vertex);
+        bindingDescription.inputRate = VK_VERTEX_INPUT_RATE_VERTEX;
+
+        return bindingDescription;
+    }
+
+    static constexpr std::array<VkVertexInputAttributeDescription, 2> GetAttributeDescriptions() noexcept
+    {
+        std::array<VkVertexInputAttributeDescription, 2> attributeDescriptions {};
+
+        attributeDescriptions[0].binding  = 0;
+        attributeDescriptions[0].location = 0;
+        attributeDescriptions[0].format   = VK_FORMAT_R32G32B32_SFLOAT;
+        attributeDescriptions[0].offset   = offsetof(Vertex, pos);
+
+        attributeDescriptions[1].binding  = 0;
+        attributeDescriptions[1].location = 1;
+        attributeDescriptions[1].format   = VK_FORMAT_R32G32B32_SFLOAT;
+        attributeDescriptions[1].offset   = offsetof(Vertex, color);
+
+        return attributeDescriptions;
+    }
+};
+
+// 图形和计算着色器共用，布局和 cull.comp 中的 std140 一致
+struct UniformBufferObject
+{
+    glm::mat4 view { glm::mat4(1.f) };
+    glm::mat4 proj { glm::mat4(1.f) };
+    glm::mat4 viewProj { glm::mat4(1.f) };
+    glm::mat4 prevViewProj { glm::mat4(1.f) }; // 上一帧深度金字塔对应的 viewProj
+    std::array<glm::vec4, 6> frustum {};       // 视锥的六个平面，xyz 是法线，w 是距离
+    glm::vec2 pyramidSize { 0.f };             // 深度金字塔第 0 层的大小
+    uint32_t pyramidLevels { 0 };
+    uint32_t objectCount { 0 };
+    uint32_t frustumCulling { 1 };
+    uint32_t occlusionCulling { 1 };
+    uint32_t pyramidValid { 0 }; // 深度金字塔中是否有上一帧的数据，第一帧以及重建交换链之后为 0
+};
+
+// 每个物体的数据，std430 布局，位置和缩放就是一个轴对齐的包围盒
+struct ObjectData
+{
+    glm::vec4 positionScale { 0.f }; // xyz 是位置，w 是立方体的边长
+    glm::vec4 color { 1.f };
+};
+
+// 绘制时通过推送常量指定可见物体列表的起始位置，两个阶段各使用列表的一半
+struct DrawPushConstant
+{
+    uint32_t listOffset { 0 };
+};
+
+// 剔除的阶段，0：使用上一帧的深度金字塔，1：使用本帧的深度金字塔重新测试第一阶段被剔除的物体
+struct CullPushConstant
+{
+    uint32_t phase { 0 };
+};
+
+struct HiZPushConstant
+{
+    glm::ivec2 srcSize { 0 };
+    glm::ivec2 dstSize { 0 };
+};
+
+// 读回到 CPU 的统计信息，只用于在 ImGui 中显示
+struct CullStatistics
+{
+    uint32_t phase1 { 0 };
+    uint32_t phase2 { 0 };
+};
+
+/// @brief 支持图形、计算和呈现的队列族
+struct QueueFamilyIndices
+{
+    std::optional<uint32_t> graphicsFamily {};
+    std::optional<uint32_t> presentFamily {};
+
+    constexpr bool IsComplete() const noexcept
+    {
+        return graphicsFamily.has_value() && presentFamily.has_value();
+    }
+};
+
+/// @brief 交换链属性信息
+struct SwapChainSupportDetails
+{
+    VkSurfaceCapabilitiesKHR capabilities {};
+    std::vector<VkSurfaceFormatKHR> foramts;
+    std::vector<VkPresentModeKHR> presentModes;
+};
+
+// 范围是 [-0.5, 0.5] 的单位立方体，所有物体共用
+// clang-format off
+const std::vector<Vertex> verticesCube {
+    { { -0.5f,  0.5f, -0.5f }, { .9f, .9f, .9f } },
+    { {  0.5f,  0.5f, -0.5f }, { .9f, .9f, .9f } },
+    { {  0.5f, -0.5f, -0.5f }, { .5f, .5f, .5f } },
+    { { -0.5f, -0.5f, -0.5f }, { .5f, .5f, .5f } },
+
+    { { -0.5f,  0.5f,  0.5f }, { 1.f, 1.f, 1.f } },
+    { {  0.5f,  0.5f,  0.5f }, { 1.f, 1.f, 1.f } },
+    { {  0.5f, -0.5f,  0.5f }, { .6f, .6f, .6f } },
+    { { -0.5f, -0.5f,  0.5f }, { .6f, .6f, .6f } },
+};
+
+const std::vector<uint16_t> indicesCube {
+    0, 1, 2, 0, 2, 3, // 前
+    1, 5, 6, 1, 6, 2, // 右
+    5, 4, 7, 5, 7, 6, // 后
+    4, 0, 3, 4, 3, 7, // 左
+    3, 2, 6, 3, 6, 7, // 上
+    4, 5, 1, 4, 1, 0, // 下
+};
+// clang-format on
+
+class HelloTriangleApplication
+{
+public:
+    void Run()
+    {
+        InitWindow();
+        InitVulkan();
+        MainLoop();
+        Cleanup();
+    }
+
+private:
+    void InitWindow()
+    {
+        if (GLFW_FALSE == glfwInit())
+        {
+            throw std::runtime_error("failed to init GLFW");
+        }
+
+        // 禁止 glfw 创建 OpenGL 上下文
+        glfwWindowHint(GLFW_CLIENT_API, GLFW_NO_API);
+
+        m_window = glfwCreateWindow(WIDTH, HEIGHT, "Vulkan", nullptr, nullptr);
+
+        glfwSetWindowUserPointer(m_window, this);
+        glfwSetFramebufferSizeCallback(m_window, FramebufferResizeCallback);
+        glfwSetKeyCallback(m_window, KeyCallback);
+        glfwSetCursorPosCallback(m_window, CursorPosCallback);
+        glfwSetScrollCallback(m_window, ScrollCallback);
+        glfwSetMouseButtonCallback(m_window, MouseButtonCallback);
+    }
+
+    void InitVulkan()
+    {
+        CreateInstance();
+        SetupDebugCallback();
+        CreateSurface();
+        PickPhysicalDevice();
+        CreateLogicalDevice();
+        CreateSwapChain();
+        CreateImageViews();
+        CreateRenderPass();
+        CreateDescriptorSetLayout();
+        CreateGraphicsPipeline();
+        CreateComputePipelines();
+        CreateCommandPool();
+        CreateDepthResources();
+        CreateFramebuffers();
+        CreateScene();
+        CreateCullingBuffers();
+        CreateUniformBuffers();
+        CreatePyramidSampler();
+        CreateDepthPyramid();
+        CreateDescriptorPool();
+        CreateImGuiDescriptorPool();
+        CreateDescriptorSets();
+        CreateCommandBuffers();
+        CreateSyncObjects();
+        InitImGui();
+    }
+
+    void MainLoop()
+    {
+        while (!glfwWindowShouldClose(m_window))
+        {
+            glfwPollEvents();
+            PrepareImGui();
+            DrawFrame();
+        }
+
+        // 等待逻辑设备的操作结束执行
+        // DrawFrame 函数中的操作是异步执行的，关闭窗口跳出while循环时，绘制操作和呈现操作可能仍在执行，不能进行清除操作
+        vkDeviceWaitIdle(m_device);
+    }
+
+    void Cleanup() noexcept
+    {
+        ImGui_ImplVulkan_Shutdown();
+        ImGui_ImplGlfw_Shutdown();
+        ImGui::DestroyContext();
+
+        CleanupSwapChain();
+        DestroyDrawable(m_drawableCube);
+
+        vkDestroyBuffer(m_device, m_objectBuffer, nullptr);
+        vkFreeMemory(m_device, m_objectBufferMemory, nullptr);
+        vkDestroyBuffer(m_device, m_drawCommandBuffer, nullptr);
+        vkFreeMemory(m_device, m_drawCommandBufferMemory, nullptr);
+        vkDestroyBuffer(m_device, m_visibleListBuffer, nullptr);
+        vkFreeMemory(m_device, m_visibleListBufferMemory, nullptr);
+        vkDestroyBuffer(m_device, m_phase1ResultBuffer, nullptr);
+        vkFreeMemory(m_device, m_phase1ResultBufferMemory, nullptr);
+
+        for (size_t i = 0; i < MAX_FRAMES_IN_FLIGHT; ++i)
+        {
+            vkDestroyBuffer(m_device, m_statisticsBuffers.at(i), nullptr);
+            vkFreeMemory(m_device, m_statisticsBuffersMemory.at(i), nullptr);
+        }
+
+        vkDestroySampler(m_device, m_pyramidSampler, nullptr);
+
+        vkDestroyPipeline(m_device, m_cullPipeline, nullptr);
+        vkDestroyPipelineLayout(m_device, m_cullPipelineLayout, nullptr);
+        vkDestroyPipeline(m_device, m_hizPipeline, nullptr);
+        vkDestroyPipelineLayout(m_device, m_hizPipelineLayout, nullptr);
+        vkDestroyPipeline(m_device, m_graphicsPipeline, nullptr);
+        vkDestroyPipelineLayout(m_device, m_pipelineLayout, nullptr);
+        vkDestroyRenderPass(m_device, m_earlyRenderPass, nullptr);
+        vkDestroyRenderPass(m_device, m_lateRenderPass, nullptr);
+
+        vkDestroyDescriptorPool(m_device, m_imguiDescriptorPool, nullptr);
+
+        for (size_t i = 0; i < MAX_FRAMES_IN_FLIGHT; ++i)
+        {
+            vkDestroyBuffer(m_device, m_uniformBuffers.at(i), nullptr);
+            vkFreeMemory(m_device, m_uniformBuffersMemory.at(i), nullptr);
+        }
+
+        vkDestroyDescriptorPool(m_device, m_descriptorPool, nullptr);
+        vkDestroyDescriptorSetLayout(m_device, m_descriptorSetLayout, nullptr);
+        vkDestroyDescriptorSetLayout(m_device, m_hizDescriptorSetLayout, nullptr);
+
+        for (size_t i = 0; i < MAX_FRAMES_IN_FLIGHT; ++i)
+        {
+            vkDestroySemaphore(m_device, m_imageAvailableSemaphores.at(i), nullptr);
+            vkDestroySemaphore(m_device, m_renderFinishedSemaphores.at(i), nullptr);
+            vkDestroyFence(m_device, m_inFlightFences.at(i), nullptr);
+        }
+
+        vkDestroyCommandPool(m_device, m_commandPool, nullptr);
+        vkDestroyDevice(m_device, nullptr);
+
+        if (g_enableValidationLayers)
+        {
+            DestroyDebugUtilsMessengerEXT(m_instance, m_debugMessenger, nullptr);
+        }
+
+        vkDestroySurfaceKHR(m_instance, m_surface, nullptr); // 清理表面对象，必须在 Vulkan 实例清理之前
+        vkDestroyInstance(m_instance, nullptr);
+
+        glfwDestroyWindow(m_window);
+        glfwTerminate();
+    }
+
+private:
+    /// @brief 添加需要渲染的GUI控件
+    void PrepareImGui()
+    {
+        ImGui::NewFrame();
+
+        // 绘制数量是 MAX_FRAMES_IN_FLIGHT 帧之前的结果，读取时不会等待 GPU
+        ImGui::Begin("Hi-Z Culling");
+        ImGui::Text("Objects: %u", OBJECT_COUNT);
+        ImGui::Text("%.3f ms/frame (%.1f FPS)", 1000.f / ImGui::GetIO().Framerate, ImGui::GetIO().Framerate);
+        ImGui::Checkbox("Frustum culling", &m_frustumCulling);
+        ImGui::Checkbox("Occlusion culling", &m_occlusionCulling);
+        ImGui::Text("Phase 1 drawn: %u", m_statistics.phase1);
+        ImGui::Text("Phase 2 drawn: %u", m_statistics.phase2);
+        ImGui::Text("Culled: %u", OBJECT_COUNT - m_statistics.phase1 - m_statistics.phase2);
+        ImGui::End();
+
+        ImGui::Render();
+    }
+
+    /// @brief 创建 Vulkan 实例
+    void CreateInstance()
+    {
+        if (g_enableValidationLayers && !CheckValidationLayerSupport())
+        {
+            throw std::runtime_error("validation layers requested, but not available");
+        }
+
+        // 应用程序的信息，这些信息可能会作为驱动程序的优化依据，让驱动做一些特殊的优化
+        VkApplicationInfo appInfo  = {};
+        appInfo.sType              = VK_STRUCTURE_TYPE_APPLICATION_INFO;
+        appInfo.pNext              = nullptr;
+        appInfo.pApplicationName   = "Hello Triangle";
+        appInfo.applicationVersion = VK_MAKE_VERSION(1, 0, 0);
+        appInfo.pEngineName        = "No Engine";
+        appInfo.engineVersion      = VK_MAKE_VERSION(1, 0, 0);
+        appInfo.apiVersion         = VK_API_VERSION_1_0;
+
+        // 指定驱动程序需要使用的全局扩展和校验层，全局是指对整个应用程序都有效，而不仅仅是某一个设备
+        VkInstanceCreateInfo createInfo = {};
+        createInfo.sType                = VK_STRUCTURE_TYPE_INSTANCE_CREATE_INFO;
+        createInfo.pApplicationInfo     = &appInfo;
+
+        // 指定需要的全局扩展
+        auto requiredExtensions            = GetRequiredExtensions();
+        createInfo.enabledExtensionCount   = static_cast<uint32_t>(requiredExtensions.size());
+        createInfo.ppEnabledExtensionNames = requiredExtensions.data();
+
+        // 指定全局校验层
+        if (g_enableValidationLayers)
+        {
+            createInfo.enabledLayerCount   = static_cast<uint32_t>(g_validationLayers.size());
+            createInfo.ppEnabledLayerNames = g_validationLayers.data();
+
+            VkDebugUtilsMessengerCreateInfoEXT debugCreateInfo = {};
+            PopulateDebugMessengerCreateInfo(debugCreateInfo);
+
+            createInfo.pNext = &debugCreateInfo;
+        }
+        else
+        {
+            createInfo.enabledLayerCount = 0;
+            createInfo.pNext             = nullptr;
+        }
+
+        // 创建 Vulkan 实例，用来初始化 Vulkan 库
+        // 1.包含创建信息的结构体指针
+        // 2.自定义的分配器回调函数
+        // 3.指向实例句柄存储位置的指针
+        if (VK_SUCCESS != vkCreateInstance(&createInfo, nullptr, &m_instance))
+        {
+            throw std::runtime_error("failed to create instance");
+        }
+    }
+
+    /// @brief 检查需要开启的校验层是否被支持
+    /// @return
+    bool CheckValidationLayerSupport() const noexcept
+    {
+        // 获取所有可用的校验层列表
+        uint32_t layerCount = 0;
+        vkEnumerateInstanceLayerProperties(&layerCount, nullptr);
+        std::vector<VkLayerProperties> availableLayers(layerCount);
+        vkEnumerateInstanceLayerProperties(&layerCount, availableLayers.data());
+        std::cout << "-------------------------------------------\n"
+                  << "All available layers:\n";
+        for (const auto& layer : availableLayers)
+        {
+            std::cout << layer.layerName << '\n';
+        }
+
+        // 检查需要开启的校验层是否可以在所有可用的校验层列表中找到
+        for (const char* layerName : g_validationLayers)
+        {
+            bool layerFound { false };
+
+            for (const auto& layerProperties : availableLayers)
+            {
+                if (0 == std::strcmp(layerName, layerProperties.layerName))
+                {
+                    layerFound = true;
+                    break;
+                }
+            }
+
+            if (!layerFound)
+            {
+                return false;
+            }
+        }
+
+        return true;
+    }
+
+    /// @brief 获取所有需要开启的扩展
+    /// @return
+    std::vector<const char*> GetRequiredExtensions() const noexcept
+    {
+        // 获取 Vulkan 支持的所有扩展
+        uint32_t extensionCount = 0;
+        vkEnumerateInstanceExtensionProperties(nullptr, &extensionCount, nullptr);
+        std::vector<VkExtensionProperties> extensions(extensionCount);
+        vkEnumerateInstanceExtensionProperties(nullptr, &extensionCount, extensions.data());
+        std::cout << "-------------------------------------------\n"
+                  << "All supported extensions:\n";
+        for (const auto& e : extensions)
+        {
+            std::cout << e.extensionName << '\n';
+        }
+
+        // Vulkan 是一个与平台无关的 API ，所以需要一个和窗口系统交互的扩展
+        // 使用 glfw 获取这个扩展
+        uint32_t glfwExtensionCount = 0;
+        const char** glfwExtensions = glfwGetRequiredInstanceExtensions(&glfwExtensionCount);
+        std::cout << "-------------------------------------------\n"
+                  << "GLFW extensions:\n";
+        for (size_t i = 0; i < glfwExtensionCount; ++i)
+        {
+            std::cout << glfwExtensions[i] << '\n';
+        }
+
+        // 将需要开启的所有扩展添加到列表并返回
+        std::vector<const char*> requiredExtensions(glfwExtensions, glfwExtensions + glfwExtensionCount);
+        if (g_enableValidationLayers)
+        {
+            // 根据需要开启调试报告相关的扩展
+            requiredExtensions.emplace_back(VK_EXT_DEBUG_UTILS_EXTENSION_NAME);
+        }
+
+        return requiredExtensions;
+    }
+
+    /// @brief 设置回调函数来接受调试信息
+    void SetupDebugCallback()
+    {
+        if (!g_enableValidationLayers)
+        {
+            return;
+        }
+
+        VkDebugUtilsMessengerCreateInfoEXT createInfo = {};
+        PopulateDebugMessengerCreateInfo(createInfo);
+
+        if (VK_SUCCESS != CreateDebugUtilsMessengerEXT(m_instance, &createInfo, nullptr, &m_debugMessenger))
+        {
+            throw std::runtime_error("failed to set up debug callback");
+        }
+    }
+
+    /// @brief 选择一个满足需求的物理设备（显卡）
+    /// @details 可以选择任意数量的显卡并同时使用它们
+    void PickPhysicalDevice()
+    {
+        // 获取支持 Vulkan 的显卡数量
+        uint32_t deviceCount { 0 };
+        vkEnumeratePhysicalDevices(m_instance, &deviceCount, nullptr);
+
+        if (0 == deviceCount)
+        {
+            throw std::runtime_error("failed to find GPUs with Vulkan support");
+        }
+
+        std::vector<VkPhysicalDevice> devices(deviceCount);
+        vkEnumeratePhysicalDevices(m_instance, &deviceCount, devices.data());
+
+        for (const auto& device : devices)
+        {
+            if (IsDeviceSuitable(device))
+            {
+                m_physicalDevice = device;
+                break;
+            }
+        }
+
+        if (nullptr == m_physicalDevice)
+        {
+            throw std::runtime_error("failed to find a suitable GPU");
+        }
+    }
+
+    /// @brief 检查显卡是否满足需求
+    /// @param device
+    /// @return
+    bool IsDeviceSuitable(const VkPhysicalDevice device) const noexcept
+    {
+        // 获取基本的设置属性，name、type以及Vulkan版本等等
+        // VkPhysicalDeviceProperties deviceProperties;
+        // vkGetPhysicalDeviceProperties(device, &deviceProperties);
+
+        // 获取对纹理的压缩、64位浮点数和多视图渲染等可选功能的支持
+        // VkPhysicalDeviceFeatures deviceFeatures;
+        // vkGetPhysicalDeviceFeatures(device, &deviceFeatures);
+
+        auto indices             = FindQueueFamilies(device);
+        auto extensionsSupported = CheckDeviceExtensionSupported(device);
+
+        bool swapChainAdequate { false };
+        if (extensionsSupported)
+        {
+            auto swapChainSupport = QuerySwapChainSupport(device);
+            swapChainAdequate     = !swapChainSupport.foramts.empty() & !swapChainSupport.presentModes.empty();
+        }
+
+        return indices.IsComplete() && extensionsSupported && swapChainAdequate;
+    }
+
+    /// @brief 查找满足需求的队列族
+    /// @details 不同的队列族支持不同的类型的指令，例如计算、内存传输、绘图等指令
+    /// @param device
+    /// @return
+    QueueFamilyIndices FindQueueFamilies(const VkPhysicalDevice device) const noexcept
+    {
+        QueueFamilyIndices indices;
+
+        // 获取物理设备支持的队列族列表
+        uint32_t queueFamilyCount = 0;
+        vkGetPhysicalDeviceQueueFamilyProperties(device, &queueFamilyCount, nullptr);
+        std::vector<VkQueueFamilyProperties> queueFamilies(queueFamilyCount);
+        vkGetPhysicalDeviceQueueFamilyProperties(device, &queueFamilyCount, queueFamilies.data());
+
+        for (uint32_t i = 0; i < queueFamilies.size(); ++i)
+        {
+            // 图形队列族，深度金字塔和剔除都在同一个指令缓冲中执行，所以还需要支持计算
+            if ((queueFamilies.at(i).queueFlags & VK_QUEUE_GRAPHICS_BIT) && (queueFamilies.at(i).queueFlags & VK_QUEUE_COMPUTE_BIT))
+            {
+                indices.graphicsFamily = i;
+            }
+
+            // 呈现队列族
+            VkBool32 presentSupport = false;
+            vkGetPhysicalDeviceSurfaceSupportKHR(device, i, m_surface, &presentSupport);
+
+            if (presentSupport)
+            {
+                indices.presentFamily = i;
+            }
+
+            if (indices.IsComplete())
+            {
+                break;
+            }
+        }
+
+        return indices;
+    }
+
+    /// @brief 创建逻辑设备作为和物理设备交互的接口
+    void CreateLogicalDevice()
+    {
+        auto indices = FindQueueFamilies(m_physicalDevice);
+
+        std::vector<VkDeviceQueueCreateInfo> queueCreateInfos;
+        std::set<uint32_t> uniqueQueueFamilies { indices.graphicsFamily.value(), indices.presentFamily.value() };
+
+        // 控制指令缓存执行顺序的优先级，即使只有一个队列也要显示指定优先级，范围：[0.0, 1.0]
+        float queuePriority { 1.f };
+        for (auto queueFamily : uniqueQueueFamilies)
+        {
+            // 描述队列簇中预要申请使用的队列数量
+            // 当前可用的驱动程序所提供的队列簇只允许创建少量的队列，并且很多时候没有必要创建多个队列
+            // 因为可以在多个线程上创建所有命令缓冲区，然后在主线程一次性的以较低开销的调用提交队列
+            VkDeviceQueueCreateInfo queueCreateInfo {};
+            queueCreateInfo.sType            = VK_STRUCTURE_TYPE_DEVICE_QUEUE_CREATE_INFO;
+            queueCreateInfo.queueFamilyIndex = queueFamily;
+            queueCreateInfo.queueCount       = 1;
+            queueCreateInfo.pQueuePriorities = &queuePriority;
+            queueCreateInfos.push_back(queueCreateInfo);
+        }
+
+        // 指定应用程序使用的设备特性（例如几何着色器）
+        VkPhysicalDeviceFeatures deviceFeatures = {};
+
+        VkDeviceCreateInfo createInfo      = {};
+        createInfo.sType                   = VK_STRUCTURE_TYPE_DEVICE_CREATE_INFO;
+        createInfo.queueCreateInfoCount    = static_cast<uint32_t>(queueCreateInfos.size());
+        createInfo.pQueueCreateInfos       = queueCreateInfos.data();
+        createInfo.pEnabledFeatures        = &deviceFeatures;
+        createInfo.enabledExtensionCount   = static_cast<uint32_t>(g_deviceExtensions.size());
+        createInfo.ppEnabledExtensionNames = g_deviceExtensions.data();
+
+        // 根据需要对设备和 Vulkan 实例使用相同的校验层
+        if (g_enableValidationLayers)
+        {
+            createInfo.enabledLayerCount   = static_cast<uint32_t>(g_validationLayers.size());
+            createInfo.ppEnabledLayerNames = g_validationLayers.data();
+        }
+        else
+        {
+            createInfo.enabledLayerCount = 0;
+        }
+
+        // 创建逻辑设备
+        if (VK_SUCCESS != vkCreateDevice(m_physicalDevice, &createInfo, nullptr, &m_device))
+        {
+            throw std::runtime_error("failed to create logical device");
+        }
+
+        // 获取指定队列族的队列句柄，设备队列在逻辑设备被销毁时隐式清理
+        // 此处的队列簇可能相同，也就是以相同的参数调用了两次这个函数
+        // 1.逻辑设备对象
+        // 2.队列族索引
+        // 3.队列索引，因为只创建了一个队列，所以此处使用索引0
+        // 4.用来存储返回的队列句柄的内存地址
+        vkGetDeviceQueue(m_device, indices.graphicsFamily.value(), 0, &m_graphicsQueue);
+        vkGetDeviceQueue(m_device, indices.presentFamily.value(), 0, &m_presentQueue);
+    }
+
+    /// @brief 创建表面，需要在程序退出前清理
+    /// @details 不同平台创建表面的方式不一样，这里使用 GLFW 统一创建
+    void CreateSurface()
+    {
+        // Vulkan 不能直接与窗口系统进行交互（是一个与平台特性无关的API集合），surface是 Vulkan 与窗体系统的连接桥梁
+        // 需要在instance创建之后立即创建窗体surface，因为它会影响物理设备的选择
+        // 窗体surface本身对于 Vulkan 也是非强制的，不需要同 OpenGL 一样必须要创建窗体surface
+        if (VK_SUCCESS != glfwCreateWindowSurface(m_instance, m_window, nullptr, &m_surface))
+        {
+            throw std::runtime_error("failed to create window surface");
+        }
+    }
+
+    /// @brief 检测所需的扩展是否支持
+    /// @param device
+    /// @return
+    bool CheckDeviceExtensionSupported(const VkPhysicalDevice device) const noexcept
+    {
+        uint32_t extensionCount { 0 };
+        vkEnumerateDeviceExtensionProperties(device, nullptr, &extensionCount, nullptr);
+        std::vector<VkExtensionProperties> availableExtensions(extensionCount);
+        vkEnumerateDeviceExtensionProperties(device, nullptr, &extensionCount, availableExtensions.data());
+
+        std::set<std::string> requiredExtensions(std::begin(g_deviceExtensions), std::end(g_deviceExtensions));
+
+        for (const auto& extension : availableExtensions)
+        {
+            requiredExtensions.erase(extension.extensionName);
+        }
+
+        // 如果为空，则支持
+        return requiredExtensions.empty();
+    }
+
+    /// @brief 查询交换链支持的细节信息
+    /// @param device
+    /// @return
+    SwapChainSupportDetails QuerySwapChainSupport(const VkPhysicalDevice device) const noexcept
+    {
+        SwapChainSupportDetails details;
+
+        // 查询基础表面特性
+        vkGetPhysicalDeviceSurfaceCapabilitiesKHR(device, m_surface, &details.capabilities);
+
+        // 查询表面支持的格式，确保集合对于所有有效的格式可扩充
+        uint32_t formatCount { 0 };
+        vkGetPhysicalDeviceSurfaceFormatsKHR(device, m_surface, &formatCount, nullptr);
+        if (0 != formatCount)
+        {
+            details.foramts.resize(formatCount);
+            vkGetPhysicalDeviceSurfaceFormatsKHR(device, m_surface, &formatCount, details.foramts.data());
+        }
+
+        // 查询表面支持的呈现模式
+        uint32_t presentModeCount { 0 };
+        vkGetPhysicalDeviceSurfacePresentModesKHR(device, m_surface, &presentModeCount, nullptr);
+        if (0 != presentModeCount)
+        {
+            details.presentModes.resize(presentModeCount);
+            vkGetPhysicalDeviceSurfacePresentModesKHR(device, m_surface, &presentModeCount, details.presentModes.data());
+        }
+
+        return details;
+    }
+
+    /// @brief 选择合适的表面格式
+    /// @param availableFormats
+    /// @return
+    VkSurfaceFormatKHR ChooseSwapSurfaceFormat(const std::vector<VkSurfaceFormatKHR>& availableFormats) const noexcept
+    {
+        // VkSurfaceFormatKHR 结构都包含一个 format 和一个 colorSpace 成员
+        // format 成员变量指定色彩通道和类型
+        // colorSpace 成员描述 SRGB 颜色空间是否通过 VK_COLOR_SPACE_SRGB_NONLINEAR_KHR 标志支持
+        // 在较早版本的规范中，这个标志名为 VK_COLORSPACE_SRGB_NONLINEAR_KHR
+
+        // 表面没有自己的首选格式，直接返回指定的格式
+        if (1 == availableFormats.size() && availableFormats.front().format == VK_FORMAT_UNDEFINED)
+        {
+            return { VK_FORMAT_B8G8R8A8_UNORM, VK_COLOR_SPACE_SRGB_NONLINEAR_KHR };
+        }
+
+        // 遍历格式列表，如果想要的格式存在则直接返回
+        for (const auto& availableFormat : availableFormats)
+        {
+            if (VK_FORMAT_B8G8R8A8_UNORM == availableFormat.format && VK_COLOR_SPACE_SRGB_NONLINEAR_KHR == availableFormat.colorSpace)
+            {
+                return availableFormat;
+            }
+        }
+
+        // 如果以上两种方式都失效，通过“优良”进行打分排序，大多数情况下会选择第一个格式作为理想的选择
+        return availableFormats.front();
+    }
+
+    /// @brief 查找最佳的可用呈现模式，模式是非常重要的，因为它代表了在屏幕呈现图像的条件
+    /// @param availablePresentModes
+    /// @return
+    VkPresentModeKHR ChooseSwapPresentMode(const std::vector<VkPresentModeKHR>& availablePresentModes) const noexcept
+    {
+        // 以下4种模式可以使用
+        // 1.VK_PRESENT_MODE_IMMEDIATE_KHR: 应用程序提交的图像被立即传输到屏幕呈现，这种模式可能会造成撕裂效果。
+        // 2.VK_PRESENT_MODE_FIFO_KHR:
+        // 交换链被看作一个队列，当显示内容需要刷新的时候，显示设备从队列的前面获取图像，并且程序将渲染完成的图像插入队列的后面。
+        // 如果队列是满的程序会等待。这种规模与视频游戏的垂直同步很类似。显示设备的刷新时刻被成为“垂直中断”。
+        // 3.VK_PRESENT_MODE_FIFO_RELAXED_KHR: 该模式与上一个模式略有不同的地方为，如果应用程序存在延迟，即接受最后一个垂直同步信号时队列空了，
+        // 将不会等待下一个垂直同步信号，而是将图像直接传送。这样做可能导致可见的撕裂效果。
+        // 4.VK_PRESENT_MODE_MAILBOX_KHR: 这是第二种模式的变种。当交换链队列满的时候，选择新的替换旧的图像，从而替代阻塞应用程序的情形。
+        // 这种模式通常用来实现三重缓冲区，与标准的垂直同步双缓冲相比，它可以有效避免延迟带来的撕裂效果。
+
+        VkPresentModeKHR bestMode = VK_PRESENT_MODE_FIFO_KHR;
+
+        for (const auto& availablePresentMode : availablePresentModes)
+        {
+            if (VK_PRESENT_MODE_MAILBOX_KHR == availablePresentMode)
+            {
+                return availablePresentMode;
+            }
+            else if (VK_PRESENT_MODE_IMMEDIATE_KHR == availablePresentMode)
+            {
+                bestMode = availablePresentMode;
+            }
+        }
+
+        return bestMode;
+    }
+
+    /// @brief 设置交换范围，交换范围是交换链中图像的分辨率
+    /// @param capabilities
+    /// @return
+    VkExtent2D ChooseSwapExtent(const VkSurfaceCapabilitiesKHR& capabilities) const noexcept
+    {
+        // 如果是最大值则表示允许我们自己选择对于窗口最合适的交换范围
+        if (std::numeric_limits<uint32_t>::max() != capabilities.currentExtent.width)
+        {
+            return capabilities.currentExtent;
+        }
+        else
+        {
+            int width { 0 }, height { 0 };
+            glfwGetFramebufferSize(m_window, &width, &height);
+
+            // 使用GLFW窗口的大小来设置交换链中图像的分辨率
+            VkExtent2D actualExtent = { static_cast<uint32_t>(width), static_cast<uint32_t>(height) };
+
+            actualExtent.width  = std::clamp(actualExtent.width, capabilities.minImageExtent.width, capabilities.maxImageExtent.width);
+            actualExtent.height = std::clamp(actualExtent.height, capabilities.minImageExtent.height, capabilities.maxImageExtent.height);
+
+            return actualExtent;
+        }
+    }
+
+    /// @brief 创建交换链
+    void CreateSwapChain()
+    {
+        SwapChainSupportDetails swapChainSupport = QuerySwapChainSupport(m_physicalDevice);
+        VkSurfaceFormatKHR surfaceFormat         = ChooseSwapSurfaceFormat(swapChainSupport.foramts);
+        VkPresentModeKHR presentMode             = ChooseSwapPresentMode(swapChainSupport.presentModes);
+        VkExtent2D extent                        = ChooseSwapExtent(swapChainSupport.capabilities);
+
+        // 交换链中的图像数量，可以理解为队列的长度，指定运行时图像的最小数量
+        // maxImageCount数值为0代表除了内存之外没有限制
+        m_minImageCount = swapChainSupport.capabilities.minImageCount + 1;
+        if (swapChainSupport.capabilities.maxImageCount > 0 && m_minImageCount > swapChainSupport.capabilities.maxImageCount)
+        {
+            m_minImageCount = swapChainSupport.capabilities.maxImageCount;
+        }
+
+        VkSwapchainCreateInfoKHR createInfo = {};
+        createInfo.sType                    = VK_STRUCTURE_TYPE_SWAPCHAIN_CREATE_INFO_KHR;
+        createInfo.surface                  = m_surface;
+        createInfo.minImageCount            = m_minImageCount;
+        createInfo.imageFormat              = surfaceFormat.format;
+        createInfo.imageColorSpace          = surfaceFormat.colorSpace;
+        createInfo.imageExtent              = extent;
+        createInfo.imageArrayLayers         = 1;                     // 图像包含的层次，通常为1，3d图像大于1
+        createInfo.imageUsage = VK_IMAGE_USAGE_COLOR_ATTACHMENT_BIT; // 指定在图像上进行怎样的操作，比如显示（颜色附件）、后处理等
+
+        auto indices                  = FindQueueFamilies(m_physicalDevice);
+        uint32_t queueFamilyIndices[] = { static_cast<uint32_t>(indices.graphicsFamily.value()),
+            static_cast<uint32_t>(indices.presentFamily.value()) };
+
+        // 在多个队列族使用交换链图像的方式
+        if (indices.graphicsFamily != indices.presentFamily)
+        {
+            // 图形队列和呈现队列不是同一个队列
+            // VK_SHARING_MODE_CONCURRENT 表示图像可以在多个队列族间使用，不需要显式地改变图像所有权
+            createInfo.imageSharingMode      = VK_SHARING_MODE_CONCURRENT;
+            createInfo.queueFamilyIndexCount = 2;
+            createInfo.pQueueFamilyIndices   = queueFamilyIndices;
+        }
+        else
+        {
+            // VK_SHARING_MODE_EXCLUSIVE 表示一张图像同一时间只能被一个队列族所拥有，这种模式性能最佳
+            createInfo.imageSharingMode      = VK_SHARING_MODE_EXCLUSIVE;
+            createInfo.queueFamilyIndexCount = 0;
+            createInfo.pQueueFamilyIndices   = nullptr;
+        }
+
+        // 指定一个固定的变换操作（需要交换链具有supportedTransforms特性），此处不进行任何变换
+        createInfo.preTransform = swapChainSupport.capabilities.currentTransform;
+        // 指定 alpha 通道是否被用来和窗口系统中的其他窗口进行混合操作
+        createInfo.compositeAlpha = VK_COMPOSITE_ALPHA_OPAQUE_BIT_KHR;
+        // 设置呈现模式
+        createInfo.presentMode = presentMode;
+        // 设置为true，不关心被遮蔽的像素数据，比如由于其他的窗体置于前方时或者渲染的部分内容存在于可视区域之外，
+        // 除非真的需要读取这些像素获数据进行处理（设置为true回读窗口像素可能会有问题），否则可以开启裁剪获得最佳性能。
+        createInfo.clipped = VK_TRUE;
+        // 交换链重建
+        // Vulkan运行时，交换链可能在某些条件下被替换，比如窗口调整大小或者交换链需要重新分配更大的图像队列。
+        // 在这种情况下，交换链实际上需要重新分配创建，并且必须在此字段中指定对旧的引用，用以回收资源
+        createInfo.oldSwapchain = VK_NULL_HANDLE;
+
+        if (VK_SUCCESS != vkCreateSwapchainKHR(m_device, &createInfo, nullptr, &m_swapChain))
+        {
+            throw std::runtime_error("failed to create swap chain");
+        }
+
+        // 获取交换链中图像，图像会在交换链销毁的同时自动清理
+        // 之前给VkSwapchainCreateInfoKHR 设置了期望的图像数量，但是实际运行允许创建更多的图像数量，因此需要重新获取数量
+        vkGetSwapchainImagesKHR(m_device, m_swapChain, &m_minImageCount, nullptr);
+        m_swapChainImages.resize(m_minImageCount);
+        vkGetSwapchainImagesKHR(m_device, m_swapChain, &m_minImageCount, m_swapChainImages.data());
+
+        m_swapChainImageFormat = surfaceFormat.format;
+        m_swapChainExtent      = extent;
+    }
+
+    /// @brief 创建图像视图
+    /// @details 任何 VkImage 对象都需要通过 VkImageView 来绑定访问，包括处于交换链中的、处于渲染管线中的
+    void CreateImageViews()
+    {
+        m_swapChainImageViews.resize(m_swapChainImages.size());
+
+        for (size_t i = 0; i < m_swapChainImages.size(); ++i)
+        {
+            VkImageViewCreateInfo createInfo           = {};
+            createInfo.sType                           = VK_STRUCTURE_TYPE_IMAGE_VIEW_CREATE_INFO;
+            createInfo.image                           = m_swapChainImages.at(i);
+            createInfo.viewType                        = VK_IMAGE_VIEW_TYPE_2D;         // 1d 2d 3d cube纹理
+            createInfo.format                          = m_swapChainImageFormat;
+            createInfo.components.r                    = VK_COMPONENT_SWIZZLE_IDENTITY; // 图像颜色通过的映射
+            createInfo.components.g                    = VK_COMPONENT_SWIZZLE_IDENTITY;
+            createInfo.components.b                    = VK_COMPONENT_SWIZZLE_IDENTITY;
+            createInfo.components.a                    = VK_COMPONENT_SWIZZLE_IDENTITY;
+            createInfo.subresourceRange.aspectMask     = VK_IMAGE_ASPECT_COLOR_BIT; // 指定图像的用途，图像的哪一部分可以被访问
+            createInfo.subresourceRange.baseMipLevel   = 0;
+            createInfo.subresourceRange.levelCount     = 1;
+            createInfo.subresourceRange.baseArrayLayer = 0;
+            createInfo.subresourceRange.layerCount     = 1;
+
+            if (VK_SUCCESS != vkCreateImageView(m_device, &createInfo, nullptr, &m_swapChainImageViews.at(i)))
+            {
+                throw std::runtime_error("failed to create image views");
+            }
+        }
+    }
+
+    /// @brief 创建图形管线
+    /// @details 在 Vulkan 中几乎不允许对图形管线进行动态设置，也就意味着每一种状态都需要提前创建一个图形管线
+    void CreateGraphicsPipeline()
+    {
+        auto vertShaderCode = ReadFile("../resources/shaders/03_03_base_vert.spv");
+        auto fragShaderCode = ReadFile("../resources/shaders/03_03_base_frag.spv");
+
+        VkShaderModule vertShaderModule = CreateShaderModule(vertShaderCode);
+        VkShaderModule fragShaderModule = CreateShaderModule(fragShaderCode);
+
+        VkPipelineShaderStageCreateInfo vertShaderStageInfo = {};
+        vertShaderStageInfo.sType                           = VK_STRUCTURE_TYPE_PIPELINE_SHADER_STAGE_CREATE_INFO;
+        vertShaderStageInfo.stage                           = VK_SHADER_STAGE_VERTEX_BIT;
+        vertShaderStageInfo.module                          = vertShaderModule;
+        vertShaderStageInfo.pName                           = "main";  // 指定调用的着色器函数，同一份代码可以实现多个着色器
+        vertShaderStageInfo.pSpecializationInfo             = nullptr; // 设置着色器常量
+
+        VkPipelineShaderStageCreateInfo fragShaderStageInfo = {};
+        fragShaderStageInfo.sType                           = VK_STRUCTURE_TYPE_PIPELINE_SHADER_STAGE_CREATE_INFO;
+        fragShaderStageInfo.stage                           = VK_SHADER_STAGE_FRAGMENT_BIT;
+        fragShaderStageInfo.module                          = fragShaderModule;
+        fragShaderStageInfo.pName                           = "main";
+        fragShaderStageInfo.pSpecializationInfo             = nullptr;
+
+        auto bindingDescription    = Vertex::GetBindingDescription();
+        auto attributeDescriptions = Vertex::GetAttributeDescriptions();
+
+        // 顶点信息
+        VkPipelineVertexInputStateCreateInfo vertexInputInfo = {};
+        vertexInputInfo.sType                                = VK_STRUCTURE_TYPE_PIPELINE_VERTEX_INPUT_STATE_CREATE_INFO;
+        vertexInputInfo.vertexBindingDescriptionCount        = 1;
+        vertexInputInfo.pVertexBindingDescriptions           = &bindingDescription;
+        vertexInputInfo.vertexAttributeDescriptionCount      = static_cast<uint32_t>(attributeDescriptions.size());
+        vertexInputInfo.pVertexAttributeDescriptions         = attributeDescriptions.data();
+
+        // 拓扑信息
+        VkPipelineInputAssemblyStateCreateInfo inputAssembly = {};
+        inputAssembly.sType                                  = VK_STRUCTURE_TYPE_PIPELINE_INPUT_ASSEMBLY_STATE_CREATE_INFO;
+        inputAssembly.topology               = VK_PRIMITIVE_TOPOLOGY_TRIANGLE_LIST; // 指定绘制的图元类型：点、线、三角形
+        inputAssembly.primitiveRestartEnable = VK_FALSE;
+
+        // 视口
+        VkViewport viewport = {};
+        viewport.x          = 0.f;
+        viewport.y          = 0.f;
+        viewport.width      = static_cast<float>(m_swapChainExtent.width);
+        viewport.height     = static_cast<float>(m_swapChainExtent.height);
+        viewport.minDepth   = 0.f; // 深度值范围，必须在 [0.f, 1.f]之间
+        viewport.maxDepth   = 1.f;
+
+        // 裁剪
+        VkRect2D scissor = {};
+        scissor.offset   = { 0, 0 };
+        scissor.extent   = m_swapChainExtent;
+
+        VkPipelineViewportStateCreateInfo viewportState = {};
+        viewportState.sType                             = VK_STRUCTURE_TYPE_PIPELINE_VIEWPORT_STATE_CREATE_INFO;
+        viewportState.viewportCount                     = 1;
+        viewportState.pViewports                        = &viewport;
+        viewportState.scissorCount                      = 1;
+        viewportState.pScissors                         = &scissor;
+
+        // 光栅化
+        VkPipelineRasterizationStateCreateInfo rasterizer = {};
+        rasterizer.sType                                  = VK_STRUCTURE_TYPE_PIPELINE_RASTERIZATION_STATE_CREATE_INFO;
+        rasterizer.depthClampEnable                       = VK_FALSE;
+        rasterizer.rasterizerDiscardEnable                = VK_FALSE;                        // 设置为true会禁止一切片段输出到帧缓冲
+        rasterizer.polygonMode                            = VK_POLYGON_MODE_FILL;
+        rasterizer.lineWidth                              = 1.f;
+        rasterizer.cullMode                               = VK_CULL_MODE_NONE;               // 表面剔除类型，正面、背面、双面剔除
+        rasterizer.frontFace                              = VK_FRONT_FACE_COUNTER_CLOCKWISE; // 指定顺时针的顶点序是正面还是反面
+        rasterizer.depthBiasEnable                        = VK_FALSE;
+        rasterizer.depthBiasConstantFactor                = 1.f;
+        rasterizer.depthBiasClamp                         = 0.f;
+        rasterizer.depthBiasSlopeFactor                   = 0.f;
+
+        // 多重采样
+        VkPipelineMultisampleStateCreateInfo multisampling = {};
+        multisampling.sType                                = VK_STRUCTURE_TYPE_PIPELINE_MULTISAMPLE_STATE_CREATE_INFO;
+        multisampling.sampleShadingEnable                  = VK_FALSE;
+        multisampling.rasterizationSamples                 = VK_SAMPLE_COUNT_1_BIT;
+        multisampling.minSampleShading                     = 1.f;
+        multisampling.pSampleMask                          = nullptr;
+        multisampling.alphaToCoverageEnable                = VK_FALSE;
+        multisampling.alphaToOneEnable                     = VK_FALSE;
+
+        // 深度和模板测试
+        VkPipelineDepthStencilStateCreateInfo depthStencil = {};
+        depthStencil.sType                                 = VK_STRUCTURE_TYPE_PIPELINE_DEPTH_STENCIL_STATE_CREATE_INFO;
+        depthStencil.depthTestEnable                       = VK_TRUE;            // 是否启用深度测试
+        depthStencil.depthWriteEnable                      = VK_TRUE;            // 深度测试通过后是否写入深度缓冲
+        depthStencil.depthCompareOp                        = VK_COMPARE_OP_LESS; // 深度值比较方式
+        depthStencil.depthBoundsTestEnable                 = VK_FALSE;           // 指定可选的深度范围测试
+        depthStencil.minDepthBounds                        = 0.f;
+        depthStencil.maxDepthBounds                        = 1.f;
+        depthStencil.stencilTestEnable                     = VK_FALSE;           // 模板测试
+        depthStencil.front                                 = {};
+        depthStencil.back                                  = {};
+
+        // 颜色混合，可以对指定帧缓冲单独设置，也可以设置全局颜色混合方式
+        VkPipelineColorBlendAttachmentState colorBlendAttachment {};
+        colorBlendAttachment.colorWriteMask =
+            VK_COLOR_COMPONENT_R_BIT | VK_COLOR_COMPONENT_G_BIT | VK_COLOR_COMPONENT_B_BIT | VK_COLOR_COMPONENT_A_BIT;
+        colorBlendAttachment.blendEnable = VK_FALSE;
+
+        VkPipelineColorBlendStateCreateInfo colorBlending {};
+        colorBlending.sType             = VK_STRUCTURE_TYPE_PIPELINE_COLOR_BLEND_STATE_CREATE_INFO;
+        colorBlending.logicOpEnable     = VK_FALSE;
+        colorBlending.logicOp           = VK_LOGIC_OP_COPY;
+        colorBlending.attachmentCount   = 1;
+        colorBlending.pAttachments      = &colorBlendAttachment;
+        colorBlending.blendConstants[0] = 0.0f;
+        colorBlending.blendConstants[1] = 0.0f;
+        colorBlending.blendConstants[2] = 0.0f;
+        colorBlending.blendConstants[3] = 0.0f;
+
+        // 动态状态，视口大小、线宽、混合常量等
+        std::vector<VkDynamicState> dynamicStates = { VK_DYNAMIC_STATE_VIEWPORT, VK_DYNAMIC_STATE_SCISSOR };
+        VkPipelineDynamicStateCreateInfo dynamicState {};
+        dynamicState.sType             = VK_STRUCTURE_TYPE_PIPELINE_DYNAMIC_STATE_CREATE_INFO;
+        dynamicState.dynamicStateCount = static_cast<uint32_t>(dynamicStates.size());
+        dynamicState.pDynamicStates    = dynamicStates.data();
+
+        // 可见物体列表的起始位置
+        VkPushConstantRange pushConstantRange = {};
+        pushConstantRange.stageFlags          = VK_SHADER_STAGE_VERTEX_BIT;
+        pushConstantRange.offset              = 0;
+        pushConstantRange.size                = sizeof(DrawPushConstant);
+
+        // 管线布局，在着色器中使用 uniform 变量
+        VkPipelineLayoutCreateInfo pipelineLayoutInfo {};
+        pipelineLayoutInfo.sType                  = VK_STRUCTURE_TYPE_PIPELINE_LAYOUT_CREATE_INFO;
+        pipelineLayoutInfo.setLayoutCount         = 1;
+        pipelineLayoutInfo.pSetLayouts            = &m_descriptorSetLayout;
+        pipelineLayoutInfo.pushConstantRangeCount = 1;
+        pipelineLayoutInfo.pPushConstantRanges    = &pushConstantRange;
+
+        if (VK_SUCCESS != vkCreatePipelineLayout(m_device, &pipelineLayoutInfo, nullptr, &m_pipelineLayout))
+        {
+            throw std::runtime_error("failed to create pipeline layout");
+        }
+
+        VkPipelineShaderStageCreateInfo shaderStages[] = { vertShaderStageInfo, fragShaderStageInfo };
+
+        // 完整的图形管线包括：着色器阶段、固定功能状态、管线布局、渲染流程
+        VkGraphicsPipelineCreateInfo pipelineInfo = {};
+        pipelineInfo.sType                        = VK_STRUCTURE_TYPE_GRAPHICS_PIPELINE_CREATE_INFO;
+        pipelineInfo.stageCount                   = 2;
+        pipelineInfo.pStages                      = shaderStages;
+        pipelineInfo.pVertexInputState            = &vertexInputInfo;
+        pipelineInfo.pInputAssemblyState          = &inputAssembly;
+        pipelineInfo.pViewportState               = &viewportState;
+        pipelineInfo.pRasterizationState          = &rasterizer;
+        pipelineInfo.pMultisampleState            = &multisampling;
+        pipelineInfo.pDepthStencilState           = nullptr;
+        pipelineInfo.pColorBlendState             = &colorBlending;
+        pipelineInfo.pDynamicState                = &dynamicState;
+        pipelineInfo.layout                       = m_pipelineLayout;
+        pipelineInfo.renderPass                   = m_earlyRenderPass; // 两个渲染流程是兼容的，可以使用同一个管线
+        pipelineInfo.subpass                      = 0;                 // 子流程在子流程数组中的索引
+        pipelineInfo.basePipelineHandle           = nullptr; // 以一个创建好的图形管线为基础创建一个新的图形管线
+        pipelineInfo.basePipelineIndex            = -1; // 只有该结构体的成员 flags 被设置为 VK_PIPELINE_CREATE_DERIVATIVE_BIT 才有效
+        pipelineInfo.pDepthStencilState           = &depthStencil;
+
+        if (VK_SUCCESS != vkCreateGraphicsPipelines(m_device, VK_NULL_HANDLE, 1, &pipelineInfo, nullptr, &m_graphicsPipeline))
+        {
+            throw std::runtime_error("failed to create graphics pipeline");
+        }
+
+        vkDestroyShaderModule(m_device, fragShaderModule, nullptr);
+        vkDestroyShaderModule(m_device, vertShaderModule, nullptr);
+    }
+
+    /// @brief 创建剔除和构建深度金字塔使用的计算管线
+    void CreateComputePipelines()
+    {
+        // 剔除和绘制使用同一个描述符集布局，剔除的阶段通过推送常量传递
+        VkPushConstantRange cullPushConstantRange = {};
+        cullPushConstantRange.stageFlags          = VK_SHADER_STAGE_COMPUTE_BIT;
+        cullPushConstantRange.offset              = 0;
+        cullPushConstantRange.size                = sizeof(CullPushConstant);
+
+        VkPipelineLayoutCreateInfo cullPipelineLayoutInfo {};
+        cullPipelineLayoutInfo.sType                  = VK_STRUCTURE_TYPE_PIPELINE_LAYOUT_CREATE_INFO;
+        cullPipelineLayoutInfo.setLayoutCount         = 1;
+        cullPipelineLayoutInfo.pSetLayouts            = &m_descriptorSetLayout;
+        cullPipelineLayoutInfo.pushConstantRangeCount = 1;
+        cullPipelineLayoutInfo.pPushConstantRanges    = &cullPushConstantRange;
+
+        if (VK_SUCCESS != vkCreatePipelineLayout(m_device, &cullPipelineLayoutInfo, nullptr, &m_cullPipelineLayout))
+        {
+            throw std::runtime_error("failed to create cull pipeline layout");
+        }
+
+        m_cullPipeline = CreateComputePipeline("../resources/shaders/03_03_cull_comp.spv", m_cullPipelineLayout);
+
+        // 构建深度金字塔：binding 0 是上一层（第 0 层读取深度图像），binding 1 是要写入的这一层
+        VkDescriptorSetLayoutBinding srcBinding = {};
+        srcBinding.binding                      = 0;
+        srcBinding.descriptorType               = VK_DESCRIPTOR_TYPE_COMBINED_IMAGE_SAMPLER;
+        srcBinding.descriptorCount              = 1;
+        srcBinding.stageFlags                   = VK_SHADER_STAGE_COMPUTE_BIT;
+
+        VkDescriptorSetLayoutBinding dstBinding = {};
+        dstBinding.binding                      = 1;
+        dstBinding.descriptorType               = VK_DESCRIPTOR_TYPE_STORAGE_IMAGE;
+        dstBinding.descriptorCount              = 1;
+        dstBinding.stageFlags                   = VK_SHADER_STAGE_COMPUTE_BIT;
+
+        std::array hizBindings { srcBinding, dstBinding };
+
+        VkDescriptorSetLayoutCreateInfo hizLayoutInfo = {};
+        hizLayoutInfo.sType                           = VK_STRUCTURE_TYPE_DESCRIPTOR_SET_LAYOUT_CREATE_INFO;
+        hizLayoutInfo.bindingCount                    = static_cast<uint32_t>(hizBindings.size());
+        hizLayoutInfo.pBindings                       = hizBindings.data();
+
+        if (VK_SUCCESS != vkCreateDescriptorSetLayout(m_device, &hizLayoutInfo, nullptr, &m_hizDescriptorSetLayout))
+        {
+            throw std::runtime_error("failed to create hiz descriptor set layout");
+        }
+
+        VkPushConstantRange hizPushConstantRange = {};
+        hizPushConstantRange.stageFlags          = VK_SHADER_STAGE_COMPUTE_BIT;
+        hizPushConstantRange.offset              = 0;
+        hizPushConstantRange.size                = sizeof(HiZPushConstant);
+
+        VkPipelineLayoutCreateInfo hizPipelineLayoutInfo {};
+        hizPipelineLayoutInfo.sType                  = VK_STRUCTURE_TYPE_PIPELINE_LAYOUT_CREATE_INFO;
+        hizPipelineLayoutInfo.setLayoutCount         = 1;
+        hizPipelineLayoutInfo.pSetLayouts            = &m_hizDescriptorSetLayout;
+        hizPipelineLayoutInfo.pushConstantRangeCount = 1;
+        hizPipelineLayoutInfo.pPushConstantRanges    = &hizPushConstantRange;
+
+        if (VK_SUCCESS != vkCreatePipelineLayout(m_device, &hizPipelineLayoutInfo, nullptr, &m_hizPipelineLayout))
+        {
+            throw std::runtime_error("failed to create hiz pipeline layout");
+        }
+
+        m_hizPipeline = CreateComputePipeline("../resources/shaders/03_03_hiz_comp.spv", m_hizPipelineLayout);
+    }
+
+    VkPipeline CreateComputePipeline(const std::string& fileName, const VkPipelineLayout layout) const
+    {
+        auto computeShaderCode             = ReadFile(fileName);
+        VkShaderModule computeShaderModule = CreateShaderModule(computeShaderCode);
+
+        VkPipelineShaderStageCreateInfo computeShaderStageInfo {};
+        computeShaderStageInfo.sType  = VK_STRUCTURE_TYPE_PIPELINE_SHADER_STAGE_CREATE_INFO;
+        computeShaderStageInfo.stage  = VK_SHADER_STAGE_COMPUTE_BIT;
+        computeShaderStageInfo.module = computeShaderModule;
+        computeShaderStageInfo.pName  = "main";
+
+        VkComputePipelineCreateInfo pipelineInfo {};
+        pipelineInfo.sType  = VK_STRUCTURE_TYPE_COMPUTE_PIPELINE_CREATE_INFO;
+        pipelineInfo.layout = layout;
+        pipelineInfo.stage  = computeShaderStageInfo;
+
+        VkPipeline pipeline { nullptr };
+        if (VK_SUCCESS != vkCreateComputePipelines(m_device, VK_NULL_HANDLE, 1, &pipelineInfo, nullptr, &pipeline))
+        {
+            throw std::runtime_error("failed to create compute pipeline: " + fileName);
+        }
+
+        vkDestroyShaderModule(m_device, computeShaderModule, nullptr);
+
+        return pipeline;
+    }
+
+    /// @brief 使用着色器字节码数组创建 VkShaderModule 对象
+    /// @param code
+    /// @return
+    VkShaderModule CreateShaderModule(const std::vector<char>& code) const
+    {
+        VkShaderModuleCreateInfo createInfo = {};
+        createInfo.sType                    = VK_STRUCTURE_TYPE_SHADER_MODULE_CREATE_INFO;
+        createInfo.codeSize                 = code.size();
+        createInfo.pCode                    = reinterpret_cast<const uint32_t*>(code.data());
+
+        VkShaderModule shaderModule;
+        if (VK_SUCCESS != vkCreateShaderModule(m_device, &createInfo, nullptr, &shaderModule))
+        {
+            throw std::runtime_error("failed to create shader module");
+        }
+
+        return shaderModule;
+    }
+
+    /// @brief 创建两个渲染流程，分别用于第一阶段和第二阶段的绘制
+    /// @details 两个渲染流程的附着格式和采样数相同，是兼容的，可以共用帧缓冲和图形管线
+    void CreateRenderPass()
+    {
+        m_earlyRenderPass = CreateRenderPass(true);
+        m_lateRenderPass  = CreateRenderPass(false);
+    }
+
+    /// @brief 创建渲染流程对象，用于渲染的帧缓冲附着，指定颜色和深度缓冲以及采样数
+    /// @param early 第一阶段清除颜色和深度，结束后深度图像用于构建深度金字塔；第二阶段保留第一阶段的结果，结束后呈现
+    VkRenderPass CreateRenderPass(bool early) const
+    {
+        // 附着描述
+        VkAttachmentDescription colorAttachment = {};
+        colorAttachment.format                  = m_swapChainImageFormat; // 颜色缓冲附着的格式
+        colorAttachment.samples                 = VK_SAMPLE_COUNT_1_BIT;  // 采样数
+        colorAttachment.loadOp         = early ? VK_ATTACHMENT_LOAD_OP_CLEAR : VK_ATTACHMENT_LOAD_OP_LOAD; // 渲染之前对附着中的数据进行操作
+        colorAttachment.storeOp        = VK_ATTACHMENT_STORE_OP_STORE;     // 渲染之后对附着中的数据（颜色和深度）进行操作
+        colorAttachment.stencilLoadOp  = VK_ATTACHMENT_LOAD_OP_DONT_CARE;  // 渲染之前对模板缓冲的操作
+        colorAttachment.stencilStoreOp = VK_ATTACHMENT_STORE_OP_DONT_CARE; // 渲染之后对模板缓冲的操作
+        colorAttachment.initialLayout  = early ? VK_IMAGE_LAYOUT_UNDEFINED : VK_IMAGE_LAYOUT_COLOR_ATTACHMENT_OPTIMAL;
+        colorAttachment.finalLayout    = early ? VK_IMAGE_LAYOUT_COLOR_ATTACHMENT_OPTIMAL : VK_IMAGE_LAYOUT_PRESENT_SRC_KHR;
+
+        // 第一阶段的深度需要保留，结束后转换为只读布局，计算着色器从中采样
+        VkAttachmentDescription depthAttachment = {};
+        depthAttachment.format                  = FindDepthFormat();
+        depthAttachment.samples                 = VK_SAMPLE_COUNT_1_BIT;
+        depthAttachment.loadOp                  = early ? VK_ATTACHMENT_LOAD_OP_CLEAR : VK_ATTACHMENT_LOAD_OP_LOAD;
+        depthAttachment.storeOp                 = early ? VK_ATTACHMENT_STORE_OP_STORE : VK_ATTACHMENT_STORE_OP_DONT_CARE;
+        depthAttachment.stencilLoadOp           = VK_ATTACHMENT_LOAD_OP_DONT_CARE;
+        depthAttachment.stencilStoreOp          = VK_ATTACHMENT_STORE_OP_DONT_CARE;
+        depthAttachment.initialLayout           = early ? VK_IMAGE_LAYOUT_UNDEFINED : VK_IMAGE_LAYOUT_DEPTH_STENCIL_READ_ONLY_OPTIMAL;
+        depthAttachment.finalLayout = early ? VK_IMAGE_LAYOUT_DEPTH_STENCIL_READ_ONLY_OPTIMAL : VK_IMAGE_LAYOUT_DEPTH_STENCIL_ATTACHMENT_OPTIMAL;
+
+        // 子流程引用的附着
+        VkAttachmentReference colorAttachmentRef = {};
+        colorAttachmentRef.attachment            = 0; // 索引，对应于片段着色器中的 layout(location = 0) out
+        colorAttachmentRef.layout                = VK_IMAGE_LAYOUT_COLOR_ATTACHMENT_OPTIMAL;
+
+        VkAttachmentReference depthAttachmentRef = {};
+        depthAttachmentRef.attachment            = 1;
+        depthAttachmentRef.layout                = VK_IMAGE_LAYOUT_DEPTH_STENCIL_ATTACHMENT_OPTIMAL;
+
+        // 子流程
+        VkSubpassDescription subpass = {};
+        subpass.pipelineBindPoint    = VK_PIPELINE_BIND_POINT_GRAPHICS; // 图形渲染子流程
+        subpass.colorAttachmentCount = 1;                               // 颜色附着个数
+        subpass.pColorAttachments    = &colorAttachmentRef;             // 指定颜色附着
+        subpass.pDepthStencilAttachment = &depthAttachmentRef; // 指定深度模板附着，深度模板附着只能是一个，所以不用设置数量
+
+        std::array<VkSubpassDependency, 2> dependencies {};
+
+        // 渲染流程开始前：等待之前对附着的写入，第二阶段还要等待构建深度金字塔时对深度图像的读取
+        dependencies.at(0).srcSubpass = VK_SUBPASS_EXTERNAL;
+        dependencies.at(0).dstSubpass = 0;
+        dependencies.at(0).srcStageMask = VK_PIPELINE_STAGE_COLOR_ATTACHMENT_OUTPUT_BIT | VK_PIPELINE_STAGE_EARLY_FRAGMENT_TESTS_BIT
+            | VK_PIPELINE_STAGE_LATE_FRAGMENT_TESTS_BIT | VK_PIPELINE_STAGE_COMPUTE_SHADER_BIT;
+        dependencies.at(0).srcAccessMask = VK_ACCESS_COLOR_ATTACHMENT_WRITE_BIT | VK_ACCESS_DEPTH_STENCIL_ATTACHMENT_WRITE_BIT;
+        dependencies.at(0).dstStageMask  = VK_PIPELINE_STAGE_COLOR_ATTACHMENT_OUTPUT_BIT | VK_PIPELINE_STAGE_EARLY_FRAGMENT_TESTS_BIT;
+        dependencies.at(0).dstAccessMask = VK_ACCESS_COLOR_ATTACHMENT_READ_BIT | VK_ACCESS_COLOR_ATTACHMENT_WRITE_BIT
+            | VK_ACCESS_DEPTH_STENCIL_ATTACHMENT_READ_BIT | VK_ACCESS_DEPTH_STENCIL_ATTACHMENT_WRITE_BIT;
+
+        // 渲染流程结束后：第一阶段写入的深度在计算着色器中读取
+        dependencies.at(1).srcSubpass    = 0;
+        dependencies.at(1).dstSubpass    = VK_SUBPASS_EXTERNAL;
+        dependencies.at(1).srcStageMask  = VK_PIPELINE_STAGE_EARLY_FRAGMENT_TESTS_BIT | VK_PIPELINE_STAGE_LATE_FRAGMENT_TESTS_BIT;
+        dependencies.at(1).srcAccessMask = VK_ACCESS_DEPTH_STENCIL_ATTACHMENT_WRITE_BIT;
+        dependencies.at(1).dstStageMask  = VK_PIPELINE_STAGE_COMPUTE_SHADER_BIT;
+        dependencies.at(1).dstAccessMask = VK_ACCESS_SHADER_READ_BIT;
+
+        std::array<VkAttachmentDescription, 2> attachments { colorAttachment, depthAttachment };
+
+        VkRenderPassCreateInfo renderPassInfo = {};
+        renderPassInfo.sType                  = VK_STRUCTURE_TYPE_RENDER_PASS_CREATE_INFO;
+        renderPassInfo.attachmentCount        = static_cast<uint32_t>(attachments.size());
+        renderPassInfo.pAttachments           = attachments.data();
+        renderPassInfo.subpassCount           = 1;
+        renderPassInfo.pSubpasses             = &subpass;
+        renderPassInfo.dependencyCount        = early ? 2 : 1;
+        renderPassInfo.pDependencies          = dependencies.data();
+
+        VkRenderPass renderPass { nullptr };
+        if (VK_SUCCESS != vkCreateRenderPass(m_device, &renderPassInfo, nullptr, &renderPass))
+        {
+            throw std::runtime_error("failed to create render pass");
+        }
+
+        return renderPass;
+    }
+
+    /// @brief 创建帧缓冲对象，附着需要绑定到帧缓冲对象上使用
+    void CreateFramebuffers()
+    {
+        m_swapChainFramebuffers.resize(m_swapChainImageViews.size());
+
+        for (size_t i = 0; i < m_swapChainImageViews.size(); ++i)
+        {
+            std::array<VkImageView, 2> attachments { m_swapChainImageViews.at(i), m_depthImageView };
+
+            VkFramebufferCreateInfo framebufferInfo = {};
+            framebufferInfo.sType                   = VK_STRUCTURE_TYPE_FRAMEBUFFER_CREATE_INFO;
+            framebufferInfo.renderPass              = m_earlyRenderPass;
+            framebufferInfo.attachmentCount         = static_cast<uint32_t>(attachments.size());
+            framebufferInfo.pAttachments            = attachments.data();
+            framebufferInfo.width                   = m_swapChainExtent.width;
+            framebufferInfo.height                  = m_swapChainExtent.height;
+            framebufferInfo.layers                  = 1;
+
+            if (VK_SUCCESS != vkCreateFramebuffer(m_device, &framebufferInfo, nullptr, &m_swapChainFramebuffers.at(i)))
+            {
+                throw std::runtime_error("failed to create framebuffer");
+            }
+        }
+    }
+
+    /// @brief 初始化ImGui
+    void InitImGui()
+    {
+        ImGui::CreateContext();
+        ImGuiIO& io = ImGui::GetIO();
+        io.ConfigFlags |= ImGuiConfigFlags_NavEnableKeyboard;
+        io.DisplaySize = ImVec2((float)(WIDTH), (float)(HEIGHT));
+        io.Fonts->Build();
+
+        ImGui::StyleColorsDark();
+        ImGui_ImplGlfw_InitForVulkan(m_window, true);
+
+        ImGui_ImplVulkan_InitInfo init_info = {};
+        init_info.Instance                  = m_instance;
+        init_info.PhysicalDevice            = m_physicalDevice;
+        init_info.Device                    = m_device;
+        init_info.Queue                     = m_presentQueue;
+        init_info.DescriptorPool            = m_imguiDescriptorPool;
+        init_info.Subpass                   = 0;
+        init_info.MinImageCount             = m_minImageCount;
+        init_info.ImageCount                = m_minImageCount;
+        init_info.MSAASamples               = VK_SAMPLE_COUNT_1_BIT;
+
+        // ImGui 在第二阶段的渲染流程中绘制
+        ImGui_ImplVulkan_Init(&init_info, m_lateRenderPass);
+
+        vkResetCommandPool(m_device, m_commandPool, 0);
+
+        VkCommandBufferBeginInfo begin_info = {};
+        begin_info.sType                    = VK_STRUCTURE_TYPE_COMMAND_BUFFER_BEGIN_INFO;
+        begin_info.flags |= VK_COMMAND_BUFFER_USAGE_ONE_TIME_SUBMIT_BIT;
+        vkBeginCommandBuffer(m_commandBuffers[m_currentFrame], &begin_info);
+
+        ImGui_ImplVulkan_CreateFontsTexture(m_commandBuffers[m_currentFrame]);
+
+        VkSubmitInfo end_info       = {};
+        end_info.sType              = VK_STRUCTURE_TYPE_SUBMIT_INFO;
+        end_info.commandBufferCount = 1;
+        end_info.pCommandBuffers    = &m_commandBuffers[m_currentFrame];
+        vkEndCommandBuffer(m_commandBuffers[m_currentFrame]);
+
+        vkQueueSubmit(m_graphicsQueue, 1, &end_info, VK_NULL_HANDLE);
+        vkDeviceWaitIdle(m_device);
+
+        ImGui_ImplVulkan_DestroyFontUploadObjects();
+    }
+
+    /// @brief 地面上的网格排列的小立方体，随机分布一些高大的建筑，从街道的高度看过去大部分物体都被建筑挡住
+    /// @details 物体数据只在初始化时上传一次，之后只由 GPU 读取
+    void CreateScene()
+    {
+        CreateVertexBuffer(verticesCube, m_drawableCube);
+        CreateIndexBuffer(indicesCube, m_drawableCube);
+
+        std::mt19937 engine { 1234 };
+        std::uniform_real_distribution<float> random { 0.f, 1.f };
+
+        std::vector<ObjectData> objects {};
+        objects.reserve(OBJECT_COUNT);
+
+        constexpr auto halfExtent = static_cast<float>(GRID_SIZE - 1) * OBJECT_SPACING * 0.5f;
+        for (uint32_t z = 0; z < GRID_SIZE; ++z)
+        {
+            for (uint32_t x = 0; x < GRID_SIZE; ++x)
+            {
+                glm::vec3 position { static_cast<float>(x) * OBJECT_SPACING - halfExtent, 0.f, static_cast<float>(z) * OBJECT_SPACING - halfExtent };
+
+                ObjectData object {};
+                if (random(engine) < BUILDING_CHANCE)
+                {
+                    auto size            = 6.f + 6.f * random(engine);
+                    object.positionScale = glm::vec4 { position.x, size * 0.5f, position.z, size };
+                    object.color         = glm::vec4 { .6f, .6f, .65f, 1.f };
+                }
+                else
+                {
+                    auto size            = 0.4f + 0.8f * random(engine);
+                    object.positionScale = glm::vec4 { position.x, size * 0.5f, position.z, size };
+                    object.color         = glm::vec4 { random(engine), random(engine), random(engine), 1.f };
+                }
+                objects.emplace_back(object);
+            }
+        }
+
+        VkDeviceSize bufferSize = sizeof(ObjectData) * objects.size();
+
+        VkBuffer stagingBuffer {};
+        VkDeviceMemory stagingBufferMemory {};
+
+        CreateBuffer(bufferSize, VK_BUFFER_USAGE_TRANSFER_SRC_BIT, VK_MEMORY_PROPERTY_HOST_VISIBLE_BIT | VK_MEMORY_PROPERTY_HOST_COHERENT_BIT,
+            stagingBuffer, stagingBufferMemory);
+
+        void* data { nullptr };
+        vkMapMemory(m_device, stagingBufferMemory, 0, bufferSize, 0, &data);
+        std::memcpy(data, objects.data(), static_cast<size_t>(bufferSize));
+        vkUnmapMemory(m_device, stagingBufferMemory);
+
+        CreateBuffer(bufferSize, VK_BUFFER_USAGE_TRANSFER_DST_BIT | VK_BUFFER_USAGE_STORAGE_BUFFER_BIT, VK_MEMORY_PROPERTY_DEVICE_LOCAL_BIT,
+            m_objectBuffer, m_objectBufferMemory);
+
+        CopyBuffer(stagingBuffer, m_objectBuffer, bufferSize);
+
+        vkDestroyBuffer(m_device, stagingBuffer, nullptr);
+        vkFreeMemory(m_device, stagingBufferMemory, nullptr);
+    }
+
+    /// @brief 剔除使用的缓冲，只在 GPU 上读写
+    /// @details 所有帧共用一份，帧之间按照提交顺序执行，通过指令缓冲开始处的屏障避免写后读、读后写的冲突
+    void CreateCullingBuffers()
+    {
+        // 两个阶段各一个间接绘制命令，每一帧开始时用 vkCmdUpdateBuffer 重置
+        CreateBuffer(sizeof(VkDrawIndexedIndirectCommand) * 2,
+            VK_BUFFER_USAGE_STORAGE_BUFFER_BIT | VK_BUFFER_USAGE_INDIRECT_BUFFER_BIT | VK_BUFFER_USAGE_TRANSFER_SRC_BIT
+                | VK_BUFFER_USAGE_TRANSFER_DST_BIT,
+            VK_MEMORY_PROPERTY_DEVICE_LOCAL_BIT, m_drawCommandBuffer, m_drawCommandBufferMemory);
+
+        // 可见物体的序号，前一半是第一阶段，后一半是第二阶段
+        CreateBuffer(sizeof(uint32_t) * OBJECT_COUNT * 2, VK_BUFFER_USAGE_STORAGE_BUFFER_BIT, VK_MEMORY_PROPERTY_DEVICE_LOCAL_BIT,
+            m_visibleListBuffer, m_visibleListBufferMemory);
+
+        // 第一阶段每个物体的结果，第二阶段只重新测试结果为 0 的物体
+        CreateBuffer(sizeof(uint32_t) * OBJECT_COUNT, VK_BUFFER_USAGE_STORAGE_BUFFER_BIT, VK_MEMORY_PROPERTY_DEVICE_LOCAL_BIT,
+            m_phase1ResultBuffer, m_phase1ResultBufferMemory);
+
+        // 每一帧结束时把两个间接绘制命令复制到 CPU 可见的缓冲，等待该帧的栅栏之后读取
+        for (size_t i = 0; i < MAX_FRAMES_IN_FLIGHT; ++i)
+        {
+            CreateBuffer(sizeof(VkDrawIndexedIndirectCommand) * 2, VK_BUFFER_USAGE_TRANSFER_DST_BIT,
+                VK_MEMORY_PROPERTY_HOST_VISIBLE_BIT | VK_MEMORY_PROPERTY_HOST_COHERENT_BIT, m_statisticsBuffers.at(i),
+                m_statisticsBuffersMemory.at(i));
+            vkMapMemory(
+                m_device, m_statisticsBuffersMemory.at(i), 0, sizeof(VkDrawIndexedIndirectCommand) * 2, 0, &m_statisticsBuffersMapped.at(i));
+        }
+    }
+
+    /// @brief 读取深度金字塔使用的采样器，不做过滤，每个纹素都是保守的最大深度
+    void CreatePyramidSampler()
+    {
+        VkSamplerCreateInfo samplerInfo {};
+        samplerInfo.sType        = VK_STRUCTURE_TYPE_SAMPLER_CREATE_INFO;
+        samplerInfo.magFilter    = VK_FILTER_NEAREST;
+        samplerInfo.minFilter    = VK_FILTER_NEAREST;
+        samplerInfo.mipmapMode   = VK_SAMPLER_MIPMAP_MODE_NEAREST;
+        samplerInfo.addressModeU = VK_SAMPLER_ADDRESS_MODE_CLAMP_TO_EDGE;
+        samplerInfo.addressModeV = VK_SAMPLER_ADDRESS_MODE_CLAMP_TO_EDGE;
+        samplerInfo.addressModeW = VK_SAMPLER_ADDRESS_MODE_CLAMP_TO_EDGE;
+        samplerInfo.minLod       = 0.f;
+        samplerInfo.maxLod       = VK_LOD_CLAMP_NONE;
+
+        if (VK_SUCCESS != vkCreateSampler(m_device, &samplerInfo, nullptr, &m_pyramidSampler))
+        {
+            throw std::runtime_error("failed to create pyramid sampler");
+        }
+    }
+
+    /// @brief 创建深度金字塔，大小和交换链相关，重建交换链时也要重建
+    /// @details 第 0 层是不超过深度图像大小的 2 的幂，之后每一层的宽高减半，直到 1x1
+    ///          每一层一个图像视图，既是这一层的写入目标，也是下一层的输入；另外一个包含所有层的视图给剔除着色器采样
+    ///          图像始终处于 VK_IMAGE_LAYOUT_GENERAL 布局，同时作为存储图像和采样图像使用
+    void CreateDepthPyramid()
+    {
+        m_pyramidWidth  = std::bit_floor(m_swapChainExtent.width);
+        m_pyramidHeight = std::bit_floor(m_swapChainExtent.height);
+        m_pyramidLevels = static_cast<uint32_t>(std::bit_width(std::max(m_pyramidWidth, m_pyramidHeight)));
+
+        CreateImage(m_pyramidWidth, m_pyramidHeight, m_pyramidLevels, VK_FORMAT_R32_SFLOAT, VK_IMAGE_TILING_OPTIMAL,
+            VK_IMAGE_USAGE_STORAGE_BIT | VK_IMAGE_USAGE_SAMPLED_BIT, VK_MEMORY_PROPERTY_DEVICE_LOCAL_BIT, m_pyramidImage, m_pyramidImageMemory);
+
+        m_pyramidView = CreateImageView(m_pyramidImage, VK_FORMAT_R32_SFLOAT, VK_IMAGE_ASPECT_COLOR_BIT, 0, m_pyramidLevels);
+
+        m_pyramidMipViews.resize(m_pyramidLevels);
+        for (uint32_t i = 0; i < m_pyramidLevels; ++i)
+        {
+            m_pyramidMipViews.at(i) = CreateImageView(m_pyramidImage, VK_FORMAT_R32_SFLOAT, VK_IMAGE_ASPECT_COLOR_BIT, i, 1);
+        }
+
+        // 每一层一个描述符集
+        std::array<VkDescriptorPoolSize, 2> poolSizes {};
+        poolSizes.at(0).type            = VK_DESCRIPTOR_TYPE_COMBINED_IMAGE_SAMPLER;
+        poolSizes.at(0).descriptorCount = m_pyramidLevels;
+        poolSizes.at(1).type            = VK_DESCRIPTOR_TYPE_STORAGE_IMAGE;
+        poolSizes.at(1).descriptorCount = m_pyramidLevels;
+
+        VkDescriptorPoolCreateInfo poolInfo {};
+        poolInfo.sType         = VK_STRUCTURE_TYPE_DESCRIPTOR_POOL_CREATE_INFO;
+        poolInfo.poolSizeCount = static_cast<uint32_t>(poolSizes.size());
+        poolInfo.pPoolSizes    = poolSizes.data();
+        poolInfo.maxSets       = m_pyramidLevels;
+
+        if (VK_SUCCESS != vkCreateDescriptorPool(m_device, &poolInfo, nullptr, &m_pyramidDescriptorPool))
+        {
+            throw std::runtime_error("failed to create pyramid descriptor pool");
+        }
+
+        std::vector<VkDescriptorSetLayout> layouts(m_pyramidLevels, m_hizDescriptorSetLayout);
+
+        VkDescriptorSetAllocateInfo allocInfo {};
+        allocInfo.sType              = VK_STRUCTURE_TYPE_DESCRIPTOR_SET_ALLOCATE_INFO;
+        allocInfo.descriptorPool     = m_pyramidDescriptorPool;
+        allocInfo.descriptorSetCount = m_pyramidLevels;
+        allocInfo.pSetLayouts        = layouts.data();
+
+        m_pyramidDescriptorSets.resize(m_pyramidLevels);
+        if (VK_SUCCESS != vkAllocateDescriptorSets(m_device, &allocInfo, m_pyramidDescriptorSets.data()))
+        {
+            throw std::runtime_error("failed to allocate pyramid descriptor sets");
+        }
+
+        for (uint32_t i = 0; i < m_pyramidLevels; ++i)
+        {
+            // 第 0 层从深度图像读取，此时深度图像处于第一阶段渲染流程结束后的只读布局
+            VkDescriptorImageInfo srcInfo {};
+            srcInfo.sampler     = m_pyramidSampler;
+            srcInfo.imageView   = 0 == i ? m_depthImageView : m_pyramidMipViews.at(i - 1);
+            srcInfo.imageLayout = 0 == i ? VK_IMAGE_LAYOUT_DEPTH_STENCIL_READ_ONLY_OPTIMAL : VK_IMAGE_LAYOUT_GENERAL;
+
+            VkDescriptorImageInfo dstInfo {};
+            dstInfo.imageView   = m_pyramidMipViews.at(i);
+            dstInfo.imageLayout = VK_IMAGE_LAYOUT_GENERAL;
+
+            std::array<VkWriteDescriptorSet, 2> descriptorWrites {};
+
+            descriptorWrites.at(0).sType           = VK_STRUCTURE_TYPE_WRITE_DESCRIPTOR_SET;
+            descriptorWrites.at(0).dstSet          = m_pyramidDescriptorSets.at(i);
+            descriptorWrites.at(0).dstBinding      = 0;
+            descriptorWrites.at(0).descriptorType  = VK_DESCRIPTOR_TYPE_COMBINED_IMAGE_SAMPLER;
+            descriptorWrites.at(0).descriptorCount = 1;
+            descriptorWrites.at(0).pImageInfo      = &srcInfo;
+
+            descriptorWrites.at(1).sType           = VK_STRUCTURE_TYPE_WRITE_DESCRIPTOR_SET;
+            descriptorWrites.at(1).dstSet          = m_pyramidDescriptorSets.at(i);
+            descriptorWrites.at(1).dstBinding      = 1;
+            descriptorWrites.at(1).descriptorType  = VK_DESCRIPTOR_TYPE_STORAGE_IMAGE;
+            descriptorWrites.at(1).descriptorCount = 1;
+            descriptorWrites.at(1).pImageInfo      = &dstInfo;
+
+            vkUpdateDescriptorSets(m_device, static_cast<uint32_t>(descriptorWrites.size()), descriptorWrites.data(), 0, nullptr);
+        }
+
+        // 新的深度金字塔中没有数据，第一阶段暂时只做视锥剔除
+        m_pyramidValid = false;
+    }
+
+    /// @brief 创建指令池，用于管理指令缓冲对象使用的内存，并负责指令缓冲对象的分配
+    void CreateCommandPool()
+    {
+        auto indices = FindQueueFamilies(m_physicalDevice);
+
+        // VK_COMMAND_POOL_CREATE_TRANSIENT_BIT 指定从Pool中分配的CommandBuffer将是短暂的，意味着它们将在相对较短的时间内被重置或释放
+        // VK_COMMAND_POOL_CREATE_RESET_COMMAND_BUFFER_BIT 允许从Pool中分配的任何CommandBuffer被单独重置到inital状态
+        // 没有设置这个flag则不能使用 vkResetCommandBuffer
+        // VK_COMMAND_POOL_CREATE_PROTECTED_BIT 指定从Pool中分配的CommandBuffer是受保护的CommandBuffer
+        VkCommandPoolCreateInfo poolInfo = {};
+        poolInfo.sType                   = VK_STRUCTURE_TYPE_COMMAND_POOL_CREATE_INFO;
+        poolInfo.flags                   = VK_COMMAND_POOL_CREATE_RESET_COMMAND_BUFFER_BIT;
+        poolInfo.queueFamilyIndex        = indices.graphicsFamily.value();
+
+        if (VK_SUCCESS != vkCreateCommandPool(m_device, &poolInfo, nullptr, &m_commandPool))
+        {
+            throw std::runtime_error("failed to create command pool");
+        }
+    }
+
+    /// @brief 为交换链中的每一个图像创建指令缓冲对象，使用它记录绘制指令
+    void CreateCommandBuffers()
+    {
+        m_commandBuffers.resize(m_swapChainFramebuffers.size());
+
+        VkCommandBufferAllocateInfo allocInfo = {};
+        allocInfo.sType                       = VK_STRUCTURE_TYPE_COMMAND_BUFFER_ALLOCATE_INFO;
+        allocInfo.commandPool                 = m_commandPool;
+        allocInfo.level                       = VK_COMMAND_BUFFER_LEVEL_PRIMARY; // 指定是主要还是辅助指令缓冲对象
+        allocInfo.commandBufferCount          = static_cast<uint32_t>(m_commandBuffers.size());
+
+        if (VK_SUCCESS != vkAllocateCommandBuffers(m_device, &allocInfo, m_commandBuffers.data()))
+        {
+            throw std::runtime_error("failed to allocate command buffers");
+        }
+    }
+
+    /// @brief 记录指令到指令缓冲
+    /// @details 剔除、绘制、构建深度金字塔都在同一个指令缓冲中，两个阶段之间没有 CPU 参与
+    void RecordCommandBuffer(const VkCommandBuffer commandBuffer, const VkFramebuffer framebuffer) const
+    {
+        VkCommandBufferBeginInfo beginInfo = {};
+        beginInfo.sType                    = VK_STRUCTURE_TYPE_COMMAND_BUFFER_BEGIN_INFO;
+        beginInfo.flags                    = VK_COMMAND_BUFFER_USAGE_SIMULTANEOUS_USE_BIT; // 指定怎样使用指令缓冲
+        beginInfo.pInheritanceInfo         = nullptr; // 只用于辅助指令缓冲，指定从调用它的主要指令缓冲继承的状态
+
+        if (VK_SUCCESS != vkBeginCommandBuffer(commandBuffer, &beginInfo))
+        {
+            throw std::runtime_error("failed to begin recording command buffer");
+        }
+
+        const auto descriptorSet  = m_descriptorSets.at(m_currentFrame);
+        const auto cullGroupCount = (OBJECT_COUNT + CULL_GROUP_SIZE - 1) / CULL_GROUP_SIZE;
+
+        // 新建的深度金字塔从未定义的布局转换为通用布局，之后一直保持这个布局
+        if (!m_pyramidValid)
+        {
+            VkImageMemoryBarrier pyramidBarrier            = {};
+            pyramidBarrier.sType                           = VK_STRUCTURE_TYPE_IMAGE_MEMORY_BARRIER;
+            pyramidBarrier.srcAccessMask                   = 0;
+            pyramidBarrier.dstAccessMask                   = VK_ACCESS_SHADER_READ_BIT | VK_ACCESS_SHADER_WRITE_BIT;
+            pyramidBarrier.oldLayout                       = VK_IMAGE_LAYOUT_UNDEFINED;
+            pyramidBarrier.newLayout                       = VK_IMAGE_LAYOUT_GENERAL;
+            pyramidBarrier.srcQueueFamilyIndex             = VK_QUEUE_FAMILY_IGNORED;
+            pyramidBarrier.dstQueueFamilyIndex             = VK_QUEUE_FAMILY_IGNORED;
+            pyramidBarrier.image                           = m_pyramidImage;
+            pyramidBarrier.subresourceRange.aspectMask     = VK_IMAGE_ASPECT_COLOR_BIT;
+            pyramidBarrier.subresourceRange.baseMipLevel   = 0;
+            pyramidBarrier.subresourceRange.levelCount     = m_pyramidLevels;
+            pyramidBarrier.subresourceRange.baseArrayLayer = 0;
+            pyramidBarrier.subresourceRange.layerCount     = 1;
+
+            vkCmdPipelineBarrier(commandBuffer, VK_PIPELINE_STAGE_TOP_OF_PIPE_BIT, VK_PIPELINE_STAGE_COMPUTE_SHADER_BIT, 0, 0, nullptr, 0, nullptr,
+                1, &pyramidBarrier);
+        }
+
+        // 1. 重置两个间接绘制命令，上一帧对剔除缓冲的读取（间接绘制、顶点着色器、统计信息的复制）必须先完成
+        InsertMemoryBarrier(commandBuffer,
+            VK_PIPELINE_STAGE_DRAW_INDIRECT_BIT | VK_PIPELINE_STAGE_VERTEX_SHADER_BIT | VK_PIPELINE_STAGE_COMPUTE_SHADER_BIT
+                | VK_PIPELINE_STAGE_TRANSFER_BIT,
+            0, VK_PIPELINE_STAGE_TRANSFER_BIT | VK_PIPELINE_STAGE_COMPUTE_SHADER_BIT, 0);
+
+        std::array<VkDrawIndexedIndirectCommand, 2> drawCommands {};
+        for (auto& drawCommand : drawCommands)
+        {
+            drawCommand.indexCount = m_drawableCube.indexCount; // instanceCount 由剔除着色器累加
+        }
+        vkCmdUpdateBuffer(commandBuffer, m_drawCommandBuffer, 0, sizeof(drawCommands), drawCommands.data());
+
+        InsertMemoryBarrier(commandBuffer, VK_PIPELINE_STAGE_TRANSFER_BIT, VK_ACCESS_TRANSFER_WRITE_BIT, VK_PIPELINE_STAGE_COMPUTE_SHADER_BIT,
+            VK_ACCESS_SHADER_READ_BIT | VK_ACCESS_SHADER_WRITE_BIT);
+
+        // 2. 第一阶段剔除，使用上一帧的深度金字塔
+        Cull(commandBuffer, descriptorSet, 0, cullGroupCount);
+
+        InsertMemoryBarrier(commandBuffer, VK_PIPELINE_STAGE_COMPUTE_SHADER_BIT, VK_ACCESS_SHADER_WRITE_BIT,
+            VK_PIPELINE_STAGE_DRAW_INDIRECT_BIT | VK_PIPELINE_STAGE_VERTEX_SHADER_BIT, VK_ACCESS_INDIRECT_COMMAND_READ_BIT | VK_ACCESS_SHADER_READ_BIT);
+
+        // 3. 第一阶段绘制
+        std::array<VkClearValue, 2> clearValues {};
+        clearValues.at(0).color        = { { .1f, .2f, .3f, 1.f } };
+        clearValues.at(1).depthStencil = { 1.f, 0 };
+
+        VkRenderPassBeginInfo renderPassInfo = {};
+        renderPassInfo.sType                 = VK_STRUCTURE_TYPE_RENDER_PASS_BEGIN_INFO;
+        renderPassInfo.renderPass            = m_earlyRenderPass;                   // 指定使用的渲染流程对象
+        renderPassInfo.framebuffer           = framebuffer;                         // 指定使用的帧缓冲对象
+        renderPassInfo.renderArea.offset     = { 0, 0 };                            // 指定用于渲染的区域
+        renderPassInfo.renderArea.extent     = m_swapChainExtent;
+        renderPassInfo.clearValueCount = static_cast<uint32_t>(clearValues.size()); // 指定使用 VK_ATTACHMENT_LOAD_OP_CLEAR 标记后使用的清除值
+        renderPassInfo.pClearValues = clearValues.data();
+
+        vkCmdBeginRenderPass(commandBuffer, &renderPassInfo, VK_SUBPASS_CONTENTS_INLINE);
+        DrawVisibleObjects(commandBuffer, descriptorSet, 0);
+        vkCmdEndRenderPass(commandBuffer);
+
+        // 4. 使用第一阶段的深度构建深度金字塔
+        // 覆盖深度金字塔之前，第一阶段剔除对它的读取必须完成，第一阶段的剔除结果在第二阶段读取
+        InsertMemoryBarrier(commandBuffer, VK_PIPELINE_STAGE_COMPUTE_SHADER_BIT, VK_ACCESS_SHADER_WRITE_BIT, VK_PIPELINE_STAGE_COMPUTE_SHADER_BIT,
+            VK_ACCESS_SHADER_READ_BIT | VK_ACCESS_SHADER_WRITE_BIT);
+
+        vkCmdBindPipeline(commandBuffer, VK_PIPELINE_BIND_POINT_COMPUTE, m_hizPipeline);
+        for (uint32_t i = 0; i < m_pyramidLevels; ++i)
+        {
+            HiZPushConstant pushConstant {};
+            pushConstant.dstSize = glm::ivec2 { std::max(m_pyramidWidth >> i, 1u), std::max(m_pyramidHeight >> i, 1u) };
+            pushConstant.srcSize = 0 == i ? glm::ivec2 { m_swapChainExtent.width, m_swapChainExtent.height }
+                                          : glm::ivec2 { std::max(m_pyramidWidth >> (i - 1), 1u), std::max(m_pyramidHeight >> (i - 1), 1u) };
+
+            vkCmdBindDescriptorSets(
+                commandBuffer, VK_PIPELINE_BIND_POINT_COMPUTE, m_hizPipelineLayout, 0, 1, &m_pyramidDescriptorSets.at(i), 0, nullptr);
+            vkCmdPushConstants(commandBuffer, m_hizPipelineLayout, VK_SHADER_STAGE_COMPUTE_BIT, 0, sizeof(HiZPushConstant), &pushConstant);
+            vkCmdDispatch(commandBuffer, (static_cast<uint32_t>(pushConstant.dstSize.x) + HIZ_GROUP_SIZE - 1) / HIZ_GROUP_SIZE,
+                (static_cast<uint32_t>(pushConstant.dstSize.y) + HIZ_GROUP_SIZE - 1) / HIZ_GROUP_SIZE, 1);
+
+            // 下一层（以及第二阶段剔除）读取这一层的结果
+            InsertMemoryBarrier(
+                commandBuffer, VK_PIPELINE_STAGE_COMPUTE_SHADER_BIT, VK_ACCESS_SHADER_WRITE_BIT, VK_PIPELINE_STAGE_COMPUTE_SHADER_BIT, VK_ACCESS_SHADER_READ_BIT);
+        }
+
+        // 5. 第二阶段剔除，只测试第一阶段被剔除的物体，使用本帧的深度金字塔
+        Cull(commandBuffer, descriptorSet, 1, cullGroupCount);
+
+        InsertMemoryBarrier(commandBuffer, VK_PIPELINE_STAGE_COMPUTE_SHADER_BIT, VK_ACCESS_SHADER_WRITE_BIT,
+            VK_PIPELINE_STAGE_DRAW_INDIRECT_BIT | VK_PIPELINE_STAGE_VERTEX_SHADER_BIT | VK_PIPELINE_STAGE_TRANSFER_BIT,
+            VK_ACCESS_INDIRECT_COMMAND_READ_BIT | VK_ACCESS_SHADER_READ_BIT | VK_ACCESS_TRANSFER_READ_BIT);
+
+        // 6. 第二阶段绘制，在第一阶段的结果上继续绘制，不需要清除
+        renderPassInfo.renderPass      = m_lateRenderPass;
+        renderPassInfo.clearValueCount = 0;
+        renderPassInfo.pClearValues    = nullptr;
+
+        vkCmdBeginRenderPass(commandBuffer, &renderPassInfo, VK_SUBPASS_CONTENTS_INLINE);
+        DrawVisibleObjects(commandBuffer, descriptorSet, 1);
+
+        // 绘制ImGui
+        ImGui_ImplVulkan_RenderDrawData(ImGui::GetDrawData(), commandBuffer);
+
+        vkCmdEndRenderPass(commandBuffer);
+
+        // 7. 把两个阶段的绘制命令复制到 CPU 可见的缓冲，等待这一帧的栅栏之后读取
+        VkBufferCopy copyRegion = {};
+        copyRegion.srcOffset    = 0;
+        copyRegion.dstOffset    = 0;
+        copyRegion.size         = sizeof(VkDrawIndexedIndirectCommand) * 2;
+        vkCmdCopyBuffer(commandBuffer, m_drawCommandBuffer, m_statisticsBuffers.at(m_currentFrame), 1, &copyRegion);
+
+        InsertMemoryBarrier(commandBuffer, VK_PIPELINE_STAGE_TRANSFER_BIT, VK_ACCESS_TRANSFER_WRITE_BIT, VK_PIPELINE_STAGE_HOST_BIT, VK_ACCESS_HOST_READ_BIT);
+
+        // 结束记录指令到指令缓冲
+        if (VK_SUCCESS != vkEndCommandBuffer(commandBuffer))
+        {
+            throw std::runtime_error("failed to record command buffer");
+        }
+    }
+
+    /// @brief 执行一个阶段的剔除
+    void Cull(const VkCommandBuffer commandBuffer, const VkDescriptorSet descriptorSet, uint32_t phase, uint32_t groupCount) const noexcept
+    {
+        CullPushConstant pushConstant {};
+        pushConstant.phase = phase;
+
+        vkCmdBindPipeline(commandBuffer, VK_PIPELINE_BIND_POINT_COMPUTE, m_cullPipeline);
+        vkCmdBindDescriptorSets(commandBuffer, VK_PIPELINE_BIND_POINT_COMPUTE, m_cullPipelineLayout, 0, 1, &descriptorSet, 0, nullptr);
+        vkCmdPushConstants(commandBuffer, m_cullPipelineLayout, VK_SHADER_STAGE_COMPUTE_BIT, 0, sizeof(CullPushConstant), &pushConstant);
+        vkCmdDispatch(commandBuffer, groupCount, 1, 1);
+    }
+
+    /// @brief 使用剔除着色器生成的间接绘制命令绘制一个阶段的可见物体
+    void DrawVisibleObjects(const VkCommandBuffer commandBuffer, const VkDescriptorSet descriptorSet, uint32_t phase) const noexcept
+    {
+        VkViewport viewport = {};
+        viewport.x          = 0.f;
+        viewport.y          = 0.f;
+        viewport.width      = static_cast<float>(m_swapChainExtent.width);
+        viewport.height     = static_cast<float>(m_swapChainExtent.height);
+        viewport.minDepth   = 0.f;
+        viewport.maxDepth   = 1.f;
+
+        vkCmdSetViewport(commandBuffer, 0, 1, &viewport);
+
+        VkRect2D scissor = {};
+        scissor.offset   = { 0, 0 };
+        scissor.extent   = m_swapChainExtent;
+
+        vkCmdSetScissor(commandBuffer, 0, 1, &scissor);
+
+        DrawPushConstant pushConstant {};
+        pushConstant.listOffset = phase * OBJECT_COUNT;
+
+        VkDeviceSize offsets[] = { 0 };
+
+        vkCmdBindPipeline(commandBuffer, VK_PIPELINE_BIND_POINT_GRAPHICS, m_graphicsPipeline);
+        vkCmdBindDescriptorSets(commandBuffer, VK_PIPELINE_BIND_POINT_GRAPHICS, m_pipelineLayout, 0, 1, &descriptorSet, 0, nullptr);
+        vkCmdBindVertexBuffers(commandBuffer, 0, 1, &m_drawableCube.vertexBuffer, offsets);
+        vkCmdBindIndexBuffer(commandBuffer, m_drawableCube.indexBuffer, 0, VK_INDEX_TYPE_UINT16);
+        vkCmdPushConstants(commandBuffer, m_pipelineLayout, VK_SHADER_STAGE_VERTEX_BIT, 0, sizeof(DrawPushConstant), &pushConstant);
+
+        // 所有可见物体只有一次绘制调用，实例数量由剔除着色器写入
+        vkCmdDrawIndexedIndirect(
+            commandBuffer, m_drawCommandBuffer, sizeof(VkDrawIndexedIndirectCommand) * phase, 1, sizeof(VkDrawIndexedIndirectCommand));
+    }
+
+    /// @brief 全局内存屏障，剔除缓冲和深度金字塔都只在一个队列上使用，不需要指定具体的缓冲和图像
+    static void InsertMemoryBarrier(const VkCommandBuffer commandBuffer, VkPipelineStageFlags srcStageMask, VkAccessFlags srcAccessMask,
+        VkPipelineStageFlags dstStageMask, VkAccessFlags dstAccessMask) noexcept
+    {
+        VkMemoryBarrier memoryBarrier = {};
+        memoryBarrier.sType           = VK_STRUCTURE_TYPE_MEMORY_BARRIER;
+        memoryBarrier.srcAccessMask   = srcAccessMask;
+        memoryBarrier.dstAccessMask   = dstAccessMask;
+
+        vkCmdPipelineBarrier(commandBuffer, srcStageMask, dstStageMask, 0, 1, &memoryBarrier, 0, nullptr, 0, nullptr);
+    }
+
+    /// @brief 绘制每一帧
+    /// @details 流程：从交换链获取一张图像、对帧缓冲附着执行指令缓冲中的渲染指令、返回渲染后的图像到交换链进行呈现操作
+    void DrawFrame()
+    {
+        // 等待一组栅栏中的一个或全部栅栏发出信号，即上一次提交的指令结束执行
+        // 使用栅栏可以进行CPU与GPU之间的同步，防止超过 MAX_FRAMES_IN_FLIGHT 帧的指令同时被提交执行
+        vkWaitForFences(m_device, 1, &m_inFlightFences.at(m_currentFrame), VK_TRUE, std::numeric_limits<uint64_t>::max());
+
+        // 栅栏已经发出信号，这一帧上一次复制的绘制命令可以直接读取
+        if (m_statisticsWritten.at(m_currentFrame))
+        {
+            auto drawCommands   = static_cast<const VkDrawIndexedIndirectCommand*>(m_statisticsBuffersMapped.at(m_currentFrame));
+            m_statistics.phase1 = drawCommands[0].instanceCount;
+            m_statistics.phase2 = drawCommands[1].instanceCount;
+        }
+
+        // 从交换链获取一张图像
+        uint32_t imageIndex { 0 };
+        // 3.获取图像的超时时间，此处禁用图像获取超时
+        // 4.通知的同步对象
+        // 5.输出可用的交换链图像的索引
+        VkResult result = vkAcquireNextImageKHR(
+            m_device, m_swapChain, std::numeric_limits<uint64_t>::max(), m_imageAvailableSemaphores.at(m_currentFrame), VK_NULL_HANDLE, &imageIndex);
+
+        // VK_ERROR_OUT_OF_DATE_KHR 交换链不能继续使用，通常发生在窗口大小改变后
+        // VK_SUBOPTIMAL_KHR 交换链仍然可以使用，但表面属性已经不能准确匹配
+        if (VK_ERROR_OUT_OF_DATE_KHR == result)
+        {
+            RecreateSwapChain();
+            return;
+        }
+        else if (VK_SUCCESS != result && VK_SUBOPTIMAL_KHR != result)
+        {
+            throw std::runtime_error("failed to acquire swap chain image");
+        }
+
+        // 每一帧都更新uniform
+        UpdateUniformBuffer(static_cast<uint32_t>(m_currentFrame));
+
+        // 手动将栅栏重置为未发出信号的状态（必须手动设置）
+        vkResetFences(m_device, 1, &m_inFlightFences.at(m_currentFrame));
+        vkResetCommandBuffer(m_commandBuffers.at(imageIndex), 0);
+        RecordCommandBuffer(m_commandBuffers.at(imageIndex), m_swapChainFramebuffers.at(imageIndex));
+        m_statisticsWritten.at(m_currentFrame) = true;
+        m_pyramidValid                         = true; // 下一帧的第一阶段可以使用这一帧构建的深度金字塔
+
+        VkPipelineStageFlags waitStages[] = { VK_PIPELINE_STAGE_COLOR_ATTACHMENT_OUTPUT_BIT };
+
+        VkSubmitInfo submitInfo         = {};
+        submitInfo.sType                = VK_STRUCTURE_TYPE_SUBMIT_INFO;
+        submitInfo.waitSemaphoreCount   = 1;
+        submitInfo.pWaitSemaphores      = &m_imageAvailableSemaphores.at(m_currentFrame); // 指定队列开始执行前需要等待的信号量
+        submitInfo.pWaitDstStageMask    = waitStages;                                     // 指定需要等待的管线阶段
+        submitInfo.commandBufferCount   = 1;
+        submitInfo.pCommandBuffers      = &m_commandBuffers[imageIndex];                  // 指定实际被提交执行的指令缓冲对象
+        submitInfo.signalSemaphoreCount = 1;
+        submitInfo.pSignalSemaphores = &m_renderFinishedSemaphores.at(m_currentFrame); // 指定在指令缓冲执行结束后发出信号的信号量对象
+
+        // 提交指令缓冲给图形指令队列
+        // 如果不等待上一次提交的指令结束执行，可能会导致内存泄漏
+        // 1.vkQueueWaitIdle 可以等待上一次的指令结束执行，2.也可以同时渲染多帧解决该问题（使用栅栏）
+        // vkQueueSubmit 的最后一个参数用来指定在指令缓冲执行结束后需要发起信号的栅栏对象
+        if (VK_SUCCESS != vkQueueSubmit(m_graphicsQueue, 1, &submitInfo, m_inFlightFences.at(m_currentFrame)))
+        {
+            throw std::runtime_error("failed to submit draw command buffer");
+        }
+
+        VkPresentInfoKHR presentInfo   = {};
+        presentInfo.sType              = VK_STRUCTURE_TYPE_PRESENT_INFO_KHR;
+        presentInfo.waitSemaphoreCount = 1;
+        presentInfo.pWaitSemaphores    = &m_renderFinishedSemaphores.at(m_currentFrame); // 指定开始呈现操作需要等待的信号量
+        presentInfo.swapchainCount     = 1;
+        presentInfo.pSwapchains        = &m_swapChain;                                   // 指定用于呈现图像的交换链
+        presentInfo.pImageIndices      = &imageIndex;                                    // 指定需要呈现的图像在交换链中的索引
+        presentInfo.pResults           = nullptr; // 可以通过该变量获取每个交换链的呈现操作是否成功的信息
+
+        // 请求交换链进行图像呈现操作
+        result = vkQueuePresentKHR(m_presentQueue, &presentInfo);
+
+        if (VK_ERROR_OUT_OF_DATE_KHR == result || VK_SUBOPTIMAL_KHR == result || m_framebufferResized)
+        {
+            m_framebufferResized = false;
+            // 交换链不完全匹配时也重建交换链
+            RecreateSwapChain();
+        }
+        else if (VK_SUCCESS != result)
+        {
+            throw std::runtime_error("failed to presend swap chain image");
+        }
+
+        // 更新当前帧索引
+        m_currentFrame = (m_currentFrame + 1) % MAX_FRAMES_IN_FLIGHT;
+    }
+
+    /// @brief 创建同步对象，用于发出图像已经被获取可以开始渲染和渲染已经结束可以开始呈现的信号
+    void CreateSyncObjects()
+    {
+        m_imageAvailableSemaphores.resize(MAX_FRAMES_IN_FLIGHT);
+        m_renderFinishedSemaphores.resize(MAX_FRAMES_IN_FLIGHT);
+        m_inFlightFences.resize(MAX_FRAMES_IN_FLIGHT);
+
+        VkSemaphoreCreateInfo semaphoreInfo = {};
+        semaphoreInfo.sType                 = VK_STRUCTURE_TYPE_SEMAPHORE_CREATE_INFO;
+
+        VkFenceCreateInfo fenceInfo = {};
+        fenceInfo.sType             = VK_STRUCTURE_TYPE_FENCE_CREATE_INFO;
+        fenceInfo.flags             = VK_FENCE_CREATE_SIGNALED_BIT; // 初始状态设置为已发出信号，避免 vkWaitForFences 一直等待
+
+        for (size_t i = 0; i < MAX_FRAMES_IN_FLIGHT; ++i)
+        {
+            if (VK_SUCCESS != vkCreateSemaphore(m_device, &semaphoreInfo, nullptr, &m_imageAvailableSemaphores.at(i))
+                || VK_SUCCESS != vkCreateSemaphore(m_device, &semaphoreInfo, nullptr, &m_renderFinishedSemaphores.at(i))
+                || vkCreateFence(m_device, &fenceInfo, nullptr, &m_inFlightFences.at(i)))
+            {
+                throw std::runtime_error("failed to create synchronization objects for a frame");
+            }
+        }
+    }
+
+    /// @brief 重建交换链
+    void RecreateSwapChain()
+    {
+        int width { 0 }, height { 0 };
+        glfwGetFramebufferSize(m_window, &width, &height);
+        while (0 == width || 0 == height)
+        {
+            glfwGetFramebufferSize(m_window, &width, &height);
+            glfwWaitEvents();
+        }
+
+        // 等待设备处于空闲状态，避免在对象的使用过程中将其清除重建
+        vkDeviceWaitIdle(m_device);
+
+        // 在重建前清理之前使用的对象
+        CleanupSwapChain();
+
+        // 可以通过动态状态来设置视口和裁剪矩形来避免重建管线
+        CreateSwapChain();
+        CreateImageViews();
+        CreateDepthResources();
+        CreateFramebuffers();
+        CreateDepthPyramid();
+        WritePyramidDescriptors();
+    }
+
+    void DestroyDrawable(Drawable& drawable) noexcept
+    {
+        vkDestroyBuffer(m_device, drawable.vertexBuffer, nullptr);
+        vkFreeMemory(m_device, drawable.vertexBufferMemory, nullptr);
+        vkDestroyBuffer(m_device, drawable.indexBuffer, nullptr);
+        vkFreeMemory(m_device, drawable.indexBufferMemory, nullptr);
+    }
+
+    /// @brief 清除交换链相关对象
+    void CleanupSwapChain() noexcept
+    {
+        vkDestroyDescriptorPool(m_device, m_pyramidDescriptorPool, nullptr);
+        for (auto imageView : m_pyramidMipViews)
+        {
+            vkDestroyImageView(m_device, imageView, nullptr);
+        }
+        vkDestroyImageView(m_device, m_pyramidView, nullptr);
+        vkDestroyImage(m_device, m_pyramidImage, nullptr);
+        vkFreeMemory(m_device, m_pyramidImageMemory, nullptr);
+
+        vkDestroyImageView(m_device, m_depthImageView, nullptr);
+        vkDestroyImage(m_device, m_depthImage, nullptr);
+        vkFreeMemory(m_device, m_depthImageMemory, nullptr);
+
+        for (auto framebuffer : m_swapChainFramebuffers)
+        {
+            vkDestroyFramebuffer(m_device, framebuffer, nullptr);
+        }
+
+        for (auto imageView : m_swapChainImageViews)
+        {
+            vkDestroyImageView(m_device, imageView, nullptr);
+        }
+
+        vkDestroySwapchainKHR(m_device, m_swapChain, nullptr);
+    }
+
+    /// @brief 设置调试扩展信息
+    /// @param createInfo
+    void PopulateDebugMessengerCreateInfo(VkDebugUtilsMessengerCreateInfoEXT& createInfo) const noexcept
+    {
+        createInfo.sType = VK_STRUCTURE_TYPE_DEBUG_UTILS_MESSENGER_CREATE_INFO_EXT;
+        // 设置回调函数处理的消息级别
+        createInfo.messageSeverity = VK_DEBUG_UTILS_MESSAGE_SEVERITY_VERBOSE_BIT_EXT | VK_DEBUG_UTILS_MESSAGE_SEVERITY_WARNING_BIT_EXT
+            | VK_DEBUG_UTILS_MESSAGE_SEVERITY_ERROR_BIT_EXT;
+        // 设置回调函数处理的消息类型
+        createInfo.messageType = VK_DEBUG_UTILS_MESSAGE_TYPE_GENERAL_BIT_EXT | VK_DEBUG_UTILS_MESSAGE_TYPE_VALIDATION_BIT_EXT
+            | VK_DEBUG_UTILS_MESSAGE_TYPE_PERFORMANCE_BIT_EXT;
+        // 设置回调函数
+        createInfo.pfnUserCallback = DebugCallback;
+        // 设置用户自定义数据，是可选的
+        createInfo.pUserData = nullptr;
+    }
+
+    /// @brief 创建顶点缓冲
+    void CreateVertexBuffer(const std::vector<Vertex>& vertices, Drawable& drawable)
+    {
+        VkDeviceSize bufferSize = sizeof(Vertex) * vertices.size();
+
+        // 为了提升性能，使用一个临时（暂存）缓冲，先将顶点数据加载到临时缓冲，再复制到顶点缓冲
+        VkBuffer stagingBuffer {};
+        VkDeviceMemory stagingBufferMemory {};
+
+        // 创建一个CPU可见的缓冲作为临时缓冲
+        // VK_MEMORY_PROPERTY_HOST_VISIBLE_BIT 用于从CPU写入数据
+        // VK_MEMORY_PROPERTY_HOST_COHERENT_BIT 可以保证数据被立即复制到缓冲关联的内存
+        CreateBuffer(bufferSize, VK_BUFFER_USAGE_TRANSFER_SRC_BIT, VK_MEMORY_PROPERTY_HOST_VISIBLE_BIT | VK_MEMORY_PROPERTY_HOST_COHERENT_BIT,
+            stagingBuffer, stagingBufferMemory);
+
+        void* data { nullptr };
+        // 将缓冲关联的内存映射到CPU可以访问的内存
+        vkMapMemory(m_device, stagingBufferMemory, 0, bufferSize, 0, &data);
+        // 将顶点数据复制到映射后的内存
+        std::memcpy(data, vertices.data(), static_cast<size_t>(bufferSize));
+        // 结束内存映射
+        vkUnmapMemory(m_device, stagingBufferMemory);
+
+        // 创建一个显卡读取较快的缓冲作为真正的顶点缓冲
+        // 具有 VK_MEMORY_PROPERTY_DEVICE_LOCAL_BIT 标记的内存最适合显卡读取，CPU通常不能访问这种类型的内存
+        CreateBuffer(bufferSize, VK_BUFFER_USAGE_TRANSFER_DST_BIT | VK_BUFFER_USAGE_VERTEX_BUFFER_BIT, VK_MEMORY_PROPERTY_DEVICE_LOCAL_BIT,
+            drawable.vertexBuffer, drawable.vertexBufferMemory);
+
+        // m_vertexBuffer 现在关联的内存是设备所有的（显卡），不能使用 vkMapMemory 函数对它关联的内存进行映射
+        // 从临时（暂存）缓冲复制数据到显卡读取较快的缓冲中
+        CopyBuffer(stagingBuffer, drawable.vertexBuffer, bufferSize);
+
+        vkDestroyBuffer(m_device, stagingBuffer, nullptr);
+        vkFreeMemory(m_device, stagingBufferMemory, nullptr);
+
+        // 驱动程序可能并不会立即复制数据到缓冲关联的内存中去，因为处理器都有缓存，写入内存的数据并不一定在多个核心同时可见
+        // 保证数据被立即复制到缓冲关联的内存可以使用以下函数，或者使用 VK_MEMORY_PROPERTY_HOST_COHERENT_BIT 属性的内存类型
+        // 使用函数的方法性能更好
+        // 写入数据到映射的内存后，调用 vkFlushMappedMemoryRanges
+        // 读取映射的内存数据前，调用 vkInvalidateMappedMemoryRanges
+    }
+
+    /// @brief 创建索引缓冲
+    void CreateIndexBuffer(const std::vector<uint16_t>& indices, Drawable& drawable)
+    {
+        drawable.indexCount     = static_cast<uint32_t>(indices.size());
+        VkDeviceSize bufferSize = sizeof(indices.front()) * indices.size();
+
+        VkBuffer stagingBuffer {};
+        VkDeviceMemory stagingBufferMemory {};
+
+        CreateBuffer(bufferSize, VK_BUFFER_USAGE_TRANSFER_SRC_BIT, VK_MEMORY_PROPERTY_HOST_VISIBLE_BIT | VK_MEMORY_PROPERTY_HOST_COHERENT_BIT,
+            stagingBuffer, stagingBufferMemory);
+
+        void* data { nullptr };
+        vkMapMemory(m_device, stagingBufferMemory, 0, bufferSize, 0, &data);
+        std::memcpy(data, indices.data(), static_cast<size_t>(bufferSize));
+        vkUnmapMemory(m_device, stagingBufferMemory);
+
+        CreateBuffer(bufferSize, VK_BUFFER_USAGE_TRANSFER_DST_BIT | VK_BUFFER_USAGE_INDEX_BUFFER_BIT, VK_MEMORY_PROPERTY_DEVICE_LOCAL_BIT,
+            drawable.indexBuffer, drawable.indexBufferMemory);
+
+        CopyBuffer(stagingBuffer, drawable.indexBuffer, bufferSize);
+
+        vkDestroyBuffer(m_device, stagingBuffer, nullptr);
+        vkFreeMemory(m_device, stagingBufferMemory, nullptr);
+    }
+
+    /// @brief 创建指定类型的缓冲
+    /// @details Vulkan 的缓冲是可以存储任意数据的可以被显卡读取的内存，不仅可以存储顶点数据
+    /// @param size
+    /// @param usage
+    /// @param properties
+    /// @param buffer
+    /// @param bufferMemory
+    void CreateBuffer(
+        VkDeviceSize size, VkBufferUsageFlags usage, VkMemoryPropertyFlags properties, VkBuffer& buffer, VkDeviceMemory& bufferMemory) const
+    {
+        VkBufferCreateInfo bufferInfo = {};
+        bufferInfo.sType              = VK_STRUCTURE_TYPE_BUFFER_CREATE_INFO;
+        bufferInfo.size               = size;                      // 缓冲的字节大小
+        bufferInfo.usage              = usage;                     // 缓冲中的数据使用目的，可以使用位或来指定多个目的
+        bufferInfo.sharingMode        = VK_SHARING_MODE_EXCLUSIVE; // 缓冲可以被特定的队列族所拥有，也可以在多个队列族共享
+        bufferInfo.flags              = 0;                         // 配置缓冲的内存稀疏程度，0表示使用默认值
+
+        if (VK_SUCCESS != vkCreateBuffer(m_device, &bufferInfo, nullptr, &buffer))
+        {
+            throw std::runtime_error("failed to create vertex buffer");
+        }
+
+        // 缓冲创建好之后还需要分配内存，首先获取缓冲的内存需求
+        // size: 缓冲需要的内存的字节大小，可能和bufferInfo.size的值不同
+        // alignment: 缓冲在实际被分配的内存中的开始位置，依赖于bufferInfo的usage和flags
+        // memoryTypeBits: 指示适合该缓冲使用的内存类型的位域
+        VkMemoryRequirements memRequirements {};
+        vkGetBufferMemoryRequirements(m_device, buffer, &memRequirements);
+
+        VkMemoryAllocateInfo allocInfo = {};
+        allocInfo.sType                = VK_STRUCTURE_TYPE_MEMORY_ALLOCATE_INFO;
+        allocInfo.allocationSize       = memRequirements.size;
+        allocInfo.memoryTypeIndex      = FindMemoryType(memRequirements.memoryTypeBits, properties);
+
+        if (VK_SUCCESS != vkAllocateMemory(m_device, &allocInfo, nullptr, &bufferMemory))
+        {
+            throw std::runtime_error("failed to allocate buffer memory");
+        }
+
+        // 4. 偏移值，需要满足能够被 memRequirements.alighment 整除
+        vkBindBufferMemory(m_device, buffer, bufferMemory, 0);
+    }
+
+    /// @brief 在缓冲之间复制数据
+    /// @param srcBuffer
+    /// @param dstBuffer
+    /// @param size
+    void CopyBuffer(VkBuffer srcBuffer, VkBuffer dstBuffer, VkDeviceSize size) const noexcept
+    {
+        VkCommandBufferAllocateInfo allocInfo = {};
+        allocInfo.sType                       = VK_STRUCTURE_TYPE_COMMAND_BUFFER_ALLOCATE_INFO;
+        allocInfo.level                       = VK_COMMAND_BUFFER_LEVEL_PRIMARY;
+        allocInfo.commandPool                 = m_commandPool;
+        allocInfo.commandBufferCount          = 1;
+
+        VkCommandBuffer commandBuffer {};
+        vkAllocateCommandBuffers(m_device, &allocInfo, &commandBuffer);
+
+        VkCommandBufferBeginInfo beginInfo = {};
+        beginInfo.sType                    = VK_STRUCTURE_TYPE_COMMAND_BUFFER_BEGIN_INFO;
+        beginInfo.flags                    = VK_COMMAND_BUFFER_USAGE_ONE_TIME_SUBMIT_BIT; // 指定如何使用这个指令缓冲
+
+        vkBeginCommandBuffer(commandBuffer, &beginInfo);
+        VkBufferCopy copyRegion = {};
+        copyRegion.srcOffset    = 0;
+        copyRegion.dstOffset    = 0;
+        copyRegion.size         = size;
+        vkCmdCopyBuffer(commandBuffer, srcBuffer, dstBuffer, 1, &copyRegion);
+        vkEndCommandBuffer(commandBuffer);
+
+        VkSubmitInfo submitInfo       = {};
+        submitInfo.sType              = VK_STRUCTURE_TYPE_SUBMIT_INFO;
+        submitInfo.commandBufferCount = 1;
+        submitInfo.pCommandBuffers    = &commandBuffer;
+
+        // 提交到内存传输指令队列执行内存传输
+        vkQueueSubmit(m_graphicsQueue, 1, &submitInfo, nullptr);
+        // 等待传输操作完成，也可以使用栅栏，栅栏可以同步多个不同的内存传输操作，给驱动程序的优化空间也更大
+        vkQueueWaitIdle(m_graphicsQueue);
+
+        vkFreeCommandBuffers(m_device, m_commandPool, 1, &commandBuffer);
+    }
+
+    VkImageView CreateImageView(VkImage image, VkFormat format, VkImageAspectFlags aspectFlags, uint32_t baseMipLevel = 0, uint32_t levelCount = 1)
+    {
+        VkImageViewCreateInfo viewInfo {};
+        viewInfo.sType                           = VK_STRUCTURE_TYPE_IMAGE_VIEW_CREATE_INFO;
+        viewInfo.image                           = image;
+        viewInfo.viewType                        = VK_IMAGE_VIEW_TYPE_2D;
+        viewInfo.format                          = format;
+        viewInfo.subresourceRange.aspectMask     = aspectFlags;
+        viewInfo.subresourceRange.baseMipLevel   = baseMipLevel;
+        viewInfo.subresourceRange.levelCount     = levelCount;
+        viewInfo.subresourceRange.baseArrayLayer = 0;
+        viewInfo.subresourceRange.layerCount     = 1;
+
+        VkImageView imageView {};
+        if (VK_SUCCESS != vkCreateImageView(m_device, &viewInfo, nullptr, &imageView))
+        {
+            throw std::runtime_error("failed to create texture image view");
+        }
+
+        return imageView;
+    }
+
+    /// @brief 查找最合适的内存类型
+    /// @details 不同类型的内存所允许进行的操作以及操作的效率有所不同
+    /// @param typeFilter 指定需要的内存类型的位域
+    /// @param properties
+    /// @return
+    uint32_t FindMemoryType(uint32_t typeFilter, VkMemoryPropertyFlags properties) const
+    {
+        // 查找物理设备可用的内存类型
+        // memoryHeaps 内存来源，比如显存以及显存用尽后的位与主存中的交换空间
+        VkPhysicalDeviceMemoryProperties memProperties {};
+        vkGetPhysicalDeviceMemoryProperties(m_physicalDevice, &memProperties);
+
+        for (uint32_t i = 0; i < memProperties.memoryTypeCount; ++i)
+        {
+            if (typeFilter & (1 << i) && (memProperties.memoryTypes[i].propertyFlags & properties) == properties)
+            {
+                return i;
+            }
+        }
+
+        throw std::runtime_error("failed to find suitable memory type");
+    }
+
+    /// @brief 创建着色器使用的每一个描述符绑定信息
+    /// @details 剔除着色器和顶点着色器使用同一个描述符集，顶点着色器只访问其中的一部分
+    void CreateDescriptorSetLayout()
+    {
+        // clang-format off
+        std::array<VkDescriptorSetLayoutBinding, 6> bindings {
+            VkDescriptorSetLayoutBinding { 0, VK_DESCRIPTOR_TYPE_UNIFORM_BUFFER,         1, VK_SHADER_STAGE_VERTEX_BIT | VK_SHADER_STAGE_COMPUTE_BIT, nullptr }, // 变换矩阵、视锥、剔除参数
+            VkDescriptorSetLayoutBinding { 1, VK_DESCRIPTOR_TYPE_STORAGE_BUFFER,         1, VK_SHADER_STAGE_VERTEX_BIT | VK_SHADER_STAGE_COMPUTE_BIT, nullptr }, // 物体数据
+            VkDescriptorSetLayoutBinding { 2, VK_DESCRIPTOR_TYPE_STORAGE_BUFFER,         1, VK_SHADER_STAGE_COMPUTE_BIT,                              nullptr }, // 间接绘制命令
+            VkDescriptorSetLayoutBinding { 3, VK_DESCRIPTOR_TYPE_STORAGE_BUFFER,         1, VK_SHADER_STAGE_VERTEX_BIT | VK_SHADER_STAGE_COMPUTE_BIT, nullptr }, // 可见物体列表
+            VkDescriptorSetLayoutBinding { 4, VK_DESCRIPTOR_TYPE_STORAGE_BUFFER,         1, VK_SHADER_STAGE_COMPUTE_BIT,                              nullptr }, // 第一阶段的结果
+            VkDescriptorSetLayoutBinding { 5, VK_DESCRIPTOR_TYPE_COMBINED_IMAGE_SAMPLER, 1, VK_SHADER_STAGE_COMPUTE_BIT,                              nullptr }, // 深度金字塔
+        };
+        // clang-format on
+
+        VkDescriptorSetLayoutCreateInfo layoutInfo = {};
+        layoutInfo.sType                           = VK_STRUCTURE_TYPE_DESCRIPTOR_SET_LAYOUT_CREATE_INFO;
+        layoutInfo.bindingCount                    = static_cast<uint32_t>(bindings.size());
+        layoutInfo.pBindings                       = bindings.data();
+
+        if (VK_SUCCESS != vkCreateDescriptorSetLayout(m_device, &layoutInfo, nullptr, &m_descriptorSetLayout))
+        {
+            throw std::runtime_error("failed to create descriptor set layout");
+        }
+    }
+
+    /// @brief 创建Uniform Buffer
+    /// @details 由于缓冲需要频繁更新，所以此处使用暂存缓冲并不会带来性能提升
+    void CreateUniformBuffers()
+    {
+        VkDeviceSize bufferSize = sizeof(UniformBufferObject);
+
+        m_uniformBuffers.resize(MAX_FRAMES_IN_FLIGHT);
+        m_uniformBuffersMemory.resize(MAX_FRAMES_IN_FLIGHT);
+        m_uniformBuffersMapped.resize(MAX_FRAMES_IN_FLIGHT);
+
+        for (size_t i = 0; i < MAX_FRAMES_IN_FLIGHT; ++i)
+        {
+            CreateBuffer(bufferSize, VK_BUFFER_USAGE_UNIFORM_BUFFER_BIT, VK_MEMORY_PROPERTY_HOST_VISIBLE_BIT | VK_MEMORY_PROPERTY_HOST_COHERENT_BIT,
+                m_uniformBuffers.at(i), m_uniformBuffersMemory.at(i));
+            vkMapMemory(m_device, m_uniformBuffersMemory.at(i), 0, bufferSize, 0, &m_uniformBuffersMapped.at(i));
+        }
+    }
+
+    /// @brief 在绘制每一帧时更新uniform
+    /// @param currentImage
+    void UpdateUniformBuffer(uint32_t currentImage)
+    {
+        auto aspect = static_cast<float>(m_swapChainExtent.width) / static_cast<float>(m_swapChainExtent.height);
+
+        UniformBufferObject ubo {};
+        ubo.view = glm::lookAt(m_eyePos, m_lookAt, m_viewUp);
+        ubo.proj = glm::perspective(glm::radians(45.f), aspect, 0.1f, 1000.f);
+
+        // glm的裁剪坐标的Y轴和 Vulkan 是相反的
+        ubo.proj[1][1] *= -1;
+
+        ubo.viewProj     = ubo.proj * ubo.view;
+        ubo.prevViewProj = m_pyramidViewProj;
+
+        // 从 viewProj 的行向量提取视锥平面，深度范围是 [0, 1]，所以近平面就是第三行
+        auto row = [&ubo](int i) { return glm::vec4 { ubo.viewProj[0][i], ubo.viewProj[1][i], ubo.viewProj[2][i], ubo.viewProj[3][i] }; };
+        ubo.frustum = { row(3) + row(0), row(3) - row(0), row(3) + row(1), row(3) - row(1), row(2), row(3) - row(2) };
+        for (auto& plane : ubo.frustum)
+        {
+            plane /= glm::length(glm::vec3(plane));
+        }
+
+        ubo.pyramidSize      = glm::vec2 { static_cast<float>(m_pyramidWidth), static_cast<float>(m_pyramidHeight) };
+        ubo.pyramidLevels    = m_pyramidLevels;
+        ubo.objectCount      = OBJECT_COUNT;
+        ubo.frustumCulling   = m_frustumCulling ? 1 : 0;
+        ubo.occlusionCulling = m_occlusionCulling ? 1 : 0;
+        ubo.pyramidValid     = m_pyramidValid ? 1 : 0;
+
+        // 这一帧构建的深度金字塔在下一帧使用
+        m_pyramidViewProj = ubo.viewProj;
+
+        // 将变换矩阵的数据复制到uniform缓冲
+        std::memcpy(m_uniformBuffersMapped[currentImage], &ubo, sizeof(ubo));
+    }
+
+    /// @brief 创建描述符池，描述符集需要通过描述符池来创建
+    void CreateDescriptorPool()
+    {
+        std::array<VkDescriptorPoolSize, 3> poolSizes {};
+
+        poolSizes.at(0).type            = VK_DESCRIPTOR_TYPE_UNIFORM_BUFFER;
+        poolSizes.at(0).descriptorCount = static_cast<uint32_t>(MAX_FRAMES_IN_FLIGHT);
+        poolSizes.at(1).type            = VK_DESCRIPTOR_TYPE_STORAGE_BUFFER;
+        poolSizes.at(1).descriptorCount = static_cast<uint32_t>(MAX_FRAMES_IN_FLIGHT * 4);
+        poolSizes.at(2).type            = VK_DESCRIPTOR_TYPE_COMBINED_IMAGE_SAMPLER;
+        poolSizes.at(2).descriptorCount = static_cast<uint32_t>(MAX_FRAMES_IN_FLIGHT);
+
+        VkDescriptorPoolCreateInfo poolInfo {};
+        poolInfo.sType         = VK_STRUCTURE_TYPE_DESCRIPTOR_POOL_CREATE_INFO;
+        poolInfo.poolSizeCount = static_cast<uint32_t>(poolSizes.size());
+        poolInfo.pPoolSizes    = poolSizes.data();
+        poolInfo.maxSets       = static_cast<uint32_t>(MAX_FRAMES_IN_FLIGHT); // 指定可以分配的最大描述符集个数
+        poolInfo.flags         = 0; // 可以用来设置独立的描述符集是否可以被清除掉，此处使用默认值
+
+        if (VK_SUCCESS != vkCreateDescriptorPool(m_device, &poolInfo, nullptr, &m_descriptorPool))
+        {
+            throw std::runtime_error("failed to create descriptor pool");
+        }
+    }
+
+    /// @brief 创建描述符集
+    void CreateDescriptorSets()
+    {
+        // 描述符布局对象的个数要匹配描述符集对象的个数
+        std::vector<VkDescriptorSetLayout> layouts(MAX_FRAMES_IN_FLIGHT, m_descriptorSetLayout);
+
+        VkDescriptorSetAllocateInfo allocInfo {};
+        allocInfo.sType              = VK_STRUCTURE_TYPE_DESCRIPTOR_SET_ALLOCATE_INFO;
+        allocInfo.descriptorPool     = m_descriptorPool; // 指定分配描述符集对象的描述符池
+        allocInfo.descriptorSetCount = static_cast<uint32_t>(MAX_FRAMES_IN_FLIGHT);
+        allocInfo.pSetLayouts        = layouts.data();
+
+        // 描述符集对象会在描述符池对象清除时自动被清除
+        m_descriptorSets.resize(MAX_FRAMES_IN_FLIGHT);
+        if (VK_SUCCESS != vkAllocateDescriptorSets(m_device, &allocInfo, m_descriptorSets.data()))
+        {
+            throw std::runtime_error("failed to allocate descriptor sets");
+        }
+
+        for (size_t i = 0; i < MAX_FRAMES_IN_FLIGHT; ++i)
+        {
+            std::array<VkDescriptorBufferInfo, 5> bufferInfos {
+                VkDescriptorBufferInfo { m_uniformBuffers.at(i), 0, sizeof(UniformBufferObject) },
+                VkDescriptorBufferInfo { m_objectBuffer, 0, VK_WHOLE_SIZE },
+                VkDescriptorBufferInfo { m_drawCommandBuffer, 0, VK_WHOLE_SIZE },
+                VkDescriptorBufferInfo { m_visibleListBuffer, 0, VK_WHOLE_SIZE },
+                VkDescriptorBufferInfo { m_phase1ResultBuffer, 0, VK_WHOLE_SIZE },
+            };
+
+            std::array<VkWriteDescriptorSet, 5> descriptorWrites {};
+            for (uint32_t binding = 0; binding < descriptorWrites.size(); ++binding)
+            {
+                descriptorWrites.at(binding).sType           = VK_STRUCTURE_TYPE_WRITE_DESCRIPTOR_SET;
+                descriptorWrites.at(binding).dstSet          = m_descriptorSets.at(i); // 指定要更新的描述符集对象
+                descriptorWrites.at(binding).dstBinding      = binding;                // 指定缓冲绑定
+                descriptorWrites.at(binding).dstArrayElement = 0; // 描述符数组的第一个元素的索引（没有数组就使用0）
+                descriptorWrites.at(binding).descriptorType  = 0 == binding ? VK_DESCRIPTOR_TYPE_UNIFORM_BUFFER : VK_DESCRIPTOR_TYPE_STORAGE_BUFFER;
+                descriptorWrites.at(binding).descriptorCount = 1;
+                descriptorWrites.at(binding).pBufferInfo     = &bufferInfos.at(binding); // 指定描述符引用的缓冲数据
+            }
+
+            // 更新描述符的配置
+            vkUpdateDescriptorSets(m_device, static_cast<uint32_t>(descriptorWrites.size()), descriptorWrites.data(), 0, nullptr);
+        }
+
+        WritePyramidDescriptors();
+    }
+
+    /// @brief 更新描述符集中的深度金字塔，重建交换链之后深度金字塔也会重建
+    void WritePyramidDescriptors()
+    {
+        VkDescriptorImageInfo imageInfo {};
+        imageInfo.sampler     = m_pyramidSampler;
+        imageInfo.imageView   = m_pyramidView;
+        imageInfo.imageLayout = VK_IMAGE_LAYOUT_GENERAL;
+
+        for (auto descriptorSet : m_descriptorSets)
+        {
+            VkWriteDescriptorSet descriptorWrite {};
+            descriptorWrite.sType           = VK_STRUCTURE_TYPE_WRITE_DESCRIPTOR_SET;
+            descriptorWrite.dstSet          = descriptorSet;
+            descriptorWrite.dstBinding      = 5;
+            descriptorWrite.dstArrayElement = 0;
+            descriptorWrite.descriptorType  = VK_DESCRIPTOR_TYPE_COMBINED_IMAGE_SAMPLER;
+            descriptorWrite.descriptorCount = 1;
+            descriptorWrite.pImageInfo      = &imageInfo;
+
+            vkUpdateDescriptorSets(m_device, 1, &descriptorWrite, 0, nullptr);
+        }
+    }
+
+    /// @brief 创建指定格式的图像对象
+    /// @param width
+    /// @param height
+    /// @param mipLevels
+    /// @param format
+    /// @param tiling
+    /// @param usage
+    /// @param properties
+    /// @param image
+    /// @param imageMemory
+    void CreateImage(uint32_t width, uint32_t height, uint32_t mipLevels, VkFormat format, VkImageTiling tiling, VkImageUsageFlags usage,
+        VkMemoryPropertyFlags properties, VkImage& image, VkDeviceMemory& imageMemory)
+
+    {
+        // tiling成员变量可以是 VK_IMAGE_TILING_LINEAR 纹素以行主序的方式排列，可以直接访问图像
+        //                     VK_IMAGE_TILING_OPTIMAL 纹素以一种对访问优化的方式排列
+        // initialLayout成员变量可以是 VK_IMAGE_LAYOUT_UNDEFINED GPU不可用，纹素在第一次变换会被丢弃
+        //                            VK_IMAGE_LAYOUT_PREINITIALIZED GPU不可用，纹素在第一次变换会被保留
+        VkImageCreateInfo imageInfo {};
+        imageInfo.sType         = VK_STRUCTURE_TYPE_IMAGE_CREATE_INFO;
+        imageInfo.imageType     = VK_IMAGE_TYPE_2D;
+        imageInfo.extent.width  = static_cast<uint32_t>(width);
+        imageInfo.extent.height = static_cast<uint32_t>(height);
+        imageInfo.extent.depth  = 1;
+        imageInfo.mipLevels     = mipLevels;
+        imageInfo.arrayLayers   = 1;
+        imageInfo.format        = format;
+        imageInfo.tiling        = tiling;                    // 设置之后不可修改
+        imageInfo.initialLayout = VK_IMAGE_LAYOUT_UNDEFINED; // 图像数据是接收方，不需要保留第一次变换时的纹理数据
+        imageInfo.usage         = usage;
+        imageInfo.sharingMode = VK_SHARING_MODE_EXCLUSIVE; // 只被一个队列族使用（支持传输操作的队列族），所以使用独占模式
+        imageInfo.samples = VK_SAMPLE_COUNT_1_BIT;         // 设置多重采样，只对用作附着的图像对象有效
+        imageInfo.flags   = 0; // 可以用来设置稀疏图像的优化，比如体素地形没必要为“空气”部分分配内存
+
+        if (VK_SUCCESS != vkCreateImage(m_device, &imageInfo, nullptr, &image))
+        {
+            throw std::runtime_error("failed to create image");
+        }
+
+        VkMemoryRequirements memRequirements {};
+        vkGetImageMemoryRequirements(m_device, image, &memRequirements);
+
+        VkMemoryAllocateInfo allocInfo {};
+        allocInfo.sType           = VK_STRUCTURE_TYPE_MEMORY_ALLOCATE_INFO;
+        allocInfo.allocationSize  = memRequirements.size;
+        allocInfo.memoryTypeIndex = FindMemoryType(memRequirements.memoryTypeBits, VK_MEMORY_PROPERTY_DEVICE_LOCAL_BIT);
+
+        if (VK_SUCCESS != vkAllocateMemory(m_device, &allocInfo, nullptr, &imageMemory))
+        {
+            throw std::runtime_error("failed to allocate image memory");
+        }
+        vkBindImageMemory(m_device, image, imageMemory, 0);
+    }
+
+    /// @brief 配置深度图像需要的资源
+    void CreateDepthResources()
+    {
+        auto depthFormat = FindDepthFormat();
+
+        // 深度图像还要在计算着色器中采样，用来构建深度金字塔
+        CreateImage(m_swapChainExtent.width, m_swapChainExtent.height, 1, depthFormat, VK_IMAGE_TILING_OPTIMAL,
+            VK_IMAGE_USAGE_DEPTH_STENCIL_ATTACHMENT_BIT | VK_IMAGE_USAGE_SAMPLED_BIT, VK_MEMORY_PROPERTY_DEVICE_LOCAL_BIT, m_depthImage,
+            m_depthImageMemory);
+
+        m_depthImageView = CreateImageView(m_depthImage, depthFormat, VK_IMAGE_ASPECT_DEPTH_BIT);
+    }
+
+    /// @brief 查找一个符合要求又被设备支持的图像数据格式
+    /// @param candidates
+    /// @param tiling
+    /// @param features
+    /// @return
+    VkFormat FindSupportedFormat(const std::vector<VkFormat>& candidates, VkImageTiling tiling, VkFormatFeatureFlags features) const
+    {
+        for (auto format : candidates)
+        {
+            // 查找可用的深度图像格式
+            VkFormatProperties props {};
+            vkGetPhysicalDeviceFormatProperties(m_physicalDevice, format, &props);
+            // props.bufferFeatures        表示数据格式支持缓冲
+            // props.linearTilingFeatures  表示数据格式支持线性tiling模式
+            // props.optimalTilingFeatures 表示数据格式支持优化tiling模式
+
+            if (VK_IMAGE_TILING_LINEAR == tiling && (props.linearTilingFeatures & features) == features)
+            {
+                return format;
+            }
+            else if (VK_IMAGE_TILING_OPTIMAL == tiling && (props.optimalTilingFeatures & features) == features)
+            {
+                return format;
+            }
+        }
+
+        throw std::runtime_error("failed to find supported format");
+    }
+
+    /// @brief 查找适合作为深度附着并且可以被采样的图像数据格式
+    /// @return
+    VkFormat FindDepthFormat() const
+    {
+        return FindSupportedFormat({ VK_FORMAT_D32_SFLOAT, VK_FORMAT_D32_SFLOAT_S8_UINT, VK_FORMAT_D24_UNORM_S8_UINT }, VK_IMAGE_TILING_OPTIMAL,
+            VK_FORMAT_FEATURE_DEPTH_STENCIL_ATTACHMENT_BIT | VK_FORMAT_FEATURE_SAMPLED_IMAGE_BIT);
+    }
+
+    /// @brief 创建ImGui的描述符池
+    void CreateImGuiDescriptorPool()
+    {
+        // clang-format off
+        std::vector<VkDescriptorPoolSize> poolSizes {
+            { VK_DESCRIPTOR_TYPE_SAMPLER, 1000 }, 
+            { VK_DESCRIPTOR_TYPE_COMBINED_IMAGE_SAMPLER, 1000 },
+            { VK_DESCRIPTOR_TYPE_SAMPLED_IMAGE, 1000 }, 
+            { VK_DESCRIPTOR_TYPE_STORAGE_IMAGE, 1000 }, 
+            { VK_DESCRIPTOR_TYPE_UNIFORM_TEXEL_BUFFER, 1000 },
+            { VK_DESCRIPTOR_TYPE_STORAGE_TEXEL_BUFFER, 1000 }, 
+            { VK_DESCRIPTOR_TYPE_UNIFORM_BUFFER, 1000 },
+            { VK_DESCRIPTOR_TYPE_STORAGE_BUFFER, 1000 }, 
+            { VK_DESCRIPTOR_TYPE_UNIFORM_BUFFER_DYNAMIC, 1000 },
+            { VK_DESCRIPTOR_TYPE_STORAGE_BUFFER_DYNAMIC, 1000 }, 
+            { VK_DESCRIPTOR_TYPE_INPUT_ATTACHMENT, 1000 } 
+        };
+        // clang-format on
+
+        VkDescriptorPoolCreateInfo poolInfo = {};
+        poolInfo.sType                      = VK_STRUCTURE_TYPE_DESCRIPTOR_POOL_CREATE_INFO;
+        poolInfo.flags                      = VK_DESCRIPTOR_POOL_CREATE_FREE_DESCRIPTOR_SET_BIT;
+        poolInfo.maxSets                    = 1000 * static_cast<uint32_t>(poolSizes.size());
+        poolInfo.poolSizeCount              = static_cast<uint32_t>(poolSizes.size());
+        poolInfo.pPoolSizes                 = poolSizes.data();
+        if (VK_SUCCESS != vkCreateDescriptorPool(m_device, &poolInfo, nullptr, &m_imguiDescriptorPool))
+        {
+            throw std::runtime_error("failed to create descriptor pool");
+        }
+    }
+
+private:
+    /// @brief 接受调试信息的回调函数
+    /// @param messageSeverity 消息的级别：诊断、资源创建、警告、不合法或可能造成崩溃的操作
+    /// @param messageType 发生了与规范和性能无关的事件、出现了违反规范的错误、进行了可能影响 Vulkan 性能的行为
+    /// @param pCallbackData 包含了调试信息的字符串、存储有和消息相关的 Vulkan 对象句柄的数组、数组中的对象个数
+    /// @param pUserData 指向了设置回调函数时，传递的数据指针
+    /// @return 引发校验层处理的 Vulkan API 调用是否中断，通常只在测试校验层本身时会返回true，其余都应该返回 VK_FALSE
+    static VKAPI_ATTR VkBool32 VKAPI_CALL DebugCallback(VkDebugUtilsMessageSeverityFlagBitsEXT messageSeverity,
+        VkDebugUtilsMessageTypeFlagsEXT messageType, const VkDebugUtilsMessengerCallbackDataEXT* pCallbackData, void* pUserData) noexcept
+    {
+        std::clog << "===========================================\n"
+                  << "Debug::validation layer: " << pCallbackData->pMessage << '\n';
+
+        return VK_FALSE;
+    }
+
+    /// @brief 代理函数，用来加载 Vulkan 扩展函数 vkCreateDebugUtilsMessengerEXT
+    /// @param instance
+    /// @param pCreateInfo
+    /// @param pAllocator
+    /// @param pCallback
+    /// @return
+    static VkResult CreateDebugUtilsMessengerEXT(VkInstance instance, const VkDebugUtilsMessengerCreateInfoEXT* pCreateInfo,
+        const VkAllocationCallbacks* pAllocator, VkDebugUtilsMessengerEXT* pCallback) noexcept
+    {
+        // vkCreateDebugUtilsMessengerEXT是一个扩展函数，不会被 Vulkan 库自动加载，所以需要手动加载
+        auto func = (PFN_vkCreateDebugUtilsMessengerEXT)vkGetInstanceProcAddr(instance, "vkCreateDebugUtilsMessengerEXT");
+
+        if (nullptr != func)
+        {
+            return func(instance, pCreateInfo, pAllocator, pCallback);
+        }
+        else
+        {
+            return VK_ERROR_EXTENSION_NOT_PRESENT;
+        }
+    }
+
+    /// @brief 代理函数，用来加载 Vulkan 扩展函数 vkDestroyDebugUtilsMessengerEXT
+    /// @param instance
+    /// @param callback
+    /// @param pAllocator
+    static void DestroyDebugUtilsMessengerEXT(
+        VkInstance instance, VkDebugUtilsMessengerEXT callback, const VkAllocationCallbacks* pAllocator) noexcept
+    {
+        auto func = (PFN_vkDestroyDebugUtilsMessengerEXT)vkGetInstanceProcAddr(instance, "vkDestroyDebugUtilsMessengerEXT");
+
+        if (nullptr != func)
+        {
+            func(instance, callback, pAllocator);
+        }
+    }
+
+    /// @brief 读取二进制着色器文件
+    /// @param fileName
+    /// @return
+    static std::vector<char> ReadFile(const std::string& fileName)
+    {
+        std::ifstream file(fileName, std::ios::ate | std::ios::binary);
+        if (!file.is_open())
+        {
+            throw std::runtime_error("failed to open file: " + fileName);
+        }
+
+        size_t fileSize = static_cast<size_t>(file.tellg());
+        std::vector<char> buffer(fileSize);
+        file.seekg(0);
+        file.read(buffer.data(), fileSize);
+        file.close();
+        return buffer;
+    }
+
+    static void FramebufferResizeCallback(GLFWwindow* window, int widht, int height) noexcept
+    {
+        if (auto app = reinterpret_cast<HelloTriangleApplication*>(glfwGetWindowUserPointer(window)))
+        {
+            app->m_framebufferResized = true;
+        }
+    }
+
+    /// @brief 光标位置回调
+    /// @param window
+    /// @param xpos
+    /// @param ypos
+    static void CursorPosCallback(GLFWwindow* window, double xpos, double ypos) noexcept
+    {
+        if (auto app = reinterpret_cast<HelloTriangleApplication*>(glfwGetWindowUserPointer(window)))
+        {
+            // 计算鼠标移动的偏移量
+            double xOffset = xpos - app->m_mouseLastX;
+            double yOffset = ypos - app->m_mouseLastY;
+
+            if (app->m_isRotating)
+            {
+                // 设置灵敏度，可以根据需要调整
+                constexpr auto sensitivity = 0.5 / 180.0 * std::numbers::pi_v<double>;
+                xOffset *= sensitivity;
+                yOffset *= sensitivity;
+
+                // 构造旋转四元数
+                glm::vec3 xAxis        = glm::normalize(glm::cross(app->m_viewUp, app->m_eyePos));
+                glm::vec3 yAxis        = glm::normalize(app->m_viewUp);
+                glm::quat xRotation    = glm::angleAxis(static_cast<float>(-yOffset), xAxis);
+                glm::quat yRotation    = glm::angleAxis(static_cast<float>(-xOffset), yAxis);
+                glm::quat rotationQuat = xRotation * yRotation;
+
+                app->m_eyePos = glm::vec3(glm::mat4(rotationQuat) * glm::vec4(app->m_eyePos, 1.f));
+                app->m_viewUp = glm::vec3(glm::mat4(rotationQuat) * glm::vec4(app->m_viewUp, 1.f));
+                // app->m_viewUp = glm::normalize(glm::cross(xAxis, -app->m_eyePos));
+            }
+
+            if (app->m_isTranslating)
+            {
+                xOffset /= (app->m_swapChainExtent.width / 2);
+                yOffset /= (app->m_swapChainExtent.height / 2);
+
+                glm::vec3 xAxis        = glm::normalize(glm::cross(app->m_viewUp, app->m_eyePos));
+                glm::vec3 yAxis        = glm::normalize(app->m_viewUp);
+                glm::mat4 xTranslation = glm::translate(glm::mat4(1.f), xAxis * static_cast<float>(-xOffset));
+                glm::mat4 yTranslation = glm::translate(glm::mat4(1.f), yAxis * static_cast<float>(yOffset));
+                glm::mat4 translation  = xTranslation * yTranslation;
+
+                app->m_eyePos = glm::vec3(translation * glm::vec4(app->m_eyePos, 1.f));
+                app->m_lookAt = glm::vec3(translation * glm::vec4(app->m_lookAt, 1.f));
+            }
+
+            // 更新上一次的鼠标位置
+            app->m_mouseLastX = xpos;
+            app->m_mouseLastY = ypos;
+        }
+    }
+
+    /// @brief 鼠标滚轮滚动回调
+    /// @param window
+    /// @param xoffset
+    /// @param yoffset 小于0向前滚动，大于0向后滚动
+    static void ScrollCallback(GLFWwindow* window, double xoffset, double yoffset) noexcept
+    {
+        if (auto app = reinterpret_cast<HelloTriangleApplication*>(glfwGetWindowUserPointer(window)))
+        {
+            glm::vec3 direction = glm::normalize(app->m_eyePos - app->m_lookAt);
+            float distance      = glm::distance(app->m_eyePos, app->m_lookAt);
+            glm::vec3 translate = direction * distance * 0.1f;
+
+            if (yoffset < 0.0)
+            {
+                glm::mat4 mat = glm::translate(glm::mat4(1.f), translate);
+                app->m_eyePos = glm::vec3(mat * glm::vec4(app->m_eyePos, 1.f));
+            }
+            else if (yoffset > 0.0)
+            {
+                glm::mat4 mat = glm::translate(glm::mat4(1.f), translate * -1.f);
+                app->m_eyePos = glm::vec3(mat * glm::vec4(app->m_eyePos, 1.f));
+            }
+        }
+    }
+
+    /// @brief 鼠标按钮操作回调
+    /// @param window
+    /// @param button
+    /// @param action
+    /// @param mods
+    static void MouseButtonCallback(GLFWwindow* window, int button, int action, int mods) noexcept
+    {
+        if (auto app = reinterpret_cast<HelloTriangleApplication*>(glfwGetWindowUserPointer(window)))
+        {
+            if (GLFW_PRESS == action && GLFW_MOUSE_BUTTON_RIGHT == button)
+            {
+                app->m_isRotating = true;
+                glfwGetCursorPos(window, &app->m_mouseLastX, &app->m_mouseLastY);
+            }
+            else if (GLFW_RELEASE == action && GLFW_MOUSE_BUTTON_RIGHT == button)
+            {
+                app->m_isRotating = false;
+            }
+
+            if (GLFW_PRESS == action && GLFW_MOUSE_BUTTON_LEFT == button)
+            {
+                app->m_isTranslating = true;
+                glfwGetCursorPos(window, &app->m_mouseLastX, &app->m_mouseLastY);
+            }
+            else if (GLFW_RELEASE == action && GLFW_MOUSE_BUTTON_LEFT == button)
+            {
+                app->m_isTranslating = false;
+            }
+        }
+    }
+
+    /// @brief 键盘操作回调
+    /// @param window
+    /// @param key
+    /// @param scancode
+    /// @param action
+    /// @param mods
+    static void KeyCallback(GLFWwindow* window, int key, int scancode, int action, int mods) noexcept
+    {
+        if (auto app = reinterpret_cast<HelloTriangleApplication*>(glfwGetWindowUserPointer(window)))
+        {
+            // 按下'r'/'R'恢复视角
+            if (GLFW_PRESS == action && GLFW_KEY_R == key)
+            {
+                app->m_viewUp = glm::vec3 { 0.f, 1.f, 0.f };
+                app->m_eyePos = glm::vec3 { 0.f, 4.f, -340.f };
+                app->m_lookAt = glm::vec3 { 0.f };
+            }
+        }
+    }
+
+private:
+    GLFWwindow* m_window { nullptr };
+    VkInstance m_instance { nullptr };
+    VkDebugUtilsMessengerEXT m_debugMessenger { nullptr };
+    VkPhysicalDevice m_physicalDevice { nullptr };
+    VkDevice m_device { nullptr };
+    VkQueue m_graphicsQueue { nullptr }; // 图形队列
+    VkSurfaceKHR m_surface { nullptr };
+    VkQueue m_presentQueue { nullptr };  // 呈现队列
+    VkSwapchainKHR m_swapChain { nullptr };
+    std::vector<VkImage> m_swapChainImages {};
+    VkFormat m_swapChainImageFormat {};
+    VkExtent2D m_swapChainExtent {};
+    std::vector<VkImageView> m_swapChainImageViews {};
+    VkRenderPass m_earlyRenderPass { nullptr }; // 第一阶段，清除颜色和深度
+    VkRenderPass m_lateRenderPass { nullptr };  // 第二阶段，保留第一阶段的结果
+    VkPipelineLayout m_pipelineLayout { nullptr };
+    VkPipeline m_graphicsPipeline { nullptr };
+    VkPipelineLayout m_cullPipelineLayout { nullptr };
+    VkPipeline m_cullPipeline { nullptr };
+    VkDescriptorSetLayout m_hizDescriptorSetLayout { nullptr };
+    VkPipelineLayout m_hizPipelineLayout { nullptr };
+    VkPipeline m_hizPipeline { nullptr };
+    std::vector<VkFramebuffer> m_swapChainFramebuffers {};
+    VkCommandPool m_commandPool { nullptr };
+    std::vector<VkCommandBuffer> m_commandBuffers {};
+    std::vector<VkSemaphore> m_imageAvailableSemaphores {};
+    std::vector<VkSemaphore> m_renderFinishedSemaphores {};
+    std::vector<VkFence> m_inFlightFences {};
+    size_t m_currentFrame { 0 };
+    bool m_framebufferResized { false };
+    Drawable m_drawableCube {};
+    VkDescriptorSetLayout m_descriptorSetLayout { nullptr };
+    std::vector<VkBuffer> m_uniformBuffers {};
+    std::vector<VkDeviceMemory> m_uniformBuffersMemory {};
+    std::vector<void*> m_uniformBuffersMapped {};
+    VkDescriptorPool m_descriptorPool { nullptr };
+    std::vector<VkDescriptorSet> m_descriptorSets {};
+    VkImage m_depthImage { nullptr };
+    VkDeviceMemory m_depthImageMemory { nullptr };
+    VkImageView m_depthImageView { nullptr };
+
+    // 剔除使用的缓冲只在一个队列上按顺序使用，所有帧共用一份
+    VkBuffer m_objectBuffer { nullptr };
+    VkDeviceMemory m_objectBufferMemory { nullptr };
+    VkBuffer m_drawCommandBuffer { nullptr }; // 两个阶段各一个间接绘制命令
+    VkDeviceMemory m_drawCommandBufferMemory { nullptr };
+    VkBuffer m_visibleListBuffer { nullptr }; // 两个阶段各 OBJECT_COUNT 个物体索引
+    VkDeviceMemory m_visibleListBufferMemory { nullptr };
+    VkBuffer m_phase1ResultBuffer { nullptr }; // 第一阶段已经绘制或者被视锥剔除的物体为 1
+    VkDeviceMemory m_phase1ResultBufferMemory { nullptr };
+    std::array<VkBuffer, MAX_FRAMES_IN_FLIGHT> m_statisticsBuffers {};
+    std::array<VkDeviceMemory, MAX_FRAMES_IN_FLIGHT> m_statisticsBuffersMemory {};
+    std::array<void*, MAX_FRAMES_IN_FLIGHT> m_statisticsBuffersMapped {};
+    std::array<bool, MAX_FRAMES_IN_FLIGHT> m_statisticsWritten {};
+    CullStatistics m_statistics {};
+
+    VkSampler m_pyramidSampler { nullptr };
+    VkImage m_pyramidImage { nullptr };
+    VkDeviceMemory m_pyramidImageMemory { nullptr };
+    VkImageView m_pyramidView { nullptr };              // 所有 mip 层级，剔除时采样
+    std::vector<VkImageView> m_pyramidMipViews {};      // 每一个 mip 层级，构建时写入
+    VkDescriptorPool m_pyramidDescriptorPool { nullptr };
+    std::vector<VkDescriptorSet> m_pyramidDescriptorSets {}; // 每一个 mip 层级一个描述符集
+    uint32_t m_pyramidWidth { 0 };
+    uint32_t m_pyramidHeight { 0 };
+    uint32_t m_pyramidLevels { 0 };
+    bool m_pyramidValid { false };          // 深度金字塔是否已经包含上一帧的深度
+    glm::mat4 m_pyramidViewProj { 1.f };    // 构建深度金字塔时使用的变换矩阵
+    bool m_frustumCulling { true };
+    bool m_occlusionCulling { true };
+
+    glm::vec3 m_viewUp { 0.f, 1.f, 0.f };
+    glm::vec3 m_eyePos { 0.f, 4.f, -340.f };
+    glm::vec3 m_lookAt { 0.f };
+    double m_mouseLastX { 0.0 };
+    double m_mouseLastY { 0.0 };
+    bool m_isRotating { false };
+    bool m_isTranslating { false };
+
+    uint32_t m_minImageCount { 0 };
+    VkDescriptorPool m_imguiDescriptorPool { nullptr };
+};
+
+int main()
+{
+    HelloTriangleApplication app;
+
+    try
+    {
+        app.Run();
+    }
+    catch (const std::exception& e)
+    {
+        std::cerr << e.what() << '\n';
+        return EXIT_FAILURE;
+    }
+
+    return EXIT_SUCCESS;
+}
+
@@ -0,0 +1,41 @@
+#version 450
+
+layout(location = 0) in vec3 inPos;
+layout(location = 1) in vec3 inColor;
+
+layout(location = 0) out vec3 fragColor;
+
+layout(binding = 0) uniform UniformBufferObject{
+    mat4 view;
+    mat4 proj;
+} ubo;
+
+struct ObjectData
+{
+    vec4 positionScale; // xyz 是位置，w 是立方体的边长
+    vec4 color;
+};
+
+layout(binding = 1, std430) readonly buffer Objects
+{
+    ObjectData objects[];
+};
+
+// 剔除着色器写入的可见物体索引
+layout(binding = 3, std430) readonly buffer VisibleList
+{
+    uint visibleIds[];
+};
+
+layout(push_constant) uniform PushConstant{
+    uint listOffset;
+} PC;
+
+void main() 
+{
+    ObjectData object = objects[visibleIds[PC.listOffset + gl_InstanceIndex]];
+
+    vec3 worldPos = inPos * object.positionScale.w + object.positionScale.xyz;
+    gl_Position   = ubo.proj * ubo.view * vec4(worldPos, 1.0);
+    fragColor     = inColor * object.color.rgb;
+}
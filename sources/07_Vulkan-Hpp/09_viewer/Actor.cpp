@@ -1,9 +1,15 @@
 #include "Actor.h"
+#include "Camera.h"
 #include "Device.h"
+#include "MeshSimplifier.h"
 #include "Utils.h"
 #include "Viewer.h"
 #include <glm/glm.hpp>
 #include <glm/gtc/matrix_transform.hpp>
+#include <algorithm>
+#include <array>
+#include <iterator>
+#include <limits>
 
 namespace {
 
@@ -20,8 +26,18 @@ struct UniformBufferObject
     glm::mat4 proj {glm::mat4(1.f)};
 };
 
+// 和描述符集布局的绑定一一对应，通过 DescriptorUpdateTemplate 一次写入
+struct UniformDescriptorData
+{
+    vk::DescriptorBufferInfo ubo {};
+};
+
+const std::vector<vk::DescriptorSetLayoutBinding> descriptorSetLayoutBindings {
+    vk::DescriptorSetLayoutBinding {0, vk::DescriptorType::eUniformBuffer, 1, vk::ShaderStageFlagBits::eVertex}
+};
+
 // clang-format off
-const std::vector<Vertex> vertices  {
+const std::vector<Vertex> cubeVertices  {
     {{-0.5f,  0.5f, -0.5f}, {1.f, 0.f, 0.f}},
     {{ 0.5f,  0.5f, -0.5f}, {1.f, 1.f, 0.f}},
     {{ 0.5f, -0.5f, -0.5f}, {0.f, 1.f, 0.f}},
@@ -33,7 +49,7 @@ const std::vector<Vertex> vertices  {
     {{-0.5f, -0.5f,  0.5f}, {1.f, 1.f, 1.f}},
 };
 
-const std::vector<uint16_t> indices{
+const std::vector<uint32_t> cubeIndices{
     0, 1, 2, 0, 2, 3, // 前
     1, 5, 6, 1, 6, 2, // 右
     5, 4, 7, 5, 7, 6, // 后
@@ -44,6 +60,78 @@ const std::vector<uint16_t> indices{
 
 // clang-format on
 
+// 球：立方体的每个面细分为 subdivisions x subdivisions 的网格再投影到球面，三角形足够多，可以生成多级 LOD
+constexpr int subdivisions {16};
+constexpr float sphereRadius {.4f};
+
+struct Geometry
+{
+    std::vector<Vertex> vertices {};
+    std::vector<uint32_t> indices {};
+};
+
+Geometry BuildSphere()
+{
+    // 颜色在立方体 8 个顶点的颜色之间三线性插值，下标为 x + 2y + 4z
+    // clang-format off
+    const std::array<glm::vec3, 8> cornerColors {
+        glm::vec3 {0.f, 1.f, 1.f}, glm::vec3 {0.f, 1.f, 0.f}, glm::vec3 {1.f, 0.f, 0.f}, glm::vec3 {1.f, 1.f, 0.f},
+        glm::vec3 {1.f, 1.f, 1.f}, glm::vec3 {0.f, 0.f, 0.f}, glm::vec3 {0.f, 0.f, 1.f}, glm::vec3 {1.f, 0.f, 1.f},
+    };
+
+    // 每个面的法线和两个切线方向，切线的叉积等于法线，所有三角形的环绕方向一致
+    const std::array<std::array<glm::ivec3, 3>, 6> faces {{
+        {glm::ivec3 { 1,  0,  0}, glm::ivec3 {0, 1, 0}, glm::ivec3 {0, 0, 1}},
+        {glm::ivec3 {-1,  0,  0}, glm::ivec3 {0, 0, 1}, glm::ivec3 {0, 1, 0}},
+        {glm::ivec3 { 0,  1,  0}, glm::ivec3 {0, 0, 1}, glm::ivec3 {1, 0, 0}},
+        {glm::ivec3 { 0, -1,  0}, glm::ivec3 {1, 0, 0}, glm::ivec3 {0, 0, 1}},
+        {glm::ivec3 { 0,  0,  1}, glm::ivec3 {1, 0, 0}, glm::ivec3 {0, 1, 0}},
+        {glm::ivec3 { 0,  0, -1}, glm::ivec3 {0, 1, 0}, glm::ivec3 {1, 0, 0}},
+    }};
+    // clang-format on
+
+    Geometry geometry {};
+
+    // 以立方体上的整数网格坐标为键，相邻两个面在棱上共用顶点，网格是封闭的
+    constexpr int gridSize = subdivisions + 1;
+    std::vector<uint32_t> gridToVertex(gridSize * gridSize * gridSize, std::numeric_limits<uint32_t>::max());
+
+    auto getVertex = [&](const glm::ivec3& grid) {
+        auto& index = gridToVertex[(grid.z * gridSize + grid.y) * gridSize + grid.x];
+        if (std::numeric_limits<uint32_t>::max() == index)
+        {
+            auto t     = glm::vec3(grid) / static_cast<float>(subdivisions);
+            auto lower = glm::mix(glm::mix(cornerColors[0], cornerColors[1], t.x), glm::mix(cornerColors[2], cornerColors[3], t.x), t.y);
+            auto upper = glm::mix(glm::mix(cornerColors[4], cornerColors[5], t.x), glm::mix(cornerColors[6], cornerColors[7], t.x), t.y);
+
+            index = static_cast<uint32_t>(geometry.vertices.size());
+            geometry.vertices.emplace_back(Vertex {glm::normalize(t - .5f) * sphereRadius, glm::mix(lower, upper, t.z)});
+        }
+        return index;
+    };
+
+    for (const auto& [normal, tangent, bitangent] : faces)
+    {
+        auto origin = (normal + 1) / 2 * subdivisions;
+        for (int j = 0; j < subdivisions; ++j)
+        {
+            for (int i = 0; i < subdivisions; ++i)
+            {
+                auto v0 = getVertex(origin + i * tangent + j * bitangent);
+                auto v1 = getVertex(origin + (i + 1) * tangent + j * bitangent);
+                auto v2 = getVertex(origin + (i + 1) * tangent + (j + 1) * bitangent);
+                auto v3 = getVertex(origin + i * tangent + (j + 1) * bitangent);
+                geometry.indices.insert(geometry.indices.end(), {v0, v1, v2, v0, v2, v3});
+            }
+        }
+    }
+
+    return geometry;
+}
+
+// 选择投影到屏幕上的误差不超过这个像素个数的最简单的 LOD
+constexpr float maxPixelError {1.f};
+
 vk::raii::Pipeline makeGraphicsPipelineForViewer(
     vk::raii::Device const& device,
     vk::raii::PipelineCache const& pipelineCache,
@@ -147,6 +235,12 @@ vk::raii::Pipeline makeGraphicsPipelineForViewer(
 
 } // namespace
 
+Actor::Actor(Shape shape, const glm::vec3& position)
+    : m_shape(shape)
+    , m_position(position)
+{
+}
+
 void Actor::Update(const std::shared_ptr<Device> device, const Viewer* viewer)
 {
     if (!m_needUpdate)
@@ -160,11 +254,13 @@ void Actor::Update(const std::shared_ptr<Device> device, const Viewer* viewer)
     vk::raii::ShaderModule vertexShaderModule(device->device, vk::ShaderModuleCreateInfo(vk::ShaderModuleCreateFlags(), vertSPV));
     vk::raii::ShaderModule fragmentShaderModule(device->device, vk::ShaderModuleCreateInfo(vk::ShaderModuleCreateFlags(), fragSPV));
 
-    std::array descriptorSetLayoutBindings {
-        vk::DescriptorSetLayoutBinding {0, vk::DescriptorType::eUniformBuffer, 1, vk::ShaderStageFlagBits::eVertex}
-    };
-    vk::DescriptorSetLayoutCreateInfo descriptorSetLayoutCreateInfo({}, descriptorSetLayoutBindings);
-    vk::raii::DescriptorSetLayout descriptorSetLayout(device->device, descriptorSetLayoutCreateInfo);
+    // 支持 push descriptor 时每一次绘制直接把描述符记录到命令缓冲，不需要分配和更新描述符集
+    m_usePushDescriptor      = device->supportPushDescriptor;
+    auto descriptorSetLayout = viewer->descriptorAllocator->GetLayout(
+        descriptorSetLayoutBindings,
+        m_usePushDescriptor ? vk::DescriptorSetLayoutCreateFlags {vk::DescriptorSetLayoutCreateFlagBits::ePushDescriptorKHR}
+                            : vk::DescriptorSetLayoutCreateFlags {}
+    );
 
     std::array<vk::DescriptorSetLayout, 1> descriptorSetLayoursForPipeline {descriptorSetLayout};
     m_pipelineLayout = vk::raii::PipelineLayout(device->device, vk::PipelineLayoutCreateInfo {{}, descriptorSetLayoursForPipeline});
@@ -185,16 +281,36 @@ void Actor::Update(const std::shared_ptr<Device> device, const Viewer* viewer)
         viewer->renderPass
     );
     //--------------------------------------------------------------------------------------
+    const auto [vertices, indices] = Shape::Sphere == m_shape ? BuildSphere() : Geometry {cubeVertices, cubeIndices};
+
     m_vertexBufferData =
         BufferData(device, sizeof(Vertex) * vertices.size(), vk::BufferUsageFlagBits::eVertexBuffer | vk::BufferUsageFlagBits::eTransferDst);
     m_vertexBufferData.upload(device, vertices, sizeof(Vertex));
 
+    // 生成 LOD 链，所有级别的索引放在同一个索引缓冲中，顶点个数不超过 uint16_t 的范围
+    auto lods = MeshSimplifier::BuildLodChain(indices, &vertices.front().pos.x, vertices.size(), sizeof(Vertex));
+
+    std::vector<uint16_t> lodIndices {};
+    m_lods.clear();
+    for (const auto& lod : lods)
+    {
+        m_lods.emplace_back(Lod {static_cast<uint32_t>(lodIndices.size()), static_cast<uint32_t>(lod.indices.size()), lod.error});
+        std::ranges::transform(lod.indices, std::back_inserter(lodIndices), [](uint32_t index) { return static_cast<uint16_t>(index); });
+    }
+
+    glm::vec3 boundsMin {std::numeric_limits<float>::max()};
+    glm::vec3 boundsMax {std::numeric_limits<float>::lowest()};
+    for (const auto& vertex : vertices)
+    {
+        boundsMin = glm::min(boundsMin, vertex.pos);
+        boundsMax = glm::max(boundsMax, vertex.pos);
+    }
+    m_boundingSphere = glm::vec4(m_position + (boundsMin + boundsMax) * .5f, glm::length(boundsMax - boundsMin) * .5f);
+
     m_indexBufferData = BufferData(
-        device,
-        sizeof(std::remove_cvref_t<decltype(indices.front())>) * indices.size(),
-        vk::BufferUsageFlagBits::eIndexBuffer | vk::BufferUsageFlagBits::eTransferDst
+        device, sizeof(uint16_t) * lodIndices.size(), vk::BufferUsageFlagBits::eIndexBuffer | vk::BufferUsageFlagBits::eTransferDst
     );
-    m_indexBufferData.upload(device, indices, sizeof(std::remove_cvref_t<decltype(indices.front())>));
+    m_indexBufferData.upload(device, lodIndices, sizeof(uint16_t));
 
     UniformBufferObject defaultUBO {};
     m_uniformBufferObjects.reserve(viewer->numberOfFrames);
@@ -209,32 +325,60 @@ void Actor::Update(const std::shared_ptr<Device> device, const Viewer* viewer)
         Utils::CopyToDevice(m_uniformBufferObjects[i].deviceMemory, defaultUBO);
     }
 
-    std::vector<vk::DescriptorSetLayout> descriptorSetLayouts(3, descriptorSetLayout);
-
-    m_descriptorSets = vk::raii::DescriptorSets(device->device, vk::DescriptorSetAllocateInfo {viewer->descriptorPool, descriptorSetLayouts});
+    if (m_usePushDescriptor)
+    {
+        m_pushDescriptorTemplate = DescriptorUpdateTemplate(device, descriptorSetLayoutBindings, *m_pipelineLayout, 0);
+        return;
+    }
 
+    // 每一帧的描述符集只引用这一帧的 uniform 缓冲，内容不会改变，同一组资源只分配和写入一次
+    const auto& updateTemplate = viewer->descriptorAllocator->GetUpdateTemplate(descriptorSetLayoutBindings);
+    m_descriptorSets.clear();
     for (uint32_t i = 0; i < viewer->numberOfFrames; ++i)
     {
-        vk::DescriptorBufferInfo descriptorBufferInfo0(m_uniformBufferObjects[i].buffer, 0, sizeof(UniformBufferObject));
-        std::array<vk::WriteDescriptorSet, 1> writeDescriptorSets {
-            vk::WriteDescriptorSet {m_descriptorSets[i], 0, 0, vk::DescriptorType::eUniformBuffer, nullptr, descriptorBufferInfo0}
-        };
-        device->device.updateDescriptorSets(writeDescriptorSets, nullptr);
+        DescriptorResource resource {};
+        resource.binding        = 0;
+        resource.descriptorType = vk::DescriptorType::eUniformBuffer;
+        resource.buffer         = m_uniformBufferObjects[i].buffer;
+        resource.range          = sizeof(UniformBufferObject);
+
+        bool isNew {false};
+        auto descriptorSet = viewer->descriptorAllocator->AllocateCached(descriptorSetLayoutBindings, {resource}, isNew);
+        if (isNew)
+        {
+            updateTemplate.Update(descriptorSet, UniformDescriptorData {{m_uniformBufferObjects[i].buffer, 0, sizeof(UniformBufferObject)}});
+        }
+        m_descriptorSets.emplace_back(descriptorSet);
     }
 }
 
-void Actor::Render(const vk::raii::CommandBuffer& cmd, const uint32_t currentFrameIndex, const glm::mat4& viewMat, const glm::mat4& projMat)
+void Actor::Render(const vk::raii::CommandBuffer& cmd, const uint32_t currentFrameIndex, const Camera& camera, const vk::Extent2D& extent)
 {
     UniformBufferObject defaultUBO {};
-    defaultUBO.model = glm::mat4(1.f);
-    defaultUBO.view  = viewMat;
-    defaultUBO.proj  = projMat;
+    defaultUBO.model = glm::translate(glm::mat4(1.f), m_position);
+    defaultUBO.view  = camera.GetViewMatrix();
+    defaultUBO.proj  = camera.GetProjectMatrix(static_cast<float>(extent.width) / static_cast<float>(extent.height));
     Utils::CopyToDevice(m_uniformBufferObjects[currentFrameIndex].deviceMemory, defaultUBO);
 
     cmd.bindPipeline(vk::PipelineBindPoint::eGraphics, m_graphicsPipeline);
 
-    cmd.bindDescriptorSets(vk::PipelineBindPoint::eGraphics, m_pipelineLayout, 0, {m_descriptorSets[currentFrameIndex]}, nullptr);
+    if (m_usePushDescriptor)
+    {
+        m_pushDescriptorTemplate.Push(
+            cmd, UniformDescriptorData {{m_uniformBufferObjects[currentFrameIndex].buffer, 0, sizeof(UniformBufferObject)}}
+        );
+    }
+    else
+    {
+        cmd.bindDescriptorSets(vk::PipelineBindPoint::eGraphics, m_pipelineLayout, 0, {m_descriptorSets[currentFrameIndex]}, nullptr);
+    }
     cmd.bindVertexBuffers(0, {m_vertexBufferData.buffer}, {0});
     cmd.bindIndexBuffer(m_indexBufferData.buffer, 0, vk::IndexType::eUint16);
-    cmd.drawIndexed(static_cast<uint32_t>(indices.size()), 1, 0, 0, 0);
+
+    // 从最简单的一级开始，第一个误差足够小的级别
+    auto lod = std::ranges::find_if(m_lods.rbegin(), m_lods.rend(), [&camera, &extent, this](const Lod& lod) {
+        return camera.ProjectError(glm::vec3(m_boundingSphere), m_boundingSphere.w, lod.error, static_cast<float>(extent.height)) <= maxPixelError;
+    });
+    const auto& selected = lod != m_lods.rend() ? *lod : m_lods.front();
+    cmd.drawIndexed(selected.indexCount, 1, selected.firstIndex, 0, 0);
 }
@@ -1,27 +1,52 @@
 #pragma once
 
 #include "BufferData.h"
+#include "DescriptorUpdateTemplate.h"
 #include <glm/glm.hpp>
 #include <vulkan/vulkan_raii.hpp>
 
 struct Device;
 class Viewer;
+class Camera;
 
 class Actor
 {
 public:
+    // 立方体只有 12 个三角形；球的三角形足够多，可以生成多级 LOD
+    enum class Shape
+    {
+        Cube,
+        Sphere,
+    };
+
+    explicit Actor(Shape shape = Shape::Cube, const glm::vec3& position = glm::vec3(0.f));
+
     void Update(const std::shared_ptr<Device> device, const Viewer* viewer);
-    void Render(const vk::raii::CommandBuffer& cmd, const uint32_t currentFrameIndex, const glm::mat4& viewMat, const glm::mat4& projMat);
+    void Render(const vk::raii::CommandBuffer& cmd, const uint32_t currentFrameIndex, const Camera& camera, const vk::Extent2D& extent);
 
 private:
+    // 所有 LOD 的索引依次存放在 m_indexBufferData 中，第 0 级是原始网格
+    struct Lod
+    {
+        uint32_t firstIndex {0};
+        uint32_t indexCount {0};
+        float error {0.f};
+    };
+
+    Shape m_shape {Shape::Cube};
+    glm::vec3 m_position {0.f}; // 模型矩阵只有平移
     bool m_needUpdate {true};
 
     vk::raii::PipelineLayout m_pipelineLayout {nullptr};
     vk::raii::Pipeline m_graphicsPipeline {nullptr};
 
-    vk::raii::DescriptorSets m_descriptorSets {nullptr};
+    std::vector<vk::DescriptorSet> m_descriptorSets {};
+    DescriptorUpdateTemplate m_pushDescriptorTemplate {nullptr};
+    bool m_usePushDescriptor {false};
 
     BufferData m_vertexBufferData {nullptr};
     BufferData m_indexBufferData {nullptr};
+    std::vector<Lod> m_lods {};
+    glm::vec4 m_boundingSphere {0.f}; // xyz 为球心，w 为半径
     std::vector<BufferData> m_uniformBufferObjects {};
 };
@@ -1,5 +1,7 @@
 #include "Camera.h"
+#include <cmath>
 #include <glm/gtc/matrix_transform.hpp>
+#include <limits>
 
 glm::mat4 Camera::GetViewMatrix() const noexcept
 {
@@ -8,7 +10,18 @@ glm::mat4 Camera::GetViewMatrix() const noexcept
 
 glm::mat4 Camera::GetProjectMatrix(const float aspect) const noexcept
 {
-    return glm::perspective(glm::radians(45.f), aspect, 0.1f, 100.f);
+    return glm::perspective(glm::radians(m_viewAngle), aspect, 0.1f, 100.f);
+}
+
+float Camera::ProjectError(const glm::vec3& center, const float radius, const float error, const float viewportHeight) const noexcept
+{
+    auto distance = glm::dot(center - m_eyePosition, glm::normalize(m_lookAt - m_eyePosition)) - radius;
+    if (distance <= 0.f)
+    {
+        return std::numeric_limits<float>::infinity();
+    }
+
+    return error * viewportHeight / (2.f * std::tan(glm::radians(m_viewAngle) * .5f) * distance);
 }
 
 void Camera::SetEyePosition(glm::vec3&& eyePosition)
@@ -8,6 +8,11 @@ public:
     glm::mat4 GetViewMatrix() const noexcept;
     glm::mat4 GetProjectMatrix(const float aspect) const noexcept;
 
+    /// @brief 世界空间中的几何误差投影到屏幕上的像素个数，用于选择 LOD
+    /// @param center radius 物体的包围球，使用球面上离相机最近的点，相机在球内时返回无穷大
+    /// @param viewportHeight 视口的高度（像素）
+    float ProjectError(const glm::vec3& center, const float radius, const float error, const float viewportHeight) const noexcept;
+
     void SetEyePosition(glm::vec3&& eyePosition);
     void SetLookAt(glm::vec3&& lookAt);
     void SetViewUp(glm::vec3&& viewUp);
@@ -16,4 +21,5 @@ private:
     glm::vec3 m_eyePosition {0.f, 0.f, 3.f};
     glm::vec3 m_lookAt {0.f, 0.f, 0.f};
     glm::vec3 m_viewUp {0.f, 1.f, 0.f};
+    float m_viewAngle {45.f}; // 垂直方向的视角（度）
 };
@@ -0,0 +1,224 @@
+#include "DescriptorAllocator.h"
+#include "Device.h"
+#include <algorithm>
+#include <array>
+
+namespace {
+
+constexpr uint32_t InitialSetsPerPool {32};
+constexpr uint32_t MaxSetsPerPool {4096};
+
+// 每个描述符集平均需要的各类描述符数量
+constexpr std::array<std::pair<vk::DescriptorType, float>, 7> PoolSizeRatios {{
+    {vk::DescriptorType::eUniformBuffer, 2.f},
+    {vk::DescriptorType::eUniformBufferDynamic, 1.f},
+    {vk::DescriptorType::eCombinedImageSampler, 2.f},
+    {vk::DescriptorType::eStorageBuffer, 1.f},
+    {vk::DescriptorType::eStorageImage, .5f},
+    {vk::DescriptorType::eSampledImage, .5f},
+    {vk::DescriptorType::eInputAttachment, .5f},
+}};
+
+inline void HashCombine(size_t& seed, size_t value) noexcept
+{
+    seed ^= value + 0x9e3779b9 + (seed << 6) + (seed >> 2);
+}
+
+} // namespace
+
+bool DescriptorLayoutKey::operator==(const DescriptorLayoutKey& other) const noexcept
+{
+    if (flags != other.flags || bindings.size() != other.bindings.size())
+    {
+        return false;
+    }
+
+    for (size_t i = 0; i < bindings.size(); ++i)
+    {
+        const auto& a = bindings[i];
+        const auto& b = other.bindings[i];
+        if (a.binding != b.binding || a.descriptorType != b.descriptorType || a.descriptorCount != b.descriptorCount
+            || a.stageFlags != b.stageFlags || a.pImmutableSamplers != b.pImmutableSamplers)
+        {
+            return false;
+        }
+    }
+
+    return true;
+}
+
+size_t DescriptorLayoutKeyHash::operator()(const DescriptorLayoutKey& key) const noexcept
+{
+    size_t seed = std::hash<uint32_t> {}(static_cast<VkDescriptorSetLayoutCreateFlags>(key.flags));
+    for (const auto& binding : key.bindings)
+    {
+        HashCombine(seed, std::hash<uint32_t> {}(binding.binding));
+        HashCombine(seed, std::hash<uint32_t> {}(static_cast<uint32_t>(binding.descriptorType)));
+        HashCombine(seed, std::hash<uint32_t> {}(binding.descriptorCount));
+        HashCombine(seed, std::hash<uint32_t> {}(static_cast<VkShaderStageFlags>(binding.stageFlags)));
+    }
+    return seed;
+}
+
+bool DescriptorSetKey::operator==(const DescriptorSetKey& other) const noexcept
+{
+    return layout == other.layout && resources == other.resources;
+}
+
+size_t DescriptorSetKeyHash::operator()(const DescriptorSetKey& key) const noexcept
+{
+    size_t seed = DescriptorLayoutKeyHash {}(key.layout);
+    for (const auto& resource : key.resources)
+    {
+        HashCombine(seed, std::hash<uint32_t> {}(resource.binding));
+        HashCombine(seed, std::hash<uint32_t> {}(resource.arrayElement));
+        HashCombine(seed, std::hash<VkBuffer> {}(static_cast<VkBuffer>(resource.buffer)));
+        HashCombine(seed, std::hash<vk::DeviceSize> {}(resource.offset));
+        HashCombine(seed, std::hash<vk::DeviceSize> {}(resource.range));
+        HashCombine(seed, std::hash<VkSampler> {}(static_cast<VkSampler>(resource.sampler)));
+        HashCombine(seed, std::hash<VkImageView> {}(static_cast<VkImageView>(resource.imageView)));
+    }
+    return seed;
+}
+
+DescriptorAllocator::DescriptorAllocator(const std::shared_ptr<Device>& device, uint32_t numberOfFrames)
+    : m_device(device)
+    , m_frames(numberOfFrames)
+{
+    m_persistent.setsPerPool = InitialSetsPerPool;
+    for (auto& frame : m_frames)
+    {
+        frame.setsPerPool = InitialSetsPerPool;
+    }
+}
+
+vk::DescriptorSetLayout DescriptorAllocator::GetLayout(const std::vector<vk::DescriptorSetLayoutBinding>& bindings, vk::DescriptorSetLayoutCreateFlags flags)
+{
+    DescriptorLayoutKey key {flags, bindings};
+    std::sort(key.bindings.begin(), key.bindings.end(), [](const auto& a, const auto& b) { return a.binding < b.binding; });
+
+    if (auto it = m_layouts.find(key); it != m_layouts.end())
+    {
+        return it->second;
+    }
+
+    vk::raii::DescriptorSetLayout layout(m_device->device, vk::DescriptorSetLayoutCreateInfo {flags, key.bindings});
+    auto [it, _] = m_layouts.emplace(std::move(key), std::move(layout));
+    return it->second;
+}
+
+const DescriptorUpdateTemplate& DescriptorAllocator::GetUpdateTemplate(const std::vector<vk::DescriptorSetLayoutBinding>& bindings)
+{
+    auto layout = static_cast<VkDescriptorSetLayout>(GetLayout(bindings));
+
+    if (auto it = m_updateTemplates.find(layout); it != m_updateTemplates.end())
+    {
+        return *it->second;
+    }
+
+    auto [it, _] = m_updateTemplates.emplace(layout, std::make_unique<DescriptorUpdateTemplate>(m_device, bindings, layout));
+    return *it->second;
+}
+
+vk::DescriptorSet DescriptorAllocator::Allocate(vk::DescriptorSetLayout layout)
+{
+    return AllocateFromChain(m_persistent, layout);
+}
+
+std::vector<vk::DescriptorSet> DescriptorAllocator::Allocate(vk::DescriptorSetLayout layout, uint32_t count)
+{
+    std::vector<vk::DescriptorSet> descriptorSets {};
+    descriptorSets.reserve(count);
+    for (uint32_t i = 0; i < count; ++i)
+    {
+        descriptorSets.emplace_back(AllocateFromChain(m_persistent, layout));
+    }
+    return descriptorSets;
+}
+
+vk::DescriptorSet DescriptorAllocator::AllocateTransient(uint32_t frameIndex, vk::DescriptorSetLayout layout)
+{
+    return AllocateFromChain(m_frames.at(frameIndex), layout);
+}
+
+vk::DescriptorSet DescriptorAllocator::AllocateCached(
+    const std::vector<vk::DescriptorSetLayoutBinding>& bindings, const std::vector<DescriptorResource>& resources, bool& isNew
+)
+{
+    DescriptorSetKey key {{{}, bindings}, resources};
+    std::sort(key.layout.bindings.begin(), key.layout.bindings.end(), [](const auto& a, const auto& b) { return a.binding < b.binding; });
+    std::sort(key.resources.begin(), key.resources.end(), [](const auto& a, const auto& b) {
+        return a.binding != b.binding ? a.binding < b.binding : a.arrayElement < b.arrayElement;
+    });
+
+    if (auto it = m_cachedSets.find(key); it != m_cachedSets.end())
+    {
+        isNew = false;
+        return it->second;
+    }
+
+    isNew    = true;
+    auto set = AllocateFromChain(m_persistent, GetLayout(bindings));
+    m_cachedSets.emplace(std::move(key), set);
+    return set;
+}
+
+void DescriptorAllocator::BeginFrame(uint32_t frameIndex)
+{
+    // 池中分配的描述符集通过 vkResetDescriptorPool 一次释放，重置之后的池留到这一帧再次使用
+    auto& chain = m_frames.at(frameIndex);
+    for (auto& pool : chain.usedPools)
+    {
+        pool.reset();
+        chain.freePools.emplace_back(std::move(pool));
+    }
+    chain.usedPools.clear();
+}
+
+vk::DescriptorSet DescriptorAllocator::AllocateFromChain(PoolChain& chain, vk::DescriptorSetLayout layout)
+{
+    if (chain.usedPools.empty())
+    {
+        GrowChain(chain);
+    }
+
+    try
+    {
+        return (*m_device->device).allocateDescriptorSets({*chain.usedPools.back(), layout}, *m_device->device.getDispatcher()).front();
+    }
+    catch (const vk::OutOfPoolMemoryError&)
+    {
+    }
+    catch (const vk::FragmentedPoolError&)
+    {
+    }
+
+    // 当前池已满，换一个新的池再分配一次，新池仍然失败说明布局本身超过了池的容量，直接抛出异常
+    GrowChain(chain);
+    return (*m_device->device).allocateDescriptorSets({*chain.usedPools.back(), layout}, *m_device->device.getDispatcher()).front();
+}
+
+vk::raii::DescriptorPool DescriptorAllocator::CreatePool(uint32_t maxSets) const
+{
+    std::vector<vk::DescriptorPoolSize> poolSizes {};
+    poolSizes.reserve(PoolSizeRatios.size());
+    for (const auto& [type, ratio] : PoolSizeRatios)
+    {
+        poolSizes.emplace_back(type, std::max(1u, static_cast<uint32_t>(ratio * maxSets)));
+    }
+
+    return vk::raii::DescriptorPool(m_device->device, vk::DescriptorPoolCreateInfo {{}, maxSets, poolSizes});
+}
+
+void DescriptorAllocator::GrowChain(PoolChain& chain)
+{
+    if (!chain.freePools.empty())
+    {
+        chain.usedPools.emplace_back(std::move(chain.freePools.back()));
+        chain.freePools.pop_back();
+        return;
+    }
+
+    chain.usedPools.emplace_back(CreatePool(chain.setsPerPool));
+    chain.setsPerPool = std::min(chain.setsPerPool * 2, MaxSetsPerPool);
+}
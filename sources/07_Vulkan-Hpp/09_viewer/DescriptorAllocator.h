@@ -0,0 +1,111 @@
+#pragma once
+
+#include "DescriptorUpdateTemplate.h"
+#include <memory>
+#include <unordered_map>
+#include <vector>
+#include <vulkan/vulkan.hpp>
+#include <vulkan/vulkan_raii.hpp>
+
+struct Device;
+
+// 描述符集布局的键，绑定按 binding 排序，绑定相同的布局只创建一次
+struct DescriptorLayoutKey
+{
+    vk::DescriptorSetLayoutCreateFlags flags {};
+    std::vector<vk::DescriptorSetLayoutBinding> bindings {};
+
+    bool operator==(const DescriptorLayoutKey& other) const noexcept;
+};
+
+struct DescriptorLayoutKeyHash
+{
+    size_t operator()(const DescriptorLayoutKey& key) const noexcept;
+};
+
+// 描述符集中一个绑定引用的资源，缓冲类型只使用 buffer/offset/range，图像类型只使用 sampler/imageView/imageLayout
+struct DescriptorResource
+{
+    uint32_t binding {0};
+    uint32_t arrayElement {0};
+    vk::DescriptorType descriptorType {};
+    vk::Buffer buffer {};
+    vk::DeviceSize offset {0};
+    vk::DeviceSize range {0};
+    vk::Sampler sampler {};
+    vk::ImageView imageView {};
+    vk::ImageLayout imageLayout {};
+
+    bool operator==(const DescriptorResource& other) const noexcept = default;
+};
+
+// 不可变描述符集的键：完整的布局（flags 和所有绑定）加上所有资源，比较时逐个字段比较，哈希冲突不会返回写入了其他资源的描述符集
+struct DescriptorSetKey
+{
+    DescriptorLayoutKey layout {};
+    std::vector<DescriptorResource> resources {};
+
+    bool operator==(const DescriptorSetKey& other) const noexcept;
+};
+
+struct DescriptorSetKeyHash
+{
+    size_t operator()(const DescriptorSetKey& key) const noexcept;
+};
+
+/// @brief 可增长的描述符分配器
+/// @details 当前描述符池耗尽（OutOfPoolMemory / FragmentedPool）时自动创建新的描述符池，没有场景大小的限制
+///          持久的描述符集和 Viewer 的生命周期相同；每一帧的临时描述符集在该帧再次开始时整体 vkResetDescriptorPool
+///          描述符池都不带 eFreeDescriptorSet 标志，所以返回的都是 vk::DescriptorSet 而不是 vk::raii::DescriptorSet
+class DescriptorAllocator
+{
+public:
+    DescriptorAllocator(const std::shared_ptr<Device>& device, uint32_t numberOfFrames);
+
+    DescriptorAllocator(const DescriptorAllocator&)            = delete;
+    DescriptorAllocator& operator=(const DescriptorAllocator&) = delete;
+
+    vk::DescriptorSetLayout GetLayout(const std::vector<vk::DescriptorSetLayoutBinding>& bindings, vk::DescriptorSetLayoutCreateFlags flags = {});
+
+    vk::DescriptorSet Allocate(vk::DescriptorSetLayout layout);
+
+    std::vector<vk::DescriptorSet> Allocate(vk::DescriptorSetLayout layout, uint32_t count);
+
+    // 只在 frameIndex 这一帧有效，下一次 BeginFrame(frameIndex) 之后失效
+    vk::DescriptorSet AllocateTransient(uint32_t frameIndex, vk::DescriptorSetLayout layout);
+
+    // 每个布局只生成一次更新模板，bindings 的数据排列方式见 DescriptorUpdateTemplate
+    const DescriptorUpdateTemplate& GetUpdateTemplate(const std::vector<vk::DescriptorSetLayoutBinding>& bindings);
+
+    // 不可变描述符集：同一个布局、同一组资源只分配一次，isNew 为 true 时调用者需要写入描述符
+    vk::DescriptorSet AllocateCached(
+        const std::vector<vk::DescriptorSetLayoutBinding>& bindings, const std::vector<DescriptorResource>& resources, bool& isNew
+    );
+
+    // 必须在 frameIndex 对应的 fence 等待完成之后调用
+    void BeginFrame(uint32_t frameIndex);
+
+private:
+    struct PoolChain
+    {
+        std::vector<vk::raii::DescriptorPool> usedPools {};
+        std::vector<vk::raii::DescriptorPool> freePools {};
+        uint32_t setsPerPool {0};
+    };
+
+    vk::DescriptorSet AllocateFromChain(PoolChain& chain, vk::DescriptorSetLayout layout);
+
+    vk::raii::DescriptorPool CreatePool(uint32_t maxSets) const;
+
+    void GrowChain(PoolChain& chain);
+
+private:
+    std::shared_ptr<Device> m_device {};
+
+    PoolChain m_persistent {};
+    std::vector<PoolChain> m_frames {};
+
+    std::unordered_map<DescriptorLayoutKey, vk::raii::DescriptorSetLayout, DescriptorLayoutKeyHash> m_layouts {};
+    std::unordered_map<VkDescriptorSetLayout, std::unique_ptr<DescriptorUpdateTemplate>> m_updateTemplates {};
+    std::unordered_map<DescriptorSetKey, vk::DescriptorSet, DescriptorSetKeyHash> m_cachedSets {};
+};
@@ -0,0 +1,104 @@
+#include "DescriptorUpdateTemplate.h"
+#include "Device.h"
+#include <algorithm>
+
+DescriptorUpdateTemplate::DescriptorUpdateTemplate(
+    const std::shared_ptr<Device>& device, const std::vector<vk::DescriptorSetLayoutBinding>& bindings, vk::DescriptorSetLayout layout
+)
+    : m_device(device)
+{
+    auto entries = MakeEntries(bindings);
+
+    m_template = vk::raii::DescriptorUpdateTemplate(
+        m_device->device, vk::DescriptorUpdateTemplateCreateInfo {{}, entries, vk::DescriptorUpdateTemplateType::eDescriptorSet, layout}
+    );
+}
+
+DescriptorUpdateTemplate::DescriptorUpdateTemplate(
+    const std::shared_ptr<Device>& device,
+    const std::vector<vk::DescriptorSetLayoutBinding>& bindings,
+    vk::PipelineLayout pipelineLayout,
+    uint32_t set,
+    vk::PipelineBindPoint bindPoint
+)
+    : m_device(device)
+    , m_pipelineLayout(pipelineLayout)
+    , m_set(set)
+{
+    assert(m_device->supportPushDescriptor);
+
+    auto entries = MakeEntries(bindings);
+
+    m_template = vk::raii::DescriptorUpdateTemplate(
+        m_device->device,
+        vk::DescriptorUpdateTemplateCreateInfo {{}, entries, vk::DescriptorUpdateTemplateType::ePushDescriptorsKHR, {}, bindPoint, pipelineLayout, set}
+    );
+}
+
+DescriptorUpdateTemplate::DescriptorUpdateTemplate(std::nullptr_t)
+{
+}
+
+void DescriptorUpdateTemplate::Update(vk::DescriptorSet descriptorSet, const void* data) const
+{
+    m_device->device.getDispatcher()->vkUpdateDescriptorSetWithTemplate(
+        static_cast<VkDevice>(*m_device->device),
+        static_cast<VkDescriptorSet>(descriptorSet),
+        static_cast<VkDescriptorUpdateTemplate>(*m_template),
+        data
+    );
+}
+
+void DescriptorUpdateTemplate::Push(const vk::raii::CommandBuffer& commandBuffer, const void* data) const
+{
+    assert(m_pipelineLayout);
+
+    commandBuffer.getDispatcher()->vkCmdPushDescriptorSetWithTemplateKHR(
+        static_cast<VkCommandBuffer>(*commandBuffer),
+        static_cast<VkDescriptorUpdateTemplate>(*m_template),
+        static_cast<VkPipelineLayout>(m_pipelineLayout),
+        m_set,
+        data
+    );
+}
+
+size_t DescriptorUpdateTemplate::GetDataSize() const noexcept
+{
+    return m_dataSize;
+}
+
+size_t DescriptorUpdateTemplate::GetDescriptorSize(vk::DescriptorType type) noexcept
+{
+    switch (type)
+    {
+        case vk::DescriptorType::eUniformBuffer:
+        case vk::DescriptorType::eStorageBuffer:
+        case vk::DescriptorType::eUniformBufferDynamic:
+        case vk::DescriptorType::eStorageBufferDynamic:
+            return sizeof(vk::DescriptorBufferInfo);
+        case vk::DescriptorType::eUniformTexelBuffer:
+        case vk::DescriptorType::eStorageTexelBuffer:
+            return sizeof(vk::BufferView);
+        default:
+            return sizeof(vk::DescriptorImageInfo);
+    }
+}
+
+std::vector<vk::DescriptorUpdateTemplateEntry> DescriptorUpdateTemplate::MakeEntries(const std::vector<vk::DescriptorSetLayoutBinding>& bindings)
+{
+    auto sortedBindings = bindings;
+    std::sort(sortedBindings.begin(), sortedBindings.end(), [](const auto& a, const auto& b) { return a.binding < b.binding; });
+
+    std::vector<vk::DescriptorUpdateTemplateEntry> entries {};
+    entries.reserve(sortedBindings.size());
+
+    m_dataSize = 0;
+    for (const auto& binding : sortedBindings)
+    {
+        auto stride = GetDescriptorSize(binding.descriptorType);
+        entries.emplace_back(binding.binding, 0, binding.descriptorCount, binding.descriptorType, m_dataSize, stride);
+        m_dataSize += stride * binding.descriptorCount;
+    }
+
+    return entries;
+}
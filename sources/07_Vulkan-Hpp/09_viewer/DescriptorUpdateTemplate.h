@@ -0,0 +1,66 @@
+#pragma once
+
+#include <cassert>
+#include <memory>
+#include <vector>
+#include <vulkan/vulkan.hpp>
+#include <vulkan/vulkan_raii.hpp>
+
+struct Device;
+
+/// @brief 由描述符集布局的绑定生成一次 VkDescriptorUpdateTemplate，之后直接从紧凑排列的结构体写入描述符
+/// @details 结构体中的成员按 binding 从小到大依次排列，每个描述符对应的类型为：
+///          Buffer 类 -> vk::DescriptorBufferInfo，Image/Sampler 类 -> vk::DescriptorImageInfo，TexelBuffer 类 -> vk::BufferView
+///          例如 binding0 为 UniformBuffer，binding1 为 CombinedImageSampler：
+///          struct { vk::DescriptorBufferInfo ubo; vk::DescriptorImageInfo texture; };
+class DescriptorUpdateTemplate
+{
+public:
+    // 用于 vkUpdateDescriptorSetWithTemplate，更新已经分配好的描述符集
+    DescriptorUpdateTemplate(
+        const std::shared_ptr<Device>& device, const std::vector<vk::DescriptorSetLayoutBinding>& bindings, vk::DescriptorSetLayout layout
+    );
+
+    // 用于 VK_KHR_push_descriptor，布局需要使用 ePushDescriptorKHR 创建，不需要分配描述符集
+    DescriptorUpdateTemplate(
+        const std::shared_ptr<Device>& device,
+        const std::vector<vk::DescriptorSetLayoutBinding>& bindings,
+        vk::PipelineLayout pipelineLayout,
+        uint32_t set,
+        vk::PipelineBindPoint bindPoint = vk::PipelineBindPoint::eGraphics
+    );
+
+    DescriptorUpdateTemplate(std::nullptr_t);
+
+    template <typename DataType>
+    void Update(vk::DescriptorSet descriptorSet, const DataType& data) const
+    {
+        assert(sizeof(DataType) >= m_dataSize);
+        Update(descriptorSet, static_cast<const void*>(&data));
+    }
+
+    template <typename DataType>
+    void Push(const vk::raii::CommandBuffer& commandBuffer, const DataType& data) const
+    {
+        assert(sizeof(DataType) >= m_dataSize);
+        Push(commandBuffer, static_cast<const void*>(&data));
+    }
+
+    void Update(vk::DescriptorSet descriptorSet, const void* data) const;
+
+    void Push(const vk::raii::CommandBuffer& commandBuffer, const void* data) const;
+
+    size_t GetDataSize() const noexcept;
+
+    static size_t GetDescriptorSize(vk::DescriptorType type) noexcept;
+
+private:
+    std::vector<vk::DescriptorUpdateTemplateEntry> MakeEntries(const std::vector<vk::DescriptorSetLayoutBinding>& bindings);
+
+private:
+    std::shared_ptr<Device> m_device {};
+    vk::raii::DescriptorUpdateTemplate m_template {nullptr};
+    vk::PipelineLayout m_pipelineLayout {};
+    uint32_t m_set {0};
+    size_t m_dataSize {0};
+};
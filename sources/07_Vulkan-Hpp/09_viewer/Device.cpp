@@ -1,8 +1,10 @@
 
 #include "Device.h"
 #include "Window.h"
+#include <algorithm>
 #include <iostream>
 #include <set>
+#include <string_view>
 
 #include <vulkan/vulkan.h>
 
@@ -152,6 +154,16 @@ void Device::CreateDevice() noexcept
         deviceQueueCreateInfos.emplace_back(vk::DeviceQueueCreateInfo {{}, queueIndex, 1, &queuePriority});
     }
 
+    // 支持 VK_KHR_push_descriptor 时开启，每一次绘制的描述符可以直接记录到命令缓冲，不需要分配描述符集
+    auto extensionProperties = physicalDevice.enumerateDeviceExtensionProperties();
+    supportPushDescriptor    = std::any_of(extensionProperties.cbegin(), extensionProperties.cend(), [](const vk::ExtensionProperties& property) {
+        return std::string_view(property.extensionName.data()) == VK_KHR_PUSH_DESCRIPTOR_EXTENSION_NAME;
+    });
+    if (supportPushDescriptor)
+    {
+        m_enableDeviceExtensionNames.emplace_back(VK_KHR_PUSH_DESCRIPTOR_EXTENSION_NAME);
+    }
+
     vk::DeviceCreateInfo deviceCreateInfo({}, deviceQueueCreateInfos, {}, m_enableDeviceExtensionNames, {});
     device = vk::raii::Device(physicalDevice, deviceCreateInfo);
 }
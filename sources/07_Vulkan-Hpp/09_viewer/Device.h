@@ -34,6 +34,8 @@ public:
     uint32_t graphicsQueueIndex {};
     uint32_t presentQueueIndex {};
 
+    bool supportPushDescriptor {false};
+
     vk::raii::PhysicalDevice physicalDevice {nullptr};
     vk::raii::Device device {nullptr};
 
@@ -0,0 +1,64 @@
+#include "Event.h"
+
+namespace {
+
+constexpr bool IsWheelEvent(EventType type) noexcept
+{
+    return EventType::MouseWheelForward == type || EventType::MouseWheelBackward == type;
+}
+
+constexpr int SignedWheelDelta(const Event& event) noexcept
+{
+    return EventType::MouseWheelForward == event.type ? event.wheelDelta : -event.wheelDelta;
+}
+
+} // namespace
+
+void EventQueue::Push(const Event& event)
+{
+    if (!m_events.empty())
+    {
+        auto& last = m_events.back();
+
+        if (EventType::MouseMove == event.type && EventType::MouseMove == last.type)
+        {
+            last.position = event.position;
+            return;
+        }
+
+        if (EventType::ResizeWindow == event.type && EventType::ResizeWindow == last.type)
+        {
+            last = event;
+            return;
+        }
+
+        if (IsWheelEvent(event.type) && IsWheelEvent(last.type))
+        {
+            auto delta = SignedWheelDelta(last) + SignedWheelDelta(event);
+            if (0 == delta)
+            {
+                m_events.pop_back();
+                return;
+            }
+
+            last.type       = delta > 0 ? EventType::MouseWheelForward : EventType::MouseWheelBackward;
+            last.wheelDelta = delta > 0 ? delta : -delta;
+            last.position   = event.position;
+            return;
+        }
+    }
+
+    m_events.emplace_back(event);
+}
+
+std::vector<Event> EventQueue::Drain()
+{
+    std::vector<Event> events {};
+    events.swap(m_events);
+    return events;
+}
+
+bool EventQueue::Empty() const noexcept
+{
+    return m_events.empty();
+}
@@ -2,6 +2,7 @@
 
 #include <array>
 #include <cstdint>
+#include <vector>
 
 enum class EventType : uint8_t
 {
@@ -65,4 +66,21 @@ struct Event
     EventKeyCode keyCode {EventKeyCode::None};
     int repeatCount {0};
     int keySym {0};
+    int wheelDelta {1}; // 合并后的滚轮滚动次数
+};
+
+/// @brief 一帧内的事件队列，入队时合并连续的同类事件
+/// @details 连续的鼠标移动只保留最后一次的位置，连续的滚轮事件累加滚动次数（前后滚动相互抵消），连续的窗口大小改变只保留最后一次
+///          其他事件（按键、鼠标按下抬起等）按顺序保留，保证拖拽等操作的先后关系不变
+class EventQueue
+{
+public:
+    void Push(const Event& event);
+
+    std::vector<Event> Drain();
+
+    bool Empty() const noexcept;
+
+private:
+    std::vector<Event> m_events {};
 };
@@ -17,7 +17,19 @@ void Interactor::Start()
 
     while (!m_window->GetWindowHelper()->ShouldExit())
     {
-        m_window->GetWindowHelper()->PollEvents();
+        // 没有需要绘制的内容时阻塞等待事件，空闲时不占用 CPU 和 GPU；被帧率上限推迟的帧只等待到下一帧允许绘制的时刻
+        if (!m_window->GetViewer()->NeedRender())
+        {
+            m_window->GetWindowHelper()->WaitEvents();
+        }
+        else if (auto wait = m_window->GetViewer()->GetTimeUntilNextFrame().count(); wait > 0.0)
+        {
+            m_window->GetWindowHelper()->WaitEvents(wait);
+        }
+        else
+        {
+            m_window->GetWindowHelper()->PollEvents();
+        }
 
         if (s_windowResized)
         {
@@ -29,6 +41,8 @@ void Interactor::Start()
             m_window->GetViewer()->ProcessEvent(event);
             s_windowResized = false;
         }
+
+        m_window->GetViewer()->ProcessPendingEvents();
     }
 }
 
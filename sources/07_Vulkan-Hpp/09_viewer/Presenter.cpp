@@ -0,0 +1,194 @@
+#include "Presenter.h"
+#include "Device.h"
+#include "Window.h"
+#include <algorithm>
+#include <iostream>
+#include <thread>
+
+SwapChainPresenter::SwapChainPresenter(const std::shared_ptr<Device>& device, WindowHelper* windowHelper)
+    : m_device(device)
+    , m_windowHelper(windowHelper)
+{
+    m_swapChainData = SwapChainData(
+        m_device,
+        m_windowHelper->surfaceData.surface,
+        m_windowHelper->surfaceData.extent,
+        vk::ImageUsageFlagBits::eColorAttachment,
+        nullptr,
+        m_device->graphicsQueueIndex,
+        m_device->presentQueueIndex
+    );
+}
+
+uint32_t SwapChainPresenter::AcquireNextImage(vk::Semaphore imageAcquiredSemaphore)
+{
+    auto [result, imageIndex] = m_swapChainData.swapChain.acquireNextImage(std::numeric_limits<uint64_t>::max(), imageAcquiredSemaphore);
+    assert(imageIndex < m_swapChainData.images.size());
+    return imageIndex;
+}
+
+void SwapChainPresenter::Present(uint32_t imageIndex, vk::Semaphore renderFinishedSemaphore)
+{
+    std::array<vk::Semaphore, 1> presentWait {renderFinishedSemaphore};
+    std::array<vk::SwapchainKHR, 1> swapchains {m_swapChainData.swapChain};
+    vk::PresentInfoKHR presentInfoKHR(presentWait, swapchains, imageIndex);
+
+    try
+    {
+        auto presentResult = m_device->presentQueue.presentKHR(presentInfoKHR);
+    }
+    catch (vk::SystemError& err)
+    {
+        std::cout << "vk::SystemError\n\twhat: " << err.what() << "\n\tcode: " << err.code() << '\n';
+    }
+}
+
+void SwapChainPresenter::Recreate(const vk::Extent2D& extent)
+{
+    m_swapChainData = SwapChainData(
+        m_device,
+        m_windowHelper->surfaceData.surface,
+        extent,
+        vk::ImageUsageFlagBits::eColorAttachment,
+        &m_swapChainData.swapChain,
+        m_device->graphicsQueueIndex,
+        m_device->presentQueueIndex
+    );
+}
+
+vk::ImageLayout SwapChainPresenter::GetPresentLayout() const noexcept
+{
+    return vk::ImageLayout::ePresentSrcKHR;
+}
+
+vk::Format SwapChainPresenter::GetFormat() const noexcept
+{
+    return m_swapChainData.colorFormat;
+}
+
+vk::Extent2D SwapChainPresenter::GetExtent() const noexcept
+{
+    return m_swapChainData.swapchainExtent;
+}
+
+uint32_t SwapChainPresenter::GetImageCount() const noexcept
+{
+    return m_swapChainData.numberOfImages;
+}
+
+vk::ImageView SwapChainPresenter::GetImageView(uint32_t imageIndex) const noexcept
+{
+    return m_swapChainData.imageViews[imageIndex];
+}
+
+//--------------------------------------------------------------------------------------
+VirtualPresenter::VirtualPresenter(const std::shared_ptr<Device>& device, const vk::Extent2D& extent, const VirtualSwapChainInfo& info)
+    : m_device(device)
+    , m_info(info)
+    , m_extent(extent)
+{
+    CreateImages();
+
+    m_presentFences.reserve(m_info.imageCount);
+    for (uint32_t i = 0; i < m_info.imageCount; ++i)
+    {
+        m_presentFences.emplace_back(vk::raii::Fence(m_device->device, vk::FenceCreateInfo(vk::FenceCreateFlagBits::eSignaled)));
+    }
+}
+
+uint32_t VirtualPresenter::AcquireNextImage(vk::Semaphore imageAcquiredSemaphore)
+{
+    auto imageIndex  = m_nextImageIndex;
+    m_nextImageIndex = (m_nextImageIndex + 1) % m_info.imageCount;
+
+    // 图像上一次的呈现完成之后才能再次写入
+    auto waitResult = m_device->device.waitForFences({m_presentFences[imageIndex]}, VK_TRUE, std::numeric_limits<uint64_t>::max());
+
+    // 模拟垂直同步：每个刷新周期只能获取一张图像
+    if (m_info.refreshRate > 0.0)
+    {
+        auto now = std::chrono::steady_clock::now();
+        if (m_nextVSync > now)
+        {
+            std::this_thread::sleep_until(m_nextVSync);
+        }
+        auto interval = std::chrono::duration_cast<std::chrono::steady_clock::duration>(std::chrono::duration<double>(1.0 / m_info.refreshRate));
+        m_nextVSync   = std::max(m_nextVSync, now) + interval;
+    }
+
+    // 和 vkAcquireNextImageKHR 一样通过信号量通知图像可用
+    vk::SubmitInfo submitInfo({}, {}, {}, imageAcquiredSemaphore);
+    m_device->graphicsQueue.submit(submitInfo, nullptr);
+
+    return imageIndex;
+}
+
+void VirtualPresenter::Present(uint32_t imageIndex, vk::Semaphore renderFinishedSemaphore)
+{
+    m_device->device.resetFences({m_presentFences[imageIndex]});
+
+    // 没有显示器，等待绘制完成的信号量之后触发 fence 即表示“呈现”完成
+    vk::PipelineStageFlags waitStage = vk::PipelineStageFlagBits::eAllCommands;
+    vk::SubmitInfo submitInfo(renderFinishedSemaphore, waitStage, {}, {});
+    m_device->graphicsQueue.submit(submitInfo, m_presentFences[imageIndex]);
+
+    ++m_presentCount;
+}
+
+void VirtualPresenter::Recreate(const vk::Extent2D& extent)
+{
+    m_device->device.waitIdle();
+
+    m_extent         = extent;
+    m_nextImageIndex = 0;
+    CreateImages();
+}
+
+vk::ImageLayout VirtualPresenter::GetPresentLayout() const noexcept
+{
+    return vk::ImageLayout::eTransferSrcOptimal;
+}
+
+vk::Format VirtualPresenter::GetFormat() const noexcept
+{
+    return m_info.format;
+}
+
+vk::Extent2D VirtualPresenter::GetExtent() const noexcept
+{
+    return m_extent;
+}
+
+uint32_t VirtualPresenter::GetImageCount() const noexcept
+{
+    return m_info.imageCount;
+}
+
+vk::ImageView VirtualPresenter::GetImageView(uint32_t imageIndex) const noexcept
+{
+    return m_images[imageIndex].imageView;
+}
+
+uint64_t VirtualPresenter::GetPresentCount() const noexcept
+{
+    return m_presentCount;
+}
+
+void VirtualPresenter::CreateImages()
+{
+    m_images.clear();
+    m_images.reserve(m_info.imageCount);
+    for (uint32_t i = 0; i < m_info.imageCount; ++i)
+    {
+        m_images.emplace_back(ImageData(
+            m_device,
+            m_info.format,
+            m_extent,
+            vk::ImageTiling::eOptimal,
+            vk::ImageUsageFlagBits::eColorAttachment | vk::ImageUsageFlagBits::eTransferSrc,
+            vk::ImageLayout::eUndefined,
+            vk::MemoryPropertyFlagBits::eDeviceLocal,
+            vk::ImageAspectFlagBits::eColor
+        ));
+    }
+}
@@ -0,0 +1,114 @@
+#pragma once
+
+#include "ImageData.h"
+#include "SwapChainData.h"
+#include <chrono>
+#include <memory>
+#include <vector>
+#include <vulkan/vulkan.hpp>
+#include <vulkan/vulkan_raii.hpp>
+
+struct Device;
+struct WindowHelper;
+
+/// @brief 图像呈现的抽象，Window 通过它获取和呈现交换链图像
+/// @details SwapChainPresenter 使用 GLFW 窗口和 VkSwapchainKHR
+///          VirtualPresenter 使用离屏图像模拟交换链，不需要窗口和显示器，可以在无显示的机器（CI、软件光栅化）上测试 Window 的绘制流程
+class Presenter
+{
+public:
+    virtual ~Presenter() noexcept = default;
+
+    // 返回可以绘制的图像序号，图像可以写入时 imageAcquiredSemaphore 被触发
+    virtual uint32_t AcquireNextImage(vk::Semaphore imageAcquiredSemaphore) = 0;
+
+    // 等待 renderFinishedSemaphore 之后呈现图像
+    virtual void Present(uint32_t imageIndex, vk::Semaphore renderFinishedSemaphore) = 0;
+
+    virtual void Recreate(const vk::Extent2D& extent) = 0;
+
+    // 渲染通道结束时图像需要转换到的布局
+    virtual vk::ImageLayout GetPresentLayout() const noexcept = 0;
+
+    virtual vk::Format GetFormat() const noexcept = 0;
+
+    virtual vk::Extent2D GetExtent() const noexcept = 0;
+
+    virtual uint32_t GetImageCount() const noexcept = 0;
+
+    virtual vk::ImageView GetImageView(uint32_t imageIndex) const noexcept = 0;
+};
+
+class SwapChainPresenter : public Presenter
+{
+public:
+    SwapChainPresenter(const std::shared_ptr<Device>& device, WindowHelper* windowHelper);
+
+    uint32_t AcquireNextImage(vk::Semaphore imageAcquiredSemaphore) override;
+
+    void Present(uint32_t imageIndex, vk::Semaphore renderFinishedSemaphore) override;
+
+    void Recreate(const vk::Extent2D& extent) override;
+
+    vk::ImageLayout GetPresentLayout() const noexcept override;
+
+    vk::Format GetFormat() const noexcept override;
+
+    vk::Extent2D GetExtent() const noexcept override;
+
+    uint32_t GetImageCount() const noexcept override;
+
+    vk::ImageView GetImageView(uint32_t imageIndex) const noexcept override;
+
+private:
+    std::shared_ptr<Device> m_device {};
+    WindowHelper* m_windowHelper {nullptr};
+    SwapChainData m_swapChainData {nullptr};
+};
+
+struct VirtualSwapChainInfo
+{
+    uint32_t imageCount {3};
+    double refreshRate {60.0}; // 模拟的垂直同步频率，0 表示不等待（类似 eImmediate）
+    vk::Format format {vk::Format::eB8G8R8A8Unorm};
+};
+
+class VirtualPresenter : public Presenter
+{
+public:
+    VirtualPresenter(const std::shared_ptr<Device>& device, const vk::Extent2D& extent, const VirtualSwapChainInfo& info = {});
+
+    uint32_t AcquireNextImage(vk::Semaphore imageAcquiredSemaphore) override;
+
+    void Present(uint32_t imageIndex, vk::Semaphore renderFinishedSemaphore) override;
+
+    void Recreate(const vk::Extent2D& extent) override;
+
+    vk::ImageLayout GetPresentLayout() const noexcept override;
+
+    vk::Format GetFormat() const noexcept override;
+
+    vk::Extent2D GetExtent() const noexcept override;
+
+    uint32_t GetImageCount() const noexcept override;
+
+    vk::ImageView GetImageView(uint32_t imageIndex) const noexcept override;
+
+    // 已经呈现的帧数
+    uint64_t GetPresentCount() const noexcept;
+
+private:
+    void CreateImages();
+
+private:
+    std::shared_ptr<Device> m_device {};
+    VirtualSwapChainInfo m_info {};
+    vk::Extent2D m_extent {};
+
+    std::vector<ImageData> m_images {};
+    std::vector<vk::raii::Fence> m_presentFences {}; // 图像被“显示器”释放之后才能再次获取
+    uint32_t m_nextImageIndex {0};
+    uint64_t m_presentCount {0};
+
+    std::chrono::steady_clock::time_point m_nextVSync {};
+};
@@ -9,6 +9,7 @@ View::View()
 void View::AddActor(const std::shared_ptr<Actor>& actor)
 {
     m_actors.emplace_back(actor);
+    m_dirty = true;
 }
 
 void View::Update(const std::shared_ptr<Device> device, const Viewer* viewer)
@@ -40,25 +41,40 @@ void View::Render(const vk::raii::CommandBuffer& commandBuffer, const Viewer* vi
     commandBuffer.setScissor(0, vk::Rect2D(offset, extent));
     commandBuffer.clearAttachments(attachment, rect);
 
-    auto aspect = static_cast<float>(extent.width) / static_cast<float>(extent.height);
-
     for (const auto& actor : m_actors)
     {
-        actor->Render(commandBuffer, viewer->currentFrameIndex, m_camera->GetViewMatrix(), m_camera->GetProjectMatrix(aspect));
+        actor->Render(commandBuffer, viewer->currentFrameIndex, *m_camera, extent);
     }
 }
 
 void View::SetViewport(const std::array<double, 4>& viewport)
 {
     m_viewport = viewport;
+    m_dirty    = true;
 }
 
 void View::SetBackground(const std::array<float, 4>& background)
 {
     m_background = background;
+    m_dirty      = true;
 }
 
 const std::unique_ptr<Camera>& View::GetCamera() const noexcept
 {
     return m_camera;
 }
+
+void View::MarkDirty() noexcept
+{
+    m_dirty = true;
+}
+
+bool View::IsDirty() const noexcept
+{
+    return m_dirty;
+}
+
+void View::ClearDirty() noexcept
+{
+    m_dirty = false;
+}
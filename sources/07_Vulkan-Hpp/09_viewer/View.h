@@ -28,9 +28,17 @@ public:
 
     const std::unique_ptr<Camera>& GetCamera() const noexcept;
 
+    // 相机、视口、背景或者 Actor 改变后需要重新绘制
+    void MarkDirty() noexcept;
+
+    bool IsDirty() const noexcept;
+
+    void ClearDirty() noexcept;
+
 private:
     std::unique_ptr<Camera> m_camera {};
     std::vector<std::shared_ptr<Actor>> m_actors {};
     std::array<double, 4> m_viewport {0.1, 0.1, .8, .8}; // 起始位置和宽高
     std::array<float, 4> m_background {.1f, .2f, .3f, 1.f};
+    bool m_dirty {true};
 };
@@ -1,8 +1,10 @@
 #include "Viewer.h"
 #include "Device.h"
 #include "ImageData.h"
+#include "Profiler.hpp"
 #include "Utils.h"
 #include "Window.h"
+#include <algorithm>
 #include <fstream>
 #include <iostream>
 
@@ -102,13 +104,7 @@ Viewer::Viewer(const std::shared_ptr<Device>& device, const uint32_t numberOfFra
     vk::RenderPassCreateInfo renderPassCreateInfo(vk::RenderPassCreateFlags(), attachmentDescriptions, subpassDescription);
     renderPass = vk::raii::RenderPass(m_device->device, renderPassCreateInfo);
 
-    std::array descriptorPoolSizes {
-        vk::DescriptorPoolSize {vk::DescriptorType::eUniformBuffer, numberOfFrames}
-    };
-
-    descriptorPool = vk::raii::DescriptorPool(
-        m_device->device, vk::DescriptorPoolCreateInfo {vk::DescriptorPoolCreateFlagBits::eFreeDescriptorSet, numberOfFrames, descriptorPoolSizes}
-    );
+    descriptorAllocator = std::make_unique<DescriptorAllocator>(m_device, numberOfFrames);
 
     //--------------------------------------------------------------------------------------
     m_framebuffers.reserve(numberOfFrames);
@@ -148,7 +144,13 @@ Viewer::Viewer(const std::shared_ptr<Device>& device, const uint32_t numberOfFra
 
 std::vector<vk::ImageView> Viewer::GetImageViews()
 {
-    return {m_colorImageDatas[0].imageView, m_colorImageDatas[1].imageView, m_colorImageDatas[2].imageView};
+    std::vector<vk::ImageView> imageViews {};
+    imageViews.reserve(m_colorImageDatas.size());
+    for (const auto& colorImageData : m_colorImageDatas)
+    {
+        imageViews.emplace_back(colorImageData.imageView);
+    }
+    return imageViews;
 }
 
 Viewer::~Viewer()
@@ -166,6 +168,7 @@ void Viewer::ResizeFramebuffer(const vk::Extent2D& extent_)
     }
 
     currentFrameIndex = 0;
+    m_dirty           = true;
 
     extent = extent_;
     m_device->device.waitIdle();
@@ -217,10 +220,16 @@ void Viewer::ResizeFramebuffer(const vk::Extent2D& extent_)
 void Viewer::AddView(const std::shared_ptr<View>& view)
 {
     m_views.emplace_back(view);
+    m_dirty = true;
 }
 
 void Viewer::Record(const vk::raii::CommandBuffer& commandBuffer)
 {
+    PROFILE_FUNCTION();
+
+    // 调用者已经等待了 currentFrameIndex 对应的 fence
+    descriptorAllocator->BeginFrame(currentFrameIndex);
+
     std::array<vk::ClearValue, 2> clearValues;
     clearValues[0].color        = vk::ClearColorValue(0.1f, 0.2f, 0.3f, 1.f);
     clearValues[1].depthStencil = vk::ClearDepthStencilValue(1.f, 0);
@@ -242,12 +251,12 @@ void Viewer::Render()
 {
     static uint32_t count {0};
     count++;
-    std::cout << "Index: " << count << "\tFrame: " << currentFrameIndex << '\n';
 
     auto result = m_device->device.waitForFences(
         {m_drawFences[currentFrameIndex], m_blitFences[currentFrameIndex]}, VK_TRUE, std::numeric_limits<uint64_t>::max()
     );
     m_device->device.resetFences({m_drawFences[currentFrameIndex], m_blitFences[currentFrameIndex]});
+    descriptorAllocator->BeginFrame(currentFrameIndex);
 
     // 确保命令执行完之后再保存图片，每个 commandbuffer 对应的第一张图片都还没有绘制就保存，所以都是黑色，图片格式是 BGRA
     auto subResourceLayout = m_saveImageDatas[currentFrameIndex].image.getSubresourceLayout({vk::ImageAspectFlagBits::eColor, 0, 0});
@@ -359,33 +368,46 @@ void Viewer::SetInteractorStyle(const std::shared_ptr<InteractorStyle>& interact
 
 void Viewer::ProcessEvent(const Event& event)
 {
-    static int index = 0;
-    std::cout << "Viewer process event: " << index++ << std::endl;
+    m_eventQueue.Push(event);
+}
 
+bool Viewer::ProcessPendingEvents()
+{
     static float base {3.f};
-    switch (event.type)
+    for (const auto& event : m_eventQueue.Drain())
+    {
+        switch (event.type)
+        {
+            case EventType::MouseWheelBackward:
+            case EventType::MouseWheelForward:
+                base += EventType::MouseWheelBackward == event.type ? static_cast<float>(event.wheelDelta) : -static_cast<float>(event.wheelDelta);
+                for (const auto& view : m_views)
+                {
+                    auto&& camera = view->GetCamera();
+                    camera->SetEyePosition(glm::vec3 {0.f, 0.f, base});
+                    view->MarkDirty();
+                }
+                break;
+            case EventType::ResizeWindow:
+                m_dirty = true;
+                break;
+            default:
+                break;
+        }
+    }
+
+    if (!NeedRender() || GetTimeUntilNextFrame().count() > 0.0)
     {
-        case EventType::MouseWheelBackward:
-            base += 1.f;
-            for (const auto& view : m_views)
-            {
-                auto&& camera = view->GetCamera();
-                camera->SetEyePosition(glm::vec3 {0.f, 0.f, base});
-            }
-            break;
-        case EventType::MouseWheelForward:
-            base -= 1.f;
-            for (const auto& view : m_views)
-            {
-                auto&& camera = view->GetCamera();
-                camera->SetEyePosition(glm::vec3 {0.f, 0.f, base});
-            }
-            break;
-        default:
-            break;
+        return false;
+    }
+
+    m_lastRenderTime = std::chrono::steady_clock::now();
+    m_dirty          = false;
+    for (const auto& view : m_views)
+    {
+        view->ClearDirty();
     }
 
-    // XXX:
     if (m_presentWindow)
     {
         m_presentWindow->Render();
@@ -394,6 +416,29 @@ void Viewer::ProcessEvent(const Event& event)
     {
         Render();
     }
+
+    return true;
+}
+
+bool Viewer::NeedRender() const noexcept
+{
+    return m_dirty || std::any_of(m_views.cbegin(), m_views.cend(), [](const auto& view) { return view->IsDirty(); });
+}
+
+void Viewer::SetMaxFrameRate(double framesPerSecond)
+{
+    m_minFrameInterval = std::chrono::duration<double>(framesPerSecond > 0.0 ? 1.0 / framesPerSecond : 0.0);
+}
+
+std::chrono::duration<double> Viewer::GetTimeUntilNextFrame() const noexcept
+{
+    auto elapsed = std::chrono::steady_clock::now() - m_lastRenderTime;
+    return std::max(std::chrono::duration<double>(0.0), m_minFrameInterval - elapsed);
+}
+
+void Viewer::MarkDirty() noexcept
+{
+    m_dirty = true;
 }
 
 void Viewer::SetPresentWindow(Window* window)
@@ -1,9 +1,11 @@
 #pragma once
 
+#include "DescriptorAllocator.h"
 #include "Event.h"
 #include "ImageData.h"
 #include "InteractorStyle.h"
 #include "View.h"
+#include <chrono>
 #include <memory>
 #include <vector>
 #include <vulkan/vulkan.hpp>
@@ -34,8 +36,23 @@ public:
 
     void AddView(const std::shared_ptr<View>& view);
 
+    // 只把事件放入队列，不会立即绘制
     void ProcessEvent(const Event& event);
 
+    // 处理队列中合并后的事件，只有场景改变并且没有超过帧率上限时才绘制一帧，返回是否绘制
+    bool ProcessPendingEvents();
+
+    // 还有需要绘制的内容（事件或者被帧率上限推迟的帧）
+    bool NeedRender() const noexcept;
+
+    // 0 表示不限制帧率
+    void SetMaxFrameRate(double framesPerSecond);
+
+    // 距离帧率上限允许绘制下一帧还需要等待的时间
+    std::chrono::duration<double> GetTimeUntilNextFrame() const noexcept;
+
+    void MarkDirty() noexcept;
+
     void SetInteractorStyle(const std::shared_ptr<InteractorStyle>& interactorStyle);
 
     void SetPresentWindow(Window* window);
@@ -47,7 +64,7 @@ private:
     uint32_t numberOfFrames {0};
     uint32_t currentFrameIndex {0};
     vk::Extent2D extent {800, 600};
-    vk::raii::DescriptorPool descriptorPool {nullptr};
+    std::unique_ptr<DescriptorAllocator> descriptorAllocator {};
     vk::raii::RenderPass renderPass {nullptr};
 
     vk::Format m_colorFormat {vk::Format::eB8G8R8A8Unorm};
@@ -72,4 +89,9 @@ private:
     std::vector<std::shared_ptr<View>> m_views {};
 
     std::shared_ptr<InteractorStyle> m_interactorStyle {};
+
+    EventQueue m_eventQueue {};
+    bool m_dirty {true};
+    std::chrono::duration<double> m_minFrameInterval {0.0};
+    std::chrono::steady_clock::time_point m_lastRenderTime {};
 };
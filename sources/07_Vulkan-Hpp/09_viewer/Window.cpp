@@ -1,5 +1,6 @@
 #include "Window.h"
 #include "Device.h"
+#include "Profiler.hpp"
 #include "Utils.h"
 #include "Viewer.h"
 #include <GLFW/glfw3.h>
@@ -158,6 +159,18 @@ void WindowHelper::PollEvents() const noexcept
     glfwPollEvents();
 }
 
+void WindowHelper::WaitEvents(double timeout) const noexcept
+{
+    if (timeout <= 0.0)
+    {
+        glfwWaitEvents();
+    }
+    else
+    {
+        glfwWaitEventsTimeout(timeout);
+    }
+}
+
 void WindowHelper::WaitWindowNotMinimized()
 {
     int width {0}, height {0};
@@ -178,6 +191,7 @@ Window::Window(const std::shared_ptr<Device>& device, const std::string& name, c
     m_windowHelper = std::make_unique<WindowHelper>(name, extent);
     m_device       = device;
     m_windowHelper->InitSurface(m_device->GetInstance());
+    m_presenter = std::make_unique<SwapChainPresenter>(m_device, m_windowHelper.get());
     InitWindow();
 }
 
@@ -185,6 +199,14 @@ Window::Window(const std::string& name, const vk::Extent2D& extent)
 {
     m_windowHelper = std::make_unique<WindowHelper>(name, extent);
     m_device       = std::make_shared<Device>(m_windowHelper);
+    m_presenter    = std::make_unique<SwapChainPresenter>(m_device, m_windowHelper.get());
+    InitWindow();
+}
+
+Window::Window(const std::shared_ptr<Device>& device, const vk::Extent2D& extent, const VirtualSwapChainInfo& info)
+{
+    m_device    = device;
+    m_presenter = std::make_unique<VirtualPresenter>(m_device, extent, info);
     InitWindow();
 }
 
@@ -195,13 +217,22 @@ Window::~Window()
 
 void Window::Render()
 {
-    static int index = 0;
-    std::cout << "Window render: " << index++ << std::endl;
+    PROFILE_FUNCTION();
 
     auto waitResult = m_device->device.waitForFences({m_drawFences[m_currentFrameIndex]}, VK_TRUE, std::numeric_limits<uint64_t>::max());
-    auto [result, imageIndex] =
-        m_swapChainData.swapChain.acquireNextImage(std::numeric_limits<uint64_t>::max(), m_imageAcquiredSemaphores[m_currentFrameIndex]);
-    assert(imageIndex < m_swapChainData.images.size());
+    auto imageIndex = m_presenter->AcquireNextImage(m_imageAcquiredSemaphores[m_currentFrameIndex]);
+
+    // fence 已经触发，上一次使用这一帧时写入的时间戳一定可用
+    auto firstQuery = 2 * m_currentFrameIndex;
+    if (*m_timestampQueryPool && m_timestampWritten[m_currentFrameIndex])
+    {
+        auto [queryResult, timestamps] =
+            m_timestampQueryPool.getResults<uint64_t>(firstQuery, 2, 2 * sizeof(uint64_t), sizeof(uint64_t), vk::QueryResultFlagBits::e64);
+        if (vk::Result::eSuccess == queryResult)
+        {
+            m_gpuFrameTime = static_cast<double>((timestamps[1] - timestamps[0]) & m_timestampMask) * m_timestampPeriod * 1e-6;
+        }
+    }
 
     m_device->device.resetFences({m_drawFences[m_currentFrameIndex]});
 
@@ -211,11 +242,17 @@ void Window::Render()
     std::array<vk::ClearValue, 1> clearValues;
     clearValues[0].color = vk::ClearColorValue(0.1f, 0.2f, 0.3f, 1.f);
     vk::RenderPassBeginInfo renderPassBeginInfo(
-        *m_renderPass, m_framebuffers[m_currentFrameIndex], vk::Rect2D(vk::Offset2D(0, 0), m_swapChainData.swapchainExtent), clearValues
+        *m_renderPass, m_framebuffers[imageIndex], vk::Rect2D(vk::Offset2D(0, 0), m_presenter->GetExtent()), clearValues
     );
 
     cmd.begin({});
 
+    if (*m_timestampQueryPool)
+    {
+        cmd.resetQueryPool(m_timestampQueryPool, firstQuery, 2);
+        cmd.writeTimestamp(vk::PipelineStageFlagBits::eTopOfPipe, m_timestampQueryPool, firstQuery);
+    }
+
     m_viewer->Record(cmd);
 
     cmd.beginRenderPass(renderPassBeginInfo, vk::SubpassContents::eInline);
@@ -226,17 +263,24 @@ void Window::Render()
         vk::Viewport(
             0.0f,
             0.0f,
-            static_cast<float>(m_swapChainData.swapchainExtent.width),
-            static_cast<float>(m_swapChainData.swapchainExtent.height),
+            static_cast<float>(m_presenter->GetExtent().width),
+            static_cast<float>(m_presenter->GetExtent().height),
             0.0f,
             1.0f
         )
     );
-    cmd.setScissor(0, vk::Rect2D(vk::Offset2D(0, 0), m_swapChainData.swapchainExtent));
+    cmd.setScissor(0, vk::Rect2D(vk::Offset2D(0, 0), m_presenter->GetExtent()));
     cmd.bindDescriptorSets(vk::PipelineBindPoint::eGraphics, m_pipelineLayout, 0, {m_descriptorSets[m_currentFrameIndex]}, nullptr);
     cmd.draw(3, 1, 0, 0);
 
     cmd.endRenderPass();
+
+    if (*m_timestampQueryPool)
+    {
+        cmd.writeTimestamp(vk::PipelineStageFlagBits::eBottomOfPipe, m_timestampQueryPool, firstQuery + 1);
+        m_timestampWritten[m_currentFrameIndex] = true;
+    }
+
     cmd.end();
 
     //--------------------------------------------------------------------------------------
@@ -248,18 +292,7 @@ void Window::Render()
     m_device->graphicsQueue.submit(drawSubmitInfo, m_drawFences[m_currentFrameIndex]);
 
     //--------------------------------------------------------------------------------------
-    std::array<vk::Semaphore, 1> presentWait {m_renderFinishedSemaphores[m_currentFrameIndex]};
-    std::array<vk::SwapchainKHR, 1> swapchains {m_swapChainData.swapChain};
-    vk::PresentInfoKHR presentInfoKHR(presentWait, swapchains, imageIndex);
-
-    try
-    {
-        auto presentResult = m_device->presentQueue.presentKHR(presentInfoKHR);
-    }
-    catch (vk::SystemError& err)
-    {
-        std::cout << "vk::SystemError\n\twhat: " << err.what() << "\n\tcode: " << err.code() << '\n';
-    }
+    m_presenter->Present(imageIndex, m_renderFinishedSemaphores[m_currentFrameIndex]);
 
     m_currentFrameIndex = (m_currentFrameIndex + 1) % m_numberOfFrames;
 }
@@ -273,7 +306,10 @@ void Window::UpdateDescriptorSets()
 {
     auto viewer_imageViews = m_viewer->GetImageViews();
 
-    for (uint32_t i = 0; i < m_numberOfFrames; ++i)
+    // Viewer 和 Window 使用相同的帧数创建，每个描述符集对应 Viewer 的一张颜色图像
+    assert(viewer_imageViews.size() == m_descriptorSets.size());
+
+    for (size_t i = 0; i < viewer_imageViews.size(); ++i)
     {
         vk::DescriptorImageInfo descriptorImageInfo(m_sampler, viewer_imageViews[i], vk::ImageLayout::eShaderReadOnlyOptimal);
         std::array writeDescriptorSets {
@@ -283,55 +319,46 @@ void Window::UpdateDescriptorSets()
     }
 }
 
-void Window::RecreateSwapChain()
+void Window::RecreateSwapChain(const vk::Extent2D& extent)
 {
-    std::cout << "recreate swap chain: " << m_windowHelper->extent.width << ' ' << m_windowHelper->extent.height << '\n';
+    std::cout << "recreate swap chain: " << extent.width << ' ' << extent.height << '\n';
 
     m_currentFrameIndex = 0; // 保证下一帧的序号从 0 开始
 
-    m_swapChainData = SwapChainData(
-        m_device,
-        m_windowHelper->surfaceData.surface,
-        m_windowHelper->extent,
-        vk::ImageUsageFlagBits::eColorAttachment,
-        &m_swapChainData.swapChain,
-        m_device->graphicsQueueIndex,
-        m_device->presentQueueIndex
-    );
-
-    assert(m_numberOfFrames == m_swapChainData.numberOfImages);
+    // 交换链图像的个数可能改变，只有帧缓冲和交换链图像一一对应，按新的个数重新创建
+    // 命令缓冲、同步对象、描述符集和 Viewer 的颜色图像按 m_currentFrameIndex 使用，个数仍然是 m_numberOfFrames
+    m_presenter->Recreate(extent);
 
-    auto w = m_swapChainData.swapchainExtent.width;
-    auto h = m_swapChainData.swapchainExtent.height;
-
-    for (uint32_t i = 0; i < m_numberOfFrames; ++i)
-    {
-        std::array<vk::ImageView, 1> imageViews {m_swapChainData.imageViews[i]};
-        m_framebuffers[i] = vk::raii::Framebuffer(m_device->device, vk::FramebufferCreateInfo({}, m_renderPass, imageViews, w, h, 1));
-    }
+    CreateFramebuffers();
 }
 
 void Window::ResizeWindow(const vk::Extent2D& extent)
 {
-    RecreateSwapChain();
+    RecreateSwapChain(m_windowHelper ? m_windowHelper->extent : extent);
     UpdateDescriptorSets();
 }
 
-void Window::InitWindow()
+void Window::CreateFramebuffers()
 {
-    m_swapChainData = SwapChainData(
-        m_device,
-        m_windowHelper->surfaceData.surface,
-        m_windowHelper->surfaceData.extent,
-        vk::ImageUsageFlagBits::eColorAttachment,
-        nullptr,
-        m_device->graphicsQueueIndex,
-        m_device->presentQueueIndex
-    );
+    auto w = m_presenter->GetExtent().width;
+    auto h = m_presenter->GetExtent().height;
+
+    auto imageCount = m_presenter->GetImageCount();
 
-    m_numberOfFrames = m_swapChainData.numberOfImages;
+    m_framebuffers.clear();
+    m_framebuffers.reserve(imageCount);
+    for (uint32_t i = 0; i < imageCount; ++i)
+    {
+        std::array<vk::ImageView, 1> imageViews {m_presenter->GetImageView(i)};
+        m_framebuffers.emplace_back(vk::raii::Framebuffer(m_device->device, vk::FramebufferCreateInfo({}, m_renderPass, imageViews, w, h, 1)));
+    }
+}
 
-    m_viewer = std::make_unique<Viewer>(m_device, m_numberOfFrames, true, m_windowHelper->surfaceData.extent);
+void Window::InitWindow()
+{
+    m_numberOfFrames = m_presenter->GetImageCount();
+
+    m_viewer = std::make_unique<Viewer>(m_device, m_numberOfFrames, true, m_presenter->GetExtent());
     m_viewer->SetPresentWindow(this);
 
     m_commandBuffers = vk::raii::CommandBuffers(
@@ -344,14 +371,14 @@ void Window::InitWindow()
     std::array attachmentDescriptions {
         vk::AttachmentDescription {
                                    {},
-                                   m_swapChainData.colorFormat,
+                                   m_presenter->GetFormat(),
                                    vk::SampleCountFlagBits::e1,
                                    vk::AttachmentLoadOp::eClear,
                                    vk::AttachmentStoreOp::eStore,
                                    vk::AttachmentLoadOp::eDontCare,
                                    vk::AttachmentStoreOp::eDontCare,
                                    vk::ImageLayout::eUndefined,
-                                   vk::ImageLayout::ePresentSrcKHR
+                                   m_presenter->GetPresentLayout()
         }
     };
 
@@ -426,14 +453,7 @@ void Window::InitWindow()
 
     UpdateDescriptorSets();
 
-    auto w = m_swapChainData.swapchainExtent.width;
-    auto h = m_swapChainData.swapchainExtent.height;
-    m_framebuffers.reserve(m_numberOfFrames);
-    for (uint32_t i = 0; i < m_numberOfFrames; ++i)
-    {
-        std::array<vk::ImageView, 1> imageViews {m_swapChainData.imageViews[i]};
-        m_framebuffers.emplace_back(vk::raii::Framebuffer(m_device->device, vk::FramebufferCreateInfo({}, m_renderPass, imageViews, w, h, 1)));
-    }
+    CreateFramebuffers();
 
     //--------------------------------------------------------------------------------------
     m_drawFences.reserve(m_numberOfFrames);
@@ -445,6 +465,17 @@ void Window::InitWindow()
         m_renderFinishedSemaphores.emplace_back(vk::raii::Semaphore(m_device->device, vk::SemaphoreCreateInfo()));
         m_imageAcquiredSemaphores.emplace_back(vk::raii::Semaphore(m_device->device, vk::SemaphoreCreateInfo()));
     }
+
+    //--------------------------------------------------------------------------------------
+    auto limits             = m_device->physicalDevice.getProperties().limits;
+    auto timestampValidBits = m_device->physicalDevice.getQueueFamilyProperties()[m_device->graphicsQueueIndex].timestampValidBits;
+    if (limits.timestampComputeAndGraphics && timestampValidBits > 0)
+    {
+        m_timestampPeriod    = static_cast<double>(limits.timestampPeriod);
+        m_timestampMask      = timestampValidBits >= 64 ? ~0ull : (1ull << timestampValidBits) - 1;
+        m_timestampQueryPool = vk::raii::QueryPool(m_device->device, vk::QueryPoolCreateInfo({}, vk::QueryType::eTimestamp, 2 * m_numberOfFrames));
+        m_timestampWritten.assign(m_numberOfFrames, false);
+    }
 }
 
 void Window::WaitIdle() const noexcept
@@ -467,6 +498,16 @@ const std::unique_ptr<Viewer>& Window::GetViewer() const noexcept
     return m_viewer;
 }
 
+const std::unique_ptr<Presenter>& Window::GetPresenter() const noexcept
+{
+    return m_presenter;
+}
+
+double Window::GetGpuFrameTime() const noexcept
+{
+    return m_gpuFrameTime;
+}
+
 void Window::SetInteractorStyle(const std::shared_ptr<InteractorStyle>& interactorStyle)
 {
     m_viewer->SetInteractorStyle(interactorStyle);
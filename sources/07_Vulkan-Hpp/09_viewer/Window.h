@@ -1,7 +1,7 @@
 #pragma once
 
+#include "Presenter.h"
 #include "SurfaceData.h"
-#include "SwapChainData.h"
 #include <atomic>
 #include <functional>
 #include <memory>
@@ -33,6 +33,9 @@ struct WindowHelper
 
     void PollEvents() const noexcept;
 
+    // 阻塞直到有新的事件，timeout 小于等于 0 时一直等待
+    void WaitEvents(double timeout = 0.0) const noexcept;
+
     void WaitWindowNotMinimized();
 
     inline static std::mutex mutex {};
@@ -47,6 +50,9 @@ struct Window
 {
     Window(const std::string& name, const vk::Extent2D& extent);
     Window(const std::shared_ptr<Device>& device, const std::string& name, const vk::Extent2D& extent);
+
+    // 无窗口，使用离屏图像模拟的交换链，可以在没有显示器的机器上运行
+    Window(const std::shared_ptr<Device>& device, const vk::Extent2D& extent, const VirtualSwapChainInfo& info);
     ~Window();
 
     void Render();
@@ -62,16 +68,21 @@ struct Window
     std::shared_ptr<Device> GetDevice() const noexcept;
     const std::unique_ptr<WindowHelper>& GetWindowHelper() const noexcept;
     const std::unique_ptr<Viewer>& GetViewer() const noexcept;
+    const std::unique_ptr<Presenter>& GetPresenter() const noexcept;
+
+    // 最近一个已经完成的帧在 GPU 上的耗时（毫秒），设备不支持时间戳或者还没有帧完成时返回负数
+    double GetGpuFrameTime() const noexcept;
 
 private:
     void UpdateDescriptorSets();
-    void RecreateSwapChain();
+    void RecreateSwapChain(const vk::Extent2D& extent);
+    void CreateFramebuffers();
     void InitWindow();
 
 private:
     std::shared_ptr<Device> m_device {};
     std::unique_ptr<WindowHelper> m_windowHelper {};
-    SwapChainData m_swapChainData {nullptr};
+    std::unique_ptr<Presenter> m_presenter {};
 
     vk::raii::CommandBuffers m_commandBuffers {nullptr};
 
@@ -94,4 +105,11 @@ private:
     std::vector<vk::raii::Fence> m_drawFences {};
     std::vector<vk::raii::Semaphore> m_renderFinishedSemaphores {};
     std::vector<vk::raii::Semaphore> m_imageAcquiredSemaphores {};
+
+    // 每一帧在命令缓冲的开始和结束各写入一个时间戳，等待该帧的 fence 之后读取，不会阻塞
+    vk::raii::QueryPool m_timestampQueryPool {nullptr};
+    std::vector<bool> m_timestampWritten {};
+    double m_timestampPeriod {0.0};
+    uint64_t m_timestampMask {~0ull}; // 只有低 timestampValidBits 位有效，计数器回绕时差值也要取这些位
+    double m_gpuFrameTime {-1.0};
 };
@@ -0,0 +1,64 @@
+#include "Actor.h"
+#include "Benchmark.h"
+#include "Device.h"
+#include "Presenter.h"
+#include "View.h"
+#include "Viewer.h"
+#include "Window.h"
+#include <memory>
+
+// 使用虚拟交换链，不需要窗口，不限制帧率
+template <uint32_t NumberOfViews, uint32_t ActorsPerView>
+class ViewerScene : public BenchmarkScene
+{
+public:
+    void Setup() override
+    {
+        m_device = std::make_shared<Device>();
+        m_window = std::make_unique<Window>(m_device, vk::Extent2D {1280, 720}, VirtualSwapChainInfo {.imageCount = 3, .refreshRate = 0.0});
+
+        auto size = 1.0 / NumberOfViews;
+        for (uint32_t i = 0; i < NumberOfViews; ++i)
+        {
+            auto view = std::make_shared<View>();
+            view->SetViewport({size * i, 0.0, size, 1.0});
+            view->SetBackground({.3f, .2f, .1f, 1.f});
+            for (uint32_t j = 0; j < ActorsPerView; ++j)
+            {
+                view->AddActor(std::make_shared<Actor>());
+            }
+            m_window->AddView(view);
+        }
+    }
+
+    void RenderFrame() override
+    {
+        m_window->Render();
+    }
+
+    void Finish() override
+    {
+        m_window->WaitIdle();
+    }
+
+    double GetGpuFrameTime() const override
+    {
+        return m_window->GetGpuFrameTime();
+    }
+
+    void Teardown() override
+    {
+        m_window.reset();
+        m_device.reset();
+    }
+
+private:
+    std::shared_ptr<Device> m_device {};
+    std::unique_ptr<Window> m_window {};
+};
+
+using SingleView = ViewerScene<1, 1>;
+using MultiView  = ViewerScene<4, 16>;
+
+BENCHMARK_SCENE(SingleView, "viewer_single_view");
+BENCHMARK_SCENE(MultiView, "viewer_4_views_64_actors");
@@ -1,7 +1,7 @@
 /**
  * 1. 单独一个窗口
  * 2. 多个窗口一个线程
- * 3.
+ * 3. 无窗口，虚拟交换链
  * 4. 多个窗口多个线程
  *
  *
@@ -27,11 +27,13 @@ int main()
 {
     auto window = std::make_shared<Window>("test", vk::Extent2D {800, 600});
     auto actor  = std::make_shared<Actor>();
+    auto sphere = std::make_shared<Actor>(Actor::Shape::Sphere, glm::vec3 {1.f, 0.f, 0.f}); // 多级 LOD，缩放时切换
     auto view   = std::make_shared<View>();
 
     view->SetViewport({.05, .05, .9, .9});
     view->SetBackground({.3f, .2f, .1f, 1.f});
     view->AddActor(actor);
+    view->AddActor(sphere);
 
     window->AddView(view);
     window->SetInteractorStyle(std::make_unique<InteractorStyle>());
@@ -39,7 +41,6 @@ int main()
     auto interactor = std::make_unique<Interactor>();
     interactor->SetWindow(window);
 
-    window->Render();
     interactor->Start();
 
     std::cout << "Success\n";
@@ -81,6 +82,56 @@ int main()
 
 #endif // TEST2
 
+#ifdef TEST3
+
+#include "Actor.h"
+#include "Device.h"
+#include "Presenter.h"
+#include "View.h"
+#include "Viewer.h"
+#include "Window.h"
+#include <iostream>
+#include <memory>
+
+int main()
+{
+    // 不需要显示器，可以在 CI 或软件光栅化（lavapipe / SwiftShader）上运行完整的 Window 绘制流程
+    auto device = std::make_shared<Device>();
+    auto window = std::make_shared<Window>(device, vk::Extent2D {800, 600}, VirtualSwapChainInfo {.imageCount = 3, .refreshRate = 0.0});
+    auto actor  = std::make_shared<Actor>();
+    auto view   = std::make_shared<View>();
+
+    view->SetViewport({.05, .05, .9, .9});
+    view->SetBackground({.3f, .2f, .1f, 1.f});
+    view->AddActor(actor);
+
+    window->AddView(view);
+
+    for (auto i = 0u; i < 100; ++i)
+    {
+        window->Render();
+    }
+
+    // 模拟窗口大小改变
+    window->WaitIdle();
+    window->GetViewer()->ResizeFramebuffer({399, 431});
+    window->ResizeWindow({399, 431});
+
+    for (auto i = 0u; i < 100; ++i)
+    {
+        window->Render();
+    }
+
+    window->WaitIdle();
+    auto presenter = dynamic_cast<VirtualPresenter*>(window->GetPresenter().get());
+    std::cout << "present count: " << presenter->GetPresentCount() << '\n';
+
+    std::cout << "Success\n";
+    return 0;
+}
+
+#endif // TEST3
+
 #ifdef TEST4
 
 #include "Actor.h"
@@ -159,12 +210,14 @@ int main()
         Event event {.type = EventType::MouseWheelBackward};
         viewer->ProcessEvent(event);
     }
+    viewer->ProcessPendingEvents(); // 10 次滚轮事件合并为一次绘制
     viewer->ResizeFramebuffer({399, 431});
     for (auto i = 0u; i < 10; ++i)
     {
         Event event {.type = EventType::MouseWheelForward};
         viewer->ProcessEvent(event);
     }
+    viewer->ProcessPendingEvents();
 
     std::cout << "Success\n";
     return 0;
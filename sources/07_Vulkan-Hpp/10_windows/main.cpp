@@ -3,12 +3,15 @@
 
 #include <GLFW/glfw3.h>
 
+#include "Profiler.hpp"
+
 #include <algorithm>
 #include <fstream>
 #include <iostream>
 #include <mutex>
 #include <optional>
 #include <thread>
+#include <tuple>
 
 static std::mutex mutex {};
 
@@ -25,6 +28,8 @@ static uint32_t CurrentFrameIndex {0};
 
 void Submit(const vk::raii::Queue& queue, const vk::SubmitInfo& info, const vk::raii::Fence& fence)
 {
+    PROFILE_FUNCTION();
+
     // 不能在多个线程同时调用 submit
     std::lock_guard lk(mutex);
     queue.submit(info, fence);
@@ -436,6 +441,9 @@ void RecreateSwapChain(
 
 int main()
 {
+    Profiler::SetEnabled(true);
+    PROFILE_THREAD("main");
+
     try
     {
         Window window1 {"Test1", extent};
@@ -650,17 +658,27 @@ int main()
 
         while (!(window1.ShouldExit() || window2.ShouldExit()))
         {
+            PROFILE_FRAME("frame");
+
             window1.PollEvents();
             window2.PollEvents();
 
-            [[maybe_unused]] auto waitResult1 = device.waitForFences({drawFences1[CurrentFrameIndex]}, VK_TRUE, TimeOut);
-            [[maybe_unused]] auto waitResult2 = device.waitForFences({drawFences2[CurrentFrameIndex]}, VK_TRUE, TimeOut);
+            {
+                PROFILE_SCOPE("wait for fences");
+                [[maybe_unused]] auto waitResult1 = device.waitForFences({drawFences1[CurrentFrameIndex]}, VK_TRUE, TimeOut);
+                [[maybe_unused]] auto waitResult2 = device.waitForFences({drawFences2[CurrentFrameIndex]}, VK_TRUE, TimeOut);
+            }
 
-            auto [result1, imageIndex1] = swapChainData1.swapChain.acquireNextImage(TimeOut, imageAcquiredSemaphores1[CurrentFrameIndex]);
-            assert(imageIndex1 < swapChainData1.images.size());
+            vk::Result result1 {}, result2 {};
+            uint32_t imageIndex1 {0}, imageIndex2 {0};
+            {
+                PROFILE_SCOPE("acquire");
+                std::tie(result1, imageIndex1) = swapChainData1.swapChain.acquireNextImage(TimeOut, imageAcquiredSemaphores1[CurrentFrameIndex]);
+                assert(imageIndex1 < swapChainData1.images.size());
 
-            auto [result2, imageIndex2] = swapChainData2.swapChain.acquireNextImage(TimeOut, imageAcquiredSemaphores2[CurrentFrameIndex]);
-            assert(imageIndex2 < swapChainData2.images.size());
+                std::tie(result2, imageIndex2) = swapChainData2.swapChain.acquireNextImage(TimeOut, imageAcquiredSemaphores2[CurrentFrameIndex]);
+                assert(imageIndex2 < swapChainData2.images.size());
+            }
 
             if (vk::Result::eErrorOutOfDateKHR == result1)
             {
@@ -703,6 +721,9 @@ int main()
 
             auto&& cmd1 = commandBuffers1[CurrentFrameIndex];
             std::thread recordThread1([&]() {
+                PROFILE_THREAD("record 1");
+                PROFILE_SCOPE("record");
+
                 cmd1.reset();
 
                 std::array<vk::ClearValue, 1> clearValues;
@@ -735,6 +756,9 @@ int main()
 
             auto&& cmd2 = commandBuffers2[CurrentFrameIndex];
             std::thread recordThread2([&]() {
+                PROFILE_THREAD("record 2");
+                PROFILE_SCOPE("record");
+
                 cmd2.reset();
 
                 std::array<vk::ClearValue, 1> clearValues;
@@ -766,8 +790,11 @@ int main()
             });
 
             // 多个线程同时记录 commandBuffer 时，commandBuffer 必须由不同的 commandPool 分配
-            recordThread1.join();
-            recordThread2.join();
+            {
+                PROFILE_SCOPE("wait for record");
+                recordThread1.join();
+                recordThread2.join();
+            }
 
             //--------------------------------------------------------------------------------------
             std::array<vk::CommandBuffer, 1> drawCommandBuffers1 {cmd1};
@@ -784,8 +811,14 @@ int main()
             vk::SubmitInfo drawSubmitInfo2(waitSemaphores2, waitStages2, drawCommandBuffers2, signalSemaphores2);
 
             // 多个线程提交 command
-            std::thread t1([&]() { Submit(graphicsTransferPresentQueue, drawSubmitInfo1, drawFences1[CurrentFrameIndex]); });
-            std::thread t2([&]() { Submit(graphicsTransferPresentQueue, drawSubmitInfo2, drawFences2[CurrentFrameIndex]); });
+            std::thread t1([&]() {
+                PROFILE_THREAD("submit 1");
+                Submit(graphicsTransferPresentQueue, drawSubmitInfo1, drawFences1[CurrentFrameIndex]);
+            });
+            std::thread t2([&]() {
+                PROFILE_THREAD("submit 2");
+                Submit(graphicsTransferPresentQueue, drawSubmitInfo2, drawFences2[CurrentFrameIndex]);
+            });
 
             t1.join();
             t2.join();
@@ -798,6 +831,7 @@ int main()
 
             try
             {
+                PROFILE_SCOPE("present");
                 vk::PresentInfoKHR presentInfoKHR(presentWaits, swapchains, imageIndices, results);
                 [[maybe_unused]] auto presentResult = graphicsTransferPresentQueue.presentKHR(presentInfoKHR);
 
@@ -846,6 +880,10 @@ int main()
         }
 
         device.waitIdle();
+
+        // 录制和提交线程每帧都会重新创建，新线程复用已经退出的线程的缓冲
+        Profiler::PrintFrameReports(std::cout, 3);
+        Profiler::SaveTrace("windows_trace.json");
     }
 
     catch (vk::SystemError& err)
@@ -20,7 +20,7 @@
 #include <thread>
 #include <list>
 
-#include "../09_viewer/Timer.hpp"
+#include "Profiler.hpp"
 
 struct RenderTarget
 {
@@ -845,10 +845,13 @@ public:
 
     void Product()
     {
+        PROFILE_THREAD("producer");
+
         while (!(m_exit && m_numberOfTasks == 0))
         {
             static uint32_t index {0};
             {
+                PROFILE_SCOPE("wait for task");
                 std::unique_lock lk(m_mutex);
                 if (!m_productCV.wait_for(lk, std::chrono::seconds(9), [this]() {
                         return !(this->m_numberOfTasks == 0 || this->m_submitIndices.size() == MaxFramesInFlight);
@@ -858,6 +861,9 @@ public:
                 }
             }
 
+            PROFILE_FRAME("frame");
+            PROFILE_SCOPE("product");
+
             UniformBufferObject defaultUBO {};
             defaultUBO.model = glm::rotate(glm::mat4(1.f), glm::radians(30.f * index), glm::vec3(0.f, 0.f, 1.f));
             copyToDevice(m_uniformBufferObjects[m_currentFrameIndex].deviceMemory, defaultUBO);
@@ -957,10 +963,13 @@ public:
 
     void Consume()
     {
+        PROFILE_THREAD("consumer");
+
         while (!(m_consumeExit && m_submitIndices.empty()))
         {
             uint32_t frameIndex {0};
             {
+                PROFILE_SCOPE("wait for frame");
                 std::unique_lock lk(m_mutex);
                 if (!m_consumeCV.wait_for(lk, std::chrono::seconds(9), [this]() { return !this->m_submitIndices.empty(); }))
                 {
@@ -969,7 +978,13 @@ public:
                 frameIndex = m_submitIndices.front();
             }
 
-            auto result = m_device.waitForFences({m_drawFences[frameIndex], m_blitFences[frameIndex]}, VK_TRUE, std::numeric_limits<uint64_t>::max());
+            PROFILE_SCOPE("consume");
+
+            {
+                PROFILE_SCOPE("wait for fences");
+                auto result =
+                    m_device.waitForFences({m_drawFences[frameIndex], m_blitFences[frameIndex]}, VK_TRUE, std::numeric_limits<uint64_t>::max());
+            }
 
             m_device.resetFences({m_drawFences[frameIndex], m_blitFences[frameIndex]});
 
@@ -998,22 +1013,31 @@ int main()
     {
         std::cout << "Main thread id: " << std::this_thread::get_id() << '\n';
 
-        Timer time("run");
+        Profiler::SetEnabled(true);
+        PROFILE_THREAD("main");
 
-        Test test {};
-        test.SetRTCallback([](const RenderTarget& rt) {
-            static int count {0};
-            Timer time2("save");
-            std::cout << "save: " << count << std::endl;
-            stbi_write_jpg(("raii_" + std::to_string(count++) + ".jpg").c_str(), rt.width, rt.height, 4, rt.pixels, 100);
-        });
-
-        for (auto i = 0u; i < 10u; ++i)
         {
-            test.AddTask();
+            PROFILE_SCOPE("run");
+
+            Test test {};
+            test.SetRTCallback([](const RenderTarget& rt) {
+                static int count {0};
+                PROFILE_SCOPE("save");
+                std::cout << "save: " << count << std::endl;
+                stbi_write_jpg(("raii_" + std::to_string(count++) + ".jpg").c_str(), rt.width, rt.height, 4, rt.pixels, 100);
+            });
+
+            for (auto i = 0u; i < 10u; ++i)
+            {
+                test.AddTask();
+            }
+
+            test.Exit();
         }
 
-        test.Exit();
+        // 生产者、消费者线程已经结束，可以在 chrome://tracing 或 https://ui.perfetto.dev 中打开
+        Profiler::PrintFrameReports(std::cout, 3);
+        Profiler::SaveTrace("productConsume_trace.json");
     }
     catch (vk::SystemError& err)
     {
@@ -0,0 +1,350 @@
+#include "GpuProfiler.h"
+#include "Context.h"
+
+#include <imgui.h>
+
+#include <cassert>
+#include <chrono>
+#include <format>
+#include <fstream>
+#include <limits>
+#include <stdexcept>
+
+namespace {
+std::string EscapeJson(const std::string& str)
+{
+    std::string result {};
+    result.reserve(str.size());
+    for (auto c : str)
+    {
+        if ('"' == c || '\\' == c)
+        {
+            result.push_back('\\');
+        }
+        result.push_back(c);
+    }
+    return result;
+}
+
+int64_t SteadyClockNanoseconds() noexcept
+{
+    return std::chrono::duration_cast<std::chrono::nanoseconds>(std::chrono::steady_clock::now().time_since_epoch()).count();
+}
+} // namespace
+
+GpuProfiler* GpuProfiler::GetProfiler()
+{
+    static GpuProfiler profiler {};
+    return &profiler;
+}
+
+void GpuProfiler::Init(const VkCommandPool commandPool)
+{
+    auto physicalDevice = Context::GetContext()->GetPhysicalDevice();
+
+    VkPhysicalDeviceProperties properties {};
+    vkGetPhysicalDeviceProperties(physicalDevice, &properties);
+
+    uint32_t queueFamilyCount {0};
+    vkGetPhysicalDeviceQueueFamilyProperties(physicalDevice, &queueFamilyCount, nullptr);
+    std::vector<VkQueueFamilyProperties> queueFamilies(queueFamilyCount);
+    vkGetPhysicalDeviceQueueFamilyProperties(physicalDevice, &queueFamilyCount, queueFamilies.data());
+
+    auto timestampValidBits = queueFamilies.at(Context::GetContext()->GetQueueFamilyIndices().graphicsFamily.value()).timestampValidBits;
+
+    // 图形队列不支持时间戳时所有的 scope 都不写入任何命令
+    if (0 == timestampValidBits)
+    {
+        return;
+    }
+
+    m_supported       = true;
+    m_timestampPeriod = static_cast<double>(properties.limits.timestampPeriod);
+    m_timestampMask   = timestampValidBits >= 64 ? ~0ull : (1ull << timestampValidBits) - 1;
+
+    VkQueryPoolCreateInfo createInfo {};
+    createInfo.sType      = VK_STRUCTURE_TYPE_QUERY_POOL_CREATE_INFO;
+    createInfo.queryType  = VK_QUERY_TYPE_TIMESTAMP;
+    createInfo.queryCount = 2 * MaxScopesPerFrame;
+
+    for (auto& frame : m_frames)
+    {
+        if (VK_SUCCESS != vkCreateQueryPool(Context::GetContext()->GetDevice(), &createInfo, nullptr, &frame.queryPool))
+        {
+            throw std::runtime_error("failed to create timestamp query pool");
+        }
+    }
+
+    m_queryResults.resize(4 * MaxScopesPerFrame);
+
+    Calibrate(commandPool);
+}
+
+void GpuProfiler::Destroy() noexcept
+{
+    for (auto& frame : m_frames)
+    {
+        vkDestroyQueryPool(Context::GetContext()->GetDevice(), frame.queryPool, nullptr);
+        frame = {};
+    }
+
+    m_supported    = false;
+    m_currentFrame = nullptr;
+}
+
+void GpuProfiler::BeginFrame(const VkCommandBuffer commandBuffer, const size_t frameIndex)
+{
+    if (!m_supported)
+    {
+        return;
+    }
+
+    ResolveFrame(frameIndex);
+
+    auto& frame = m_frames.at(frameIndex);
+    vkCmdResetQueryPool(commandBuffer, frame.queryPool, 0, 2 * MaxScopesPerFrame);
+
+    frame.scopes.clear();
+    frame.frameNumber = m_frameNumber++;
+    frame.written     = true;
+
+    m_currentFrame = &frame;
+    m_scopeStack.clear();
+}
+
+uint32_t GpuProfiler::BeginScope(const VkCommandBuffer commandBuffer, const std::string& name)
+{
+    if (!m_supported || !m_currentFrame || m_currentFrame->scopes.size() >= MaxScopesPerFrame)
+    {
+        return InvalidScope;
+    }
+
+    auto scope = static_cast<uint32_t>(m_currentFrame->scopes.size());
+    m_currentFrame->scopes.emplace_back(name, static_cast<uint32_t>(m_scopeStack.size()));
+    m_scopeStack.emplace_back(scope);
+
+    vkCmdWriteTimestamp(commandBuffer, VK_PIPELINE_STAGE_TOP_OF_PIPE_BIT, m_currentFrame->queryPool, 2 * scope);
+
+    return scope;
+}
+
+void GpuProfiler::EndScope(const VkCommandBuffer commandBuffer, const uint32_t scope)
+{
+    if (InvalidScope == scope)
+    {
+        return;
+    }
+
+    assert(!m_scopeStack.empty() && m_scopeStack.back() == scope);
+    m_scopeStack.pop_back();
+
+    vkCmdWriteTimestamp(commandBuffer, VK_PIPELINE_STAGE_BOTTOM_OF_PIPE_BIT, m_currentFrame->queryPool, 2 * scope + 1);
+}
+
+const std::vector<GpuScopeResult>& GpuProfiler::GetResults() const noexcept
+{
+    return m_results;
+}
+
+bool GpuProfiler::IsSupported() const noexcept
+{
+    return m_supported;
+}
+
+void GpuProfiler::DrawImGui() const
+{
+    ImGui::Begin("GPU Profiler");
+
+    if (!m_supported)
+    {
+        ImGui::TextUnformatted("timestamp queries are not supported");
+        ImGui::End();
+        return;
+    }
+
+    if (ImGui::BeginTable("passes", 3, ImGuiTableFlags_Borders | ImGuiTableFlags_RowBg))
+    {
+        ImGui::TableSetupColumn("Pass");
+        ImGui::TableSetupColumn("Start (ms)");
+        ImGui::TableSetupColumn("Time (ms)");
+        ImGui::TableHeadersRow();
+
+        for (const auto& result : m_results)
+        {
+            ImGui::TableNextRow();
+            ImGui::TableNextColumn();
+            ImGui::Text("%*s%s", static_cast<int>(result.depth * 2), "", result.name.c_str());
+            ImGui::TableNextColumn();
+            ImGui::Text("%.3f", result.begin);
+            ImGui::TableNextColumn();
+            ImGui::Text("%.3f", result.duration);
+        }
+
+        ImGui::EndTable();
+    }
+
+    ImGui::End();
+}
+
+void GpuProfiler::SaveTrace(const std::string& fileName) const
+{
+    std::ofstream file(fileName);
+    if (!file.is_open())
+    {
+        throw std::runtime_error("failed to open file: " + fileName);
+    }
+
+    // ts 和 dur 的单位是微秒
+    file << "{\"displayTimeUnit\":\"ms\",\"traceEvents\":[\n";
+    file << R"({"name":"process_name","ph":"M","pid":0,"args":{"name":"Vulkan"}})";
+    WriteTraceEvents(file);
+    file << "\n]}\n";
+}
+
+void GpuProfiler::WriteTraceEvents(std::ostream& os) const
+{
+    os << std::format(",\n" R"({{"name":"thread_name","ph":"M","pid":0,"tid":{},"args":{{"name":"GPU"}}}})", TraceThreadId);
+
+    for (const auto& events : m_traceFrames)
+    {
+        for (const auto& event : events)
+        {
+            os << std::format(
+                ",\n"
+                R"({{"name":"{}","cat":"gpu","ph":"X","pid":0,"tid":{},"ts":{:.3f},"dur":{:.3f},"args":{{"frame":{}}}}})",
+                EscapeJson(event.name),
+                TraceThreadId,
+                static_cast<double>(event.begin) / 1000.0,
+                static_cast<double>(event.duration) / 1000.0,
+                event.frameNumber
+            );
+        }
+    }
+}
+
+void GpuProfiler::Calibrate(const VkCommandPool commandPool)
+{
+    auto device = Context::GetContext()->GetDevice();
+
+    VkCommandBufferAllocateInfo allocInfo = {};
+    allocInfo.sType                       = VK_STRUCTURE_TYPE_COMMAND_BUFFER_ALLOCATE_INFO;
+    allocInfo.commandPool                 = commandPool;
+    allocInfo.level                       = VK_COMMAND_BUFFER_LEVEL_PRIMARY;
+    allocInfo.commandBufferCount          = 1;
+
+    VkCommandBuffer commandBuffer {nullptr};
+    vkAllocateCommandBuffers(device, &allocInfo, &commandBuffer);
+
+    VkCommandBufferBeginInfo beginInfo = {};
+    beginInfo.sType                    = VK_STRUCTURE_TYPE_COMMAND_BUFFER_BEGIN_INFO;
+    beginInfo.flags                    = VK_COMMAND_BUFFER_USAGE_ONE_TIME_SUBMIT_BIT;
+
+    auto queryPool = m_frames.front().queryPool;
+    vkBeginCommandBuffer(commandBuffer, &beginInfo);
+    vkCmdResetQueryPool(commandBuffer, queryPool, 0, 1);
+    vkCmdWriteTimestamp(commandBuffer, VK_PIPELINE_STAGE_TOP_OF_PIPE_BIT, queryPool, 0);
+    vkEndCommandBuffer(commandBuffer);
+
+    VkFenceCreateInfo fenceInfo = {};
+    fenceInfo.sType             = VK_STRUCTURE_TYPE_FENCE_CREATE_INFO;
+
+    VkFence fence {nullptr};
+    vkCreateFence(device, &fenceInfo, nullptr, &fence);
+
+    VkSubmitInfo submitInfo       = {};
+    submitInfo.sType              = VK_STRUCTURE_TYPE_SUBMIT_INFO;
+    submitInfo.commandBufferCount = 1;
+    submitInfo.pCommandBuffers    = &commandBuffer;
+
+    // 没有 VK_EXT_calibrated_timestamps 时的近似：时间戳写入的时刻在提交和 fence 触发之间，取两者的中点
+    auto before = SteadyClockNanoseconds();
+    vkQueueSubmit(Context::GetContext()->GetGraphicsQueue(), 1, &submitInfo, fence);
+    vkWaitForFences(device, 1, &fence, VK_TRUE, std::numeric_limits<uint64_t>::max());
+    auto after = SteadyClockNanoseconds();
+
+    vkGetQueryPoolResults(
+        device, queryPool, 0, 1, sizeof(uint64_t), &m_calibrationTimestamp, sizeof(uint64_t), VK_QUERY_RESULT_64_BIT | VK_QUERY_RESULT_WAIT_BIT
+    );
+    m_calibrationNanoseconds = before + (after - before) / 2;
+
+    vkDestroyFence(device, fence, nullptr);
+    vkFreeCommandBuffers(device, commandPool, 1, &commandBuffer);
+}
+
+void GpuProfiler::ResolveFrame(const size_t frameIndex)
+{
+    auto& frame = m_frames.at(frameIndex);
+    if (!frame.written || frame.scopes.empty())
+    {
+        return;
+    }
+
+    // 每个查询两个 uint64_t：时间戳和可用性，不带 WAIT_BIT，结果没有准备好时直接跳过这一帧
+    auto queryCount = static_cast<uint32_t>(2 * frame.scopes.size());
+    auto result     = vkGetQueryPoolResults(
+        Context::GetContext()->GetDevice(),
+        frame.queryPool,
+        0,
+        queryCount,
+        2 * queryCount * sizeof(uint64_t),
+        m_queryResults.data(),
+        2 * sizeof(uint64_t),
+        VK_QUERY_RESULT_64_BIT | VK_QUERY_RESULT_WITH_AVAILABILITY_BIT
+    );
+
+    if (VK_SUCCESS != result && VK_NOT_READY != result)
+    {
+        return;
+    }
+
+    for (uint32_t i = 0; i < queryCount; ++i)
+    {
+        if (0 == m_queryResults[2 * i + 1])
+        {
+            return;
+        }
+    }
+
+    auto timestamp = [this](uint32_t query) { return m_queryResults[2 * query] & m_timestampMask; };
+    auto toMs      = [this](uint64_t ticks) { return static_cast<double>(ticks & m_timestampMask) * m_timestampPeriod * 1e-6; };
+
+    auto frameBegin = timestamp(0);
+
+    m_results.clear();
+    std::vector<TraceEvent> events {};
+    events.reserve(frame.scopes.size());
+
+    for (uint32_t i = 0; i < frame.scopes.size(); ++i)
+    {
+        auto begin = timestamp(2 * i);
+        auto end   = timestamp(2 * i + 1);
+
+        m_results.emplace_back(frame.scopes[i].name, frame.scopes[i].depth, toMs(begin - frameBegin), toMs(end - begin));
+
+        auto beginNs = ToCpuNanoseconds(begin);
+        events.emplace_back(frame.scopes[i].name, frame.frameNumber, beginNs, ToCpuNanoseconds(end) - beginNs);
+    }
+
+    m_traceFrames.emplace_back(std::move(events));
+    if (m_traceFrames.size() > MaxTraceFrames)
+    {
+        m_traceFrames.pop_front();
+    }
+}
+
+int64_t GpuProfiler::ToCpuNanoseconds(const uint64_t timestamp) const noexcept
+{
+    auto ticks = (timestamp - m_calibrationTimestamp) & m_timestampMask;
+    return m_calibrationNanoseconds + static_cast<int64_t>(static_cast<double>(ticks) * m_timestampPeriod);
+}
+
+GpuScope::GpuScope(const VkCommandBuffer commandBuffer, const std::string& name)
+    : m_commandBuffer(commandBuffer)
+    , m_scope(GpuProfiler::GetProfiler()->BeginScope(commandBuffer, name))
+{
+}
+
+GpuScope::~GpuScope() noexcept
+{
+    GpuProfiler::GetProfiler()->EndScope(m_commandBuffer, m_scope);
+}
@@ -0,0 +1,125 @@
+#pragma once
+
+#include <vulkan/vulkan.h>
+
+#include "Common.h"
+
+#include <array>
+#include <cstdint>
+#include <deque>
+#include <ostream>
+#include <string>
+#include <vector>
+
+struct GpuScopeResult
+{
+    std::string name {};
+    uint32_t depth {0};    // 嵌套的层级，0 表示最外层
+    double begin {0.0};    // 相对于该帧第一个时间戳的开始时间（毫秒）
+    double duration {0.0}; // 毫秒
+};
+
+/// @brief 基于 VK_QUERY_TYPE_TIMESTAMP 的 GPU 计时
+/// @details 每一个 MaxFramesInFlight 帧使用一个独立的 VkQueryPool，BeginFrame 在该帧的 fence 等待完成之后调用，
+///          此时读取的是同一个 QueryPool 上一次（MaxFramesInFlight 帧之前）写入的结果，不会等待 GPU
+///          时间戳在 GPU 的时钟域，初始化时和 std::chrono::steady_clock 对齐一次，导出的 trace 可以和 CPU 的事件放在同一条时间轴上
+class GpuProfiler
+{
+public:
+    static GpuProfiler* GetProfiler();
+
+    void Init(const VkCommandPool commandPool);
+
+    void Destroy() noexcept;
+
+    // 读取 frameIndex 上一次的结果并重置 QueryPool，必须在渲染流程之外调用
+    void BeginFrame(const VkCommandBuffer commandBuffer, const size_t frameIndex);
+
+    // 返回 scope 的序号，超过每帧的上限或者设备不支持时间戳时返回 InvalidScope
+    uint32_t BeginScope(const VkCommandBuffer commandBuffer, const std::string& name);
+
+    void EndScope(const VkCommandBuffer commandBuffer, const uint32_t scope);
+
+    // 最近一个已经完成的帧，按照 BeginScope 的顺序排列（先序遍历）
+    const std::vector<GpuScopeResult>& GetResults() const noexcept;
+
+    void DrawImGui() const;
+
+    // 导出最近 MaxTraceFrames 帧的 Chrome trace_event JSON，可以在 chrome://tracing 或 Perfetto 中打开
+    void SaveTrace(const std::string& fileName) const;
+
+    // 只写入事件，每个事件以 ",\n" 开头，用于追加到 Profiler::SaveTrace 导出的 CPU trace 中
+    void WriteTraceEvents(std::ostream& os) const;
+
+    bool IsSupported() const noexcept;
+
+    static inline constexpr uint32_t InvalidScope {~0u};
+    static inline constexpr uint32_t MaxScopesPerFrame {128};
+    static inline constexpr size_t MaxTraceFrames {300};
+    static inline constexpr uint32_t TraceThreadId {1000}; // trace 中 GPU 事件所在的“线程”
+
+private:
+    GpuProfiler() = default;
+
+    void Calibrate(const VkCommandPool commandPool);
+
+    void ResolveFrame(const size_t frameIndex);
+
+    // GPU 时间戳转换为 steady_clock 的纳秒
+    int64_t ToCpuNanoseconds(const uint64_t timestamp) const noexcept;
+
+private:
+    struct Scope
+    {
+        std::string name {};
+        uint32_t depth {0};
+    };
+
+    struct Frame
+    {
+        VkQueryPool queryPool {nullptr};
+        std::vector<Scope> scopes {};
+        uint64_t frameNumber {0};
+        bool written {false};
+    };
+
+    struct TraceEvent
+    {
+        std::string name {};
+        uint64_t frameNumber {0};
+        int64_t begin {0};    // 纳秒
+        int64_t duration {0}; // 纳秒
+    };
+
+    bool m_supported {false};
+    double m_timestampPeriod {1.0}; // 每个时间戳单位对应的纳秒数
+    uint64_t m_timestampMask {~0ull};
+
+    uint64_t m_calibrationTimestamp {0};
+    int64_t m_calibrationNanoseconds {0};
+
+    std::array<Frame, Common::MaxFramesInFlight> m_frames {};
+    Frame* m_currentFrame {nullptr};
+    std::vector<uint32_t> m_scopeStack {};
+    uint64_t m_frameNumber {0};
+
+    std::vector<uint64_t> m_queryResults {};
+    std::vector<GpuScopeResult> m_results {};
+    std::deque<std::vector<TraceEvent>> m_traceFrames {};
+};
+
+/// @brief GpuScope scope(cmd, "name"); 在构造和析构时各写入一个时间戳，可以嵌套
+class GpuScope
+{
+public:
+    GpuScope(const VkCommandBuffer commandBuffer, const std::string& name);
+
+    ~GpuScope() noexcept;
+
+    GpuScope(const GpuScope&)            = delete;
+    GpuScope& operator=(const GpuScope&) = delete;
+
+private:
+    VkCommandBuffer m_commandBuffer {nullptr};
+    uint32_t m_scope {GpuProfiler::InvalidScope};
+};
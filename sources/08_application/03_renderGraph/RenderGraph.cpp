@@ -1,5 +1,7 @@
 
 #include "RenderGraph.h"
+#include "GpuProfiler.h"
+#include "Profiler.hpp"
 #include "RenderPass.h"
 #include "Window.h"
 
@@ -31,8 +33,12 @@ void RenderGraph::Compile()
 
 void RenderGraph::Execute(const VkCommandBuffer cmd, const size_t frameIndex, const uint32_t imageIndex)
 {
-    for (const auto& [_, renderPass] : m_renderPasses)
+    // 每个 pass 自动计时，结果见 GpuProfiler 和 Profiler
+    // m_renderPasses 的 key 在 Compile 之后不会再变化，name.c_str() 可以直接作为 CPU scope 的名字
+    for (const auto& [name, renderPass] : m_renderPasses)
     {
+        PROFILE_SCOPE(name.c_str());
+        GpuScope scope(cmd, name);
         renderPass.Execute(cmd, frameIndex, imageIndex);
     }
 }
@@ -1,10 +1,16 @@
 #include "Window.h"
 #include "Context.h"
+#include "GpuProfiler.h"
+#include "Profiler.hpp"
 #include "RenderGraph.h"
 
 #include <GLFW/glfw3.h>
+#include <imgui.h>
+#include <imgui_impl_glfw.h>
+#include <imgui_impl_vulkan.h>
 
 #include <algorithm>
+#include <array>
 #include <format>
 #include <iostream>
 #include <numbers>
@@ -64,12 +70,18 @@ Window::Window()
     CreateSyncObjects();
 
     CreateSwapChain();
+
+    GpuProfiler::GetProfiler()->Init(m_commandPool);
+    InitImGui();
 }
 
 Window::~Window() noexcept
 {
     vkDeviceWaitIdle(Context::GetContext()->GetDevice());
 
+    CleanupImGui();
+    GpuProfiler::GetProfiler()->Destroy();
+
     CleanupSwapChain();
 
     vkDestroyDescriptorPool(Context::GetContext()->GetDevice(), m_descriptorPool, nullptr);
@@ -121,24 +133,45 @@ void Window::MainLoop()
 {
     while (!glfwWindowShouldClose(m_window))
     {
+        PROFILE_FRAME("frame");
+
         glfwPollEvents();
+
+        {
+            PROFILE_SCOPE("imgui");
+            ImGui_ImplVulkan_NewFrame();
+            ImGui_ImplGlfw_NewFrame();
+            ImGui::NewFrame();
+            GpuProfiler::GetProfiler()->DrawImGui();
+            ImGui::Render();
+        }
+
         DrawFrame();
     }
 }
 
 void Window::DrawFrame()
 {
-    vkWaitForFences(Context::GetContext()->GetDevice(), 1, &m_inFlightFences.at(m_currentFrame), VK_TRUE, std::numeric_limits<uint64_t>::max());
+    PROFILE_FUNCTION();
+
+    {
+        PROFILE_SCOPE("wait for fence");
+        vkWaitForFences(Context::GetContext()->GetDevice(), 1, &m_inFlightFences.at(m_currentFrame), VK_TRUE, std::numeric_limits<uint64_t>::max());
+    }
 
     uint32_t imageIndex {0};
-    VkResult result = vkAcquireNextImageKHR(
-        Context::GetContext()->GetDevice(),
-        m_swapChain,
-        std::numeric_limits<uint64_t>::max(),
-        m_imageAvailableSemaphores.at(m_currentFrame),
-        VK_NULL_HANDLE,
-        &imageIndex
-    );
+    VkResult result {VK_SUCCESS};
+    {
+        PROFILE_SCOPE("acquire");
+        result = vkAcquireNextImageKHR(
+            Context::GetContext()->GetDevice(),
+            m_swapChain,
+            std::numeric_limits<uint64_t>::max(),
+            m_imageAvailableSemaphores.at(m_currentFrame),
+            VK_NULL_HANDLE,
+            &imageIndex
+        );
+    }
 
     if (VK_ERROR_OUT_OF_DATE_KHR == result)
     {
@@ -164,7 +197,16 @@ void Window::DrawFrame()
         throw std::runtime_error("failed to begin recording command buffer");
     }
 
-    m_renderGraph.Execute(m_commandBuffers.at(m_currentFrame), 0, imageIndex);
+    // fence 已经等待完成，读取 MaxFramesInFlight 帧之前的时间戳不会阻塞
+    GpuProfiler::GetProfiler()->BeginFrame(m_commandBuffers.at(m_currentFrame), m_currentFrame);
+    {
+        GpuScope frameScope(m_commandBuffers.at(m_currentFrame), "frame");
+
+        m_renderGraph.Execute(m_commandBuffers.at(m_currentFrame), m_currentFrame, imageIndex);
+
+        GpuScope imguiScope(m_commandBuffers.at(m_currentFrame), "imgui");
+        RecordImGui(m_commandBuffers.at(m_currentFrame), imageIndex);
+    }
 
     if (VK_SUCCESS != vkEndCommandBuffer(m_commandBuffers.at(m_currentFrame)))
     {
@@ -199,7 +241,10 @@ void Window::DrawFrame()
     presentInfo.pImageIndices      = &imageIndex;
     presentInfo.pResults           = nullptr;
 
-    result = vkQueuePresentKHR(Context::GetContext()->GetPresentQueue(), &presentInfo);
+    {
+        PROFILE_SCOPE("present");
+        result = vkQueuePresentKHR(Context::GetContext()->GetPresentQueue(), &presentInfo);
+    }
 
     if (VK_ERROR_OUT_OF_DATE_KHR == result || VK_SUBOPTIMAL_KHR == result || m_framebufferResized)
     {
@@ -493,6 +538,155 @@ void Window::CreateDescriptorPool()
     }
 }
 
+void Window::InitImGui()
+{
+    // ImGui 使用单独的描述符池
+    std::array<VkDescriptorPoolSize, 1> poolSizes {
+        VkDescriptorPoolSize {VK_DESCRIPTOR_TYPE_COMBINED_IMAGE_SAMPLER, 16}
+    };
+
+    VkDescriptorPoolCreateInfo poolInfo = {};
+    poolInfo.sType                      = VK_STRUCTURE_TYPE_DESCRIPTOR_POOL_CREATE_INFO;
+    poolInfo.flags                      = VK_DESCRIPTOR_POOL_CREATE_FREE_DESCRIPTOR_SET_BIT;
+    poolInfo.maxSets                    = 16;
+    poolInfo.poolSizeCount              = static_cast<uint32_t>(poolSizes.size());
+    poolInfo.pPoolSizes                 = poolSizes.data();
+
+    if (VK_SUCCESS != vkCreateDescriptorPool(Context::GetContext()->GetDevice(), &poolInfo, nullptr, &m_imguiDescriptorPool))
+    {
+        throw std::runtime_error("failed to create imgui descriptor pool");
+    }
+
+    // 保留 RenderGraph 绘制的内容，图像已经是 PRESENT_SRC 布局
+    VkAttachmentDescription colorAttachment = {};
+    colorAttachment.format                  = m_swapChainImageFormat;
+    colorAttachment.samples                 = VK_SAMPLE_COUNT_1_BIT;
+    colorAttachment.loadOp                  = VK_ATTACHMENT_LOAD_OP_LOAD;
+    colorAttachment.storeOp                 = VK_ATTACHMENT_STORE_OP_STORE;
+    colorAttachment.stencilLoadOp           = VK_ATTACHMENT_LOAD_OP_DONT_CARE;
+    colorAttachment.stencilStoreOp          = VK_ATTACHMENT_STORE_OP_DONT_CARE;
+    colorAttachment.initialLayout           = VK_IMAGE_LAYOUT_PRESENT_SRC_KHR;
+    colorAttachment.finalLayout             = VK_IMAGE_LAYOUT_PRESENT_SRC_KHR;
+
+    VkAttachmentReference colorAttachmentRef = {};
+    colorAttachmentRef.attachment            = 0;
+    colorAttachmentRef.layout                = VK_IMAGE_LAYOUT_COLOR_ATTACHMENT_OPTIMAL;
+
+    VkSubpassDescription subpass = {};
+    subpass.pipelineBindPoint    = VK_PIPELINE_BIND_POINT_GRAPHICS;
+    subpass.colorAttachmentCount = 1;
+    subpass.pColorAttachments    = &colorAttachmentRef;
+
+    VkSubpassDependency dependency = {};
+    dependency.srcSubpass          = VK_SUBPASS_EXTERNAL;
+    dependency.dstSubpass          = 0;
+    dependency.srcStageMask        = VK_PIPELINE_STAGE_COLOR_ATTACHMENT_OUTPUT_BIT;
+    dependency.srcAccessMask       = VK_ACCESS_COLOR_ATTACHMENT_WRITE_BIT;
+    dependency.dstStageMask        = VK_PIPELINE_STAGE_COLOR_ATTACHMENT_OUTPUT_BIT;
+    dependency.dstAccessMask       = VK_ACCESS_COLOR_ATTACHMENT_READ_BIT | VK_ACCESS_COLOR_ATTACHMENT_WRITE_BIT;
+
+    VkRenderPassCreateInfo renderPassInfo = {};
+    renderPassInfo.sType                  = VK_STRUCTURE_TYPE_RENDER_PASS_CREATE_INFO;
+    renderPassInfo.attachmentCount        = 1;
+    renderPassInfo.pAttachments           = &colorAttachment;
+    renderPassInfo.subpassCount           = 1;
+    renderPassInfo.pSubpasses             = &subpass;
+    renderPassInfo.dependencyCount        = 1;
+    renderPassInfo.pDependencies          = &dependency;
+
+    if (VK_SUCCESS != vkCreateRenderPass(Context::GetContext()->GetDevice(), &renderPassInfo, nullptr, &m_imguiRenderPass))
+    {
+        throw std::runtime_error("failed to create imgui render pass");
+    }
+
+    m_imguiFramebuffers.resize(m_colors.size());
+    for (size_t i = 0; i < m_colors.size(); ++i)
+    {
+        VkFramebufferCreateInfo framebufferInfo = {};
+        framebufferInfo.sType                   = VK_STRUCTURE_TYPE_FRAMEBUFFER_CREATE_INFO;
+        framebufferInfo.renderPass              = m_imguiRenderPass;
+        framebufferInfo.attachmentCount         = 1;
+        framebufferInfo.pAttachments            = &m_colors[i].imageView;
+        framebufferInfo.width                   = m_swapChainExtent.width;
+        framebufferInfo.height                  = m_swapChainExtent.height;
+        framebufferInfo.layers                  = 1;
+
+        if (VK_SUCCESS != vkCreateFramebuffer(Context::GetContext()->GetDevice(), &framebufferInfo, nullptr, &m_imguiFramebuffers[i]))
+        {
+            throw std::runtime_error("failed to create imgui framebuffer");
+        }
+    }
+
+    ImGui::CreateContext();
+    ImGui::StyleColorsDark();
+    ImGui_ImplGlfw_InitForVulkan(m_window, true);
+
+    ImGui_ImplVulkan_InitInfo initInfo = {};
+    initInfo.Instance                  = Context::GetContext()->GetInstance();
+    initInfo.PhysicalDevice            = Context::GetContext()->GetPhysicalDevice();
+    initInfo.Device                    = Context::GetContext()->GetDevice();
+    initInfo.QueueFamily               = Context::GetContext()->GetQueueFamilyIndices().graphicsFamily.value();
+    initInfo.Queue                     = Context::GetContext()->GetGraphicsQueue();
+    initInfo.DescriptorPool            = m_imguiDescriptorPool;
+    initInfo.Subpass                   = 0;
+    initInfo.MinImageCount             = m_swapChainImageCount;
+    initInfo.ImageCount                = m_swapChainImageCount;
+    initInfo.MSAASamples               = VK_SAMPLE_COUNT_1_BIT;
+
+    ImGui_ImplVulkan_Init(&initInfo, m_imguiRenderPass);
+
+    // 上传字体纹理
+    auto commandBuffer = m_commandBuffers.at(m_currentFrame);
+
+    VkCommandBufferBeginInfo beginInfo = {};
+    beginInfo.sType                    = VK_STRUCTURE_TYPE_COMMAND_BUFFER_BEGIN_INFO;
+    beginInfo.flags                    = VK_COMMAND_BUFFER_USAGE_ONE_TIME_SUBMIT_BIT;
+    vkBeginCommandBuffer(commandBuffer, &beginInfo);
+
+    ImGui_ImplVulkan_CreateFontsTexture(commandBuffer);
+
+    vkEndCommandBuffer(commandBuffer);
+
+    VkSubmitInfo submitInfo       = {};
+    submitInfo.sType              = VK_STRUCTURE_TYPE_SUBMIT_INFO;
+    submitInfo.commandBufferCount = 1;
+    submitInfo.pCommandBuffers    = &commandBuffer;
+
+    vkQueueSubmit(Context::GetContext()->GetGraphicsQueue(), 1, &submitInfo, VK_NULL_HANDLE);
+    vkQueueWaitIdle(Context::GetContext()->GetGraphicsQueue());
+
+    ImGui_ImplVulkan_DestroyFontUploadObjects();
+}
+
+void Window::CleanupImGui() noexcept
+{
+    ImGui_ImplVulkan_Shutdown();
+    ImGui_ImplGlfw_Shutdown();
+    ImGui::DestroyContext();
+
+    for (auto framebuffer : m_imguiFramebuffers)
+    {
+        vkDestroyFramebuffer(Context::GetContext()->GetDevice(), framebuffer, nullptr);
+    }
+
+    vkDestroyRenderPass(Context::GetContext()->GetDevice(), m_imguiRenderPass, nullptr);
+    vkDestroyDescriptorPool(Context::GetContext()->GetDevice(), m_imguiDescriptorPool, nullptr);
+}
+
+void Window::RecordImGui(const VkCommandBuffer commandBuffer, const uint32_t imageIndex) const
+{
+    VkRenderPassBeginInfo renderPassInfo = {};
+    renderPassInfo.sType                 = VK_STRUCTURE_TYPE_RENDER_PASS_BEGIN_INFO;
+    renderPassInfo.renderPass            = m_imguiRenderPass;
+    renderPassInfo.framebuffer           = m_imguiFramebuffers[imageIndex];
+    renderPassInfo.renderArea.offset     = {0, 0};
+    renderPassInfo.renderArea.extent     = m_swapChainExtent;
+
+    vkCmdBeginRenderPass(commandBuffer, &renderPassInfo, VK_SUBPASS_CONTENTS_INLINE);
+    ImGui_ImplVulkan_RenderDrawData(ImGui::GetDrawData(), commandBuffer);
+    vkCmdEndRenderPass(commandBuffer);
+}
+
 void Window::FramebufferResizeCallback(GLFWwindow* window, int widht, int height) noexcept
 {
     if (auto app = reinterpret_cast<Window*>(glfwGetWindowUserPointer(window)))
@@ -607,6 +801,20 @@ void Window::KeyCallback(GLFWwindow* window, int key, int scancode, int action,
             app->m_eyePos = glm::vec3 {0.f, 0.f, -3.f};
             app->m_lookAt = glm::vec3 {0.f};
         }
+
+        // 按下'T'保存最近几百帧的 CPU 和 GPU 时间线，两者在同一条时间轴上
+        if (GLFW_PRESS == action && GLFW_KEY_T == key)
+        {
+            try
+            {
+                Profiler::SaveTrace("trace.json", [](std::ostream& os) { GpuProfiler::GetProfiler()->WriteTraceEvents(os); });
+                std::cout << "save trace.json\n";
+            }
+            catch (const std::exception& e)
+            {
+                std::cerr << e.what() << '\n';
+            }
+        }
     }
 }
 
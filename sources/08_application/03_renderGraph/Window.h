@@ -90,6 +90,13 @@ private:
 
     void CleanupSwapChain() noexcept;
 
+    void InitImGui();
+
+    void CleanupImGui() noexcept;
+
+    // 在 RenderGraph 的输出上叠加 ImGui，显示每个 pass 的 GPU 耗时
+    void RecordImGui(const VkCommandBuffer commandBuffer, const uint32_t imageIndex) const;
+
     void DrawFrame();
 
 private:
@@ -129,5 +136,9 @@ private:
 
     std::vector<ImageData> m_colors {};
 
+    VkDescriptorPool m_imguiDescriptorPool {nullptr};
+    VkRenderPass m_imguiRenderPass {nullptr};
+    std::vector<VkFramebuffer> m_imguiFramebuffers {};
+
     RenderGraph m_renderGraph {this};
 };
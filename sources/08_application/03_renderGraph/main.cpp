@@ -2,9 +2,13 @@
 #include "RenderGraph.h"
 #include "RenderPass.h"
 #include "Window.h"
+#include "Profiler.hpp"
 
 int main()
 {
+    Profiler::SetEnabled(true);
+    PROFILE_THREAD("main");
+
     Window window {};
 
     auto& renderGraph = window.GetRenderGraph();
@@ -0,0 +1,384 @@
+#include "Benchmark.h"
+#include "json.hpp"
+#include <algorithm>
+#include <atomic>
+#include <chrono>
+#include <cmath>
+#include <cstdlib>
+#include <fstream>
+#include <iostream>
+#include <new>
+#include <numeric>
+
+#if defined(_WIN32)
+#include <Windows.h>
+#include <psapi.h>
+#else
+#include <sys/resource.h>
+#endif
+
+namespace {
+std::atomic_uint64_t s_allocationCount {0};
+std::atomic_uint64_t s_allocationBytes {0};
+
+void* CountedAllocate(std::size_t size)
+{
+    s_allocationCount.fetch_add(1, std::memory_order_relaxed);
+    s_allocationBytes.fetch_add(size, std::memory_order_relaxed);
+
+    if (auto ptr = std::malloc(size == 0 ? 1 : size))
+    {
+        return ptr;
+    }
+    throw std::bad_alloc();
+}
+
+void* CountedAllocate(std::size_t size, std::align_val_t alignment)
+{
+    s_allocationCount.fetch_add(1, std::memory_order_relaxed);
+    s_allocationBytes.fetch_add(size, std::memory_order_relaxed);
+
+    auto align = static_cast<std::size_t>(alignment);
+#if defined(_WIN32)
+    auto ptr = _aligned_malloc(size == 0 ? 1 : size, align);
+#else
+    // aligned_alloc 要求 size 是 alignment 的整数倍
+    auto ptr = std::aligned_alloc(align, std::max(align, (size + align - 1) / align * align));
+#endif
+    if (ptr)
+    {
+        return ptr;
+    }
+    throw std::bad_alloc();
+}
+
+void AlignedFree(void* ptr) noexcept
+{
+#if defined(_WIN32)
+    _aligned_free(ptr);
+#else
+    std::free(ptr);
+#endif
+}
+
+double Percentile(const std::vector<double>& sorted, double percent)
+{
+    // nearest-rank
+    auto rank = static_cast<size_t>(std::ceil(percent / 100.0 * static_cast<double>(sorted.size())));
+    return sorted[std::clamp<size_t>(rank, 1, sorted.size()) - 1];
+}
+
+nlohmann::json ToJson(const BenchmarkStatistics& statistics)
+{
+    return {
+        {"mean", statistics.mean},
+        {"min", statistics.min},
+        {"max", statistics.max},
+        {"p50", statistics.p50},
+        {"p95", statistics.p95},
+        {"p99", statistics.p99},
+    };
+}
+} // namespace
+
+// 替换全局的 operator new/delete 以统计内存分配次数，nothrow 版本默认会转发到这里，对齐版本单独替换
+void* operator new(std::size_t size)
+{
+    return CountedAllocate(size);
+}
+
+void* operator new[](std::size_t size)
+{
+    return CountedAllocate(size);
+}
+
+void operator delete(void* ptr) noexcept
+{
+    std::free(ptr);
+}
+
+void operator delete[](void* ptr) noexcept
+{
+    std::free(ptr);
+}
+
+void operator delete(void* ptr, std::size_t) noexcept
+{
+    std::free(ptr);
+}
+
+void operator delete[](void* ptr, std::size_t) noexcept
+{
+    std::free(ptr);
+}
+
+void* operator new(std::size_t size, std::align_val_t alignment)
+{
+    return CountedAllocate(size, alignment);
+}
+
+void* operator new[](std::size_t size, std::align_val_t alignment)
+{
+    return CountedAllocate(size, alignment);
+}
+
+void operator delete(void* ptr, std::align_val_t) noexcept
+{
+    AlignedFree(ptr);
+}
+
+void operator delete[](void* ptr, std::align_val_t) noexcept
+{
+    AlignedFree(ptr);
+}
+
+void operator delete(void* ptr, std::size_t, std::align_val_t) noexcept
+{
+    AlignedFree(ptr);
+}
+
+void operator delete[](void* ptr, std::size_t, std::align_val_t) noexcept
+{
+    AlignedFree(ptr);
+}
+
+uint64_t GetAllocationCount() noexcept
+{
+    return s_allocationCount.load(std::memory_order_relaxed);
+}
+
+uint64_t GetAllocationBytes() noexcept
+{
+    return s_allocationBytes.load(std::memory_order_relaxed);
+}
+
+uint64_t GetPeakMemory() noexcept
+{
+#if defined(_WIN32)
+    PROCESS_MEMORY_COUNTERS counters {};
+    if (GetProcessMemoryInfo(GetCurrentProcess(), &counters, sizeof(counters)))
+    {
+        return static_cast<uint64_t>(counters.PeakWorkingSetSize);
+    }
+    return 0;
+#else
+    rusage usage {};
+    getrusage(RUSAGE_SELF, &usage);
+#if defined(__APPLE__)
+    return static_cast<uint64_t>(usage.ru_maxrss); // 字节
+#else
+    return static_cast<uint64_t>(usage.ru_maxrss) * 1024; // KB
+#endif
+#endif
+}
+
+BenchmarkStatistics BenchmarkStatistics::FromSamples(std::vector<double> samples)
+{
+    BenchmarkStatistics statistics {};
+    if (samples.empty())
+    {
+        return statistics;
+    }
+
+    std::sort(samples.begin(), samples.end());
+
+    statistics.mean = std::accumulate(samples.cbegin(), samples.cend(), 0.0) / static_cast<double>(samples.size());
+    statistics.min  = samples.front();
+    statistics.max  = samples.back();
+    statistics.p50  = Percentile(samples, 50.0);
+    statistics.p95  = Percentile(samples, 95.0);
+    statistics.p99  = Percentile(samples, 99.0);
+
+    return statistics;
+}
+
+BenchmarkRegistry& BenchmarkRegistry::Get()
+{
+    // 函数内的静态变量，保证在各个场景的静态注册对象之前构造
+    static BenchmarkRegistry registry {};
+    return registry;
+}
+
+void BenchmarkRegistry::Register(const std::string& name, BenchmarkSceneFactory factory)
+{
+    m_scenes.emplace_back(name, std::move(factory));
+}
+
+BenchmarkResult BenchmarkRegistry::Run(const std::string& name, const BenchmarkSceneFactory& factory, const BenchmarkOptions& options) const
+{
+    auto scene = factory();
+    scene->Setup();
+
+    auto warmupFrames   = options.warmupFrames;
+    auto measuredFrames = options.measuredFrames;
+    if (auto frameLimit = scene->GetFrameLimit(); frameLimit > 0)
+    {
+        warmupFrames   = std::min(warmupFrames, frameLimit);
+        measuredFrames = std::min(measuredFrames, frameLimit);
+    }
+
+    for (uint32_t i = 0; i < warmupFrames; ++i)
+    {
+        scene->RenderFrame();
+    }
+    scene->Finish();
+
+    std::vector<double> cpuFrameTimes {};
+    std::vector<double> gpuFrameTimes {};
+    cpuFrameTimes.reserve(measuredFrames);
+    gpuFrameTimes.reserve(measuredFrames);
+
+    auto allocationCount = GetAllocationCount();
+    auto allocationBytes = GetAllocationBytes();
+
+    for (uint32_t i = 0; i < measuredFrames; ++i)
+    {
+        auto start = std::chrono::steady_clock::now();
+        scene->RenderFrame();
+        auto end = std::chrono::steady_clock::now();
+
+        cpuFrameTimes.emplace_back(std::chrono::duration<double, std::milli>(end - start).count());
+
+        if (auto gpuFrameTime = scene->GetGpuFrameTime(); gpuFrameTime >= 0.0)
+        {
+            gpuFrameTimes.emplace_back(gpuFrameTime);
+        }
+    }
+
+    // 两个 reserve 之后测量循环中不会再有 vector 的分配，统计的都是场景本身的分配
+    allocationCount = GetAllocationCount() - allocationCount;
+    allocationBytes = GetAllocationBytes() - allocationBytes;
+
+    scene->Finish();
+    auto metrics = scene->GetMetrics();
+    scene->Teardown();
+
+    BenchmarkResult result {};
+    result.name            = name;
+    result.frames          = measuredFrames;
+    result.cpuFrameTime    = BenchmarkStatistics::FromSamples(std::move(cpuFrameTimes));
+    result.hasGpuFrameTime = !gpuFrameTimes.empty();
+    result.gpuFrameTime    = BenchmarkStatistics::FromSamples(std::move(gpuFrameTimes));
+    result.allocationCount = allocationCount;
+    result.allocationBytes = allocationBytes;
+    result.peakMemory      = GetPeakMemory();
+    result.metrics         = std::move(metrics);
+
+    return result;
+}
+
+int BenchmarkRegistry::RunAll(int argc, char** argv) const
+{
+    BenchmarkOptions options {};
+
+    for (int i = 1; i < argc; ++i)
+    {
+        std::string arg = argv[i];
+        if ("--list" == arg)
+        {
+            for (const auto& [name, factory] : m_scenes)
+            {
+                std::cout << name << '\n';
+            }
+            return EXIT_SUCCESS;
+        }
+        if (i + 1 >= argc)
+        {
+            std::cerr << "missing value for " << arg << '\n';
+            return EXIT_FAILURE;
+        }
+
+        std::string value = argv[++i];
+        if ("--warmup" == arg)
+        {
+            options.warmupFrames = static_cast<uint32_t>(std::stoul(value));
+        }
+        else if ("--frames" == arg)
+        {
+            options.measuredFrames = static_cast<uint32_t>(std::stoul(value));
+        }
+        else if ("--filter" == arg)
+        {
+            options.filter = value;
+        }
+        else if ("--output" == arg)
+        {
+            options.output = value;
+        }
+        else if ("--label" == arg)
+        {
+            options.label = value;
+        }
+        else
+        {
+            std::cerr << "unknown option: " << arg << "\n"
+                      << "usage: " << argv[0] << " [--list] [--warmup N] [--frames N] [--filter name] [--output file.json] [--label text]\n";
+            return EXIT_FAILURE;
+        }
+    }
+
+    nlohmann::json scenes = nlohmann::json::array();
+    for (const auto& [name, factory] : m_scenes)
+    {
+        if (!options.filter.empty() && std::string::npos == name.find(options.filter))
+        {
+            continue;
+        }
+
+        std::cerr << "running " << name << " (" << options.warmupFrames << " warm-up, " << options.measuredFrames << " measured frames)\n";
+        auto result = Run(name, factory, options);
+
+        nlohmann::json metrics = nlohmann::json::object();
+        for (const auto& [metricName, value] : result.metrics)
+        {
+            metrics[metricName] = value;
+        }
+
+        scenes.push_back({
+            {"name", result.name},
+            {"frames", result.frames},
+            {"cpuFrameTime", ToJson(result.cpuFrameTime)},
+            {"gpuFrameTime", result.hasGpuFrameTime ? ToJson(result.gpuFrameTime) : nlohmann::json(nullptr)},
+            {"allocationCount", result.allocationCount},
+            {"allocationBytes", result.allocationBytes},
+            {"peakMemory", result.peakMemory},
+            {"metrics", metrics},
+        });
+    }
+
+    nlohmann::json report = {
+        {"executable", argv[0]},
+        {"label", options.label},
+        {"warmupFrames", options.warmupFrames},
+        {"measuredFrames", options.measuredFrames},
+        {"scenes", scenes},
+    };
+
+    std::cout << report.dump(4) << '\n';
+
+    if (!options.output.empty())
+    {
+        std::ofstream file(options.output);
+        if (!file)
+        {
+            std::cerr << "failed to open " << options.output << '\n';
+            return EXIT_FAILURE;
+        }
+        file << report.dump(4) << '\n';
+    }
+
+    return EXIT_SUCCESS;
+}
+
+int main(int argc, char** argv)
+{
+    try
+    {
+        return BenchmarkRegistry::Get().RunAll(argc, argv);
+    }
+    catch (const std::exception& e)
+    {
+        std::cerr << e.what() << '\n';
+        return EXIT_FAILURE;
+    }
+}
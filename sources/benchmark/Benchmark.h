@@ -0,0 +1,119 @@
+#pragma once
+
+#include <cstdint>
+#include <functional>
+#include <memory>
+#include <string>
+#include <utility>
+#include <vector>
+
+/// @brief 基准测试场景，每个示例在自己的 bench 目录中实现并通过 BENCHMARK_SCENE 注册
+/// @details 运行顺序：Setup -> 预热帧 RenderFrame -> Finish -> 测量帧 RenderFrame -> Finish -> Teardown
+///          RenderFrame 只负责提交一帧，不需要等待 GPU 完成，和示例正常运行时的行为一致
+class BenchmarkScene
+{
+public:
+    virtual ~BenchmarkScene() noexcept = default;
+
+    virtual void Setup()
+    {
+    }
+
+    virtual void RenderFrame() = 0;
+
+    // 等待 GPU 执行完所有已经提交的工作
+    virtual void Finish()
+    {
+    }
+
+    // 最近一个已经完成的帧在 GPU 上的耗时（毫秒），返回负数表示不支持
+    virtual double GetGpuFrameTime() const
+    {
+        return -1.0;
+    }
+
+    // 单帧耗时很长的场景（例如离线处理整个网格）可以限制预热和测量的帧数，0 表示使用命令行的设置
+    virtual uint32_t GetFrameLimit() const
+    {
+        return 0;
+    }
+
+    // 场景自定义的指标（例如网格优化前后的 ACMR），在 Teardown 之前读取并写入结果
+    virtual std::vector<std::pair<std::string, double>> GetMetrics() const
+    {
+        return {};
+    }
+
+    virtual void Teardown()
+    {
+    }
+};
+
+using BenchmarkSceneFactory = std::function<std::unique_ptr<BenchmarkScene>()>;
+
+struct BenchmarkOptions
+{
+    uint32_t warmupFrames {60};
+    uint32_t measuredFrames {600};
+    std::string filter {};    // 只运行名称包含该字符串的场景，为空时运行所有场景
+    std::string output {};    // JSON 结果的文件路径，为空时只输出到控制台
+    std::string label {};     // 写入结果中的标记，例如提交的哈希，用于对比不同提交的结果
+};
+
+struct BenchmarkStatistics
+{
+    double mean {0.0};
+    double min {0.0};
+    double max {0.0};
+    double p50 {0.0};
+    double p95 {0.0};
+    double p99 {0.0};
+
+    static BenchmarkStatistics FromSamples(std::vector<double> samples);
+};
+
+struct BenchmarkResult
+{
+    std::string name {};
+    uint32_t frames {0};
+    BenchmarkStatistics cpuFrameTime {}; // 毫秒，每次 RenderFrame 的耗时（包含等待 fence 的时间）
+    BenchmarkStatistics gpuFrameTime {}; // 毫秒，hasGpuFrameTime 为 false 时无效
+    bool hasGpuFrameTime {false};
+    uint64_t allocationCount {0};        // 测量帧内 operator new 的调用次数
+    uint64_t allocationBytes {0};
+    uint64_t peakMemory {0};             // 进程的峰值常驻内存（字节）
+    std::vector<std::pair<std::string, double>> metrics {};
+};
+
+class BenchmarkRegistry
+{
+public:
+    static BenchmarkRegistry& Get();
+
+    void Register(const std::string& name, BenchmarkSceneFactory factory);
+
+    BenchmarkResult Run(const std::string& name, const BenchmarkSceneFactory& factory, const BenchmarkOptions& options) const;
+
+    // 解析命令行，运行所有匹配的场景并输出 JSON，返回值作为 main 的返回值
+    int RunAll(int argc, char** argv) const;
+
+private:
+    std::vector<std::pair<std::string, BenchmarkSceneFactory>> m_scenes {};
+};
+
+struct BenchmarkRegistrar
+{
+    BenchmarkRegistrar(const std::string& name, BenchmarkSceneFactory factory)
+    {
+        BenchmarkRegistry::Get().Register(name, std::move(factory));
+    }
+};
+
+// 从程序开始到现在所有线程 operator new 的调用次数和字节数
+uint64_t GetAllocationCount() noexcept;
+uint64_t GetAllocationBytes() noexcept;
+
+uint64_t GetPeakMemory() noexcept;
+
+#define BENCHMARK_SCENE(SceneType, name) \
+    static BenchmarkRegistrar s_benchmarkRegistrar_##SceneType(name, []() -> std::unique_ptr<BenchmarkScene> { return std::make_unique<SceneType>(); })
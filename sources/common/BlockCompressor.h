@@ -0,0 +1,826 @@
+#pragma once
+
+#include "Parallel.h"
+
+#include <algorithm>
+#include <array>
+#include <cmath>
+#include <cstdint>
+#include <cstring>
+#include <limits>
+#include <utility>
+#include <vector>
+
+/// @brief CPU 块压缩编码器，cook 纹理时把 RGBA8 压缩为 BC1/BC3/BC5/BC7，显存占用和采样带宽降低为原来的 1/8 ~ 1/4
+/// @details 每个 4x4 的块独立编码，按块的行分给多个线程；块内的 16 个像素按分量分开存放（SoA），
+///          查找最近的调色板颜色等循环都是在 16 个像素上的定长循环，编译器可以直接向量化
+///          BC1：RGB565 端点 + 2 位索引，只使用 4 色模式（不透明）
+///          BC3：BC1 的颜色块 + BC4 的 alpha 块
+///          BC5：R、G 两个 BC4 块，用于法线贴图等双通道数据
+///          BC7：只使用 mode 6（单个子集，RGBA7777 端点 + 每个端点一个 p-bit，4 位索引），不透明和带 alpha 的纹理都适用
+class BlockCompressor
+{
+public:
+    enum class Format
+    {
+        BC1,
+        BC3,
+        BC5,
+        BC7,
+    };
+
+    /// @brief Fast：主成分方向上的端点；Normal：再做一次最小二乘优化；High：多次最小二乘优化，BC4 搜索端点附近的值，BC7 穷举 p-bit
+    enum class Quality
+    {
+        Fast,
+        Normal,
+        High,
+    };
+
+    struct Options
+    {
+        Format format {Format::BC7};
+        Quality quality {Quality::Normal};
+        uint32_t threadCount {0}; // 0：使用共享线程池的所有线程（Parallel.h）
+    };
+
+    static inline constexpr uint32_t BlockExtent {4};
+
+    static constexpr uint32_t GetBlockSize(Format format) noexcept
+    {
+        return Format::BC1 == format ? 8 : 16;
+    }
+
+    static constexpr size_t GetCompressedSize(uint32_t width, uint32_t height, Format format) noexcept
+    {
+        return size_t {(width + BlockExtent - 1) / BlockExtent} * ((height + BlockExtent - 1) / BlockExtent) * GetBlockSize(format);
+    }
+
+    /// @param pixels RGBA8，宽高不是 4 的倍数时边缘的块重复使用最后一行（列）
+    static std::vector<uint8_t> Compress(const uint8_t* pixels, uint32_t width, uint32_t height, const Options& options)
+    {
+        const auto blocksX   = (width + BlockExtent - 1) / BlockExtent;
+        const auto blocksY   = (height + BlockExtent - 1) / BlockExtent;
+        const auto blockSize = GetBlockSize(options.format);
+
+        std::vector<uint8_t> output(GetCompressedSize(width, height, options.format));
+        const auto taskCount = std::min(Parallel::GetTaskCount(size_t {blocksX} * blocksY, MinBlocksPerThread, options.threadCount), blocksY);
+        Parallel::For(blocksY, taskCount, [&](size_t begin, size_t end, uint32_t) {
+            for (auto by = static_cast<uint32_t>(begin); by < end; ++by)
+            {
+                for (uint32_t bx = 0; bx < blocksX; ++bx)
+                {
+                    auto block       = LoadBlock(pixels, width, height, bx, by);
+                    auto destination = output.data() + (size_t {by} * blocksX + bx) * blockSize;
+                    switch (options.format)
+                    {
+                    case Format::BC1:
+                        EncodeBc1(block, options.quality, destination);
+                        break;
+                    case Format::BC3:
+                        EncodeBc4(block[3], options.quality, destination);
+                        EncodeBc1(block, options.quality, destination + 8);
+                        break;
+                    case Format::BC5:
+                        EncodeBc4(block[0], options.quality, destination);
+                        EncodeBc4(block[1], options.quality, destination + 8);
+                        break;
+                    case Format::BC7:
+                        EncodeBc7(block, options.quality, destination);
+                        break;
+                    }
+                }
+            }
+        });
+
+        return output;
+    }
+
+    /// @brief 解码为 RGBA8，用于计算压缩质量；BC7 只解码编码器使用的 mode 6，其它模式输出 0
+    static std::vector<uint8_t> Decompress(const uint8_t* blocks, uint32_t width, uint32_t height, Format format)
+    {
+        const auto blocksX   = (width + BlockExtent - 1) / BlockExtent;
+        const auto blocksY   = (height + BlockExtent - 1) / BlockExtent;
+        const auto blockSize = GetBlockSize(format);
+
+        std::vector<uint8_t> pixels(size_t {width} * height * 4);
+        for (uint32_t by = 0; by < blocksY; ++by)
+        {
+            for (uint32_t bx = 0; bx < blocksX; ++bx)
+            {
+                std::array<std::array<uint8_t, 4>, 16> texels {};
+                auto source = blocks + (size_t {by} * blocksX + bx) * blockSize;
+                switch (format)
+                {
+                case Format::BC1:
+                    DecodeBc1(source, texels);
+                    break;
+                case Format::BC3:
+                    DecodeBc1(source + 8, texels);
+                    DecodeBc4(source, texels, 3);
+                    break;
+                case Format::BC5:
+                    DecodeBc4(source, texels, 0);
+                    DecodeBc4(source + 8, texels, 1);
+                    for (auto& texel : texels)
+                    {
+                        texel[2] = 0;
+                        texel[3] = 255;
+                    }
+                    break;
+                case Format::BC7:
+                    DecodeBc7(source, texels);
+                    break;
+                }
+
+                for (uint32_t i = 0; i < 16; ++i)
+                {
+                    auto x = bx * BlockExtent + i % BlockExtent;
+                    auto y = by * BlockExtent + i / BlockExtent;
+                    if (x < width && y < height)
+                    {
+                        std::memcpy(pixels.data() + (size_t {y} * width + x) * 4, texels[i].data(), 4);
+                    }
+                }
+            }
+        }
+
+        return pixels;
+    }
+
+private:
+    static inline constexpr size_t MinBlocksPerThread {1024};
+
+    // block[c][i]：第 i 个像素的第 c 个分量，范围 [0, 255]
+    using Channel = std::array<float, 16>;
+    using Block   = std::array<Channel, 4>;
+    using Color   = std::array<float, 4>;
+
+    static inline constexpr std::array<int32_t, 16> Bc7Weights {0, 4, 9, 13, 17, 21, 26, 30, 34, 38, 43, 47, 51, 55, 60, 64};
+
+    static Block LoadBlock(const uint8_t* pixels, uint32_t width, uint32_t height, uint32_t bx, uint32_t by) noexcept
+    {
+        Block block {};
+        for (uint32_t i = 0; i < 16; ++i)
+        {
+            auto x     = std::min(bx * BlockExtent + i % BlockExtent, width - 1);
+            auto y     = std::min(by * BlockExtent + i / BlockExtent, height - 1);
+            auto texel = pixels + (size_t {y} * width + x) * 4;
+            for (uint32_t c = 0; c < 4; ++c)
+            {
+                block[c][i] = texel[c];
+            }
+        }
+        return block;
+    }
+
+    /// @brief 前 ChannelCount 个分量的主成分方向（幂迭代），所有像素相同时返回 0 向量
+    template <uint32_t ChannelCount>
+    static Color PrincipalAxis(const Block& block, Color& mean) noexcept
+    {
+        mean = {};
+        for (uint32_t c = 0; c < ChannelCount; ++c)
+        {
+            for (auto value : block[c])
+            {
+                mean[c] += value;
+            }
+            mean[c] /= 16.f;
+        }
+
+        std::array<std::array<float, 4>, 4> covariance {};
+        for (uint32_t c0 = 0; c0 < ChannelCount; ++c0)
+        {
+            for (uint32_t c1 = c0; c1 < ChannelCount; ++c1)
+            {
+                float sum {0.f};
+                for (uint32_t i = 0; i < 16; ++i)
+                {
+                    sum += (block[c0][i] - mean[c0]) * (block[c1][i] - mean[c1]);
+                }
+                covariance[c0][c1] = covariance[c1][c0] = sum;
+            }
+        }
+
+        // 从方差最大的分量开始迭代，避免初始向量和主成分方向正交
+        Color axis {};
+        uint32_t largest {0};
+        for (uint32_t c = 1; c < ChannelCount; ++c)
+        {
+            largest = covariance[c][c] > covariance[largest][largest] ? c : largest;
+        }
+        axis[largest] = 1.f;
+
+        // 迭代中只按最大的分量缩放，最后再归一化，4 次迭代对 4x4 的块已经足够
+        for (uint32_t iteration = 0; iteration < 4; ++iteration)
+        {
+            Color next {};
+            for (uint32_t c0 = 0; c0 < ChannelCount; ++c0)
+            {
+                for (uint32_t c1 = 0; c1 < ChannelCount; ++c1)
+                {
+                    next[c0] += covariance[c0][c1] * axis[c1];
+                }
+            }
+
+            float scale {0.f};
+            for (auto value : next)
+            {
+                scale = std::max(scale, std::abs(value));
+            }
+            if (scale < 1e-6f)
+            {
+                return {};
+            }
+
+            for (uint32_t c = 0; c < 4; ++c)
+            {
+                axis[c] = next[c] / scale;
+            }
+        }
+
+        float length {0.f};
+        for (auto value : axis)
+        {
+            length += value * value;
+        }
+
+        length = 1.f / std::sqrt(length);
+        for (auto& value : axis)
+        {
+            value *= length;
+        }
+        return axis;
+    }
+
+    /// @brief 把像素投影到主成分方向上，投影的最小值和最大值作为两个端点
+    template <uint32_t ChannelCount>
+    static std::pair<Color, Color> FitEndpoints(const Block& block) noexcept
+    {
+        Color mean {};
+        auto axis = PrincipalAxis<ChannelCount>(block, mean);
+
+        auto minT = std::numeric_limits<float>::max();
+        auto maxT = std::numeric_limits<float>::lowest();
+        for (uint32_t i = 0; i < 16; ++i)
+        {
+            float t {0.f};
+            for (uint32_t c = 0; c < ChannelCount; ++c)
+            {
+                t += (block[c][i] - mean[c]) * axis[c];
+            }
+            minT = std::min(minT, t);
+            maxT = std::max(maxT, t);
+        }
+
+        Color e0 {}, e1 {};
+        for (uint32_t c = 0; c < ChannelCount; ++c)
+        {
+            e0[c] = std::clamp(mean[c] + axis[c] * maxT, 0.f, 255.f);
+            e1[c] = std::clamp(mean[c] + axis[c] * minT, 0.f, 255.f);
+        }
+        return {e0, e1};
+    }
+
+    /// @brief 固定索引时用最小二乘求两个端点，weights[i] 是第 i 个像素中第二个端点的权重
+    template <uint32_t ChannelCount>
+    static bool SolveEndpoints(const Block& block, const std::array<float, 16>& weights, Color& e0, Color& e1) noexcept
+    {
+        float aa {0.f}, ab {0.f}, bb {0.f};
+        Color ax {}, bx {};
+        for (uint32_t i = 0; i < 16; ++i)
+        {
+            auto b = weights[i];
+            auto a = 1.f - b;
+            aa += a * a;
+            ab += a * b;
+            bb += b * b;
+            for (uint32_t c = 0; c < ChannelCount; ++c)
+            {
+                ax[c] += a * block[c][i];
+                bx[c] += b * block[c][i];
+            }
+        }
+
+        auto determinant = aa * bb - ab * ab;
+        if (std::abs(determinant) < 1e-6f)
+        {
+            return false;
+        }
+
+        for (uint32_t c = 0; c < ChannelCount; ++c)
+        {
+            e0[c] = std::clamp((ax[c] * bb - bx[c] * ab) / determinant, 0.f, 255.f);
+            e1[c] = std::clamp((bx[c] * aa - ax[c] * ab) / determinant, 0.f, 255.f);
+        }
+        return true;
+    }
+
+    /// @brief 对每个像素找到误差最小的调色板颜色，返回总误差，ChannelCount 为 3（RGB）或者 4（RGBA）
+    template <uint32_t ChannelCount, size_t PaletteSize>
+    static float SelectIndices(const Block& block, const std::array<Color, PaletteSize>& palette, std::array<uint8_t, 16>& indices) noexcept
+    {
+        static_assert(3 == ChannelCount || 4 == ChannelCount);
+
+        // 索引也用 float 记录，内层循环只有 float 的比较和选择，可以向量化
+        std::array<float, 16> best {}, bestIndices {};
+        best.fill(std::numeric_limits<float>::max());
+
+        for (uint32_t j = 0; j < PaletteSize; ++j)
+        {
+            const auto& color = palette[j];
+            for (uint32_t i = 0; i < 16; ++i)
+            {
+                auto r     = block[0][i] - color[0];
+                auto g     = block[1][i] - color[1];
+                auto b     = block[2][i] - color[2];
+                auto a     = 4 == ChannelCount ? block[3][i] - color[3] : 0.f;
+                auto error = r * r + g * g + b * b + a * a;
+                bestIndices[i] = error < best[i] ? static_cast<float>(j) : bestIndices[i];
+                best[i]        = std::min(error, best[i]);
+            }
+        }
+
+        float total {0.f};
+        for (uint32_t i = 0; i < 16; ++i)
+        {
+            total += best[i];
+            indices[i] = static_cast<uint8_t>(bestIndices[i]);
+        }
+        return total;
+    }
+
+    static uint32_t GetIterationCount(Quality quality) noexcept
+    {
+        return Quality::Fast == quality ? 0 : Quality::Normal == quality ? 1 : 4;
+    }
+
+    //--------------------------------------------------------------------------------------------------------------
+    // BC1
+
+    struct Bc1Block
+    {
+        uint16_t color0 {0};
+        uint16_t color1 {0};
+        std::array<uint8_t, 16> indices {};
+        float error {std::numeric_limits<float>::max()};
+    };
+
+    static uint16_t Pack565(const Color& color) noexcept
+    {
+        auto r = static_cast<uint16_t>(std::lround(color[0] * 31.f / 255.f));
+        auto g = static_cast<uint16_t>(std::lround(color[1] * 63.f / 255.f));
+        auto b = static_cast<uint16_t>(std::lround(color[2] * 31.f / 255.f));
+        return static_cast<uint16_t>(r << 11 | g << 5 | b);
+    }
+
+    static std::array<int32_t, 3> Unpack565(uint16_t color) noexcept
+    {
+        int32_t r = color >> 11 & 31, g = color >> 5 & 63, b = color & 31;
+        return {r << 3 | r >> 2, g << 2 | g >> 4, b << 3 | b >> 2};
+    }
+
+    static std::array<std::array<int32_t, 3>, 4> Bc1Palette(uint16_t color0, uint16_t color1) noexcept
+    {
+        auto p0 = Unpack565(color0);
+        auto p1 = Unpack565(color1);
+
+        std::array<std::array<int32_t, 3>, 4> palette {p0, p1};
+        for (uint32_t c = 0; c < 3; ++c)
+        {
+            palette[2][c] = (2 * p0[c] + p1[c]) / 3;
+            palette[3][c] = (p0[c] + 2 * p1[c]) / 3;
+        }
+        return palette;
+    }
+
+    static Bc1Block QuantizeBc1(const Block& block, const Color& e0, const Color& e1) noexcept
+    {
+        Bc1Block result {};
+        result.color0 = Pack565(e0);
+        result.color1 = Pack565(e1);
+
+        // 4 色模式要求 color0 > color1，相等时只使用索引 0（3 色模式下索引 0 的颜色相同）
+        if (result.color0 < result.color1)
+        {
+            std::swap(result.color0, result.color1);
+        }
+
+        auto palette = Bc1Palette(result.color0, result.color1);
+        std::array<Color, 4> colors {};
+        for (uint32_t j = 0; j < 4; ++j)
+        {
+            colors[j] = {static_cast<float>(palette[j][0]), static_cast<float>(palette[j][1]), static_cast<float>(palette[j][2]), 0.f};
+        }
+
+        if (result.color0 == result.color1)
+        {
+            std::array<Color, 1> single {colors[0]};
+            result.error = SelectIndices<3>(block, single, result.indices);
+        }
+        else
+        {
+            result.error = SelectIndices<3>(block, colors, result.indices);
+        }
+        return result;
+    }
+
+    static void EncodeBc1(const Block& block, Quality quality, uint8_t* output) noexcept
+    {
+        auto [e0, e1] = FitEndpoints<3>(block);
+        auto best     = QuantizeBc1(block, e0, e1);
+
+        // 索引 0 ~ 3 对应的第二个端点的权重
+        static constexpr std::array<float, 4> Weights {0.f, 1.f, 1.f / 3.f, 2.f / 3.f};
+        for (uint32_t iteration = 0; iteration < GetIterationCount(quality) && best.color0 != best.color1; ++iteration)
+        {
+            std::array<float, 16> weights {};
+            for (uint32_t i = 0; i < 16; ++i)
+            {
+                weights[i] = Weights[best.indices[i]];
+            }
+
+            // 端点已经按 color0 > color1 排序，求解时使用量化之后的端点顺序
+            auto p0 = Unpack565(best.color0);
+            auto p1 = Unpack565(best.color1);
+            Color s0 {static_cast<float>(p0[0]), static_cast<float>(p0[1]), static_cast<float>(p0[2]), 0.f};
+            Color s1 {static_cast<float>(p1[0]), static_cast<float>(p1[1]), static_cast<float>(p1[2]), 0.f};
+            if (!SolveEndpoints<3>(block, weights, s0, s1))
+            {
+                break;
+            }
+
+            auto candidate = QuantizeBc1(block, s0, s1);
+            if (candidate.error >= best.error)
+            {
+                break;
+            }
+            best = candidate;
+        }
+
+        uint32_t indices {0};
+        for (uint32_t i = 0; i < 16; ++i)
+        {
+            indices |= static_cast<uint32_t>(best.indices[i]) << (i * 2);
+        }
+
+        std::memcpy(output, &best.color0, 2);
+        std::memcpy(output + 2, &best.color1, 2);
+        std::memcpy(output + 4, &indices, 4);
+    }
+
+    static void DecodeBc1(const uint8_t* input, std::array<std::array<uint8_t, 4>, 16>& texels) noexcept
+    {
+        uint16_t color0 {0}, color1 {0};
+        uint32_t indices {0};
+        std::memcpy(&color0, input, 2);
+        std::memcpy(&color1, input + 2, 2);
+        std::memcpy(&indices, input + 4, 4);
+
+        auto palette = Bc1Palette(color0, color1);
+        auto opaque  = color0 > color1;
+        if (!opaque)
+        {
+            // 3 色模式：索引 2 是两个端点的平均值，索引 3 是透明的黑色
+            auto p0 = Unpack565(color0);
+            auto p1 = Unpack565(color1);
+            for (uint32_t c = 0; c < 3; ++c)
+            {
+                palette[2][c] = (p0[c] + p1[c]) / 2;
+                palette[3][c] = 0;
+            }
+        }
+
+        for (uint32_t i = 0; i < 16; ++i)
+        {
+            auto index = indices >> (i * 2) & 3;
+            for (uint32_t c = 0; c < 3; ++c)
+            {
+                texels[i][c] = static_cast<uint8_t>(palette[index][c]);
+            }
+            texels[i][3] = opaque || 3 != index ? 255 : 0;
+        }
+    }
+
+    //--------------------------------------------------------------------------------------------------------------
+    // BC4
+
+    static std::array<int32_t, 8> Bc4Palette(int32_t value0, int32_t value1) noexcept
+    {
+        std::array<int32_t, 8> palette {value0, value1};
+        if (value0 > value1)
+        {
+            for (int32_t i = 1; i < 7; ++i)
+            {
+                palette[i + 1] = ((7 - i) * value0 + i * value1) / 7;
+            }
+        }
+        else
+        {
+            for (int32_t i = 1; i < 5; ++i)
+            {
+                palette[i + 1] = ((5 - i) * value0 + i * value1) / 5;
+            }
+            palette[6] = 0;
+            palette[7] = 255;
+        }
+        return palette;
+    }
+
+    static float SelectBc4Indices(const Channel& values, int32_t value0, int32_t value1, std::array<uint8_t, 16>& indices) noexcept
+    {
+        auto palette = Bc4Palette(value0, value1);
+
+        std::array<float, 16> best {}, bestIndices {};
+        best.fill(std::numeric_limits<float>::max());
+
+        for (uint32_t j = 0; j < 8; ++j)
+        {
+            auto value = static_cast<float>(palette[j]);
+            for (uint32_t i = 0; i < 16; ++i)
+            {
+                auto error     = (values[i] - value) * (values[i] - value);
+                bestIndices[i] = error < best[i] ? static_cast<float>(j) : bestIndices[i];
+                best[i]        = std::min(error, best[i]);
+            }
+        }
+
+        float total {0.f};
+        for (uint32_t i = 0; i < 16; ++i)
+        {
+            total += best[i];
+            indices[i] = static_cast<uint8_t>(bestIndices[i]);
+        }
+        return total;
+    }
+
+    static void EncodeBc4(const Channel& values, Quality quality, uint8_t* output) noexcept
+    {
+        auto [minIt, maxIt] = std::minmax_element(values.begin(), values.end());
+        auto minValue       = static_cast<int32_t>(*minIt);
+        auto maxValue       = static_cast<int32_t>(*maxIt);
+
+        // 8 值模式：value0 > value1，所有值相同时使用 6 值模式的索引 0
+        int32_t best0 {maxValue}, best1 {minValue};
+        std::array<uint8_t, 16> bestIndices {};
+        auto bestError = SelectBc4Indices(values, best0, best1, bestIndices);
+
+        auto tryEndpoints = [&](int32_t value0, int32_t value1) {
+            std::array<uint8_t, 16> indices {};
+            auto error = SelectBc4Indices(values, value0, value1, indices);
+            if (error < bestError)
+            {
+                bestError   = error;
+                best0       = value0;
+                best1       = value1;
+                bestIndices = indices;
+            }
+        };
+
+        if (Quality::Fast != quality && minValue != maxValue)
+        {
+            // 6 值模式可以精确表示 0 和 255，端点只需要覆盖其余的值
+            int32_t innerMin {255}, innerMax {0};
+            for (auto value : values)
+            {
+                if (value > 0.f && value < 255.f)
+                {
+                    innerMin = std::min(innerMin, static_cast<int32_t>(value));
+                    innerMax = std::max(innerMax, static_cast<int32_t>(value));
+                }
+            }
+            if (innerMin <= innerMax)
+            {
+                tryEndpoints(innerMin, innerMax);
+            }
+        }
+
+        if (Quality::High == quality && minValue != maxValue)
+        {
+            // 端点向内收缩可以让插值的颜色更接近中间的值
+            for (int32_t d0 = -2; d0 <= 2; ++d0)
+            {
+                for (int32_t d1 = -2; d1 <= 2; ++d1)
+                {
+                    auto value0 = std::clamp(maxValue + d0, 0, 255);
+                    auto value1 = std::clamp(minValue + d1, 0, 255);
+                    if (value0 > value1)
+                    {
+                        tryEndpoints(value0, value1);
+                    }
+                }
+            }
+        }
+
+        uint64_t bits {0};
+        for (uint32_t i = 0; i < 16; ++i)
+        {
+            bits |= static_cast<uint64_t>(bestIndices[i]) << (i * 3);
+        }
+
+        output[0] = static_cast<uint8_t>(best0);
+        output[1] = static_cast<uint8_t>(best1);
+        for (uint32_t i = 0; i < 6; ++i)
+        {
+            output[2 + i] = static_cast<uint8_t>(bits >> (i * 8));
+        }
+    }
+
+    static void DecodeBc4(const uint8_t* input, std::array<std::array<uint8_t, 4>, 16>& texels, uint32_t channel) noexcept
+    {
+        auto palette = Bc4Palette(input[0], input[1]);
+
+        uint64_t bits {0};
+        for (uint32_t i = 0; i < 6; ++i)
+        {
+            bits |= static_cast<uint64_t>(input[2 + i]) << (i * 8);
+        }
+
+        for (uint32_t i = 0; i < 16; ++i)
+        {
+            texels[i][channel] = static_cast<uint8_t>(palette[bits >> (i * 3) & 7]);
+        }
+    }
+
+    //--------------------------------------------------------------------------------------------------------------
+    // BC7 mode 6
+
+    struct Bc7Block
+    {
+        std::array<std::array<int32_t, 4>, 2> endpoints {}; // 7 位
+        std::array<int32_t, 2> pbits {};
+        std::array<uint8_t, 16> indices {};
+        float error {std::numeric_limits<float>::max()};
+    };
+
+    static std::array<Color, 16> Bc7Palette(const Bc7Block& block) noexcept
+    {
+        std::array<Color, 16> palette {};
+        for (uint32_t c = 0; c < 4; ++c)
+        {
+            auto value0 = block.endpoints[0][c] << 1 | block.pbits[0];
+            auto value1 = block.endpoints[1][c] << 1 | block.pbits[1];
+            for (uint32_t j = 0; j < 16; ++j)
+            {
+                palette[j][c] = static_cast<float>(((64 - Bc7Weights[j]) * value0 + Bc7Weights[j] * value1 + 32) >> 6);
+            }
+        }
+        return palette;
+    }
+
+    /// @brief 量化端点并选择索引，High 穷举 4 种 p-bit 组合，其余质量每个端点分别选择量化误差最小的 p-bit
+    static Bc7Block QuantizeBc7(const Block& block, const Color& e0, const Color& e1, Quality quality) noexcept
+    {
+        auto quantize = [](Bc7Block& candidate, uint32_t endpoint, const Color& color, int32_t pbit) {
+            float error {0.f};
+            for (uint32_t c = 0; c < 4; ++c)
+            {
+                auto value                        = std::clamp(static_cast<int32_t>((color[c] - pbit) * .5f + .5f), 0, 127);
+                auto difference                   = color[c] - static_cast<float>(value << 1 | pbit);
+                candidate.endpoints[endpoint][c] = value;
+                error += difference * difference;
+            }
+            candidate.pbits[endpoint] = pbit;
+            return error;
+        };
+
+        auto evaluate = [&](Bc7Block& candidate) {
+            candidate.error = SelectIndices<4>(block, Bc7Palette(candidate), candidate.indices);
+        };
+
+        Bc7Block best {};
+        if (Quality::High != quality)
+        {
+            Bc7Block other {};
+            for (uint32_t endpoint = 0; endpoint < 2; ++endpoint)
+            {
+                const auto& color = 0 == endpoint ? e0 : e1;
+                if (quantize(other, endpoint, color, 1) < quantize(best, endpoint, color, 0))
+                {
+                    quantize(best, endpoint, color, 1);
+                }
+            }
+            evaluate(best);
+            return best;
+        }
+
+        for (int32_t p0 = 0; p0 < 2; ++p0)
+        {
+            for (int32_t p1 = 0; p1 < 2; ++p1)
+            {
+                Bc7Block candidate {};
+                quantize(candidate, 0, e0, p0);
+                quantize(candidate, 1, e1, p1);
+                evaluate(candidate);
+                if (candidate.error < best.error)
+                {
+                    best = candidate;
+                }
+            }
+        }
+        return best;
+    }
+
+    static void EncodeBc7(const Block& block, Quality quality, uint8_t* output) noexcept
+    {
+        auto [e0, e1] = FitEndpoints<4>(block);
+        auto best     = QuantizeBc7(block, e0, e1, quality);
+
+        for (uint32_t iteration = 0; iteration < GetIterationCount(quality); ++iteration)
+        {
+            std::array<float, 16> weights {};
+            for (uint32_t i = 0; i < 16; ++i)
+            {
+                weights[i] = Bc7Weights[best.indices[i]] / 64.f;
+            }
+
+            if (!SolveEndpoints<4>(block, weights, e0, e1))
+            {
+                break;
+            }
+
+            auto candidate = QuantizeBc7(block, e0, e1, quality);
+            if (candidate.error >= best.error)
+            {
+                break;
+            }
+            best = candidate;
+        }
+
+        // 第一个像素的索引最高位隐含为 0（anchor），否则交换两个端点并翻转所有索引
+        if (best.indices[0] >= 8)
+        {
+            std::swap(best.endpoints[0], best.endpoints[1]);
+            std::swap(best.pbits[0], best.pbits[1]);
+            for (auto& index : best.indices)
+            {
+                index = static_cast<uint8_t>(15 - index);
+            }
+        }
+
+        // 从最低位开始：mode 6（7 位），R0 R1 G0 G1 B0 B1 A0 A1（各 7 位），P0 P1，索引（第一个 3 位，其余 4 位）
+        std::array<uint64_t, 2> bits {};
+        uint32_t position {0};
+        auto write = [&](uint64_t value, uint32_t count) {
+            for (uint32_t i = 0; i < count; ++i, ++position)
+            {
+                bits[position / 64] |= (value >> i & 1) << (position % 64);
+            }
+        };
+
+        write(1 << 6, 7);
+        for (uint32_t c = 0; c < 4; ++c)
+        {
+            write(best.endpoints[0][c], 7);
+            write(best.endpoints[1][c], 7);
+        }
+        write(best.pbits[0], 1);
+        write(best.pbits[1], 1);
+        for (uint32_t i = 0; i < 16; ++i)
+        {
+            write(best.indices[i], 0 == i ? 3 : 4);
+        }
+
+        std::memcpy(output, bits.data(), 16);
+    }
+
+    static void DecodeBc7(const uint8_t* input, std::array<std::array<uint8_t, 4>, 16>& texels) noexcept
+    {
+        std::array<uint64_t, 2> bits {};
+        std::memcpy(bits.data(), input, 16);
+
+        uint32_t position {0};
+        auto read = [&](uint32_t count) {
+            uint32_t value {0};
+            for (uint32_t i = 0; i < count; ++i, ++position)
+            {
+                value |= static_cast<uint32_t>(bits[position / 64] >> (position % 64) & 1) << i;
+            }
+            return value;
+        };
+
+        if (1 << 6 != read(7))
+        {
+            texels = {};
+            return;
+        }
+
+        Bc7Block block {};
+        for (uint32_t c = 0; c < 4; ++c)
+        {
+            block.endpoints[0][c] = static_cast<int32_t>(read(7));
+            block.endpoints[1][c] = static_cast<int32_t>(read(7));
+        }
+        block.pbits = {static_cast<int32_t>(read(1)), static_cast<int32_t>(read(1))};
+
+        auto palette = Bc7Palette(block);
+        for (uint32_t i = 0; i < 16; ++i)
+        {
+            auto index = read(0 == i ? 3 : 4);
+            for (uint32_t c = 0; c < 4; ++c)
+            {
+                texels[i][c] = static_cast<uint8_t>(palette[index][c]);
+            }
+        }
+    }
+};
@@ -0,0 +1,160 @@
+#pragma once
+
+#include <cstddef>
+#include <cstdio>
+#include <fstream>
+#include <span>
+#include <stdexcept>
+#include <string>
+
+#if defined(_WIN32)
+#ifndef NOMINMAX
+#define NOMINMAX
+#endif
+#include <Windows.h>
+#else
+#include <fcntl.h>
+#include <sys/mman.h>
+#include <sys/stat.h>
+#include <unistd.h>
+#endif
+
+/// @brief 以只读方式把整个文件映射到内存，cook 之后的网格和纹理文件共用，关闭之后映射的内存失效
+class MappedFile
+{
+public:
+    MappedFile() = default;
+
+    ~MappedFile() noexcept
+    {
+        Close();
+    }
+
+    MappedFile(const MappedFile&)            = delete;
+    MappedFile& operator=(const MappedFile&) = delete;
+
+    /// @brief 文件不存在或者为空时返回 false
+    bool Open(const std::string& fileName)
+    {
+        Close();
+
+#if defined(_WIN32)
+        m_file = CreateFileA(fileName.c_str(), GENERIC_READ, FILE_SHARE_READ, nullptr, OPEN_EXISTING, FILE_FLAG_SEQUENTIAL_SCAN, nullptr);
+        if (INVALID_HANDLE_VALUE == m_file)
+        {
+            m_file = nullptr;
+            return false;
+        }
+
+        LARGE_INTEGER size {};
+        if (!GetFileSizeEx(m_file, &size) || 0 == size.QuadPart)
+        {
+            Close();
+            return false;
+        }
+        m_size = static_cast<size_t>(size.QuadPart);
+
+        m_mapping = CreateFileMappingA(m_file, nullptr, PAGE_READONLY, 0, 0, nullptr);
+        m_data    = m_mapping ? MapViewOfFile(m_mapping, FILE_MAP_READ, 0, 0, 0) : nullptr;
+#else
+        auto fd = ::open(fileName.c_str(), O_RDONLY);
+        if (fd < 0)
+        {
+            return false;
+        }
+
+        struct stat status {};
+        if (0 != fstat(fd, &status) || 0 == status.st_size)
+        {
+            ::close(fd);
+            return false;
+        }
+        m_size = static_cast<size_t>(status.st_size);
+
+        // 映射之后文件描述符就可以关闭
+        auto data = mmap(nullptr, m_size, PROT_READ, MAP_PRIVATE, fd, 0);
+        ::close(fd);
+
+        m_data = MAP_FAILED == data ? nullptr : data;
+        if (m_data)
+        {
+            // 所有的数据都会被顺序复制一次，提前读入
+            madvise(m_data, m_size, MADV_WILLNEED);
+        }
+#endif
+
+        if (!m_data)
+        {
+            Close();
+            return false;
+        }
+
+        return true;
+    }
+
+    void Close() noexcept
+    {
+#if defined(_WIN32)
+        if (m_data)
+        {
+            UnmapViewOfFile(m_data);
+        }
+        if (m_mapping)
+        {
+            CloseHandle(m_mapping);
+        }
+        if (m_file && INVALID_HANDLE_VALUE != m_file)
+        {
+            CloseHandle(m_file);
+        }
+        m_file    = nullptr;
+        m_mapping = nullptr;
+#else
+        if (m_data)
+        {
+            munmap(m_data, m_size);
+        }
+#endif
+        m_data = nullptr;
+        m_size = 0;
+    }
+
+    const std::byte* GetData() const noexcept
+    {
+        return static_cast<const std::byte*>(m_data);
+    }
+
+    size_t GetSize() const noexcept
+    {
+        return m_size;
+    }
+
+    /// @brief 先写入临时文件再替换，写入过程中退出不会留下损坏的文件
+    static void Write(const std::string& fileName, std::span<const std::byte> data)
+    {
+        auto tempName = fileName + ".tmp";
+        {
+            std::ofstream file(tempName, std::ios::binary | std::ios::trunc);
+            if (!file.is_open())
+            {
+                throw std::runtime_error("failed to open file: " + tempName);
+            }
+            file.write(reinterpret_cast<const char*>(data.data()), static_cast<std::streamsize>(data.size()));
+        }
+
+        std::remove(fileName.c_str());
+        if (0 != std::rename(tempName.c_str(), fileName.c_str()))
+        {
+            throw std::runtime_error("failed to write file: " + fileName);
+        }
+    }
+
+private:
+    void* m_data {nullptr};
+    size_t m_size {0};
+
+#if defined(_WIN32)
+    HANDLE m_file {nullptr};
+    HANDLE m_mapping {nullptr};
+#endif
+};
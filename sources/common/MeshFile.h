@@ -0,0 +1,230 @@
+#pragma once
+
+#include "MappedFile.h"
+#include "MeshOptimizer.h"
+#include "VertexWelder.h"
+
+// tiny_obj_loader.h 的实现部分没有包含保护，示例定义 TINYOBJLOADER_IMPLEMENTATION 并包含之后不能再次包含
+#ifndef TINY_OBJ_LOADER_H_
+#include <tiny_obj_loader.h>
+#endif
+
+#include <algorithm>
+#include <array>
+#include <cstddef>
+#include <cstdint>
+#include <cstring>
+#include <limits>
+#include <span>
+#include <stdexcept>
+#include <string>
+#include <vector>
+
+/// @brief 预处理（cook）之后的二进制网格文件头，所有数据按小端存储
+/// @details 文件布局：[MeshFileHeader][顶点数据][索引数据]，每一段的起始位置按 Alignment 对齐
+///          顶点数据和示例中的 Vertex 结构完全一致，加载时不需要解析，直接从映射的内存复制到暂存缓冲
+struct MeshFileHeader
+{
+    static inline constexpr uint32_t Magic {0x4853454d}; // "MESH"
+    static inline constexpr uint32_t Version {2}; // 2: cook 时对三角形和顶点重新排序
+    static inline constexpr uint64_t Alignment {64};
+
+    uint32_t magic {Magic};
+    uint32_t version {Version};
+    uint32_t vertexStride {0}; // sizeof(Vertex)，和加载时的 Vertex 不一致说明文件已经过期
+    uint32_t indexSize {sizeof(uint32_t)};
+    uint64_t vertexCount {0};
+    uint64_t indexCount {0};
+    uint64_t vertexOffset {0};
+    uint64_t indexOffset {0};
+    uint64_t fileSize {0};
+    std::array<float, 3> boundsMin {};
+    std::array<float, 3> boundsMax {};
+};
+
+static_assert(sizeof(MeshFileHeader) % 8 == 0);
+
+/// @brief 以只读方式把二进制网格文件映射到内存，顶点和索引直接指向映射的内存，关闭之后失效
+class MeshFile
+{
+public:
+    /// @brief 文件不存在、格式或者版本不一致时返回 false，调用者需要重新 cook
+    bool Open(const std::string& fileName, uint32_t vertexStride)
+    {
+        if (!m_file.Open(fileName))
+        {
+            return false;
+        }
+
+        auto size = m_file.GetSize();
+        if (size < sizeof(MeshFileHeader))
+        {
+            Close();
+            return false;
+        }
+
+        const auto& header = GetHeader();
+        if (MeshFileHeader::Magic != header.magic || MeshFileHeader::Version != header.version || vertexStride != header.vertexStride
+            || sizeof(uint32_t) != header.indexSize || size != header.fileSize
+            || header.vertexOffset + header.vertexCount * header.vertexStride > size
+            || header.indexOffset + header.indexCount * header.indexSize > size)
+        {
+            Close();
+            return false;
+        }
+
+        return true;
+    }
+
+    void Close() noexcept
+    {
+        m_file.Close();
+    }
+
+    const MeshFileHeader& GetHeader() const noexcept
+    {
+        return *reinterpret_cast<const MeshFileHeader*>(m_file.GetData());
+    }
+
+    template <typename VertexType>
+    std::span<const VertexType> GetVertices() const noexcept
+    {
+        const auto& header = GetHeader();
+        return {reinterpret_cast<const VertexType*>(m_file.GetData() + header.vertexOffset), header.vertexCount};
+    }
+
+    std::span<const uint32_t> GetIndices() const noexcept
+    {
+        const auto& header = GetHeader();
+        return {reinterpret_cast<const uint32_t*>(m_file.GetData() + header.indexOffset), header.indexCount};
+    }
+
+    /// @brief cook：把已经去重的顶点和索引按照文件布局写入磁盘
+    template <typename VertexType>
+    static void Write(
+        const std::string& fileName,
+        std::span<const VertexType> vertices,
+        std::span<const uint32_t> indices,
+        const std::array<float, 3>& boundsMin,
+        const std::array<float, 3>& boundsMax
+    )
+    {
+        MeshFileHeader header {};
+        header.vertexStride = static_cast<uint32_t>(sizeof(VertexType));
+        header.vertexCount  = vertices.size();
+        header.indexCount   = indices.size();
+        header.vertexOffset = AlignUp(sizeof(MeshFileHeader));
+        header.indexOffset  = AlignUp(header.vertexOffset + vertices.size_bytes());
+        header.fileSize     = header.indexOffset + indices.size_bytes();
+        header.boundsMin    = boundsMin;
+        header.boundsMax    = boundsMax;
+
+        std::vector<std::byte> data(header.fileSize);
+        std::memcpy(data.data(), &header, sizeof(header));
+        std::memcpy(data.data() + header.vertexOffset, vertices.data(), vertices.size_bytes());
+        std::memcpy(data.data() + header.indexOffset, indices.data(), indices.size_bytes());
+
+        MappedFile::Write(fileName, data);
+    }
+
+    /// @brief 重新排序前后的顶点缓存和顶点读取统计，由调用者决定是否输出
+    struct CookStatistics
+    {
+        MeshOptimizer::VertexCacheStatistics cacheBefore {};
+        MeshOptimizer::VertexCacheStatistics cacheAfter {};
+        MeshOptimizer::VertexFetchStatistics fetchBefore {};
+        MeshOptimizer::VertexFetchStatistics fetchAfter {};
+    };
+
+    /// @brief 离线预处理：解析 obj 并对顶点去重、重新排序，结果按照 GPU 使用的布局写入二进制网格文件
+    /// @details VertexType 需要 pos、texCoord、color 三个成员，没有三角形的 obj 抛出异常
+    template <typename VertexType>
+    static CookStatistics Cook(const std::string& objName, const std::string& cookedName)
+    {
+        tinyobj::attrib_t attrib {};
+        std::vector<tinyobj::shape_t> shapes {};
+        std::vector<tinyobj::material_t> materials {};
+        std::string warn {}, err {};
+
+        if (!tinyobj::LoadObj(&attrib, &shapes, &materials, &warn, &err, objName.c_str()))
+        {
+            throw std::runtime_error(warn + err);
+        }
+
+        // 每个三角形的每个角一个顶点，焊接之后得到去重的顶点和索引
+        size_t cornerCount {0};
+        for (const auto& shape : shapes)
+        {
+            cornerCount += shape.mesh.indices.size();
+        }
+
+        if (0 == cornerCount)
+        {
+            throw std::runtime_error("mesh has no triangles: " + objName);
+        }
+
+        std::vector<VertexType> corners {};
+        corners.reserve(cornerCount);
+        for (const auto& shape : shapes)
+        {
+            for (const auto& index : shape.mesh.indices)
+            {
+                VertexType vertex {};
+
+                vertex.pos = {
+                    attrib.vertices[3 * index.vertex_index + 0],
+                    attrib.vertices[3 * index.vertex_index + 1],
+                    attrib.vertices[3 * index.vertex_index + 2]
+                };
+
+                vertex.texCoord = {attrib.texcoords[2 * index.texcoord_index + 0], 1.0f - attrib.texcoords[2 * index.texcoord_index + 1]};
+
+                vertex.color = {1.0f, 1.0f, 1.0f};
+
+                corners.push_back(vertex);
+            }
+        }
+
+        std::vector<VertexType> vertices {};
+        std::vector<uint32_t> indices {};
+        VertexWelder::Weld<VertexType>(corners, vertices, indices);
+
+        std::array<float, 3> boundsMin {};
+        std::array<float, 3> boundsMax {};
+        boundsMin.fill(std::numeric_limits<float>::max());
+        boundsMax.fill(std::numeric_limits<float>::lowest());
+        for (const auto& vertex : vertices)
+        {
+            for (int i = 0; i < 3; ++i)
+            {
+                boundsMin[i] = std::min(boundsMin[i], vertex.pos[i]);
+                boundsMax[i] = std::max(boundsMax[i], vertex.pos[i]);
+            }
+        }
+
+        // 顶点缓存 => 过度绘制 => 顶点读取，每一步都依赖上一步的顺序
+        CookStatistics statistics {};
+        statistics.cacheBefore = MeshOptimizer::AnalyzeVertexCache(indices, vertices.size());
+        statistics.fetchBefore = MeshOptimizer::AnalyzeVertexFetch(indices, vertices.size(), sizeof(VertexType));
+
+        std::vector<uint32_t> clusters {};
+        indices = MeshOptimizer::OptimizeVertexCache(indices, vertices.size(), MeshOptimizer::DefaultCacheSize, &clusters);
+        indices = MeshOptimizer::OptimizeOverdraw(indices, clusters, &vertices.front().pos.x, sizeof(VertexType));
+        MeshOptimizer::OptimizeVertexFetch(indices, vertices);
+
+        statistics.cacheAfter = MeshOptimizer::AnalyzeVertexCache(indices, vertices.size());
+        statistics.fetchAfter = MeshOptimizer::AnalyzeVertexFetch(indices, vertices.size(), sizeof(VertexType));
+
+        Write<VertexType>(cookedName, vertices, indices, boundsMin, boundsMax);
+        return statistics;
+    }
+
+private:
+    static constexpr uint64_t AlignUp(uint64_t size) noexcept
+    {
+        return (size + MeshFileHeader::Alignment - 1) & ~(MeshFileHeader::Alignment - 1);
+    }
+
+private:
+    MappedFile m_file {};
+};
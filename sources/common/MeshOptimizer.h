@@ -0,0 +1,456 @@
+#pragma once
+
+#include <algorithm>
+#include <array>
+#include <cmath>
+#include <cstddef>
+#include <cstdint>
+#include <numeric>
+#include <span>
+#include <vector>
+
+/// @brief 导入或者 cook 时对三角形列表重新排序，只改变三角形和顶点的顺序，不改变网格本身
+/// @details 1. OptimizeVertexCache：Tipsify（Sander 2007），提高顶点着色结果（post-transform cache）的命中率
+///          2. OptimizeOverdraw：把 Tipsify 的结果分成若干簇，朝外的簇先绘制，减少被遮挡的片段
+///          3. OptimizeVertexFetch：按照第一次使用的顺序重新排列顶点，读取顶点时相邻的索引落在相同的缓存行
+///          三个步骤必须按照这个顺序执行，后面的步骤不会破坏前面步骤的结果
+class MeshOptimizer
+{
+public:
+    static inline constexpr uint32_t DefaultCacheSize {16};
+
+    struct VertexCacheStatistics
+    {
+        float acmr {0.f}; // 平均每个三角形的缓存未命中次数，范围 [0.5, 3]
+        float atvr {0.f}; // 平均每个顶点被着色的次数，最优为 1
+    };
+
+    struct VertexFetchStatistics
+    {
+        uint64_t bytesFetched {0};
+        float overfetch {0.f}; // 读取的字节数 / 顶点数据的大小，最优为 1
+    };
+
+    /// @brief Tipsify，线性时间，返回重新排序之后的索引
+    /// @param clusters 不为空时写入每一簇的第一个三角形，簇在顶点缓存中走入死胡同（需要跳转）的位置结束
+    static std::vector<uint32_t> OptimizeVertexCache(
+        std::span<const uint32_t> indices, size_t vertexCount, uint32_t cacheSize = DefaultCacheSize, std::vector<uint32_t>* clusters = nullptr
+    )
+    {
+        auto triangleCount = indices.size() / 3;
+
+        // 顶点 => 使用该顶点的三角形
+        std::vector<uint32_t> offsets(vertexCount + 1, 0);
+        for (auto index : indices)
+        {
+            offsets[index + 1]++;
+        }
+        std::partial_sum(offsets.begin(), offsets.end(), offsets.begin());
+
+        std::vector<uint32_t> adjacency(indices.size());
+        std::vector<uint32_t> fill(offsets.begin(), offsets.end() - 1);
+        for (uint32_t i = 0; i < indices.size(); ++i)
+        {
+            adjacency[fill[indices[i]]++] = i / 3;
+        }
+
+        std::vector<uint32_t> liveCount(vertexCount, 0);
+        for (size_t v = 0; v < vertexCount; ++v)
+        {
+            liveCount[v] = offsets[v + 1] - offsets[v];
+        }
+
+        std::vector<uint32_t> cacheTime(vertexCount, 0);
+        std::vector<bool> emitted(triangleCount, false);
+        std::vector<uint32_t> deadEnd {};
+        std::vector<uint32_t> candidates {};
+
+        std::vector<uint32_t> result {};
+        result.reserve(triangleCount * 3);
+
+        uint32_t time {cacheSize + 1};
+        size_t cursor {0};
+        int64_t fanning = vertexCount > 0 ? 0 : -1;
+
+        // 没有剩余三角形的顶点之后，从死胡同栈或者按顺序找下一个顶点
+        auto skipDeadEnd = [&]() -> int64_t {
+            while (!deadEnd.empty())
+            {
+                auto vertex = deadEnd.back();
+                deadEnd.pop_back();
+                if (liveCount[vertex] > 0)
+                {
+                    return vertex;
+                }
+            }
+
+            while (cursor < vertexCount)
+            {
+                if (liveCount[cursor] > 0)
+                {
+                    return static_cast<int64_t>(cursor);
+                }
+                ++cursor;
+            }
+
+            return -1;
+        };
+
+        if (clusters)
+        {
+            clusters->assign(1, 0);
+        }
+
+        while (fanning >= 0)
+        {
+            candidates.clear();
+
+            for (auto k = offsets[fanning]; k < offsets[fanning + 1]; ++k)
+            {
+                auto triangle = adjacency[k];
+                if (emitted[triangle])
+                {
+                    continue;
+                }
+
+                for (uint32_t j = 0; j < 3; ++j)
+                {
+                    auto vertex = indices[triangle * 3 + j];
+                    result.emplace_back(vertex);
+                    deadEnd.emplace_back(vertex);
+                    candidates.emplace_back(vertex);
+                    liveCount[vertex]--;
+
+                    if (time - cacheTime[vertex] > cacheSize)
+                    {
+                        cacheTime[vertex] = time++;
+                    }
+                }
+
+                emitted[triangle] = true;
+            }
+
+            // 选择仍然在缓存中、并且剩余三角形处理完之后不会被挤出缓存的顶点里最早进入缓存的一个
+            int64_t next {-1};
+            uint32_t best {0};
+            for (auto vertex : candidates)
+            {
+                if (0 == liveCount[vertex])
+                {
+                    continue;
+                }
+
+                uint32_t priority {0};
+                if (time - cacheTime[vertex] + 2 * liveCount[vertex] <= cacheSize)
+                {
+                    priority = time - cacheTime[vertex];
+                }
+
+                if (priority > best)
+                {
+                    best = priority;
+                    next = vertex;
+                }
+            }
+
+            if (next < 0)
+            {
+                next = skipDeadEnd();
+
+                if (clusters && next >= 0 && clusters->back() != result.size() / 3)
+                {
+                    clusters->emplace_back(static_cast<uint32_t>(result.size() / 3));
+                }
+            }
+
+            fanning = next;
+        }
+
+        return result;
+    }
+
+    /// @brief 按照簇重新排列三角形，朝向网格外侧的簇先绘制，之后绘制的簇更多地被深度测试剔除
+    /// @details Tipsify 的簇较大时，再根据缓存的命中率细分（缓存命中率不低于整簇的 threshold 倍时切分），细分不会明显增加 ACMR
+    /// @param positions 第一个顶点位置的指针，每个位置是 3 个 float
+    /// @param stride 相邻两个顶点的位置之间的字节数
+    static std::vector<uint32_t> OptimizeOverdraw(
+        std::span<const uint32_t> indices,
+        const std::vector<uint32_t>& clusters,
+        const float* positions,
+        size_t stride,
+        float threshold    = 1.05f,
+        uint32_t cacheSize = DefaultCacheSize
+    )
+    {
+        auto triangleCount = static_cast<uint32_t>(indices.size() / 3);
+        if (0 == triangleCount)
+        {
+            return {indices.begin(), indices.end()};
+        }
+
+        auto position = [positions, stride](uint32_t vertex) {
+            auto p = reinterpret_cast<const float*>(reinterpret_cast<const std::byte*>(positions) + vertex * stride);
+            return std::array<float, 3> {p[0], p[1], p[2]};
+        };
+
+        auto splits = SplitClusters(indices, clusters, triangleCount, threshold, cacheSize);
+
+        // 整个网格的中心（按三角形面积加权）
+        std::array<double, 3> meshCenter {};
+        double meshArea {0.0};
+
+        struct Cluster
+        {
+            uint32_t first {0};
+            uint32_t count {0};
+            std::array<double, 3> center {};
+            std::array<double, 3> normal {};
+            double area {0.0};
+            double sortKey {0.0};
+        };
+
+        std::vector<Cluster> result(splits.size());
+        for (size_t c = 0; c < splits.size(); ++c)
+        {
+            auto& cluster = result[c];
+            cluster.first = splits[c];
+            cluster.count = (c + 1 < splits.size() ? splits[c + 1] : triangleCount) - splits[c];
+
+            for (auto t = cluster.first; t < cluster.first + cluster.count; ++t)
+            {
+                auto a = position(indices[t * 3]);
+                auto b = position(indices[t * 3 + 1]);
+                auto d = position(indices[t * 3 + 2]);
+
+                std::array<double, 3> e1 {b[0] - a[0], b[1] - a[1], b[2] - a[2]};
+                std::array<double, 3> e2 {d[0] - a[0], d[1] - a[1], d[2] - a[2]};
+                std::array<double, 3> n {e1[1] * e2[2] - e1[2] * e2[1], e1[2] * e2[0] - e1[0] * e2[2], e1[0] * e2[1] - e1[1] * e2[0]};
+                auto area = std::sqrt(n[0] * n[0] + n[1] * n[1] + n[2] * n[2]) * 0.5;
+
+                for (size_t k = 0; k < 3; ++k)
+                {
+                    auto centroid = (a[k] + b[k] + d[k]) / 3.0;
+                    cluster.center[k] += centroid * area;
+                    cluster.normal[k] += n[k];
+                    meshCenter[k] += centroid * area;
+                }
+
+                cluster.area += area;
+                meshArea += area;
+            }
+        }
+
+        for (auto& value : meshCenter)
+        {
+            value = meshArea > 0.0 ? value / meshArea : 0.0;
+        }
+
+        for (auto& cluster : result)
+        {
+            auto length = std::sqrt(
+                cluster.normal[0] * cluster.normal[0] + cluster.normal[1] * cluster.normal[1] + cluster.normal[2] * cluster.normal[2]
+            );
+
+            for (size_t k = 0; k < 3; ++k)
+            {
+                auto center = cluster.area > 0.0 ? cluster.center[k] / cluster.area : 0.0;
+                auto normal = length > 0.0 ? cluster.normal[k] / length : 0.0;
+                cluster.sortKey += (center - meshCenter[k]) * normal;
+            }
+        }
+
+        std::stable_sort(result.begin(), result.end(), [](const Cluster& a, const Cluster& b) { return a.sortKey > b.sortKey; });
+
+        std::vector<uint32_t> reordered {};
+        reordered.reserve(indices.size());
+        for (const auto& cluster : result)
+        {
+            reordered.insert(reordered.end(), indices.begin() + cluster.first * 3, indices.begin() + (cluster.first + cluster.count) * 3);
+        }
+
+        return reordered;
+    }
+
+    /// @brief 按照索引中第一次出现的顺序重新排列顶点，同时更新索引，没有被使用的顶点被删除
+    /// @return 新的顶点个数
+    template <typename VertexType>
+    static size_t OptimizeVertexFetch(std::vector<uint32_t>& indices, std::vector<VertexType>& vertices)
+    {
+        constexpr auto Unused = ~0u;
+
+        std::vector<uint32_t> remap(vertices.size(), Unused);
+        std::vector<VertexType> reordered {};
+        reordered.reserve(vertices.size());
+
+        for (auto& index : indices)
+        {
+            if (Unused == remap[index])
+            {
+                remap[index] = static_cast<uint32_t>(reordered.size());
+                reordered.emplace_back(vertices[index]);
+            }
+            index = remap[index];
+        }
+
+        vertices = std::move(reordered);
+        return vertices.size();
+    }
+
+    /// @brief 模拟 FIFO 的顶点缓存
+    static VertexCacheStatistics AnalyzeVertexCache(std::span<const uint32_t> indices, size_t vertexCount, uint32_t cacheSize = DefaultCacheSize)
+    {
+        VertexCacheStatistics statistics {};
+        if (indices.empty() || 0 == vertexCount)
+        {
+            return statistics;
+        }
+
+        std::vector<uint32_t> cacheTime(vertexCount, 0);
+        uint32_t time {cacheSize + 1};
+        uint64_t misses {0};
+
+        for (auto index : indices)
+        {
+            if (time - cacheTime[index] > cacheSize)
+            {
+                cacheTime[index] = time++;
+                misses++;
+            }
+        }
+
+        statistics.acmr = static_cast<float>(misses) / static_cast<float>(indices.size() / 3);
+        statistics.atvr = static_cast<float>(misses) / static_cast<float>(vertexCount);
+        return statistics;
+    }
+
+    /// @brief 顶点缓存未命中时从显存读取顶点，按 64 字节的缓存行统计读取的字节数，缓存行使用 LRU 替换
+    static VertexFetchStatistics AnalyzeVertexFetch(
+        std::span<const uint32_t> indices, size_t vertexCount, size_t vertexSize, uint32_t cacheSize = DefaultCacheSize
+    )
+    {
+        constexpr size_t LineSize {64};
+        constexpr size_t LineCount {64};
+
+        VertexFetchStatistics statistics {};
+        if (indices.empty() || 0 == vertexCount)
+        {
+            return statistics;
+        }
+
+        std::vector<uint32_t> cacheTime(vertexCount, 0);
+        uint32_t time {cacheSize + 1};
+
+        std::vector<bool> used(vertexCount, false);
+        std::vector<std::pair<size_t, uint64_t>> lines {}; // 缓存行号，最近一次使用的时间
+        uint64_t lineTime {0};
+
+        for (auto index : indices)
+        {
+            used[index] = true;
+            if (time - cacheTime[index] <= cacheSize)
+            {
+                continue;
+            }
+            cacheTime[index] = time++;
+
+            auto first = index * vertexSize / LineSize;
+            auto last  = ((index + 1) * vertexSize - 1) / LineSize;
+            for (auto line = first; line <= last; ++line)
+            {
+                auto it = std::find_if(lines.begin(), lines.end(), [line](const auto& entry) { return entry.first == line; });
+                if (lines.end() != it)
+                {
+                    it->second = ++lineTime;
+                    continue;
+                }
+
+                statistics.bytesFetched += LineSize;
+                if (lines.size() < LineCount)
+                {
+                    lines.emplace_back(line, ++lineTime);
+                }
+                else
+                {
+                    *std::min_element(lines.begin(), lines.end(), [](const auto& a, const auto& b) { return a.second < b.second; }) = {
+                        line, ++lineTime
+                    };
+                }
+            }
+        }
+
+        auto usedBytes = static_cast<uint64_t>(std::count(used.begin(), used.end(), true)) * vertexSize;
+        statistics.overfetch = static_cast<float>(statistics.bytesFetched) / static_cast<float>(usedBytes);
+        return statistics;
+    }
+
+private:
+    /// @brief 在 Tipsify 的簇内部继续切分：从簇的开始模拟顶点缓存，局部的 ACMR 不高于整簇的 threshold 倍时切分并清空缓存
+    static std::vector<uint32_t> SplitClusters(
+        std::span<const uint32_t> indices, const std::vector<uint32_t>& clusters, uint32_t triangleCount, float threshold, uint32_t cacheSize
+    )
+    {
+        std::vector<uint32_t> hard = clusters.empty() ? std::vector<uint32_t> {0} : clusters;
+
+        uint32_t maxIndex {0};
+        for (auto index : indices)
+        {
+            maxIndex = std::max(maxIndex, index);
+        }
+
+        std::vector<uint32_t> cacheTime(static_cast<size_t>(maxIndex) + 1, 0);
+        uint32_t time {cacheSize + 1};
+
+        // 返回一个三角形的顶点缓存未命中次数
+        auto simulate = [&](uint32_t triangle) {
+            uint32_t misses {0};
+            for (uint32_t j = 0; j < 3; ++j)
+            {
+                auto index = indices[triangle * 3 + j];
+                if (time - cacheTime[index] > cacheSize)
+                {
+                    cacheTime[index] = time++;
+                    misses++;
+                }
+            }
+            return misses;
+        };
+
+        // 时间向前跳过缓存大小，相当于清空缓存
+        auto flush = [&]() { time += cacheSize + 1; };
+
+        std::vector<uint32_t> result {};
+        for (size_t c = 0; c < hard.size(); ++c)
+        {
+            auto first = hard[c];
+            auto last  = c + 1 < hard.size() ? hard[c + 1] : triangleCount;
+
+            flush();
+            uint32_t clusterMisses {0};
+            for (auto t = first; t < last; ++t)
+            {
+                clusterMisses += simulate(t);
+            }
+            auto clusterAcmr = static_cast<float>(clusterMisses) / static_cast<float>(last - first);
+
+            flush();
+            result.emplace_back(first);
+
+            uint32_t start {first};
+            uint32_t misses {0};
+            for (auto t = first; t < last; ++t)
+            {
+                misses += simulate(t);
+
+                if (t + 1 < last && static_cast<float>(misses) / static_cast<float>(t + 1 - start) <= clusterAcmr * threshold)
+                {
+                    result.emplace_back(t + 1);
+                    start  = t + 1;
+                    misses = 0;
+                    flush();
+                }
+            }
+        }
+
+        return result;
+    }
+};
@@ -0,0 +1,476 @@
+#pragma once
+
+#include <algorithm>
+#include <array>
+#include <cmath>
+#include <cstddef>
+#include <cstdint>
+#include <limits>
+#include <numeric>
+#include <queue>
+#include <span>
+#include <vector>
+
+/// @brief 导入时生成网格的 LOD 链：二次误差度量（Garland-Heckbert 1997）的边折叠简化
+/// @details 1. 位置相同的顶点（纹理坐标或者法线不同的接缝）看作同一个位置，每个位置累加相邻三角形平面的二次误差（按面积加权）
+///          2. 边折叠只把一个顶点移动到边的另一个端点上，不产生新的顶点，所有 LOD 共用原始的顶点缓冲，只有索引不同
+///          3. 网格的边界、接缝以及非流形的边上的顶点不移动，保证 LOD 之间没有裂缝、纹理不会错位
+///          4. 误差是折叠之后的顶点到原始网格平面的均方根距离，和模型使用相同的单位，运行时投影到屏幕上选择 LOD
+class MeshSimplifier
+{
+public:
+    struct Lod
+    {
+        std::vector<uint32_t> indices {};
+        float error {0.f}; // 相对于原始网格的几何误差，单位和顶点位置相同
+    };
+
+    struct LodOptions
+    {
+        float ratio {.5f};              // 每一级的目标三角形个数是上一级的比例
+        uint32_t maxLodCount {6};       // 包括原始网格
+        uint32_t minTriangleCount {32}; // 三角形个数少于这个值时不再生成下一级
+        float maxError {std::numeric_limits<float>::max()};
+        float minReduction {.1f}; // 三角形个数减少的比例小于这个值时停止，通常是剩余的顶点都被锁定
+    };
+
+    /// @brief 简化到不超过 targetIndexCount 个索引，或者下一次折叠的误差超过 targetError
+    /// @param positions 第一个顶点位置的指针，每个位置是 3 个 float
+    /// @param stride 相邻两个顶点的位置之间的字节数
+    /// @param resultError 不为空时写入简化之后的误差
+    static std::vector<uint32_t> Simplify(
+        std::span<const uint32_t> indices,
+        const float* positions,
+        size_t vertexCount,
+        size_t stride,
+        size_t targetIndexCount,
+        float targetError  = std::numeric_limits<float>::max(),
+        float* resultError = nullptr
+    )
+    {
+        std::vector<uint32_t> result {};
+        float error {0.f};
+
+        const std::array targets {targetIndexCount};
+        SimplifyProgressive(indices, positions, vertexCount, stride, targets, targetError, [&](std::vector<uint32_t>&& lodIndices, float lodError) {
+            result = std::move(lodIndices);
+            error  = lodError;
+        });
+
+        if (resultError)
+        {
+            *resultError = error;
+        }
+
+        return result;
+    }
+
+    static std::vector<Lod> BuildLodChain(std::span<const uint32_t> indices, const float* positions, size_t vertexCount, size_t stride)
+    {
+        return BuildLodChain(indices, positions, vertexCount, stride, LodOptions {});
+    }
+
+    /// @brief 第 0 级是原始的索引，之后每一级的三角形个数是上一级的 ratio 倍，误差单调递增
+    /// @details 贪心的折叠顺序是确定的，简化到更少的三角形只是在同一个序列上继续折叠，所以所有的级别在一次简化中依次输出，
+    ///          结果和每一级都从原始网格单独简化相同，耗时和简化一次相同
+    static std::vector<Lod> BuildLodChain(
+        std::span<const uint32_t> indices, const float* positions, size_t vertexCount, size_t stride, const LodOptions& options
+    )
+    {
+        std::vector<Lod> lods {};
+        lods.emplace_back(Lod {{indices.begin(), indices.end()}, 0.f});
+
+        std::vector<size_t> targets {};
+        auto triangleCount = indices.size() / 3;
+        while (targets.size() + 1 < options.maxLodCount && triangleCount >= options.minTriangleCount)
+        {
+            triangleCount = static_cast<size_t>(static_cast<float>(triangleCount) * options.ratio);
+            targets.emplace_back(triangleCount * 3);
+        }
+
+        SimplifyProgressive(indices, positions, vertexCount, stride, targets, options.maxError, [&](std::vector<uint32_t>&& lodIndices, float error) {
+            const auto& previous = lods.back();
+            if (lodIndices.empty()
+                || static_cast<float>(lodIndices.size()) > static_cast<float>(previous.indices.size()) * (1.f - options.minReduction))
+            {
+                return;
+            }
+
+            lods.emplace_back(Lod {std::move(lodIndices), std::max(error, previous.error)});
+        });
+
+        return lods;
+    }
+
+private:
+    /// @brief 按误差从小到大折叠，三角形个数依次不超过 targetIndexCounts 中的每一个值时调用一次 output(indices, error)
+    ///        误差超过 targetError 或者没有可以折叠的边时，输出当前的结果之后结束
+    template <typename Function>
+    static void SimplifyProgressive(
+        std::span<const uint32_t> indices,
+        const float* positions,
+        size_t vertexCount,
+        size_t stride,
+        std::span<const size_t> targetIndexCounts,
+        float targetError,
+        const Function& output
+    )
+    {
+        auto position = [positions, stride](uint32_t vertex) {
+            auto p = reinterpret_cast<const float*>(reinterpret_cast<const std::byte*>(positions) + vertex * stride);
+            return std::array<double, 3> {p[0], p[1], p[2]};
+        };
+
+        // 位置相同的顶点合并为一个位置
+        std::vector<uint32_t> sorted(vertexCount);
+        std::iota(sorted.begin(), sorted.end(), 0u);
+        std::ranges::sort(sorted, [&position](uint32_t a, uint32_t b) { return position(a) < position(b); });
+
+        std::vector<uint32_t> positionIds(vertexCount, 0);
+        std::vector<uint32_t> wedgeCount {};
+        std::vector<uint32_t> representatives {}; // 每个位置的任意一个顶点，只用来读取位置
+        for (size_t i = 0; i < vertexCount; ++i)
+        {
+            if (0 == i || position(sorted[i]) != position(sorted[i - 1]))
+            {
+                wedgeCount.emplace_back(0);
+                representatives.emplace_back(sorted[i]);
+            }
+            positionIds[sorted[i]] = static_cast<uint32_t>(wedgeCount.size() - 1);
+            ++wedgeCount.back();
+        }
+        auto positionCount = wedgeCount.size();
+
+        std::vector<std::array<uint32_t, 3>> triangles {};
+        triangles.reserve(indices.size() / 3);
+        for (size_t i = 0; i + 2 < indices.size(); i += 3)
+        {
+            std::array<uint32_t, 3> triangle {indices[i], indices[i + 1], indices[i + 2]};
+            auto a = positionIds[triangle[0]];
+            auto b = positionIds[triangle[1]];
+            auto c = positionIds[triangle[2]];
+            if (a != b && b != c && c != a)
+            {
+                triangles.emplace_back(triangle);
+            }
+        }
+
+        std::vector<std::vector<uint32_t>> adjacency(positionCount);
+        std::vector<Quadric> quadrics(positionCount);
+        std::vector<uint64_t> edges {};
+        edges.reserve(triangles.size() * 3);
+        for (uint32_t t = 0; t < triangles.size(); ++t)
+        {
+            auto quadric = Quadric::FromTriangle(position(triangles[t][0]), position(triangles[t][1]), position(triangles[t][2]));
+            for (uint32_t j = 0; j < 3; ++j)
+            {
+                auto a = positionIds[triangles[t][j]];
+                auto b = positionIds[triangles[t][(j + 1) % 3]];
+                adjacency[a].emplace_back(t);
+                quadrics[a] += quadric;
+                edges.emplace_back(EdgeKey(a, b));
+            }
+        }
+
+        // 只被一个三角形使用的边是网格的边界，超过两个是非流形的边，它们的端点和接缝都不移动
+        std::vector<bool> locked(positionCount, false);
+        for (uint32_t p = 0; p < positionCount; ++p)
+        {
+            locked[p] = wedgeCount[p] > 1;
+        }
+        std::ranges::sort(edges);
+        for (size_t i = 0; i < edges.size();)
+        {
+            auto j = i;
+            while (j < edges.size() && edges[j] == edges[i])
+            {
+                ++j;
+            }
+            if (2 != j - i)
+            {
+                locked[edges[i] >> 32]                  = true;
+                locked[static_cast<uint32_t>(edges[i])] = true;
+            }
+            i = j;
+        }
+
+        std::vector<bool> removed(triangles.size(), false);
+        std::vector<uint32_t> versions(positionCount, 0);
+        std::priority_queue<Collapse, std::vector<Collapse>, std::greater<>> heap {};
+
+        std::vector<uint32_t> neighbors {};
+        std::vector<uint32_t> targetNeighbors {};
+        std::vector<uint32_t> common {};
+
+        // p 和每个相邻的位置之间的两个方向的折叠，bothDirections 为 false 时只添加从 p 出发的折叠
+        auto pushCollapses = [&](uint32_t p, bool bothDirections) {
+            CollectNeighbors(adjacency[p], triangles, positionIds, p, neighbors);
+            for (auto other : neighbors)
+            {
+                auto quadric = quadrics[p] + quadrics[other];
+                if (!locked[p])
+                {
+                    heap.push({quadric.Error(position(representatives[other])), p, other, versions[p], versions[other]});
+                }
+                if (bothDirections && !locked[other])
+                {
+                    heap.push({quadric.Error(position(representatives[p])), other, p, versions[other], versions[p]});
+                }
+            }
+        };
+
+        for (uint32_t p = 0; p < positionCount; ++p)
+        {
+            pushCollapses(p, false);
+        }
+
+        auto triangleCount = triangles.size();
+        auto targetErrorSq = static_cast<double>(targetError) * static_cast<double>(targetError);
+        double maxErrorSq {0.0};
+
+        auto outputTriangles = [&]() {
+            std::vector<uint32_t> result {};
+            result.reserve(triangleCount * 3);
+            for (size_t t = 0; t < triangles.size(); ++t)
+            {
+                if (!removed[t])
+                {
+                    result.insert(result.end(), triangles[t].begin(), triangles[t].end());
+                }
+            }
+            output(std::move(result), static_cast<float>(std::sqrt(maxErrorSq)));
+        };
+
+        size_t nextTarget {0};
+        while (nextTarget < targetIndexCounts.size())
+        {
+            if (triangleCount <= targetIndexCounts[nextTarget] / 3)
+            {
+                outputTriangles();
+                ++nextTarget;
+                continue;
+            }
+            if (heap.empty())
+            {
+                break;
+            }
+
+            auto collapse = heap.top();
+            heap.pop();
+
+            auto from = collapse.from;
+            auto to   = collapse.to;
+            if (collapse.fromVersion != versions[from] || collapse.toVersion != versions[to] || adjacency[from].empty())
+            {
+                continue;
+            }
+            if (collapse.error > targetErrorSq)
+            {
+                break;
+            }
+
+            // 两个端点必须仍然相邻，并且只有两个共同的邻居（边两侧的三角形），否则折叠之后拓扑改变
+            CollectNeighbors(adjacency[from], triangles, positionIds, from, neighbors);
+            CollectNeighbors(adjacency[to], triangles, positionIds, to, targetNeighbors);
+            if (!std::ranges::binary_search(neighbors, to))
+            {
+                continue;
+            }
+
+            common.clear();
+            std::ranges::set_intersection(neighbors, targetNeighbors, std::back_inserter(common));
+            if (2 != common.size())
+            {
+                continue;
+            }
+
+            // 移动之后不能有三角形翻转
+            auto target = position(representatives[to]);
+            uint32_t targetVertex {0};
+            bool flipped {false};
+            for (auto t : adjacency[from])
+            {
+                const auto& triangle = triangles[t];
+                auto corner          = std::ranges::find_if(triangle, [&](uint32_t v) { return positionIds[v] == from; }) - triangle.begin();
+                auto shared          = std::ranges::find_if(triangle, [&](uint32_t v) { return positionIds[v] == to; });
+                if (shared != triangle.end())
+                {
+                    targetVertex = *shared;
+                    continue;
+                }
+
+                auto p0     = position(triangle[(corner + 1) % 3]);
+                auto p1     = position(triangle[(corner + 2) % 3]);
+                auto before = Normal(position(triangle[corner]), p0, p1);
+                auto after  = Normal(target, p0, p1);
+                if (Dot(before, after) <= 0.0)
+                {
+                    flipped = true;
+                    break;
+                }
+            }
+            if (flipped)
+            {
+                continue;
+            }
+
+            // 折叠：from 的三角形中 from 的顶点替换为 to 在共享三角形中的顶点，包含 to 的三角形退化之后删除
+            for (auto t : adjacency[from])
+            {
+                auto& triangle = triangles[t];
+                if (std::ranges::any_of(triangle, [&](uint32_t v) { return positionIds[v] == to; }))
+                {
+                    removed[t] = true;
+                    --triangleCount;
+                    continue;
+                }
+
+                for (auto& vertex : triangle)
+                {
+                    if (positionIds[vertex] == from)
+                    {
+                        vertex = targetVertex;
+                    }
+                }
+                adjacency[to].emplace_back(t);
+            }
+            adjacency[from].clear();
+
+            // 其他邻居的二次误差没有变化，堆中以它们为端点的折叠仍然有效，只有和 to 相连的折叠需要重新计算
+            for (auto p : neighbors)
+            {
+                std::erase_if(adjacency[p], [&removed](uint32_t t) { return removed[t]; });
+            }
+
+            quadrics[to] += quadrics[from];
+            ++versions[from];
+            ++versions[to];
+            maxErrorSq = std::max(maxErrorSq, collapse.error);
+
+            pushCollapses(to, true);
+        }
+
+        // 没有达到目标时输出最后的结果
+        if (nextTarget < targetIndexCounts.size())
+        {
+            outputTriangles();
+        }
+    }
+
+    /// @brief 对称的 4x4 矩阵（只保存上三角的 10 个元素）和面积之和，误差除以面积得到均方距离
+    struct Quadric
+    {
+        std::array<double, 10> m {};
+        double weight {0.0};
+
+        static Quadric FromTriangle(const std::array<double, 3>& p0, const std::array<double, 3>& p1, const std::array<double, 3>& p2) noexcept
+        {
+            auto n      = Normal(p0, p1, p2);
+            auto length = std::sqrt(Dot(n, n));
+
+            Quadric quadric {};
+            if (length <= 0.0)
+            {
+                return quadric;
+            }
+
+            auto area = length * .5;
+            auto a    = n[0] / length;
+            auto b    = n[1] / length;
+            auto c    = n[2] / length;
+            auto d    = -(a * p0[0] + b * p0[1] + c * p0[2]);
+
+            quadric.m      = {a * a, a * b, a * c, a * d, b * b, b * c, b * d, c * c, c * d, d * d};
+            quadric.weight = area;
+            for (auto& value : quadric.m)
+            {
+                value *= area;
+            }
+
+            return quadric;
+        }
+
+        Quadric& operator+=(const Quadric& other) noexcept
+        {
+            for (size_t i = 0; i < m.size(); ++i)
+            {
+                m[i] += other.m[i];
+            }
+            weight += other.weight;
+            return *this;
+        }
+
+        Quadric operator+(const Quadric& other) const noexcept
+        {
+            auto result = *this;
+            result += other;
+            return result;
+        }
+
+        /// @brief 点到所有平面的距离的平方按面积加权的平均值
+        double Error(const std::array<double, 3>& p) const noexcept
+        {
+            auto [x, y, z] = p;
+
+            auto error = m[0] * x * x + 2.0 * m[1] * x * y + 2.0 * m[2] * x * z + 2.0 * m[3] * x + m[4] * y * y + 2.0 * m[5] * y * z
+                       + 2.0 * m[6] * y + m[7] * z * z + 2.0 * m[8] * z + m[9];
+
+            return weight > 0.0 ? std::max(error / weight, 0.0) : 0.0;
+        }
+    };
+
+    struct Collapse
+    {
+        double error {0.0};
+        uint32_t from {0};
+        uint32_t to {0};
+        uint32_t fromVersion {0}; // 端点的二次误差或者邻接关系改变之后，堆中旧的折叠不再有效
+        uint32_t toVersion {0};
+
+        bool operator>(const Collapse& other) const noexcept
+        {
+            return error > other.error;
+        }
+    };
+
+    static uint64_t EdgeKey(uint32_t a, uint32_t b) noexcept
+    {
+        return (static_cast<uint64_t>(std::min(a, b)) << 32) | std::max(a, b);
+    }
+
+    static std::array<double, 3> Normal(const std::array<double, 3>& p0, const std::array<double, 3>& p1, const std::array<double, 3>& p2) noexcept
+    {
+        std::array<double, 3> e1 {p1[0] - p0[0], p1[1] - p0[1], p1[2] - p0[2]};
+        std::array<double, 3> e2 {p2[0] - p0[0], p2[1] - p0[1], p2[2] - p0[2]};
+        return {e1[1] * e2[2] - e1[2] * e2[1], e1[2] * e2[0] - e1[0] * e2[2], e1[0] * e2[1] - e1[1] * e2[0]};
+    }
+
+    static double Dot(const std::array<double, 3>& a, const std::array<double, 3>& b) noexcept
+    {
+        return a[0] * b[0] + a[1] * b[1] + a[2] * b[2];
+    }
+
+    /// @brief 使用 p 的三角形中除 p 以外的位置，排序并去重
+    static void CollectNeighbors(
+        const std::vector<uint32_t>& adjacency,
+        const std::vector<std::array<uint32_t, 3>>& triangles,
+        const std::vector<uint32_t>& positionIds,
+        uint32_t p,
+        std::vector<uint32_t>& neighbors
+    )
+    {
+        neighbors.clear();
+        for (auto t : adjacency)
+        {
+            for (auto vertex : triangles[t])
+            {
+                if (positionIds[vertex] != p)
+                {
+                    neighbors.emplace_back(positionIds[vertex]);
+                }
+            }
+        }
+        std::ranges::sort(neighbors);
+        neighbors.erase(std::unique(neighbors.begin(), neighbors.end()), neighbors.end());
+    }
+};
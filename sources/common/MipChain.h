@@ -0,0 +1,86 @@
+#pragma once
+
+#include <algorithm>
+#include <array>
+#include <cmath>
+#include <cstddef>
+#include <cstdint>
+#include <vector>
+
+/// @brief 在 CPU 上生成 8 位图像的完整 mip 链，cook 纹理和纹理流送共用
+class MipChain
+{
+public:
+    /// @brief 每一级是上一级的 2x2 盒式滤波，尺寸向下取整，奇数尺寸时最后一行（列）被丢弃，只有一行（列）时重复使用这一行（列）
+    /// @param channels 每个像素的通道数，4 个通道时第 4 个通道是 alpha
+    /// @param srgb 为 true 时颜色通道在线性空间中求平均，否则 sRGB 纹理的小 mip 会偏暗，alpha 总是线性的
+    /// @return 第 0 级是原图
+    static std::vector<std::vector<uint8_t>> Generate(const uint8_t* pixels, uint32_t width, uint32_t height, uint32_t channels, bool srgb)
+    {
+        std::vector<std::vector<uint8_t>> levels {};
+        levels.emplace_back(pixels, pixels + size_t {width} * height * channels);
+
+        const auto& toLinear = GetSrgbToLinearTable();
+
+        while (width > 1 || height > 1)
+        {
+            auto mipWidth  = std::max(width / 2, 1u);
+            auto mipHeight = std::max(height / 2, 1u);
+
+            const auto& source = levels.back();
+            std::vector<uint8_t> mip(size_t {mipWidth} * mipHeight * channels);
+            for (uint32_t y = 0; y < mipHeight; ++y)
+            {
+                std::array<uint32_t, 2> rows {std::min(y * 2, height - 1), std::min(y * 2 + 1, height - 1)};
+                for (uint32_t x = 0; x < mipWidth; ++x)
+                {
+                    std::array<uint32_t, 2> columns {std::min(x * 2, width - 1), std::min(x * 2 + 1, width - 1)};
+                    for (uint32_t c = 0; c < channels; ++c)
+                    {
+                        auto linear = srgb && c < 3;
+
+                        float sum {0.f};
+                        for (auto row : rows)
+                        {
+                            for (auto column : columns)
+                            {
+                                auto value = source[(size_t {row} * width + column) * channels + c];
+                                sum += linear ? toLinear[value] : value / 255.f;
+                            }
+                        }
+
+                        auto average = sum * .25f;
+                        auto encoded = linear ? LinearToSrgb(average) : average;
+                        mip[(size_t {y} * mipWidth + x) * channels + c] = static_cast<uint8_t>(std::clamp(encoded * 255.f + .5f, 0.f, 255.f));
+                    }
+                }
+            }
+
+            levels.emplace_back(std::move(mip));
+            width  = mipWidth;
+            height = mipHeight;
+        }
+
+        return levels;
+    }
+
+private:
+    static const std::array<float, 256>& GetSrgbToLinearTable() noexcept
+    {
+        static const auto table = []() {
+            std::array<float, 256> values {};
+            for (size_t i = 0; i < values.size(); ++i)
+            {
+                auto value = i / 255.f;
+                values[i]  = value <= .04045f ? value / 12.92f : std::pow((value + .055f) / 1.055f, 2.4f);
+            }
+            return values;
+        }();
+        return table;
+    }
+
+    static float LinearToSrgb(float value) noexcept
+    {
+        return value <= .0031308f ? value * 12.92f : 1.055f * std::pow(value, 1.f / 2.4f) - .055f;
+    }
+};
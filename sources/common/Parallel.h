@@ -0,0 +1,97 @@
+#pragma once
+
+#include "ThreadPool.h"
+
+#include <algorithm>
+#include <atomic>
+#include <condition_variable>
+#include <cstdint>
+#include <exception>
+#include <memory>
+#include <mutex>
+
+/// @brief 多个示例共用的数据并行：把 [0, count) 平均分为 taskCount 段，在共享的线程池和当前线程上执行
+/// @details 线程池在第一次使用时创建（硬件线程数），之后的调用不再创建线程
+///          每一段由第一个空闲的线程领取，当前线程也领取，所以在线程池的任务中调用也不会因为等待自己而死锁
+///          第 t 段总是 [t * chunk, (t + 1) * chunk)，和由哪个线程执行无关，调用者可以按段的序号存放每一段的结果
+class Parallel
+{
+public:
+    static ThreadPool& GetPool()
+    {
+        static ThreadPool pool {};
+        return pool;
+    }
+
+    /// @param requested 为 0 时使用线程池的线程数
+    /// @return 每一段至少有 minWorkPerTask 个元素，结果不小于 1
+    static uint32_t GetTaskCount(size_t workCount, size_t minWorkPerTask, uint32_t requested)
+    {
+        auto taskCount = 0 == requested ? GetPool().GetThreadCount() : requested;
+        auto useful    = static_cast<uint32_t>(std::max<size_t>(workCount / minWorkPerTask, 1));
+        return std::max(std::min(taskCount, useful), 1u);
+    }
+
+    /// @brief function(begin, end, task) 对每一段调用一次，所有段完成之后返回，第一个异常在返回前重新抛出
+    template <typename Function>
+    static void For(size_t count, uint32_t taskCount, const Function& function)
+    {
+        if (taskCount <= 1)
+        {
+            function(0, count, 0);
+            return;
+        }
+
+        // 领取不到段的任务可能在 For 返回之后才开始执行，只访问共享的状态
+        struct State
+        {
+            std::atomic_uint32_t next {0};
+            std::atomic_uint32_t done {0};
+            std::mutex mutex {};
+            std::condition_variable condition {};
+            std::exception_ptr exception {};
+        };
+
+        auto state = std::make_shared<State>();
+        auto chunk = (count + taskCount - 1) / taskCount;
+        auto run   = [state, &function, chunk, count, taskCount]() {
+            for (auto t = state->next.fetch_add(1); t < taskCount; t = state->next.fetch_add(1))
+            {
+                try
+                {
+                    function(std::min(chunk * t, count), std::min(chunk * (t + 1), count), t);
+                }
+                catch (...)
+                {
+                    std::lock_guard lk(state->mutex);
+                    if (!state->exception)
+                    {
+                        state->exception = std::current_exception();
+                    }
+                }
+
+                if (state->done.fetch_add(1) + 1 == taskCount)
+                {
+                    std::lock_guard lk(state->mutex);
+                    state->condition.notify_all();
+                }
+            }
+        };
+
+        auto& pool   = GetPool();
+        auto helpers = std::min(taskCount - 1, pool.GetThreadCount());
+        for (uint32_t i = 0; i < helpers; ++i)
+        {
+            pool.Submit(run);
+        }
+
+        run();
+
+        std::unique_lock lk(state->mutex);
+        state->condition.wait(lk, [&state, taskCount]() { return state->done.load() == taskCount; });
+        if (state->exception)
+        {
+            std::rethrow_exception(state->exception);
+        }
+    }
+};
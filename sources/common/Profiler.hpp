@@ -0,0 +1,409 @@
+#pragma once
+
+#include <algorithm>
+#include <array>
+#include <atomic>
+#include <chrono>
+#include <cstdint>
+#include <cstdio>
+#include <fstream>
+#include <functional>
+#include <iostream>
+#include <map>
+#include <memory>
+#include <mutex>
+#include <stdexcept>
+#include <string>
+#include <string_view>
+#include <vector>
+
+/// @brief 分层的 CPU 性能分析，只有头文件，位于 sources/common，所有示例直接 #include "Profiler.hpp" 使用
+/// @details PROFILE_SCOPE("name") 在构造和析构时向当前线程的环形缓冲写入开始/结束事件（纳秒时间戳）
+///          每个线程只有自己写自己的缓冲，写入时没有锁；读取时复制一份快照，复制过程中被覆盖的事件直接丢弃
+///          定义 DISABLE_PROFILER 时所有的宏都为空；运行时没有 Profiler::SetEnabled(true) 时每个 scope 只有一次原子读取
+///          时间戳使用 std::chrono::steady_clock，和 GpuProfiler 对齐后的 GPU 事件在同一条时间轴上
+class Profiler
+{
+public:
+    enum class EventType : uint8_t
+    {
+        Begin,
+        End,
+        Frame,
+    };
+
+    struct Event
+    {
+        const char* name {nullptr}; // 必须是静态存储的字符串，例如字符串字面量或 __func__
+        int64_t timestamp {0};
+        EventType type {EventType::Begin};
+    };
+
+    struct ScopeStatistics
+    {
+        std::string thread {};
+        const char* name {nullptr};
+        uint32_t calls {0};
+        int64_t total {0}; // 纳秒，包含嵌套的子 scope
+    };
+
+    struct FrameReport
+    {
+        uint64_t markerIndex {0}; // 开始标记在本次快照所有帧标记中的序号，不是应用程序的帧号
+        int64_t begin {0};
+        int64_t end {0};
+        std::vector<ScopeStatistics> scopes {};
+    };
+
+    static inline constexpr size_t Capacity {1 << 15}; // 每个线程最多保留的事件数
+
+    static void SetEnabled(bool enabled) noexcept
+    {
+        s_enabled.store(enabled, std::memory_order_relaxed);
+    }
+
+    static bool IsEnabled() noexcept
+    {
+        return s_enabled.load(std::memory_order_relaxed);
+    }
+
+    static int64_t Now() noexcept
+    {
+        return std::chrono::duration_cast<std::chrono::nanoseconds>(std::chrono::steady_clock::now().time_since_epoch()).count();
+    }
+
+    static void Begin(const char* name) noexcept
+    {
+        GetThreadBuffer().Push({name, Now(), EventType::Begin});
+    }
+
+    static void End() noexcept
+    {
+        GetThreadBuffer().Push({nullptr, Now(), EventType::End});
+    }
+
+    // 帧标记，两个标记之间的所有 scope 汇总为一帧
+    static void MarkFrame(const char* name = "frame") noexcept
+    {
+        if (IsEnabled())
+        {
+            GetThreadBuffer().Push({name, Now(), EventType::Frame});
+        }
+    }
+
+    static void SetThreadName(const std::string& name)
+    {
+        auto& buffer = GetThreadBuffer();
+        std::lock_guard lk(s_mutex);
+        buffer.name = name;
+    }
+
+    // 以最后一个帧标记结束的最近 count 帧
+    static std::vector<FrameReport> BuildFrameReports(size_t count = 1)
+    {
+        auto snapshots = TakeSnapshots();
+
+        std::vector<int64_t> markers {};
+        for (const auto& snapshot : snapshots)
+        {
+            for (const auto& event : snapshot.events)
+            {
+                if (EventType::Frame == event.type)
+                {
+                    markers.emplace_back(event.timestamp);
+                }
+            }
+        }
+        std::sort(markers.begin(), markers.end());
+
+        std::vector<FrameReport> reports {};
+        if (markers.size() < 2)
+        {
+            return reports;
+        }
+
+        auto first = markers.size() - 1 > count ? markers.size() - 1 - count : 0;
+        for (auto i = first; i + 1 < markers.size(); ++i)
+        {
+            FrameReport report {};
+            report.markerIndex = i;
+            report.begin       = markers[i];
+            report.end         = markers[i + 1];
+
+            std::map<std::pair<std::string, const char*>, ScopeStatistics> scopes {};
+            for (const auto& snapshot : snapshots)
+            {
+                ForEachScope(snapshot.events, [&](const char* name, int64_t begin, int64_t end) {
+                    if (begin >= report.begin && begin < report.end)
+                    {
+                        auto& statistics  = scopes[{snapshot.name, name}];
+                        statistics.thread = snapshot.name;
+                        statistics.name   = name;
+                        statistics.calls++;
+                        statistics.total += end - begin;
+                    }
+                });
+            }
+
+            for (auto& [_, statistics] : scopes)
+            {
+                report.scopes.emplace_back(std::move(statistics));
+            }
+            reports.emplace_back(std::move(report));
+        }
+
+        return reports;
+    }
+
+    static void PrintFrameReports(std::ostream& os, size_t count = 1)
+    {
+        for (const auto& report : BuildFrameReports(count))
+        {
+            os << "frame marker " << report.markerIndex << ": " << static_cast<double>(report.end - report.begin) * 1e-6 << " ms\n";
+            for (const auto& scope : report.scopes)
+            {
+                os << "    [" << scope.thread << "] " << scope.name << " x" << scope.calls << ": " << static_cast<double>(scope.total) * 1e-6
+                   << " ms\n";
+            }
+        }
+    }
+
+    // Chrome/Perfetto 的 trace_event JSON，appendEvents 可以追加其他来源的事件（例如 GPU 时间戳），每个事件以 ",\n" 开头
+    static void SaveTrace(const std::string& fileName, const std::function<void(std::ostream&)>& appendEvents = {})
+    {
+        std::ofstream file(fileName);
+        if (!file.is_open())
+        {
+            throw std::runtime_error("failed to open file: " + fileName);
+        }
+
+        // ts 和 dur 的单位是微秒
+        file << "{\"displayTimeUnit\":\"ms\",\"traceEvents\":[\n";
+        file << R"({"name":"process_name","ph":"M","pid":0,"args":{"name":"Vulkan"}})";
+
+        for (const auto& snapshot : TakeSnapshots())
+        {
+            file << ",\n"
+                 << R"({"name":"thread_name","ph":"M","pid":0,"tid":)" << snapshot.id << R"(,"args":{"name":")" << EscapeJson(snapshot.name)
+                 << "\"}}";
+
+            for (const auto& event : snapshot.events)
+            {
+                if (EventType::Frame == event.type)
+                {
+                    file << ",\n"
+                         << R"({"name":")" << EscapeJson(event.name) << R"(","ph":"i","s":"g","pid":0,"tid":)" << snapshot.id
+                         << R"(,"ts":)" << FormatMicroseconds(event.timestamp) << '}';
+                }
+            }
+
+            ForEachScope(snapshot.events, [&](const char* name, int64_t begin, int64_t end) {
+                file << ",\n"
+                     << R"({"name":")" << EscapeJson(name) << R"(","cat":"cpu","ph":"X","pid":0,"tid":)" << snapshot.id << R"(,"ts":)"
+                     << FormatMicroseconds(begin) << R"(,"dur":)" << FormatMicroseconds(end - begin) << '}';
+            });
+        }
+
+        if (appendEvents)
+        {
+            appendEvents(file);
+        }
+
+        file << "\n]}\n";
+    }
+
+private:
+    struct ThreadBuffer
+    {
+        uint32_t id {0};
+        std::string name {};
+        bool alive {true};
+        std::atomic_uint64_t head {0};
+        std::array<Event, Capacity> events {};
+
+        void Push(const Event& event) noexcept
+        {
+            auto index               = head.load(std::memory_order_relaxed);
+            events[index % Capacity] = event;
+            head.store(index + 1, std::memory_order_release);
+        }
+    };
+
+    struct Snapshot
+    {
+        uint32_t id {0};
+        std::string name {};
+        std::vector<Event> events {};
+    };
+
+    // 线程退出之后缓冲仍然由全局列表持有，可以继续导出，直到被之后新建的线程复用
+    // 复用时清空旧线程的事件并恢复默认名字，避免新线程的 scope 和旧线程未配对的事件混在一起
+    // 每一帧都创建新线程（例如 10_windows 的录制线程）时缓冲的数量不会一直增长
+    struct ThreadSlot
+    {
+        ThreadBuffer* buffer {nullptr};
+
+        ThreadSlot()
+        {
+            std::lock_guard lk(s_mutex);
+            for (const auto& candidate : s_buffers)
+            {
+                if (!candidate->alive)
+                {
+                    // 旧线程已经退出，读取快照也需要 s_mutex，此时没有其他线程访问这个缓冲
+                    candidate->alive = true;
+                    candidate->name  = "thread " + std::to_string(candidate->id);
+                    candidate->head.store(0, std::memory_order_relaxed);
+                    buffer = candidate.get();
+                    return;
+                }
+            }
+
+            auto& result = s_buffers.emplace_back(std::make_unique<ThreadBuffer>());
+            result->id   = static_cast<uint32_t>(s_buffers.size());
+            result->name = "thread " + std::to_string(result->id);
+            buffer       = result.get();
+        }
+
+        ~ThreadSlot()
+        {
+            std::lock_guard lk(s_mutex);
+            buffer->alive = false;
+        }
+    };
+
+    static ThreadBuffer& GetThreadBuffer()
+    {
+        thread_local ThreadSlot slot {};
+        return *slot.buffer;
+    }
+
+    static std::vector<Snapshot> TakeSnapshots()
+    {
+        std::lock_guard lk(s_mutex);
+
+        std::vector<Snapshot> snapshots {};
+        for (const auto& buffer : s_buffers)
+        {
+            auto& snapshot = snapshots.emplace_back(Snapshot {buffer->id, buffer->name, {}});
+
+            auto head  = buffer->head.load(std::memory_order_acquire);
+            auto first = head > Capacity ? head - Capacity : 0;
+            snapshot.events.reserve(head - first);
+            for (auto i = first; i < head; ++i)
+            {
+                snapshot.events.emplace_back(buffer->events[i % Capacity]);
+            }
+
+            // 复制期间写线程可能已经覆盖了最旧的一部分，序号 newHead - Capacity 的位置可能正在被写入，也一起丢弃
+            auto newHead     = buffer->head.load(std::memory_order_acquire);
+            auto overwritten = newHead >= Capacity ? newHead - Capacity + 1 : 0;
+            if (overwritten > first)
+            {
+                auto count = std::min<size_t>(overwritten - first, snapshot.events.size());
+                snapshot.events.erase(snapshot.events.begin(), snapshot.events.begin() + count);
+            }
+        }
+
+        return snapshots;
+    }
+
+    // 把开始/结束事件配对，缺少开始事件（已经被覆盖）的结束事件被忽略
+    template <typename Func>
+    static void ForEachScope(const std::vector<Event>& events, Func&& func)
+    {
+        std::vector<const Event*> stack {};
+        for (const auto& event : events)
+        {
+            if (EventType::Begin == event.type)
+            {
+                stack.emplace_back(&event);
+            }
+            else if (EventType::End == event.type && !stack.empty())
+            {
+                func(stack.back()->name, stack.back()->timestamp, event.timestamp);
+                stack.pop_back();
+            }
+        }
+    }
+
+    // 名字中的引号、反斜杠和控制字符需要转义，否则导出的 JSON 无法解析
+    static std::string EscapeJson(std::string_view text)
+    {
+        std::string result {};
+        result.reserve(text.size());
+        for (auto c : text)
+        {
+            if ('"' == c || '\\' == c)
+            {
+                result += '\\';
+                result += c;
+            }
+            else if (static_cast<unsigned char>(c) < 0x20)
+            {
+                char buffer[8] {};
+                std::snprintf(buffer, sizeof(buffer), "\\u%04x", static_cast<unsigned int>(c));
+                result += buffer;
+            }
+            else
+            {
+                result += c;
+            }
+        }
+        return result;
+    }
+
+    static std::string FormatMicroseconds(int64_t nanoseconds)
+    {
+        char buffer[32] {};
+        std::snprintf(buffer, sizeof(buffer), "%.3f", static_cast<double>(nanoseconds) / 1000.0);
+        return buffer;
+    }
+
+private:
+    inline static std::atomic_bool s_enabled {false};
+    inline static std::mutex s_mutex {};
+    inline static std::vector<std::unique_ptr<ThreadBuffer>> s_buffers {};
+};
+
+class ProfileScope
+{
+public:
+    explicit ProfileScope(const char* name) noexcept
+        : m_active(Profiler::IsEnabled())
+    {
+        if (m_active)
+        {
+            Profiler::Begin(name);
+        }
+    }
+
+    ~ProfileScope() noexcept
+    {
+        if (m_active)
+        {
+            Profiler::End();
+        }
+    }
+
+    ProfileScope(const ProfileScope&)            = delete;
+    ProfileScope& operator=(const ProfileScope&) = delete;
+
+private:
+    bool m_active {false};
+};
+
+#define PROFILE_CONCAT_IMPL(a, b) a##b
+#define PROFILE_CONCAT(a, b)      PROFILE_CONCAT_IMPL(a, b)
+
+#ifdef DISABLE_PROFILER
+#define PROFILE_SCOPE(name)  ((void)0)
+#define PROFILE_FUNCTION()   ((void)0)
+#define PROFILE_FRAME(name)  ((void)0)
+#define PROFILE_THREAD(name) ((void)0)
+#else
+#define PROFILE_SCOPE(name)  ProfileScope PROFILE_CONCAT(profileScope, __LINE__)(name)
+#define PROFILE_FUNCTION()   PROFILE_SCOPE(__func__)
+#define PROFILE_FRAME(name)  Profiler::MarkFrame(name)
+#define PROFILE_THREAD(name) Profiler::SetThreadName(name)
+#endif
@@ -0,0 +1,181 @@
+#pragma once
+
+#include "MappedFile.h"
+
+#include <algorithm>
+#include <cstddef>
+#include <cstdint>
+#include <cstring>
+#include <span>
+#include <string>
+#include <vector>
+
+/// @brief 预处理（cook）之后的纹理文件头，和 KTX2 类似，所有 mip 和面已经按照上传的顺序排列，加载时不需要解码
+/// @details 文件布局：[TextureFileHeader][TextureFileLevel x levelCount][数据]
+///          和 KTX2 一样从最小的 mip 开始存放，每个 mip 的起始位置按 Alignment 对齐，同一个 mip 的所有面紧密排列，
+///          整个数据段复制到暂存缓冲的偏移 0 处之后，每个 mip 只需要一个 VkBufferImageCopy（layerCount = faceCount）
+struct TextureFileHeader
+{
+    static inline constexpr uint32_t Magic {0x52584554}; // "TEXR"
+    static inline constexpr uint32_t Version {2}; // 2: 支持块压缩格式
+    // 不小于常见设备的 optimalBufferCopyOffsetAlignment，同时是块大小的倍数
+    static inline constexpr uint64_t Alignment {256};
+
+    uint32_t magic {Magic};
+    uint32_t version {Version};
+    uint32_t format {0};      // VkFormat 的值，和加载时请求的格式不一致说明文件已经过期
+    uint32_t blockExtent {1}; // 块的边长（纹素），未压缩的格式为 1，BC 格式为 4
+    uint32_t blockSize {0};   // 每个块的字节数
+    uint32_t reserved {0};
+    uint32_t width {0};
+    uint32_t height {0};
+    uint32_t levelCount {0};
+    uint32_t faceCount {0}; // 立方体贴图为 6
+    uint64_t alignment {Alignment};
+    uint64_t dataOffset {0}; // 数据段相对于文件开始的偏移，所有 mip 的偏移都相对于数据段
+    uint64_t fileSize {0};
+};
+
+/// @brief 每个 mip 一项，按 mip 等级排列（第 0 项是最大的 mip）
+struct TextureFileLevel
+{
+    uint64_t offset {0};   // 相对于数据段的偏移，也就是暂存缓冲中的 bufferOffset
+    uint64_t faceSize {0}; // 一个面的字节数，整个 mip 的大小是 faceSize * faceCount
+    uint32_t width {0};
+    uint32_t height {0};
+};
+
+static_assert(sizeof(TextureFileHeader) % 8 == 0 && sizeof(TextureFileLevel) % 8 == 0);
+
+/// @brief 以只读方式把纹理文件映射到内存，mip 数据直接指向映射的内存，关闭之后失效
+class TextureFile
+{
+public:
+    /// @brief 文件不存在、格式或者版本不一致时返回 false，调用者需要重新 cook
+    bool Open(const std::string& fileName, uint32_t format)
+    {
+        if (!m_file.Open(fileName))
+        {
+            return false;
+        }
+
+        auto size = m_file.GetSize();
+        if (size < sizeof(TextureFileHeader))
+        {
+            Close();
+            return false;
+        }
+
+        const auto& header = GetHeader();
+        if (TextureFileHeader::Magic != header.magic || TextureFileHeader::Version != header.version || format != header.format
+            || size != header.fileSize || 0 == header.levelCount || 0 == header.faceCount
+            || sizeof(TextureFileHeader) + header.levelCount * sizeof(TextureFileLevel) > header.dataOffset || header.dataOffset > size)
+        {
+            Close();
+            return false;
+        }
+
+        for (const auto& level : GetLevels())
+        {
+            if (0 == header.blockExtent || 0 != level.offset % header.alignment
+                || level.faceSize != GetLevelSize(level.width, level.height, header.blockExtent, header.blockSize)
+                || header.dataOffset + level.offset + level.faceSize * header.faceCount > size)
+            {
+                Close();
+                return false;
+            }
+        }
+
+        return true;
+    }
+
+    void Close() noexcept
+    {
+        m_file.Close();
+    }
+
+    const TextureFileHeader& GetHeader() const noexcept
+    {
+        return *reinterpret_cast<const TextureFileHeader*>(m_file.GetData());
+    }
+
+    std::span<const TextureFileLevel> GetLevels() const noexcept
+    {
+        return {reinterpret_cast<const TextureFileLevel*>(m_file.GetData() + sizeof(TextureFileHeader)), GetHeader().levelCount};
+    }
+
+    /// @brief 整个数据段，按原样复制到暂存缓冲
+    std::span<const std::byte> GetData() const noexcept
+    {
+        const auto& header = GetHeader();
+        return {m_file.GetData() + header.dataOffset, header.fileSize - header.dataOffset};
+    }
+
+    /// @brief 一个面的一个 mip 的字节数，不足一个块的部分按整块计算
+    static constexpr uint64_t GetLevelSize(uint32_t width, uint32_t height, uint32_t blockExtent, uint32_t blockSize) noexcept
+    {
+        return uint64_t {(width + blockExtent - 1) / blockExtent} * ((height + blockExtent - 1) / blockExtent) * blockSize;
+    }
+
+    /// @brief cook：把所有面和 mip 按照文件布局写入磁盘
+    /// @param faces faces[f][level] 是第 f 个面的第 level 级 mip，已经是 format 的数据（RGBA8 或者压缩之后的块），所有面的 mip 个数必须相同
+    /// @param blockExtent 未压缩的格式为 1，BC 格式为 4
+    /// @param blockSize 每个块（纹素）的字节数
+    static void Write(
+        const std::string& fileName,
+        uint32_t format,
+        uint32_t width,
+        uint32_t height,
+        std::span<const std::vector<std::vector<uint8_t>>> faces,
+        uint32_t blockExtent = 1,
+        uint32_t blockSize   = 4
+    )
+    {
+        TextureFileHeader header {};
+        header.format      = format;
+        header.blockExtent = blockExtent;
+        header.blockSize   = blockSize;
+        header.width       = width;
+        header.height      = height;
+        header.levelCount  = static_cast<uint32_t>(faces.front().size());
+        header.faceCount   = static_cast<uint32_t>(faces.size());
+        header.dataOffset  = AlignUp(sizeof(TextureFileHeader) + header.levelCount * sizeof(TextureFileLevel));
+
+        // 从最小的 mip 开始排列
+        std::vector<TextureFileLevel> levels(header.levelCount);
+        uint64_t offset {0};
+        for (auto level = header.levelCount; level-- > 0;)
+        {
+            levels[level].width    = std::max(width >> level, 1u);
+            levels[level].height   = std::max(height >> level, 1u);
+            levels[level].faceSize = GetLevelSize(levels[level].width, levels[level].height, blockExtent, blockSize);
+            levels[level].offset   = offset;
+            offset                 = AlignUp(offset + levels[level].faceSize * header.faceCount);
+        }
+        header.fileSize = header.dataOffset + offset;
+
+        std::vector<std::byte> data(header.fileSize);
+        std::memcpy(data.data(), &header, sizeof(header));
+        std::memcpy(data.data() + sizeof(header), levels.data(), levels.size() * sizeof(TextureFileLevel));
+        for (uint32_t level = 0; level < header.levelCount; ++level)
+        {
+            for (uint32_t face = 0; face < header.faceCount; ++face)
+            {
+                const auto& pixels = faces[face][level];
+                auto destination   = header.dataOffset + levels[level].offset + face * levels[level].faceSize;
+                std::memcpy(data.data() + destination, pixels.data(), std::min<size_t>(pixels.size(), levels[level].faceSize));
+            }
+        }
+
+        MappedFile::Write(fileName, data);
+    }
+
+private:
+    static constexpr uint64_t AlignUp(uint64_t size) noexcept
+    {
+        return (size + TextureFileHeader::Alignment - 1) & ~(TextureFileHeader::Alignment - 1);
+    }
+
+private:
+    MappedFile m_file {};
+};
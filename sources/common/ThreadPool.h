@@ -0,0 +1,101 @@
+#pragma once
+
+#include <algorithm>
+#include <condition_variable>
+#include <cstdint>
+#include <functional>
+#include <future>
+#include <memory>
+#include <mutex>
+#include <queue>
+#include <thread>
+#include <type_traits>
+#include <vector>
+
+/// @brief 固定线程数的线程池，线程在构造时创建，析构时执行完队列中剩余的任务再结束
+/// @details 任务按提交的顺序执行，Submit 返回的 std::future 析构时不会等待任务（和 std::async 不同）
+///          任务中不能等待同一个线程池中的其他任务，所有线程都在等待时会死锁，需要等待的任务放到不同的线程池中
+class ThreadPool
+{
+public:
+    /// @param threadCount 为 0 时使用硬件线程数
+    explicit ThreadPool(uint32_t threadCount = 0)
+    {
+        auto count = 0 == threadCount ? std::max(std::thread::hardware_concurrency(), 1u) : threadCount;
+
+        m_threads.reserve(count);
+        for (uint32_t i = 0; i < count; ++i)
+        {
+            m_threads.emplace_back([this]() { Run(); });
+        }
+    }
+
+    ~ThreadPool() noexcept
+    {
+        {
+            std::lock_guard lk(m_mutex);
+            m_stop = true;
+        }
+        m_condition.notify_all();
+
+        for (auto& thread : m_threads)
+        {
+            thread.join();
+        }
+    }
+
+    ThreadPool(const ThreadPool&)            = delete;
+    ThreadPool& operator=(const ThreadPool&) = delete;
+
+    uint32_t GetThreadCount() const noexcept
+    {
+        return static_cast<uint32_t>(m_threads.size());
+    }
+
+    template <typename Func>
+    std::future<std::invoke_result_t<std::decay_t<Func>>> Submit(Func&& func)
+    {
+        using Result = std::invoke_result_t<std::decay_t<Func>>;
+
+        // std::function 要求可以复制，packaged_task 只能移动，所以放在 shared_ptr 中
+        auto task   = std::make_shared<std::packaged_task<Result()>>(std::forward<Func>(func));
+        auto future = task->get_future();
+        {
+            std::lock_guard lk(m_mutex);
+            m_tasks.emplace([task]() { (*task)(); });
+        }
+        m_condition.notify_one();
+
+        return future;
+    }
+
+private:
+    void Run()
+    {
+        while (true)
+        {
+            std::function<void()> task {};
+            {
+                std::unique_lock lk(m_mutex);
+                m_condition.wait(lk, [this]() { return m_stop || !m_tasks.empty(); });
+                if (m_tasks.empty())
+                {
+                    return;
+                }
+
+                task = std::move(m_tasks.front());
+                m_tasks.pop();
+            }
+
+            // 任务抛出的异常保存在 future 中
+            task();
+        }
+    }
+
+private:
+    std::vector<std::thread> m_threads {};
+    std::queue<std::function<void()>> m_tasks {};
+    std::mutex m_mutex {};
+    std::condition_variable m_condition {};
+    bool m_stop {false};
+};
@@ -0,0 +1,250 @@
+#pragma once
+
+#include "Parallel.h"
+
+#include <algorithm>
+#include <array>
+#include <atomic>
+#include <bit>
+#include <cmath>
+#include <cstdint>
+#include <cstring>
+#include <span>
+#include <type_traits>
+#include <vector>
+
+/// @brief 顶点焊接：合并相同的顶点，输出去重之后的顶点和每个输入顶点对应的新索引，代替 std::unordered_map<Vertex, uint32_t>
+/// @details 1. 并行计算每个顶点的 64 位哈希（按 4 字节的字读取顶点的原始数据）
+///          2. 按哈希的高位把顶点分到 PartitionCount 个分区，计数排序之后每个分区内仍然保持输入的顺序
+///          3. 每个线程依次领取分区，在分区内用开放寻址（线性探测）的哈希表查找第一次出现的顶点
+///          4. 按输入顺序给第一次出现的顶点分配新索引，结果和串行的 unordered_map 完全一致，和线程数无关
+///          epsilon 大于 0 时每个 float 分量先按 epsilon 量化再比较（网格吸附），用于扫描得到的数据：
+///          合并的顶点每个分量相差小于 epsilon，但是落在网格两侧的相邻顶点不会合并
+class VertexWelder
+{
+public:
+    struct Options
+    {
+        float epsilon {0.f};      // 0：逐位比较
+        uint32_t threadCount {0}; // 0：使用共享线程池的所有线程（Parallel.h）
+    };
+
+    /// @param vertices 每个三角形的每个角一个顶点
+    /// @param uniqueVertices 输出，按第一次出现的顺序排列，epsilon 焊接时使用第一次出现的顶点的值
+    /// @param remap 输出，remap[i] 是 vertices[i] 在 uniqueVertices 中的索引，可以直接作为索引缓冲
+    template <typename VertexType>
+    static void Weld(
+        std::span<const VertexType> vertices,
+        std::vector<VertexType>& uniqueVertices,
+        std::vector<uint32_t>& remap,
+        const Options& options = {}
+    )
+    {
+        static_assert(std::is_trivially_copyable_v<VertexType> && 0 == sizeof(VertexType) % sizeof(uint32_t));
+
+        const auto vertexCount = vertices.size();
+        const auto threadCount = Parallel::GetTaskCount(vertexCount, MinVerticesPerThread, options.threadCount);
+        const auto words       = sizeof(VertexType) / sizeof(uint32_t);
+
+        uniqueVertices.clear();
+        remap.assign(vertexCount, 0);
+        if (0 == vertexCount)
+        {
+            return;
+        }
+
+        // epsilon 焊接先把所有分量量化为整数，之后和逐位比较的流程相同
+        std::vector<uint32_t> quantized {};
+        if (options.epsilon > 0.f)
+        {
+            quantized.resize(vertexCount * words);
+            Parallel::For(vertexCount, threadCount, [&](size_t begin, size_t end, uint32_t) {
+                auto source = reinterpret_cast<const std::byte*>(vertices.data());
+                for (auto i = begin * words; i < end * words; ++i)
+                {
+                    float value {0.f};
+                    std::memcpy(&value, source + i * sizeof(float), sizeof(float));
+                    quantized[i] = static_cast<uint32_t>(static_cast<int64_t>(std::floor(value / options.epsilon + .5f)));
+                }
+            });
+        }
+
+        const Key key {
+            quantized.empty() ? reinterpret_cast<const std::byte*>(vertices.data()) : reinterpret_cast<const std::byte*>(quantized.data()), words
+        };
+
+        std::vector<uint64_t> hashes(vertexCount);
+        std::vector<std::array<uint32_t, PartitionCount>> histograms(threadCount);
+        Parallel::For(vertexCount, threadCount, [&](size_t begin, size_t end, uint32_t thread) {
+            auto& histogram = histograms[thread];
+            histogram.fill(0);
+            for (size_t i = begin; i < end; ++i)
+            {
+                hashes[i] = key.Hash(i);
+                ++histogram[Partition(hashes[i])];
+            }
+        });
+
+        // 计数排序：分区 p 中线程 t 的顶点排在线程 t - 1 之后，分区内保持输入的顺序
+        std::vector<uint32_t> partitionBegin(PartitionCount + 1, 0);
+        {
+            uint32_t offset {0};
+            for (uint32_t p = 0; p < PartitionCount; ++p)
+            {
+                partitionBegin[p] = offset;
+                for (auto& histogram : histograms)
+                {
+                    auto count   = histogram[p];
+                    histogram[p] = offset;
+                    offset += count;
+                }
+            }
+            partitionBegin[PartitionCount] = offset;
+        }
+
+        std::vector<uint32_t> order(vertexCount);
+        Parallel::For(vertexCount, threadCount, [&](size_t begin, size_t end, uint32_t thread) {
+            auto& cursor = histograms[thread];
+            for (size_t i = begin; i < end; ++i)
+            {
+                order[cursor[Partition(hashes[i])]++] = static_cast<uint32_t>(i);
+            }
+        });
+
+        // representative[i] 是和 vertices[i] 相同的第一个顶点
+        std::vector<uint32_t> representative(vertexCount);
+        std::atomic_uint32_t nextPartition {0};
+        Parallel::For(threadCount, threadCount, [&](size_t, size_t, uint32_t) {
+            std::vector<uint32_t> table {};
+            for (auto p = nextPartition.fetch_add(1); p < PartitionCount; p = nextPartition.fetch_add(1))
+            {
+                auto first = partitionBegin[p];
+                auto last  = partitionBegin[p + 1];
+                if (first == last)
+                {
+                    continue;
+                }
+
+                // 装载因子不超过 0.5
+                auto capacity = std::bit_ceil(std::max<size_t>((last - first) * 2, 16));
+                auto mask     = capacity - 1;
+                table.assign(capacity, EmptySlot);
+
+                for (auto i = first; i < last; ++i)
+                {
+                    auto index = order[i];
+                    auto slot  = hashes[index] & mask;
+                    while (true)
+                    {
+                        auto candidate = table[slot];
+                        if (EmptySlot == candidate)
+                        {
+                            table[slot]           = index;
+                            representative[index] = index;
+                            break;
+                        }
+                        if (hashes[candidate] == hashes[index] && key.Equal(candidate, index))
+                        {
+                            representative[index] = candidate;
+                            break;
+                        }
+                        slot = (slot + 1) & mask;
+                    }
+                }
+            }
+        });
+
+        // 按输入顺序编号：先统计每一段中第一次出现的顶点个数，再写入新索引
+        std::vector<uint32_t> uniqueCounts(threadCount + 1, 0);
+        Parallel::For(vertexCount, threadCount, [&](size_t begin, size_t end, uint32_t thread) {
+            uint32_t count {0};
+            for (size_t i = begin; i < end; ++i)
+            {
+                count += representative[i] == i ? 1 : 0;
+            }
+            uniqueCounts[thread + 1] = count;
+        });
+        for (uint32_t t = 0; t < threadCount; ++t)
+        {
+            uniqueCounts[t + 1] += uniqueCounts[t];
+        }
+
+        uniqueVertices.resize(uniqueCounts[threadCount]);
+        Parallel::For(vertexCount, threadCount, [&](size_t begin, size_t end, uint32_t thread) {
+            auto next = uniqueCounts[thread];
+            for (size_t i = begin; i < end; ++i)
+            {
+                if (representative[i] == i)
+                {
+                    uniqueVertices[next] = vertices[i];
+                    remap[i]             = next++;
+                }
+            }
+        });
+
+        // 第一次出现的顶点在上一步已经编号，其余顶点引用它的编号
+        Parallel::For(vertexCount, threadCount, [&](size_t begin, size_t end, uint32_t) {
+            for (size_t i = begin; i < end; ++i)
+            {
+                if (representative[i] != i)
+                {
+                    remap[i] = remap[representative[i]];
+                }
+            }
+        });
+    }
+
+private:
+    static inline constexpr uint32_t PartitionBits {8};
+    static inline constexpr uint32_t PartitionCount {1u << PartitionBits};
+    static inline constexpr uint32_t EmptySlot {~0u};
+    static inline constexpr size_t MinVerticesPerThread {1 << 16};
+
+    /// @brief 把顶点看作 uint32_t 数组，epsilon 焊接时指向量化之后的整数，否则是 float 的原始位
+    struct Key
+    {
+        const std::byte* data {nullptr};
+        size_t words {0};
+
+        uint32_t Word(size_t vertex, size_t word) const noexcept
+        {
+            uint32_t bits {0};
+            std::memcpy(&bits, data + (vertex * words + word) * sizeof(uint32_t), sizeof(bits));
+            return bits;
+        }
+
+        uint64_t Hash(size_t vertex) const noexcept
+        {
+            uint64_t hash {0x9e3779b97f4a7c15ull ^ words};
+            for (size_t i = 0; i < words; i += 2)
+            {
+                uint64_t value = Word(vertex, i);
+                if (i + 1 < words)
+                {
+                    value |= static_cast<uint64_t>(Word(vertex, i + 1)) << 32;
+                }
+
+                hash ^= value * 0x9e3779b97f4a7c15ull;
+                hash = std::rotl(hash, 29) * 0xbf58476d1ce4e5b9ull;
+            }
+
+            // splitmix64 的最后一步，高位（分区）和低位（哈希表的槽）都充分混合
+            hash ^= hash >> 30;
+            hash *= 0xbf58476d1ce4e5b9ull;
+            hash ^= hash >> 27;
+            hash *= 0x94d049bb133111ebull;
+            hash ^= hash >> 31;
+            return hash;
+        }
+
+        bool Equal(size_t a, size_t b) const noexcept
+        {
+            return 0 == std::memcmp(data + a * words * sizeof(uint32_t), data + b * words * sizeof(uint32_t), words * sizeof(uint32_t));
+        }
+    };
+
+    static uint32_t Partition(uint64_t hash) noexcept
+    {
+        return static_cast<uint32_t>(hash >> (64 - PartitionBits));
+    }
+};